@@ -0,0 +1,425 @@
+/*
+ * Benchmark suite: every operation family over a sweep of sizes, next to the
+ * naive loops the library started from (the baseline).
+ *
+ * usage: matrix_bench [--filter name] [--max-bytes N[K|M|G]] [--min-time s] [--max-run s]
+ *                     [--json path] [--no-naive]
+ *
+ * For each operation and size n (n x n operands, or vectors of n*n elements)
+ * the operation is repeated in batches of at least BENCH_BATCH seconds until
+ * --min-time has elapsed and BENCH_MIN_SAMPLES batches were timed; every batch
+ * gives one ns/op sample. The report shows the median, p90 and p99 of the
+ * samples, the GFLOP/s and GB/s of the median, and the speedup over the
+ * baseline.
+ * A size is skipped when its operands would exceed --max-bytes, or when the
+ * previous size predicts that one run would take longer than --max-run. The
+ * default of 1G stops the sweep at n = 8192; n = 16384 and 32768 need 3G and
+ * 12G.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "matrix.h"
+
+// shortest timed batch, in seconds
+#define BENCH_BATCH 1e-3
+
+// fewest and most samples per measurement
+#define BENCH_MIN_SAMPLES 10
+#define BENCH_MAX_SAMPLES 1000
+
+// operands of one size: n x n matrices a, b and c (results), a and b also as 1 x n*n vectors
+typedef struct {
+    size_t n;
+    matrix_t *a, *b, *c;
+    matrix_t va, vb;
+    MATRIX_TYPE sink;
+}bench_args_t;
+
+typedef struct {
+    const char *name;
+    // floating point operations and bytes moved by one run, for n x n operands (0 when not meaningful)
+    double (*flops)(double n);
+    double (*bytes)(double n);
+    void (*run)(bench_args_t *args);
+    void (*naive)(bench_args_t *args);
+}bench_t;
+
+// one measurement: percentiles of ns/op
+typedef struct {
+    double p50, p90, p99;
+    int done;
+}bench_stat_t;
+
+static double bench_now(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+/*
+ * Baseline: the loops of the first version of the library, on dense operands.
+ */
+
+static void naive_mul(const matrix_t *m1, const matrix_t *m2, matrix_t *result){
+    memset(result->data, 0, m1->row * m2->col * sizeof(MATRIX_TYPE));
+    for(size_t i = 0; i < m1->row; i++)
+        for(size_t j = 0; j < m2->col; j++)
+            for(size_t k = 0; k < m1->col; k++)
+                result->data[i*m2->col + j] += m1->data[i*m1->col + k] * m2->data[k*m2->col + j];
+}
+
+static void naive_run_mul(bench_args_t *x){
+    naive_mul(x->a, x->b, x->c);
+}
+
+static void naive_run_pow(bench_args_t *x){
+    // one product per unit of the exponent, through a copy, as m_pow did
+    size_t n = x->n;
+    matrix_t *tmp = matrix_init(n, n);
+    for(size_t i = 0; i < n; i++)
+        for(size_t j = 0; j < n; j++)
+            x->c->data[i*n + j] = i == j;
+    for(int e = 0; e < 8; e++){
+        memcpy(tmp->data, x->c->data, n * n * sizeof(MATRIX_TYPE));
+        naive_mul(tmp, x->a, x->c);
+    }
+    matrix_free(tmp);
+}
+
+static void naive_run_transp(bench_args_t *x){
+    size_t n = x->n;
+    for(size_t i = 0; i < n; i++)
+        for(size_t j = 0; j < n; j++)
+            x->c->data[j*n + i] = x->a->data[i*n + j];
+}
+
+static void naive_run_add(bench_args_t *x){
+    for(size_t i = 0; i < x->n * x->n; i++)
+        x->c->data[i] = x->a->data[i] + x->b->data[i];
+}
+
+static void naive_run_sub(bench_args_t *x){
+    for(size_t i = 0; i < x->n * x->n; i++)
+        x->c->data[i] = x->a->data[i] - x->b->data[i];
+}
+
+static void naive_run_kadd(bench_args_t *x){
+    for(size_t i = 0; i < x->n * x->n; i++)
+        x->c->data[i] = x->a->data[i] + 3;
+}
+
+static void naive_run_kmul(bench_args_t *x){
+    for(size_t i = 0; i < x->n * x->n; i++)
+        x->c->data[i] = x->a->data[i] * 3;
+}
+
+static void naive_run_kdiv(bench_args_t *x){
+    for(size_t i = 0; i < x->n * x->n; i++)
+        x->c->data[i] = x->a->data[i] / 3;
+}
+
+static void naive_run_dot(bench_args_t *x){
+    MATRIX_TYPE s = 0;
+    for(size_t i = 0; i < x->n * x->n; i++)
+        s += x->a->data[i] * x->b->data[i];
+    x->sink = s;
+}
+
+static void naive_run_sum_row(bench_args_t *x){
+    size_t n = x->n;
+    memset(x->c->data, 0, n * sizeof(MATRIX_TYPE));
+    for(size_t i = 0; i < n; i++)
+        for(size_t j = 0; j < n; j++)
+            x->c->data[j] += x->a->data[i*n + j];
+}
+
+static void naive_run_sum_column(bench_args_t *x){
+    size_t n = x->n;
+    memset(x->c->data, 0, n * sizeof(MATRIX_TYPE));
+    for(size_t i = 0; i < n; i++)
+        for(size_t j = 0; j < n; j++)
+            x->c->data[i] += x->a->data[i*n + j];
+}
+
+static void naive_run_tanh(bench_args_t *x){
+    for(size_t i = 0; i < x->n * x->n; i++)
+        x->c->data[i] = tanhf(x->a->data[i]);
+}
+
+/*
+ * Library operations, writing to preallocated results so that allocation is not timed.
+ */
+
+static MATRIX_TYPE bench_tanh(MATRIX_TYPE x){
+    return tanhf(x);
+}
+
+static void run_mul(bench_args_t *x){
+    m_mult(x->a, x->b, x->c);
+}
+
+static void run_pow(bench_args_t *x){
+    m_powt(x->a, 8, x->c);
+}
+
+static void run_transp(bench_args_t *x){
+    m_transpt(x->a, x->c);
+}
+
+static void run_add(bench_args_t *x){
+    m_addt(x->a, x->b, x->c);
+}
+
+static void run_sub(bench_args_t *x){
+    m_subt(x->a, x->b, x->c);
+}
+
+static void run_kadd(bench_args_t *x){
+    m_kaddt(x->a, 3, x->c);
+}
+
+static void run_kmul(bench_args_t *x){
+    m_kmult(x->a, 3, x->c);
+}
+
+static void run_kdiv(bench_args_t *x){
+    m_kdivt(x->a, 3, x->c);
+}
+
+static void run_dot(bench_args_t *x){
+    x->sink = m_dot(&x->va, &x->vb);
+}
+
+static void run_sum_row(bench_args_t *x){
+    matrix_t r = matrix_view_data(x->c->data, 1, x->n, x->n);
+    m_sumfdt(x->a, &r, ROW);
+}
+
+static void run_sum_column(bench_args_t *x){
+    matrix_t r = matrix_view_data(x->c->data, x->n, 1, 1);
+    m_sumfdt(x->a, &r, COLUMN);
+}
+
+static void run_apply(bench_args_t *x){
+    m_applyt(x->a, x->c, bench_tanh);
+}
+
+static void run_map(bench_args_t *x){
+    m_mapt(x->a, x->c, MATRIX_FN_TANH);
+}
+
+static double flops_mul(double n){ return 2 * n * n * n; }
+static double flops_pow(double n){ return 3 * 2 * n * n * n; }
+static double flops_elem(double n){ return n * n; }
+static double flops_dot(double n){ return 2 * n * n; }
+static double bytes_3(double n){ return 3 * n * n * sizeof(MATRIX_TYPE); }
+static double bytes_2(double n){ return 2 * n * n * sizeof(MATRIX_TYPE); }
+static double bytes_1(double n){ return n * n * sizeof(MATRIX_TYPE); }
+
+static const bench_t benchmarks[] = {
+    { "m_mul",          flops_mul,  bytes_3, run_mul,        naive_run_mul },
+    { "m_pow^8",        flops_pow,  bytes_2, run_pow,        naive_run_pow },
+    { "m_transp",       NULL,       bytes_2, run_transp,     naive_run_transp },
+    { "m_add",          flops_elem, bytes_3, run_add,        naive_run_add },
+    { "m_sub",          flops_elem, bytes_3, run_sub,        naive_run_sub },
+    { "m_kadd",         flops_elem, bytes_2, run_kadd,       naive_run_kadd },
+    { "m_kmul",         flops_elem, bytes_2, run_kmul,       naive_run_kmul },
+    { "m_kdiv",         flops_elem, bytes_2, run_kdiv,       naive_run_kdiv },
+    { "m_dot",          flops_dot,  bytes_2, run_dot,        naive_run_dot },
+    { "m_sumfd(ROW)",   flops_elem, bytes_1, run_sum_row,    naive_run_sum_row },
+    { "m_sumfd(COL)",   flops_elem, bytes_1, run_sum_column, naive_run_sum_column },
+    { "m_apply(tanh)",  NULL,       bytes_2, run_apply,      naive_run_tanh },
+    { "m_map(TANH)",    NULL,       bytes_2, run_map,        naive_run_tanh },
+};
+
+static const size_t sizes[] = { 4, 16, 64, 256, 1024, 4096, 8192, 16384, 32768 };
+
+static int bench_cmp(const void *a, const void *b){
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static bench_stat_t bench_measure(void (*fn)(bench_args_t *), bench_args_t *args, double min_time){
+    /*
+        * time fn in batches
+        * @return bench_stat_t : percentiles of ns/op over the batches
+    */
+    static double samples[BENCH_MAX_SAMPLES];
+    bench_stat_t st = { 0 };
+
+    // warm up (page faults, thread pool), and size the batches from the first run
+    double t = bench_now();
+    fn(args);
+    double once = bench_now() - t;
+    size_t reps = once >= BENCH_BATCH ? 1 : (size_t)(BENCH_BATCH / (once > 1e-9 ? once : 1e-9)) + 1;
+
+    size_t count = 0;
+    double start = bench_now();
+    while(count < BENCH_MAX_SAMPLES && (count < BENCH_MIN_SAMPLES || bench_now() - start < min_time)){
+        // a single run longer than the whole budget is measured three times only
+        if(count >= 3 && once > min_time)
+            break;
+        t = bench_now();
+        for(size_t r = 0; r < reps; r++)
+            fn(args);
+        samples[count++] = (bench_now() - t) / (double)reps * 1e9;
+    }
+
+    qsort(samples, count, sizeof(double), bench_cmp);
+    st.p50 = samples[(count - 1) / 2];
+    st.p90 = samples[(count * 9 - 1) / 10];
+    st.p99 = samples[(count * 99 - 1) / 100];
+    st.done = 1;
+    return st;
+}
+
+static int bench_skip(double prev_ns, double (*work)(double), size_t prev, size_t n, double max_run){
+    // one run of size n is predicted to take longer than max_run from the previous size
+    if(!prev_ns)
+        return 0;
+    double scale = work((double)n) / work((double)prev);
+    return prev_ns * scale * 1e-9 > max_run;
+}
+
+static size_t bench_parse_bytes(const char *s){
+    char *end;
+    double v = strtod(s, &end);
+    switch(*end){
+        case 'G': case 'g': v *= 1024;  // fall through
+        case 'M': case 'm': v *= 1024;  // fall through
+        case 'K': case 'k': v *= 1024;
+    }
+    return (size_t)v;
+}
+
+static void bench_usage(const char *argv0){
+    fprintf(stderr, "usage: %s [--filter name] [--max-bytes N[K|M|G]] [--min-time s] [--max-run s] "
+                    "[--json path] [--no-naive]\n"
+                    "  --max-bytes: largest memory of the three operands of a size (default 1G, up to n = 8192;\n"
+                    "               n = 16384 needs 3G, n = 32768 12G)\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char **argv){
+    const char *filter = NULL, *json = NULL;
+    size_t max_bytes = (size_t)1 << 30;
+    double min_time = 0.25, max_run = 5;
+    int naive = 1;
+
+    for(int i = 1; i < argc; i++){
+        if(!strcmp(argv[i], "--no-naive"))
+            naive = 0;
+        else if(i + 1 >= argc)
+            bench_usage(argv[0]);
+        else if(!strcmp(argv[i], "--filter"))
+            filter = argv[++i];
+        else if(!strcmp(argv[i], "--max-bytes"))
+            max_bytes = bench_parse_bytes(argv[++i]);
+        else if(!strcmp(argv[i], "--min-time"))
+            min_time = atof(argv[++i]);
+        else if(!strcmp(argv[i], "--max-run"))
+            max_run = atof(argv[++i]);
+        else if(!strcmp(argv[i], "--json"))
+            json = argv[++i];
+        else
+            bench_usage(argv[0]);
+    }
+
+    FILE *out = NULL;
+    if(json && !(out = fopen(json, "w"))){
+        perror(json);
+        return 1;
+    }
+    if(out)
+        fprintf(out, "{\n  \"type\": \"f32\",\n  \"threads\": %zu,\n  \"results\": [", matrix_get_num_threads());
+
+    printf("%-14s %6s %12s %12s %12s %9s %9s %12s %8s\n",
+           "op", "n", "ns/op p50", "p90", "p99", "GFLOP/s", "GB/s", "naive p50", "speedup");
+
+    int first = 1;
+    for(size_t b = 0; b < sizeof(benchmarks) / sizeof(*benchmarks); b++){
+        const bench_t *op = &benchmarks[b];
+        if(filter && !strstr(op->name, filter))
+            continue;
+
+        double prev_ns = 0, prev_naive = 0;
+        size_t prev = 0, prev_n_naive = 0;
+        int run_naive = naive;
+        double (*work)(double) = op->flops ? op->flops : op->bytes;
+
+        for(size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); s++){
+            size_t n = sizes[s];
+            if(3 * n * n * sizeof(MATRIX_TYPE) > max_bytes || bench_skip(prev_ns, work, prev, n, max_run))
+                break;
+
+            bench_args_t args = { .n = n, .a = matrix_init(n, n), .b = matrix_init(n, n), .c = matrix_init(n, n) };
+            if(!args.a || !args.b || !args.c){
+                fprintf(stderr, "%s: n = %zu does not fit in memory\n", op->name, n);
+                if(args.a) matrix_free(args.a);
+                if(args.b) matrix_free(args.b);
+                if(args.c) matrix_free(args.c);
+                break;
+            }
+
+            // entries of magnitude about 1/sqrt(n), so that powers stay finite
+            MATRIX_TYPE scale = (MATRIX_TYPE)(2 / sqrt((double)n));
+            for(size_t i = 0; i < n * n; i++){
+                args.a->data[i] = ((MATRIX_TYPE)rand() / (MATRIX_TYPE)RAND_MAX - (MATRIX_TYPE)0.5) * scale;
+                args.b->data[i] = ((MATRIX_TYPE)rand() / (MATRIX_TYPE)RAND_MAX - (MATRIX_TYPE)0.5) * scale;
+            }
+            args.va = matrix_view_data(args.a->data, 1, n * n, n * n);
+            args.vb = matrix_view_data(args.b->data, 1, n * n, n * n);
+
+            bench_stat_t st = bench_measure(op->run, &args, min_time), base = { 0 };
+            // once the baseline is too slow for one size, it is for the larger ones as well
+            run_naive = run_naive && !bench_skip(prev_naive, work, prev_n_naive, n, max_run);
+            if(run_naive){
+                base = bench_measure(op->naive, &args, min_time);
+                prev_naive = base.p50;
+                prev_n_naive = n;
+            }
+            prev_ns = st.p50;
+            prev = n;
+
+            double gflops = op->flops ? op->flops((double)n) / st.p50 : 0;
+            double gbps = op->bytes((double)n) / st.p50;
+
+            printf("%-14s %6zu %12.1f %12.1f %12.1f ", op->name, n, st.p50, st.p90, st.p99);
+            if(op->flops)
+                printf("%9.2f ", gflops);
+            else
+                printf("%9s ", "-");
+            printf("%9.2f ", gbps);
+            if(base.done)
+                printf("%12.1f %7.1fx\n", base.p50, base.p50 / st.p50);
+            else
+                printf("%12s %8s\n", "-", "-");
+
+            if(out){
+                fprintf(out, "%s\n    {\"op\": \"%s\", \"n\": %zu, \"ns_p50\": %.1f, \"ns_p90\": %.1f, \"ns_p99\": %.1f, "
+                             "\"gbps\": %.4f",
+                        first ? "" : ",", op->name, n, st.p50, st.p90, st.p99, gbps);
+                if(op->flops)
+                    fprintf(out, ", \"gflops\": %.4f", gflops);
+                if(base.done)
+                    fprintf(out, ", \"naive_ns_p50\": %.1f, \"speedup\": %.3f", base.p50, base.p50 / st.p50);
+                fprintf(out, "}");
+                first = 0;
+            }
+
+            matrix_free(args.a);
+            matrix_free(args.b);
+            matrix_free(args.c);
+        }
+    }
+
+    if(out){
+        fprintf(out, "\n  ]\n}\n");
+        fclose(out);
+    }
+    return 0;
+}
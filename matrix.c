@@ -1,9 +1,92 @@
 #include <stdlib.h>
+#include <string.h>
 #include <err.h>
 
 #include "matrix.h"
+#include "matrix_alloc.h"
+#include "matrix_gemm.h"
+#include "matrix_gemv.h"
+#include "matrix_math.h"
+#include "matrix_simd.h"
+#include "matrix_stats.h"
+#include "matrix_strassen.h"
+#include "matrix_transp.h"
+#include "matrix_view.h"
 #include "state.h"
 
+// the element type of the family being compiled is an integer type
+#define MATRIX_INTEGER ((MATRIX_TYPE)0.5 == 0)
+
+// validation of the _unchecked variants: none, unless the library is built with MATRIX_DEBUG
+#ifdef MATRIX_DEBUG
+#define MATRIX_DEBUG_CHECK(cond, code, fname) do{ if(!(cond)) errx(code, "%s: %s", fname, code##_MESSAGE); }while(0)
+#else
+#define MATRIX_DEBUG_CHECK(cond, code, fname) ((void)0)
+#endif
+
+/*
+ * Span helpers: run a contiguous kernel over whole matrices, in one call when
+ * every operand is dense, row by row when one of them is a strided view.
+ */
+static void matrix_map2(void (*kernel)(const MATRIX_TYPE *, const MATRIX_TYPE *, MATRIX_TYPE *, size_t),
+                        const matrix_t *m1, const matrix_t *m2, matrix_t *result){
+    if(matrix_dense(m1) && matrix_dense(m2) && matrix_dense(result)){
+        kernel(m1->data, m2->data, result->data, m1->row * m1->col);
+        return;
+    }
+    for(size_t i = 0; i < m1->row; i++)
+        kernel(m1->data + i*m1->stride, m2->data + i*m2->stride, result->data + i*result->stride, m1->col);
+}
+
+static void matrix_mapk(void (*kernel)(const MATRIX_TYPE *, MATRIX_TYPE, MATRIX_TYPE *, size_t),
+                        const matrix_t *m1, MATRIX_TYPE k, matrix_t *result){
+    if(matrix_dense(m1) && matrix_dense(result)){
+        kernel(m1->data, k, result->data, m1->row * m1->col);
+        return;
+    }
+    for(size_t i = 0; i < m1->row; i++)
+        kernel(m1->data + i*m1->stride, k, result->data + i*result->stride, m1->col);
+}
+
+static void matrix_map1(void (*kernel)(const MATRIX_TYPE *, MATRIX_TYPE *, size_t),
+                        const matrix_t *m1, matrix_t *result){
+    if(matrix_dense(m1) && matrix_dense(result)){
+        kernel(m1->data, result->data, m1->row * m1->col);
+        return;
+    }
+    for(size_t i = 0; i < m1->row; i++)
+        kernel(m1->data + i*m1->stride, result->data + i*result->stride, m1->col);
+}
+
+static void matrix_fill(matrix_t *m1, MATRIX_TYPE x){
+    if(matrix_dense(m1)){
+        matrix_simd->fill(m1->data, x, m1->row * m1->col);
+        return;
+    }
+    for(size_t i = 0; i < m1->row; i++)
+        matrix_simd->fill(m1->data + i*m1->stride, x, m1->col);
+}
+
+static void matrix_fill_diag(matrix_t *m1, MATRIX_TYPE x){
+    size_t n = m1->row < m1->col ? m1->row : m1->col;
+    for(size_t i = 0; i < n; i++)
+        m1->data[i * (m1->stride + 1)] = x;
+}
+
+static void matrix_copy(const matrix_t *src, matrix_t *dest){
+    if(matrix_dense(src) && matrix_dense(dest)){
+        matrix_simd->copy(src->data, dest->data, src->row * src->col);
+        return;
+    }
+    // rows are copied in the direction that never reads an already overwritten row
+    if(dest->data <= src->data)
+        for(size_t i = 0; i < src->row; i++)
+            matrix_simd->copy(src->data + i*src->stride, dest->data + i*dest->stride, src->col);
+    else
+        for(size_t i = src->row; i-- > 0;)
+            matrix_simd->copy(src->data + i*src->stride, dest->data + i*dest->stride, src->col);
+}
+
 matrix_t* matrix_init(size_t row, size_t col){
     /*
         * matrix initialisation with random values
@@ -11,15 +94,11 @@ matrix_t* matrix_init(size_t row, size_t col){
         *        col: number of columns
         * @return matrix_t* : pointer to the matrix
     */
-    matrix_t *result = malloc(sizeof(matrix_t));
-    result->row = row;
-    result->col = col;
-    result->data = calloc(result->row * result->col, sizeof(MATRIX_TYPE));
-    if (!result->data) {
-        matrix_free(result);
+    matrix_t *result;
+    if(!(result = matrix_alloc(row, col)))
         return NULL;
-    }
 
+    memset(result->data, 0, row * col * sizeof(MATRIX_TYPE));
     return result;
 }
 
@@ -32,11 +111,10 @@ matrix_t* matrix_of(size_t row, size_t col, MATRIX_TYPE x){
         * @return matrix_t* : pointer to the matrix
     */
     matrix_t *result;
-    if(!(result = matrix_init(row, col)))
+    if(!(result = matrix_alloc(row, col)))
         return NULL;
 
-    for(size_t i = 0; i < result->row * result->col; i++)
-        result->data[i] = x;
+    matrix_fill(result, x);
     return result;
 }
 
@@ -48,7 +126,7 @@ MATRIX_TYPE matrix_get(const matrix_t *m1, size_t i, size_t j){
         *         j: column index
         * @return MATRIX_TYPE : value of the element
     */
-    return m1->data[i*m1->col + j];
+    return MATRIX_AT(m1, i, j);
 }
 
 void matrix_set(matrix_t *m1, size_t i, size_t j, MATRIX_TYPE val){
@@ -65,7 +143,148 @@ void matrix_set(matrix_t *m1, size_t i, size_t j, MATRIX_TYPE val){
     if (i >= m1->row || j >= m1->col)
         errx(MATRIX_INDEX_OUT_OF_BOUNDS, "matrix_set: %s", MATRIX_INDEX_OUT_OF_BOUNDS_MESSAGE);
 
-    m1->data[i*m1->col + j] = val;
+    MATRIX_AT(m1, i, j) = val;
+}
+
+MATRIX_TYPE* matrix_row(const matrix_t *m1, size_t i){
+    /*
+        * pointer to a row, for element access without a check per element
+        * @params m1: pointer to the matrix
+        *         i: row index
+        * @return MATRIX_TYPE* : pointer to the col elements of row i
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_row: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(i >= m1->row)
+        errx(MATRIX_INDEX_OUT_OF_BOUNDS, "matrix_row: %s", MATRIX_INDEX_OUT_OF_BOUNDS_MESSAGE);
+
+    return m1->data + i * m1->stride;
+}
+
+void matrix_get_data(const matrix_t *m1, MATRIX_TYPE *dst){
+    /*
+        * copy the elements of a matrix to a buffer
+        * @params m1: pointer to the matrix
+        *         dst: row * col elements, row-major
+    */
+    if(!m1 || !dst)
+        errx(MATRIX_NULL_POINTER, "matrix_get_data: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    matrix_t v = matrix_view_data(dst, m1->row, m1->col, m1->col);
+    matrix_copy(m1, &v);
+}
+
+void matrix_set_data(matrix_t *m1, const MATRIX_TYPE *src){
+    /*
+        * fill a matrix from a buffer
+        * @params m1: pointer to the matrix
+        *         src: row * col elements, row-major
+    */
+    if(!m1 || !src)
+        errx(MATRIX_NULL_POINTER, "matrix_set_data: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    matrix_t v = matrix_view_data((MATRIX_TYPE *)src, m1->row, m1->col, m1->col);
+    matrix_copy(&v, m1);
+}
+
+static int matrix_line_check(const matrix_t *m1, size_t i, size_t j, ptrdiff_t di, ptrdiff_t dj, size_t n){
+    /*
+        * n elements from (i,j) by steps of (di,dj) are inside the matrix
+        * the positions are linear in the step count: checking the first and the last is enough
+        * @return int : 0 if they are, MATRIX_INDEX_OUT_OF_BOUNDS otherwise
+    */
+    if(!n)
+        return 0;
+    if(i >= m1->row || j >= m1->col || n - 1 > (size_t)PTRDIFF_MAX)
+        return MATRIX_INDEX_OUT_OF_BOUNDS;
+
+    ptrdiff_t li, lj;
+    if(__builtin_mul_overflow(di, (ptrdiff_t)(n - 1), &li) || __builtin_add_overflow(li, (ptrdiff_t)i, &li) ||
+       __builtin_mul_overflow(dj, (ptrdiff_t)(n - 1), &lj) || __builtin_add_overflow(lj, (ptrdiff_t)j, &lj))
+        return MATRIX_INDEX_OUT_OF_BOUNDS;
+    if(li < 0 || lj < 0 || (size_t)li >= m1->row || (size_t)lj >= m1->col)
+        return MATRIX_INDEX_OUT_OF_BOUNDS;
+    return 0;
+}
+
+void matrix_gather(const matrix_t *m1, size_t i, size_t j, ptrdiff_t di, ptrdiff_t dj, size_t n, MATRIX_TYPE *dst){
+    /*
+        * read n elements along a line of the matrix into a buffer: (i,j), (i+di,j+dj), ...
+        * (0,1) reads a row, (1,0) a column, (1,1) a diagonal, (1,-1) an anti-diagonal
+        * @params m1: pointer to the matrix
+        *         i, j: first element
+        *         di, dj: step between two elements, in rows and columns
+        *         n: number of elements
+        *         dst: n elements
+    */
+    if(!m1 || (!dst && n))
+        errx(MATRIX_NULL_POINTER, "matrix_gather: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(matrix_line_check(m1, i, j, di, dj, n))
+        errx(MATRIX_INDEX_OUT_OF_BOUNDS, "matrix_gather: %s", MATRIX_INDEX_OUT_OF_BOUNDS_MESSAGE);
+
+    if(!n)
+        return;
+    const MATRIX_TYPE *p = &MATRIX_AT(m1, i, j);
+    ptrdiff_t step = di * (ptrdiff_t)m1->stride + dj;
+    if(step == 1){
+        matrix_simd->copy(p, dst, n);
+        return;
+    }
+    for(size_t k = 0; k < n; k++)
+        dst[k] = p[(ptrdiff_t)k * step];
+}
+
+void matrix_scatter(matrix_t *m1, size_t i, size_t j, ptrdiff_t di, ptrdiff_t dj, size_t n, const MATRIX_TYPE *src){
+    /*
+        * write n elements of a buffer along a line of the matrix: (i,j), (i+di,j+dj), ...
+        * @params m1: pointer to the matrix
+        *         i, j: first element
+        *         di, dj: step between two elements, in rows and columns
+        *         n: number of elements
+        *         src: n elements
+    */
+    if(!m1 || (!src && n))
+        errx(MATRIX_NULL_POINTER, "matrix_scatter: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(matrix_line_check(m1, i, j, di, dj, n))
+        errx(MATRIX_INDEX_OUT_OF_BOUNDS, "matrix_scatter: %s", MATRIX_INDEX_OUT_OF_BOUNDS_MESSAGE);
+
+    if(!n)
+        return;
+    MATRIX_TYPE *p = &MATRIX_AT(m1, i, j);
+    ptrdiff_t step = di * (ptrdiff_t)m1->stride + dj;
+    if(step == 1){
+        matrix_simd->copy(src, p, n);
+        return;
+    }
+    for(size_t k = 0; k < n; k++)
+        p[(ptrdiff_t)k * step] = src[k];
+}
+
+void matrix_get_diag(const matrix_t *m1, MATRIX_TYPE *dst){
+    /*
+        * copy the main diagonal of a matrix to a buffer
+        * @params m1: pointer to the matrix
+        *         dst: min(row, col) elements
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_get_diag: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    matrix_gather(m1, 0, 0, 1, 1, m1->row < m1->col ? m1->row : m1->col, dst);
+}
+
+void matrix_set_diag(matrix_t *m1, const MATRIX_TYPE *src){
+    /*
+        * set the main diagonal of a matrix from a buffer
+        * @params m1: pointer to the matrix
+        *         src: min(row, col) elements
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_set_diag: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    matrix_scatter(m1, 0, 0, 1, 1, m1->row < m1->col ? m1->row : m1->col, src);
 }
 
 matrix_t* matrix_Id(size_t dim){
@@ -78,8 +297,7 @@ matrix_t* matrix_Id(size_t dim){
     if(!(result = matrix_init(dim, dim)))
         return NULL;
     
-    for(size_t i = 0; i < result->row; i++)
-        matrix_set(result, i, i, 1);
+    matrix_fill_diag(result, 1);
     return result;
 }
 
@@ -95,8 +313,7 @@ matrix_t* matrix_nId(size_t dim, MATRIX_TYPE n){
     if(!(result = matrix_init(dim, dim)))
         return NULL;
 
-    for(size_t i = 0; i < result->row; i++)
-        matrix_set(result, i, i, n);
+    matrix_fill_diag(result, n);
     return result;
 }
 
@@ -112,8 +329,7 @@ void matrix_copyto(const matrix_t* src, matrix_t* dest){
     if(dest->col != src->col || dest->row != src->row)
         errx(MATRIX_INVALID_DIMENSIONS, "matrix_copyto: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
 
-    for(size_t i = 0; i < src->row * src->col; i++)
-        dest->data[i] = src->data[i];
+    matrix_copy(src, dest);
 }
 
 matrix_t* matrix_getcpy(const matrix_t* src){
@@ -125,8 +341,11 @@ matrix_t* matrix_getcpy(const matrix_t* src){
     if(!src)
         errx(MATRIX_NULL_POINTER, "matrix_getcpy: %s", MATRIX_NULL_POINTER_MESSAGE);
     
-    matrix_t *result = matrix_init(src->row, src->col);
-    matrix_copyto(src, result);
+    matrix_t *result;
+    if(!(result = matrix_alloc(src->row, src->col)))
+        return NULL;
+
+    matrix_copy(src, result);
     return result;
 }
 
@@ -137,8 +356,96 @@ void matrix_free(matrix_t *m1){
     */
     if(!m1)
         errx(MATRIX_NULL_POINTER, "matrix_free: %s", MATRIX_NULL_POINTER_MESSAGE);
-    free(m1->data);
-    free(m1);
+    matrix_release(m1);
+}
+
+matrix_t matrix_view(const matrix_t *m1, size_t i, size_t j, size_t row, size_t col){
+    /*
+        * zero-copy view on a block of a matrix
+        * @params m1: pointer to the viewed matrix
+        *         i: first row of the block
+        *         j: first column of the block
+        *         row: number of rows of the block
+        *         col: number of columns of the block
+        * @return matrix_t : the view, sharing the storage of m1
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_view: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(i + row > m1->row || j + col > m1->col)
+        errx(MATRIX_INDEX_OUT_OF_BOUNDS, "matrix_view: %s", MATRIX_INDEX_OUT_OF_BOUNDS_MESSAGE);
+
+    matrix_t view = { row, col, m1->data + i*m1->stride + j, m1->stride, NULL, MATRIX_FLAG_VIEW };
+    return view;
+}
+
+matrix_t matrix_view_rows(const matrix_t *m1, size_t i, size_t n){
+    /*
+        * zero-copy view on consecutive rows of a matrix
+        * @params m1: pointer to the viewed matrix
+        *         i: first row
+        *         n: number of rows
+        * @return matrix_t : the view, sharing the storage of m1
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_view_rows: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    return matrix_view(m1, i, 0, n, m1->col);
+}
+
+matrix_t matrix_view_data(MATRIX_TYPE *data, size_t row, size_t col, size_t stride){
+    /*
+        * view on external row-major storage
+        * @params data: first element
+        *         row: number of rows
+        *         col: number of columns
+        *         stride: elements between the starts of two rows (at least col)
+        * @return matrix_t : the view, the storage stays owned by the caller
+    */
+    if(!data)
+        errx(MATRIX_NULL_POINTER, "matrix_view_data: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(stride < col)
+        errx(MATRIX_INVALID_DIMENSIONS, "matrix_view_data: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    matrix_t view = { row, col, data, stride, NULL, MATRIX_FLAG_VIEW };
+    return view;
+}
+
+matrix_batch_t matrix_batch(MATRIX_TYPE *data, size_t count, size_t row, size_t col, size_t stride){
+    /*
+        * batch of same-shape dense matrices over external storage
+        * @params data: first element of the first matrix
+        *         count: number of matrices
+        *         row: number of rows of each matrix
+        *         col: number of columns of each matrix
+        *         stride: elements between the starts of two matrices (0 or at least row*col)
+        * @return matrix_batch_t : the batch, the storage stays owned by the caller
+    */
+    if(!data)
+        errx(MATRIX_NULL_POINTER, "matrix_batch: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(stride && stride < row * col)
+        errx(MATRIX_INVALID_DIMENSIONS, "matrix_batch: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    matrix_batch_t batch = { count, row, col, data, stride };
+    return batch;
+}
+
+matrix_t matrix_batch_at(const matrix_batch_t *b, size_t t){
+    /*
+        * view on one matrix of a batch
+        * @params b: pointer to the batch
+        *         t: index of the matrix
+        * @return matrix_t : the view, sharing the storage of the batch
+    */
+    if(!b)
+        errx(MATRIX_NULL_POINTER, "matrix_batch_at: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(t >= b->count)
+        errx(MATRIX_INDEX_OUT_OF_BOUNDS, "matrix_batch_at: %s", MATRIX_INDEX_OUT_OF_BOUNDS_MESSAGE);
+
+    return matrix_view_data(b->data + t * b->stride, b->row, b->col, b->col);
 }
 
 matrix_t *m_add(const matrix_t *m1, const matrix_t *m2){
@@ -154,12 +461,13 @@ matrix_t *m_add(const matrix_t *m1, const matrix_t *m2){
     if(m1->row != m2->row || m1->col != m2->col)
         errx(MATRIX_INVALID_DIMENSIONS, "m_add: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
     
+    MATRIX_STAT_MAP(MATRIX_OP_ADD, m1->row * m1->col, 1, 3);
+
     matrix_t *result;
-    if(!(result = matrix_init(m1->row, m1->col)))
+    if(!(result = matrix_alloc(m1->row, m1->col)))
         return NULL;
 
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        result->data[i] = m1->data[i] + m2->data[i];
+    matrix_map2(matrix_simd->add, m1, m2, result);
 
     return result;
 }
@@ -176,8 +484,9 @@ void m_addp(matrix_t *m1, const matrix_t *m2){
     if(m1->row != m2->row || m1->col != m2->col)
         errx(MATRIX_INVALID_DIMENSIONS, "m_addp: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
     
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        m1->data[i] += m2->data[i];
+    MATRIX_STAT_MAP(MATRIX_OP_ADD, m1->row * m1->col, 1, 3);
+
+    matrix_map2(matrix_simd->add, m1, m2, m1);
 }
 
 void m_addt(const matrix_t *m1, const matrix_t *m2, matrix_t *result){
@@ -196,8 +505,24 @@ void m_addt(const matrix_t *m1, const matrix_t *m2, matrix_t *result){
     if(result->row != m1->row || result->col != m1->col)
         errx(MATRIX_INVALID_DIMENSIONS, "m_addt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
     
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        result->data[i] = m1->data[i] + m2->data[i];
+    MATRIX_STAT_MAP(MATRIX_OP_ADD, m1->row * m1->col, 1, 3);
+
+    matrix_map2(matrix_simd->add, m1, m2, result);
+}
+
+void m_addt_unchecked(const matrix_t *m1, const matrix_t *m2, matrix_t *result){
+    /*
+        * matrix addition to result, without validation (see m_addt for the conditions)
+        * @params m1: pointer to the first matrix
+        *         m2: pointer to the second matrix
+        *         result: pointer to the result matrix
+    */
+    MATRIX_DEBUG_CHECK(m1 && m2 && result, MATRIX_NULL_POINTER, "m_addt_unchecked");
+    MATRIX_DEBUG_CHECK(m1->row == m2->row && m1->col == m2->col && result->row == m1->row && result->col == m1->col,
+                       MATRIX_INVALID_DIMENSIONS, "m_addt_unchecked");
+    MATRIX_STAT_MAP(MATRIX_OP_ADD, m1->row * m1->col, 1, 3);
+
+    matrix_map2(matrix_simd->add, m1, m2, result);
 }
 
 matrix_t* m_kadd(const matrix_t *m1, MATRIX_TYPE k){
@@ -210,12 +535,13 @@ matrix_t* m_kadd(const matrix_t *m1, MATRIX_TYPE k){
     if(!m1)
         errx(MATRIX_NULL_POINTER, "m_kadd: %s", MATRIX_NULL_POINTER_MESSAGE);
     
+    MATRIX_STAT_MAP(MATRIX_OP_KADD, m1->row * m1->col, 1, 2);
+
     matrix_t *result;
-    if(!(result = matrix_init(m1->row, m1->col)))
+    if(!(result = matrix_alloc(m1->row, m1->col)))
         return NULL;
 
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        result->data[i] = m1->data[i] + k;
+    matrix_mapk(matrix_simd->kadd, m1, k, result);
 
     return result;
 }
@@ -229,8 +555,9 @@ void m_kaddp(matrix_t *m1, MATRIX_TYPE k){
     if(!m1)
         errx(MATRIX_NULL_POINTER, "m_kaddp: %s", MATRIX_NULL_POINTER_MESSAGE);
     
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        m1->data[i] += k;
+    MATRIX_STAT_MAP(MATRIX_OP_KADD, m1->row * m1->col, 1, 2);
+
+    matrix_mapk(matrix_simd->kadd, m1, k, m1);
 }
 
 void m_kaddt(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result){
@@ -246,8 +573,23 @@ void m_kaddt(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result){
     if(result->row != m1->row || result->col != m1->col)
         errx(MATRIX_INVALID_DIMENSIONS, "m_kaddt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
     
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        result->data[i] = m1->data[i] + k;
+    MATRIX_STAT_MAP(MATRIX_OP_KADD, m1->row * m1->col, 1, 2);
+
+    matrix_mapk(matrix_simd->kadd, m1, k, result);
+}
+
+void m_kaddt_unchecked(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result){
+    /*
+        * matrix scalar addition to result, without validation (see m_kaddt for the conditions)
+        * @params m1: pointer to the matrix
+        *         k: scalar value
+        *         result: pointer to the result matrix
+    */
+    MATRIX_DEBUG_CHECK(m1 && result, MATRIX_NULL_POINTER, "m_kaddt_unchecked");
+    MATRIX_DEBUG_CHECK(result->row == m1->row && result->col == m1->col, MATRIX_INVALID_DIMENSIONS, "m_kaddt_unchecked");
+    MATRIX_STAT_MAP(MATRIX_OP_KADD, m1->row * m1->col, 1, 2);
+
+    matrix_mapk(matrix_simd->kadd, m1, k, result);
 }
 
 matrix_t *m_sub(const matrix_t *m1, const matrix_t *m2){
@@ -263,12 +605,13 @@ matrix_t *m_sub(const matrix_t *m1, const matrix_t *m2){
     if(m1->row != m2->row || m1->col != m2->col)
         errx(MATRIX_INVALID_DIMENSIONS, "m_sub: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
     
+    MATRIX_STAT_MAP(MATRIX_OP_SUB, m1->row * m1->col, 1, 3);
+
     matrix_t *result;
-    if(!(result = matrix_init(m1->row, m1->col)))
+    if(!(result = matrix_alloc(m1->row, m1->col)))
         return NULL;
 
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        result->data[i] = m1->data[i] - m2->data[i];
+    matrix_map2(matrix_simd->sub, m1, m2, result);
 
     return result;
 
@@ -286,8 +629,9 @@ void m_subp(matrix_t *m1, const matrix_t *m2){
     if(m1->row != m2->row || m1->col != m2->col)
         errx(MATRIX_INVALID_DIMENSIONS, "m_subp: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
     
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        m1->data[i] -= m2->data[i];
+    MATRIX_STAT_MAP(MATRIX_OP_SUB, m1->row * m1->col, 1, 3);
+
+    matrix_map2(matrix_simd->sub, m1, m2, m1);
 }
 
 void m_subt(const matrix_t *m1, const matrix_t *m2, matrix_t *result){
@@ -306,8 +650,24 @@ void m_subt(const matrix_t *m1, const matrix_t *m2, matrix_t *result){
     if(result->row != m1->row || result->col != m1->col)
         errx(MATRIX_INVALID_DIMENSIONS, "m_subt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
     
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        result->data[i] = m1->data[i] - m2->data[i];
+    MATRIX_STAT_MAP(MATRIX_OP_SUB, m1->row * m1->col, 1, 3);
+
+    matrix_map2(matrix_simd->sub, m1, m2, result);
+}
+
+void m_subt_unchecked(const matrix_t *m1, const matrix_t *m2, matrix_t *result){
+    /*
+        * matrix subtraction to result, without validation (see m_subt for the conditions)
+        * @params m1: pointer to the first matrix
+        *         m2: pointer to the second matrix
+        *         result: pointer to the result matrix
+    */
+    MATRIX_DEBUG_CHECK(m1 && m2 && result, MATRIX_NULL_POINTER, "m_subt_unchecked");
+    MATRIX_DEBUG_CHECK(m1->row == m2->row && m1->col == m2->col && result->row == m1->row && result->col == m1->col,
+                       MATRIX_INVALID_DIMENSIONS, "m_subt_unchecked");
+    MATRIX_STAT_MAP(MATRIX_OP_SUB, m1->row * m1->col, 1, 3);
+
+    matrix_map2(matrix_simd->sub, m1, m2, result);
 }
 
 matrix_t* m_ksub(const matrix_t *m1, MATRIX_TYPE k){
@@ -317,6 +677,8 @@ matrix_t* m_ksub(const matrix_t *m1, MATRIX_TYPE k){
         *         k: scalar value
         * @return matrix_t* : pointer to the result matrix
     */
+    MATRIX_STAT_MAP(MATRIX_OP_KSUB, m1 ? m1->row * m1->col : 0, 1, 2);
+
     return m_kadd(m1, -k);
 }
 
@@ -326,6 +688,8 @@ void m_ksubp(matrix_t *m1, MATRIX_TYPE k){
         * @params m1: pointer to the matrix
         *         k: scalar value
     */
+    MATRIX_STAT_MAP(MATRIX_OP_KSUB, m1 ? m1->row * m1->col : 0, 1, 2);
+
     return m_kaddp(m1, -k);
 }
 
@@ -336,9 +700,32 @@ void m_ksubt(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result){
         *         k: scalar value
         *         result: pointer to the result matrix
     */
+    MATRIX_STAT_MAP(MATRIX_OP_KSUB, m1 ? m1->row * m1->col : 0, 1, 2);
+
     return m_kaddt(m1, -k, result);
 }
 
+static void matrix_mul(const matrix_t *m1, const matrix_t *m2, matrix_t *result){
+    // result = m1*m2, result not overlapping m1 or m2
+    // a matrix-vector product reads A once: the GEMV kernels stream it instead of packing it for GEMM
+    if(m2->col == 1)
+        matrix_gemv(MATRIX_GEMV_DEFAULT, m1->row, m1->col, 1, m1->data, m1->stride, m2->data, m2->stride,
+                    0, result->data, result->stride);
+    else if(m1->row == 1)
+        matrix_gemv(MATRIX_GEMV_TRANS, m2->row, m2->col, 1, m2->data, m2->stride, m1->data, 1, 0, result->data, 1);
+    else{
+        // above the crossover, Strassen-Winograd in the workspace of the thread, the blocked kernel when
+        // it cannot be allocated (same result, without the savings)
+        size_t crossover = matrix_strassen_crossover(), ws = matrix_strassen_ws(m1->row, m2->col, m1->col, crossover);
+        MATRIX_TYPE *buf = ws ? matrix_strassen_workspace(ws) : NULL;
+        if(buf)
+            matrix_strassen(m1->row, m2->col, m1->col, m1->data, m1->stride, m2->data, m2->stride,
+                            result->data, result->stride, crossover, buf);
+        else
+            matrix_gemm(m1->row, m2->col, m1->col, 1, m1->data, m1->stride, m2->data, m2->stride, 0, result->data, result->stride);
+    }
+}
+
 matrix_t* m_mul(const matrix_t *m1, const matrix_t *m2){
     /*
         * matrix multiplication
@@ -352,14 +739,13 @@ matrix_t* m_mul(const matrix_t *m1, const matrix_t *m2){
     if(m1->col != m2->row)
         errx(MATRIX_INVALID_DIMENSIONS, "m_mul: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
     
+    MATRIX_STAT_GEMM(MATRIX_OP_MUL, 1, m1->row, m2->col, m1->col);
+
     matrix_t *result;
-    if(!(result = matrix_init(m1->row, m2->col)))
+    if(!(result = matrix_alloc(m1->row, m2->col)))
         return NULL;
 
-    for(size_t i = 0; i < m1->row; i++)
-        for(size_t j = 0; j < m2->col; j++)
-            for(size_t k = 0; k < m1->col; k++)
-                result->data[i*result->col + j] += m1->data[i*m1->col + k] * m2->data[k*m2->col + j];
+    matrix_mul(m1, m2, result);
 
     return result;
 }
@@ -380,105 +766,412 @@ void m_mult(const matrix_t *m1, const matrix_t *m2, matrix_t *result){
     if(result->row != m1->row || result->col != m2->col)
         errx(MATRIX_INVALID_DIMENSIONS, "m_mult: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
     
-    for(size_t i = 0; i < m1->row; i++)
-        for(size_t j = 0; j < m2->col; j++)
-            for(size_t k = 0; k < m1->col; k++)
-                result->data[i*result->col + j] += m1->data[i*m1->col + k] * m2->data[k*m2->col + j];
+    MATRIX_STAT_GEMM(MATRIX_OP_MUL, 1, m1->row, m2->col, m1->col);
+
+    // the kernel writes C while still reading A and B: go through a temporary when they overlap
+    if(matrix_overlap(result, m1) || matrix_overlap(result, m2)){
+        matrix_t *tmp;
+        if(!(tmp = m_mul(m1, m2)))
+            errx(MATRIX_MEMORY_ERROR, "m_mult: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+        matrix_copyto(tmp, result);
+        matrix_free(tmp);
+        return;
+    }
+
+    matrix_mul(m1, m2, result);
 }
 
-matrix_t* m_pow(const matrix_t *m1, size_t n){
+void m_mult_unchecked(const matrix_t *m1, const matrix_t *m2, matrix_t *result){
     /*
-        * matrix power
-        * @params m1: pointer to the matrix
-        *         n: power
+        * matrix multiplication to result, without validation (see m_mult for the conditions)
+        * result must not overlap m1 or m2: there is no temporary
+        * @params m1: pointer to the first matrix
+        *         m2: pointer to the second matrix
+        *         result: pointer to the result matrix
+    */
+    MATRIX_DEBUG_CHECK(m1 && m2 && result, MATRIX_NULL_POINTER, "m_mult_unchecked");
+    MATRIX_DEBUG_CHECK(m1->col == m2->row && result->row == m1->row && result->col == m2->col,
+                       MATRIX_INVALID_DIMENSIONS, "m_mult_unchecked");
+    MATRIX_DEBUG_CHECK(!matrix_overlap(result, m1) && !matrix_overlap(result, m2),
+                       MATRIX_INVALID_ARGUMENT, "m_mult_unchecked");
+    MATRIX_STAT_GEMM(MATRIX_OP_MUL, 1, m1->row, m2->col, m1->col);
+
+    matrix_mul(m1, m2, result);
+}
+
+static int matrix_epilogue(const matrix_t *bias, matrix_act_t act, size_t row, size_t col, gemm_epilogue_t *ep){
+    /*
+        * epilogue of the fused multiplication
+        * @params bias: NULL, 1 x col row bias or row x 1 column bias
+        *         act: activation
+        *         row, col: dimensions of the result
+        *         ep: epilogue to fill
+        * @return int : 0 on success, MATRIX_INVALID_DIMENSIONS if bias has neither shape
+    */
+    *ep = (gemm_epilogue_t){ NULL, NULL, 0, act };
+    if(!bias)
+        return 0;
+
+    if(bias->row == 1 && bias->col == col)
+        ep->row_bias = bias->data;
+    else if(bias->col == 1 && bias->row == row){
+        ep->col_bias = bias->data;
+        ep->col_bias_stride = bias->stride;
+    }else
+        return MATRIX_INVALID_DIMENSIONS;
+    return 0;
+}
+
+matrix_t* m_gemm(MATRIX_TYPE alpha, const matrix_t *m1, const matrix_t *m2, const matrix_t *bias, matrix_act_t act){
+    /*
+        * fused matrix multiplication: act(alpha*m1*m2 + bias)
+        * bias and activation are applied to each tile of the product while it is still in cache
+        * @params alpha: scaling of the product
+        *         m1: pointer to the first matrix
+        *         m2: pointer to the second matrix
+        *         bias: NULL, 1 x n row added to every row or m x 1 column added to every column
+        *         act: activation applied last
         * @return matrix_t* : pointer to the result matrix
     */
-    if(!m1)
-        errx(MATRIX_NULL_POINTER, "m_pow: %s", MATRIX_NULL_POINTER_MESSAGE);
-    
-    if(m1->row != m1->col)
-        errx(MATRIX_INVALID_DIMENSIONS, "m_pow: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
-    
-    matrix_t *result;
-    if(!(result = matrix_Id(m1->row)))
-        return NULL;
+    if(!m1 || !m2)
+        errx(MATRIX_NULL_POINTER, "m_gemm: %s", MATRIX_NULL_POINTER_MESSAGE);
 
-    matrix_t *tmp;
-    if(!(tmp = matrix_getcpy(m1)))
+    if(m1->col != m2->row)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_gemm: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    gemm_epilogue_t ep;
+    if(matrix_epilogue(bias, act, m1->row, m2->col, &ep))
+        errx(MATRIX_INVALID_DIMENSIONS, "m_gemm: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT_GEMM(MATRIX_OP_GEMM, 1, m1->row, m2->col, m1->col);
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(m1->row, m2->col)))
         return NULL;
 
-    for(size_t i = 0; i < n; i++){
-        m_mult(result, tmp, result);
-        matrix_free(tmp);
-        tmp = matrix_getcpy(result);
-    }
+    matrix_gemm_fused(m1->row, m2->col, m1->col, alpha, m1->data, m1->stride, m2->data, m2->stride,
+                      0, result->data, result->stride, &ep);
 
-    matrix_free(tmp);
     return result;
 }
 
-void m_powp(matrix_t *m1, size_t n){
+void m_gemmt(MATRIX_TYPE alpha, const matrix_t *m1, const matrix_t *m2, MATRIX_TYPE beta,
+             const matrix_t *bias, matrix_act_t act, matrix_t *result){
     /*
-        * in place matrix power
-        * @params m1: pointer to the matrix
-        *         n: power
+        * fused matrix multiplication to result: result = act(alpha*m1*m2 + beta*result + bias)
+        * @params alpha: scaling of the product
+        *         m1: pointer to the first matrix
+        *         m2: pointer to the second matrix
+        *         beta: scaling of the previous content of result (0 to overwrite)
+        *         bias: NULL, 1 x n row added to every row or m x 1 column added to every column
+        *         act: activation applied last
+        *         result: pointer to the result matrix
     */
-    if(!m1)
-        errx(MATRIX_NULL_POINTER, "m_powp: %s", MATRIX_NULL_POINTER_MESSAGE);
-    
-    if(m1->row != m1->col)
-        errx(MATRIX_INVALID_DIMENSIONS, "m_powp: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
-    
-    matrix_t *result;
-    if(!(result = matrix_Id(m1->row)))
-        return;
+    if(!m1 || !m2 || !result)
+        errx(MATRIX_NULL_POINTER, "m_gemmt: %s", MATRIX_NULL_POINTER_MESSAGE);
 
-    matrix_t *tmp;
-    if(!(tmp = matrix_getcpy(m1))){
-        matrix_free(result);
-        return;
-    }
+    if(m1->col != m2->row)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_gemmt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
 
-    for(size_t i = 0; i < n; i++){
-        m_mult(result, tmp, result);
+    if(result->row != m1->row || result->col != m2->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_gemmt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    gemm_epilogue_t ep;
+    if(matrix_epilogue(bias, act, result->row, result->col, &ep))
+        errx(MATRIX_INVALID_DIMENSIONS, "m_gemmt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT_GEMM(MATRIX_OP_GEMM, 1, m1->row, m2->col, m1->col);
+
+    // the kernel writes C while still reading A, B and the bias: go through a temporary when they overlap
+    if(matrix_overlap(result, m1) || matrix_overlap(result, m2) || (bias && matrix_overlap(result, bias))){
+        matrix_t *tmp;
+        if(!(tmp = matrix_alloc(result->row, result->col)))
+            errx(MATRIX_MEMORY_ERROR, "m_gemmt: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+        if(beta != 0)
+            matrix_copy(result, tmp);
+        matrix_gemm_fused(m1->row, m2->col, m1->col, alpha, m1->data, m1->stride, m2->data, m2->stride,
+                          beta, tmp->data, tmp->stride, &ep);
+        matrix_copy(tmp, result);
         matrix_free(tmp);
-        tmp = matrix_getcpy(result);
+        return;
     }
 
-    matrix_free(tmp);
-    matrix_copyto(result, m1);
-    matrix_free(result);
+    matrix_gemm_fused(m1->row, m2->col, m1->col, alpha, m1->data, m1->stride, m2->data, m2->stride,
+                      beta, result->data, result->stride, &ep);
 }
 
-void m_powt(const matrix_t *m1, size_t n, matrix_t *result){
+static int matrix_gemv_check(const matrix_t *m1, const matrix_t *x, matrix_gemv_t flags, size_t *len){
     /*
-        * matrix power to result
-        * @params m1: pointer to the matrix
-        *         n: power
-        *         result: pointer to the result matrix
+        * dimensions of a matrix-vector product
+        * @params len: length of the result
+        * @return int : 0 on success, MATRIX_INVALID_DIMENSIONS if x is not a vector matching op(m1)
     */
-    if(!m1 || !result)
-        errx(MATRIX_NULL_POINTER, "m_powt: %s", MATRIX_NULL_POINTER_MESSAGE);
-    
-    if(m1->row != m1->col)
-        errx(MATRIX_INVALID_DIMENSIONS, "m_powt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
-    
-    if(result->row != m1->row || result->col != m1->col)
-        errx(MATRIX_INVALID_DIMENSIONS, "m_powt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
-    
-    matrix_t *tmp;
-    if(!(tmp = matrix_getcpy(m1)))
-        return;
+    size_t inner = flags & MATRIX_GEMV_TRANS ? m1->row : m1->col;
+    *len = flags & MATRIX_GEMV_TRANS ? m1->col : m1->row;
+    if(!matrix_is_vec(x) || x->row * x->col != inner)
+        return MATRIX_INVALID_DIMENSIONS;
+    return 0;
+}
 
-    for(size_t i = 0; i < n; i++){
-        m_mult(result, tmp, result);
-        matrix_copyto(result, tmp);
-    }
+matrix_t* m_gemv(MATRIX_TYPE alpha, const matrix_t *m1, const matrix_t *x, matrix_gemv_t flags){
+    /*
+        * matrix-vector product: alpha*op(m1)*x
+        * @params alpha: scaling of the product
+        *         m1: pointer to the matrix
+        *         x: pointer to the vector (row or column)
+        *         flags: MATRIX_GEMV_TRANS to multiply by the transpose of m1, MATRIX_GEMV_WIDE to accumulate
+        *                in double (int64_t for i32)
+        * @return matrix_t* : pointer to the result vector, a row if x is a row, a column otherwise
+    */
+    if(!m1 || !x)
+        errx(MATRIX_NULL_POINTER, "m_gemv: %s", MATRIX_NULL_POINTER_MESSAGE);
 
-    matrix_free(tmp);
+    size_t len;
+    if(matrix_gemv_check(m1, x, flags, &len))
+        errx(MATRIX_INVALID_DIMENSIONS, "m_gemv: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_GEMV, len, 2 * (uint64_t)m1->row * m1->col,
+                ((uint64_t)m1->row * m1->col + m1->row + m1->col) * sizeof(MATRIX_TYPE));
+
+    // a 1 x 1 x is taken as a column, like a column of m1
+    matrix_t *result;
+    if(!(result = x->row == 1 && x->col != 1 ? matrix_alloc(1, len) : matrix_alloc(len, 1)))
+        return NULL;
+
+    matrix_gemv(flags, m1->row, m1->col, alpha, m1->data, m1->stride, x->data, matrix_vec_inc(x),
+                0, result->data, matrix_vec_inc(result));
+
+    return result;
 }
 
-matrix_t* m_kmul(const matrix_t *m1, MATRIX_TYPE k){
+void m_gemvt(MATRIX_TYPE alpha, const matrix_t *m1, const matrix_t *x, MATRIX_TYPE beta,
+             matrix_gemv_t flags, matrix_t *result){
+    /*
+        * matrix-vector product to result: result = alpha*op(m1)*x + beta*result
+        * @params alpha: scaling of the product
+        *         m1: pointer to the matrix
+        *         x: pointer to the vector (row or column)
+        *         beta: scaling of the previous content of result (0 to overwrite)
+        *         flags: MATRIX_GEMV_TRANS and / or MATRIX_GEMV_WIDE
+        *         result: pointer to the result vector (row or column)
+    */
+    if(!m1 || !x || !result)
+        errx(MATRIX_NULL_POINTER, "m_gemvt: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    size_t len;
+    if(matrix_gemv_check(m1, x, flags, &len) || !matrix_is_vec(result) || result->row * result->col != len)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_gemvt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_GEMV, len, 2 * (uint64_t)m1->row * m1->col,
+                ((uint64_t)m1->row * m1->col + m1->row + m1->col) * sizeof(MATRIX_TYPE));
+
+    // the kernels write y while still reading A and x: go through a temporary when they overlap
+    if(matrix_overlap(result, m1) || matrix_overlap(result, x)){
+        matrix_t *tmp;
+        if(!(tmp = matrix_alloc(result->row, result->col)))
+            errx(MATRIX_MEMORY_ERROR, "m_gemvt: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+        if(beta != 0)
+            matrix_copy(result, tmp);
+        matrix_gemv(flags, m1->row, m1->col, alpha, m1->data, m1->stride, x->data, matrix_vec_inc(x),
+                    beta, tmp->data, matrix_vec_inc(tmp));
+        matrix_copy(tmp, result);
+        matrix_free(tmp);
+        return;
+    }
+
+    matrix_gemv(flags, m1->row, m1->col, alpha, m1->data, m1->stride, x->data, matrix_vec_inc(x),
+                beta, result->data, matrix_vec_inc(result));
+}
+
+static int matrix_batch_overlap(const matrix_batch_t *b1, const matrix_batch_t *b2){
+    // the storage spans of two batches intersect
+    const MATRIX_TYPE *end1 = b1->data + (b1->count - 1) * b1->stride + b1->row * b1->col;
+    const MATRIX_TYPE *end2 = b2->data + (b2->count - 1) * b2->stride + b2->row * b2->col;
+    return b1->data < end2 && b2->data < end1;
+}
+
+void m_mult_batched(const matrix_batch_t *m1, const matrix_batch_t *m2, matrix_batch_t *result){
+    /*
+        * batched matrix multiplication: one call for many small products
+        * @params m1: pointer to the batch of first operands (or a batch of one, reused)
+        *         m2: pointer to the batch of second operands (or a batch of one, reused)
+        *         result: pointer to the batch of results
+    */
+    if(!m1 || !m2 || !result)
+        errx(MATRIX_NULL_POINTER, "m_mult_batched: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(m1->col != m2->row || result->row != m1->row || result->col != m2->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_mult_batched: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    if((m1->count != result->count && m1->count != 1) || (m2->count != result->count && m2->count != 1))
+        errx(MATRIX_INVALID_DIMENSIONS, "m_mult_batched: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT_GEMM(MATRIX_OP_MUL_BATCHED, result->count, result->row, result->col, m1->col);
+
+    if(!result->count || !result->row || !result->col)
+        return;
+
+    size_t m = result->row, n = result->col, k = m1->col;
+    size_t stride_a = m1->count == 1 ? 0 : m1->stride;
+    size_t stride_b = m2->count == 1 ? 0 : m2->stride;
+
+    // the kernels write C while still reading A and B: go through a temporary when they overlap
+    if(matrix_batch_overlap(result, m1) || matrix_batch_overlap(result, m2)){
+        MATRIX_TYPE *tmp;
+        if(!(tmp = malloc(result->count * m * n * sizeof(MATRIX_TYPE))))
+            errx(MATRIX_MEMORY_ERROR, "m_mult_batched: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+        matrix_gemm_batched(result->count, m, n, k, m1->data, stride_a, m2->data, stride_b, tmp, m * n);
+        for(size_t t = 0; t < result->count; t++)
+            memcpy(result->data + t * result->stride, tmp + t * m * n, m * n * sizeof(MATRIX_TYPE));
+        free(tmp);
+        return;
+    }
+
+    matrix_gemm_batched(result->count, m, n, k, m1->data, stride_a, m2->data, stride_b, result->data, result->stride);
+}
+
+static inline uint64_t matrix_pow_products(size_t n){
+    // products done by matrix_pow_into: one squaring per bit after the first, one more per other set bit
+    if(n < 2)
+        return 0;
+    return (uint64_t)(63 - __builtin_clzll(n)) + (uint64_t)__builtin_popcountll(n) - 1;
+}
+
+static int matrix_pow_into(const matrix_t *m1, size_t n, matrix_t *result){
+    /*
+        * result = m1^n by binary exponentiation (O(log n) products)
+        * the two ping-pong buffers, and the Strassen-Winograd workspace, are allocated once, up front
+        * m1 is copied before result is written, so both may share storage
+        * @params m1: pointer to the square matrix
+        *         n: power
+        *         result: pointer to the result matrix
+        * @return int : 0 on success, MATRIX_MEMORY_ERROR if the buffers cannot be allocated
+    */
+    size_t dim = m1->row, size = dim * dim;
+
+    if(n == 0){
+        matrix_fill(result, 0);
+        for(size_t i = 0; i < dim; i++)
+            MATRIX_AT(result, i, i) = 1;
+        return 0;
+    }
+
+    if(n == 1 || size == 0){
+        matrix_copy(m1, result);
+        return 0;
+    }
+
+    size_t crossover = matrix_strassen_crossover(), ws = matrix_strassen_ws(dim, dim, dim, crossover);
+    MATRIX_TYPE *buffers = malloc((2 * size + ws) * sizeof(MATRIX_TYPE));
+    if(!buffers)
+        return MATRIX_MEMORY_ERROR;
+
+    // the three buffers rotate: each product writes to the spare one
+    matrix_t base = matrix_view_data(buffers, dim, dim, dim);
+    matrix_t spare = matrix_view_data(buffers + size, dim, dim, dim);
+    matrix_t acc = *result, swap;
+    int started = 0;
+    matrix_copy(m1, &base);
+
+    for(;;){
+        if(n & 1){
+            if(!started){
+                matrix_copy(&base, &acc);
+                started = 1;
+            }else{
+                matrix_strassen(dim, dim, dim, acc.data, acc.stride, base.data, base.stride, spare.data, spare.stride,
+                                crossover, buffers + 2 * size);
+                swap = acc; acc = spare; spare = swap;
+            }
+        }
+
+        if(!(n >>= 1))
+            break;
+
+        matrix_strassen(dim, dim, dim, base.data, base.stride, base.data, base.stride, spare.data, spare.stride,
+                        crossover, buffers + 2 * size);
+        swap = base; base = spare; spare = swap;
+    }
+
+    if(acc.data != result->data)
+        matrix_copy(&acc, result);
+
+    free(buffers);
+    return 0;
+}
+
+matrix_t* m_pow(const matrix_t *m1, size_t n){
+    /*
+        * matrix power
+        * @params m1: pointer to the matrix
+        *         n: power
+        * @return matrix_t* : pointer to the result matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_pow: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    if(m1->row != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_pow: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+    
+    MATRIX_STAT(MATRIX_OP_POW, m1->row * m1->col, matrix_pow_products(n) * 2 * m1->row * m1->row * m1->row,
+                matrix_pow_products(n) * 3 * m1->row * m1->row * sizeof(MATRIX_TYPE));
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(m1->row, m1->col)))
+        return NULL;
+
+    if(matrix_pow_into(m1, n, result)){
+        matrix_free(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+void m_powp(matrix_t *m1, size_t n){
+    /*
+        * in place matrix power
+        * @params m1: pointer to the matrix
+        *         n: power
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_powp: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    if(m1->row != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_powp: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+    
+    MATRIX_STAT(MATRIX_OP_POW, m1->row * m1->col, matrix_pow_products(n) * 2 * m1->row * m1->row * m1->row,
+                matrix_pow_products(n) * 3 * m1->row * m1->row * sizeof(MATRIX_TYPE));
+
+    if(matrix_pow_into(m1, n, m1))
+        errx(MATRIX_MEMORY_ERROR, "m_powp: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+}
+
+void m_powt(const matrix_t *m1, size_t n, matrix_t *result){
+    /*
+        * matrix power to result
+        * result may be m1 itself
+        * @params m1: pointer to the matrix
+        *         n: power
+        *         result: pointer to the result matrix
+    */
+    if(!m1 || !result)
+        errx(MATRIX_NULL_POINTER, "m_powt: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    if(m1->row != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_powt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+    
+    if(result->row != m1->row || result->col != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_powt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+    
+    MATRIX_STAT(MATRIX_OP_POW, m1->row * m1->col, matrix_pow_products(n) * 2 * m1->row * m1->row * m1->row,
+                matrix_pow_products(n) * 3 * m1->row * m1->row * sizeof(MATRIX_TYPE));
+
+    if(matrix_pow_into(m1, n, result))
+        errx(MATRIX_MEMORY_ERROR, "m_powt: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+}
+
+matrix_t* m_kmul(const matrix_t *m1, MATRIX_TYPE k){
     /*
         * matrix scalar multiplication
         * @params m1: pointer to the matrix
@@ -488,12 +1181,13 @@ matrix_t* m_kmul(const matrix_t *m1, MATRIX_TYPE k){
     if(!m1)
         errx(MATRIX_NULL_POINTER, "m_kmul: %s", MATRIX_NULL_POINTER_MESSAGE);
     
+    MATRIX_STAT_MAP(MATRIX_OP_KMUL, m1->row * m1->col, 1, 2);
+
     matrix_t *result;
-    if(!(result = matrix_init(m1->row, m1->col)))
+    if(!(result = matrix_alloc(m1->row, m1->col)))
         return NULL;
 
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        result->data[i] = m1->data[i] * k;
+    matrix_mapk(matrix_simd->kmul, m1, k, result);
 
     return result;
 }
@@ -507,8 +1201,9 @@ void m_kmulp(matrix_t *m1, MATRIX_TYPE k){
     if(!m1)
         errx(MATRIX_NULL_POINTER, "m_kmulp: %s", MATRIX_NULL_POINTER_MESSAGE);
     
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        m1->data[i] *= k;
+    MATRIX_STAT_MAP(MATRIX_OP_KMUL, m1->row * m1->col, 1, 2);
+
+    matrix_mapk(matrix_simd->kmul, m1, k, m1);
 }
 
 void m_kmult(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result){
@@ -524,8 +1219,23 @@ void m_kmult(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result){
     if(result->row != m1->row || result->col != m1->col)
         errx(MATRIX_INVALID_DIMENSIONS, "m_kmult: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
     
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        result->data[i] = m1->data[i] * k;
+    MATRIX_STAT_MAP(MATRIX_OP_KMUL, m1->row * m1->col, 1, 2);
+
+    matrix_mapk(matrix_simd->kmul, m1, k, result);
+}
+
+void m_kmult_unchecked(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result){
+    /*
+        * matrix scalar multiplication to result, without validation (see m_kmult for the conditions)
+        * @params m1: pointer to the matrix
+        *         k: scalar value
+        *         result: pointer to the result matrix
+    */
+    MATRIX_DEBUG_CHECK(m1 && result, MATRIX_NULL_POINTER, "m_kmult_unchecked");
+    MATRIX_DEBUG_CHECK(result->row == m1->row && result->col == m1->col, MATRIX_INVALID_DIMENSIONS, "m_kmult_unchecked");
+    MATRIX_STAT_MAP(MATRIX_OP_KMUL, m1->row * m1->col, 1, 2);
+
+    matrix_mapk(matrix_simd->kmul, m1, k, result);
 }
 
 // matrix scalar division
@@ -536,7 +1246,23 @@ matrix_t* m_kdiv(const matrix_t *m1, MATRIX_TYPE k){
         *         k: scalar value
         * @return matrix_t* : pointer to the result matrix
     */
-    return m_kmul(m1, 1/k);
+    MATRIX_STAT_MAP(MATRIX_OP_KDIV, m1 ? m1->row * m1->col : 0, 1, 2);
+
+    if(!MATRIX_INTEGER)
+        return m_kmul(m1, 1/k);
+
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_kdiv: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(k == 0)
+        errx(MATRIX_INVALID_ARGUMENT, "m_kdiv: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(m1->row, m1->col)))
+        return NULL;
+
+    m_kdivt(m1, k, result);
+    return result;
 }
 
 void m_kdivp(matrix_t *m1, MATRIX_TYPE k){
@@ -545,55 +1271,104 @@ void m_kdivp(matrix_t *m1, MATRIX_TYPE k){
         * @params m1: pointer to the matrix
         *         k: scalar value
     */
-    return m_kmulp(m1, 1/k);
+    MATRIX_STAT_MAP(MATRIX_OP_KDIV, m1 ? m1->row * m1->col : 0, 1, 2);
+
+    if(!MATRIX_INTEGER)
+        return m_kmulp(m1, 1/k);
+
+    m_kdivt(m1, k, m1);
 }
 
 void m_kdivt(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result){
     /*
         * matrix scalar division to result
+        * floating point families multiply by 1/k, integer ones divide every element (k must not be 0, and the
+        * minimum divided by -1 wraps around to itself)
         * @params m1: pointer to the matrix
         *         k: scalar value
         *         result: pointer to the result matrix
     */
-    return m_kmult(m1, 1/k, result);
+    MATRIX_STAT_MAP(MATRIX_OP_KDIV, m1 ? m1->row * m1->col : 0, 1, 2);
+
+    if(!MATRIX_INTEGER)
+        return m_kmult(m1, 1/k, result);
+
+    if(!m1 || !result)
+        errx(MATRIX_NULL_POINTER, "m_kdivt: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(result->row != m1->row || result->col != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_kdivt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    // both trap in hardware: 0, and -1 on the minimum
+    if(k == 0)
+        errx(MATRIX_INVALID_ARGUMENT, "m_kdivt: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    if(k == -1)
+        for(size_t i = 0; i < m1->row; i++)
+            for(size_t j = 0; j < m1->col; j++)
+                MATRIX_AT(result, i, j) = (MATRIX_TYPE)(0u - (uint32_t)MATRIX_AT(m1, i, j));
+    else
+        for(size_t i = 0; i < m1->row; i++)
+            for(size_t j = 0; j < m1->col; j++)
+                MATRIX_AT(result, i, j) = MATRIX_AT(m1, i, j) / k;
 }
 
 // matrix scalar product
 MATRIX_TYPE m_dot(const matrix_t *m1, const matrix_t *m2){
     /*
         * matrix scalar product
-        * m1 and m2 must be vectors (row or column)
+        * m1 and m2 must be vectors (row or column) of the same length
+        * the products are summed with several accumulators, by blocks added in double precision
         * @params m1: pointer to the first matrix
         *         m2: pointer to the second matrix
-        * @return MATRIX_TYPE* : pointer to the result scalar
+        * @return MATRIX_TYPE : the result scalar
     */
     if(!m1 || !m2)
         errx(MATRIX_NULL_POINTER, "m_dot: %s", MATRIX_NULL_POINTER_MESSAGE);
 
-    // if matrices are not vectors
-    if(m1->row != 1 && m1->col != 1 || m2->row != 1 && m2->col != 1)
+    if(!matrix_is_vec(m1) || !matrix_is_vec(m2) || m1->row * m1->col != m2->row * m2->col)
         errx(MATRIX_INVALID_DIMENSIONS, "m_dot: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
 
-    // if matrices dimensions are not compatibles
-    if(m1->row == 1){
-        if(m2->row == 1){
-            if(m1->col != m2->col)
-                errx(MATRIX_INVALID_DIMENSIONS, "m_dot: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
-        }else if(m1->col != m2->row)
-            errx(MATRIX_INVALID_DIMENSIONS, "m_dot: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
-    }else{
-        if(m2->col == 1){
-            if(m1->row != m2->row)
-                errx(MATRIX_INVALID_DIMENSIONS, "m_dot: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
-        }else if(m1->row != m2->col)
-            errx(MATRIX_INVALID_DIMENSIONS, "m_dot: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
-    }
-    
-    MATRIX_TYPE result = 0;
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        result += m1->data[i] * m2->data[i];
+    MATRIX_STAT(MATRIX_OP_DOT, 1, 2 * (uint64_t)m1->row * m1->col, 2 * (uint64_t)m1->row * m1->col * sizeof(MATRIX_TYPE));
 
-    return result;
+    return (MATRIX_TYPE)matrix_dot(MATRIX_GEMV_DEFAULT, m1->row * m1->col, m1->data, matrix_vec_inc(m1),
+                                   m2->data, matrix_vec_inc(m2));
+}
+
+MATRIX_TYPE m_dot_unchecked(const matrix_t *m1, const matrix_t *m2){
+    /*
+        * matrix scalar product, without validation (see m_dot for the conditions)
+        * @params m1: pointer to the first matrix
+        *         m2: pointer to the second matrix
+        * @return MATRIX_TYPE : the result scalar
+    */
+    MATRIX_DEBUG_CHECK(m1 && m2, MATRIX_NULL_POINTER, "m_dot_unchecked");
+    MATRIX_DEBUG_CHECK(matrix_is_vec(m1) && matrix_is_vec(m2) && m1->row * m1->col == m2->row * m2->col,
+                       MATRIX_INVALID_DIMENSIONS, "m_dot_unchecked");
+    MATRIX_STAT(MATRIX_OP_DOT, 1, 2 * (uint64_t)m1->row * m1->col, 2 * (uint64_t)m1->row * m1->col * sizeof(MATRIX_TYPE));
+
+    return (MATRIX_TYPE)matrix_dot(MATRIX_GEMV_DEFAULT, m1->row * m1->col, m1->data, matrix_vec_inc(m1),
+                                   m2->data, matrix_vec_inc(m2));
+}
+
+double m_dotd(const matrix_t *m1, const matrix_t *m2){
+    /*
+        * matrix scalar product, every product accumulated in double precision (int64_t for i32)
+        * m1 and m2 must be vectors (row or column) of the same length
+        * @params m1: pointer to the first matrix
+        *         m2: pointer to the second matrix
+        * @return double : the result scalar
+    */
+    if(!m1 || !m2)
+        errx(MATRIX_NULL_POINTER, "m_dotd: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(!matrix_is_vec(m1) || !matrix_is_vec(m2) || m1->row * m1->col != m2->row * m2->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_dotd: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_DOT, 1, 2 * (uint64_t)m1->row * m1->col, 2 * (uint64_t)m1->row * m1->col * sizeof(MATRIX_TYPE));
+
+    return (double)matrix_dot(MATRIX_GEMV_WIDE, m1->row * m1->col, m1->data, matrix_vec_inc(m1),
+                              m2->data, matrix_vec_inc(m2));
 }
 
 matrix_t *m_transp(const matrix_t *m1){
@@ -605,14 +1380,13 @@ matrix_t *m_transp(const matrix_t *m1){
     if(!m1)
         errx(MATRIX_NULL_POINTER, "m_transp: %s", MATRIX_NULL_POINTER_MESSAGE);
     
+    MATRIX_STAT_MAP(MATRIX_OP_TRANSP, m1->row * m1->col, 0, 2);
+
     matrix_t *result;
-    if(!(result = matrix_init(m1->col, m1->row)))
+    if(!(result = matrix_alloc(m1->col, m1->row)))
         return NULL;
 
-    for(size_t i = 0; i < m1->row; i++)
-        for(size_t j = 0; j < m1->col; j++)
-            result->data[j*result->col + i] = m1->data[i*m1->col + j];
-
+    matrix_transpose(m1->row, m1->col, m1->data, m1->stride, result->data, result->stride);
     return result;
 }
 
@@ -628,9 +1402,61 @@ void m_transpt(const matrix_t *m1, matrix_t *result){
     if(m1->row != result->col || m1->col != result->row)
         errx(MATRIX_INVALID_DIMENSIONS, "m_transpt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
 
-    for(size_t i = 0; i < m1->row; i++)
-        for(size_t j = 0; j < m1->col; j++)
-            result->data[j*result->col + i] = m1->data[i*m1->col + j];
+    MATRIX_STAT_MAP(MATRIX_OP_TRANSP, m1->row * m1->col, 0, 2);
+
+    if(!matrix_overlap(result, m1)){
+        matrix_transpose(m1->row, m1->col, m1->data, m1->stride, result->data, result->stride);
+        return;
+    }
+
+    // same square storage: swap in place, otherwise go through a temporary
+    if(result->data == m1->data && result->stride == m1->stride && m1->row == m1->col){
+        matrix_transpose_square(m1->row, result->data, result->stride);
+        return;
+    }
+
+    matrix_t *tmp;
+    if(!(tmp = matrix_alloc(result->row, result->col)))
+        errx(MATRIX_MEMORY_ERROR, "m_transpt: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+    matrix_transpose(m1->row, m1->col, m1->data, m1->stride, tmp->data, tmp->stride);
+    matrix_copy(tmp, result);
+    matrix_free(tmp);
+}
+
+void m_transpp(matrix_t *m1){
+    /*
+        * in place matrix transposition
+        * square matrices (views included) swap their elements across the diagonal,
+        * dense rectangular matrices are permuted in their own storage and take the
+        * transposed dimensions
+        * @params m1: pointer to the matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_transpp: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    MATRIX_STAT_MAP(MATRIX_OP_TRANSP, m1->row * m1->col, 0, 2);
+
+    if(m1->row == m1->col){
+        matrix_transpose_square(m1->row, m1->data, m1->stride);
+        return;
+    }
+
+    // a rectangular view cannot change its shape inside the storage it shares
+    if(!matrix_dense(m1) || (m1->flags & MATRIX_FLAG_VIEW))
+        errx(MATRIX_INVALID_DIMENSIONS, "m_transpp: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    if(matrix_transpose_inplace(m1->row, m1->col, m1->data))
+        errx(MATRIX_MEMORY_ERROR, "m_transpp: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+
+    size_t row = m1->row;
+    m1->row = m1->col;
+    m1->col = row;
+    m1->stride = row;
+}
+
+static inline size_t matrix_reduce_len(const matrix_t *m1, matrix_dir_t dir){
+    // number of results of a reduction along dir
+    return dir == ROW ? m1->col : dir == COLUMN ? m1->row : 1;
 }
 
 matrix_t *m_sumfd(const matrix_t *m1, matrix_dir_t dir){
@@ -643,19 +1469,13 @@ matrix_t *m_sumfd(const matrix_t *m1, matrix_dir_t dir){
     if(!m1)
         errx(MATRIX_NULL_POINTER, "m_sumfd: %s", MATRIX_NULL_POINTER_MESSAGE);
     
-    matrix_t *result;
-    if(dir == ROW)
-        result = matrix_of(1, m1->col, 0);
-    else
-        result = matrix_of(m1->row, 1, 0);
+    MATRIX_STAT_REDUCE(MATRIX_OP_SUMFD, m1->row * m1->col, matrix_reduce_len(m1, dir));
 
-    for(size_t i = 0; i < m1->row; i++)
-        for(size_t j = 0; j < m1->col; j++)
-            if(dir == ROW)
-                result->data[j] += m1->data[i*m1->col + j];
-            else
-                result->data[i] += m1->data[i*m1->col + j];
+    matrix_t *result;
+    if(!(result = matrix_alloc(dir == COLUMN ? m1->row : 1, dir == ROW ? m1->col : 1)))
+        return NULL;
 
+    m_reduce(m1, dir, &(matrix_reduce_t){ .sum = result });
     return result;
 }
 
@@ -669,20 +1489,12 @@ void m_sumfdt(const matrix_t *m1, matrix_t *result, matrix_dir_t dir){
     if(!m1 || !result)
         errx(MATRIX_NULL_POINTER, "m_sumfdt: %s", MATRIX_NULL_POINTER_MESSAGE);
     
-    if(dir == ROW){
-        if(result->row != 1 || result->col != m1->col)
-            errx(MATRIX_INVALID_DIMENSIONS, "m_sumfdt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
-    }else{
-        if(result->row != m1->row || result->col != 1)
-            errx(MATRIX_INVALID_DIMENSIONS, "m_sumfdt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
-    }
+    if(result->row != (dir == COLUMN ? m1->row : 1) || result->col != (dir == ROW ? m1->col : 1))
+        errx(MATRIX_INVALID_DIMENSIONS, "m_sumfdt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
 
-    for(size_t i = 0; i < m1->row; i++)
-        for(size_t j = 0; j < m1->col; j++)
-            if(dir == ROW)
-                result->data[j] += m1->data[i*m1->col + j];
-            else
-                result->data[i] += m1->data[i*m1->col + j];
+    MATRIX_STAT_REDUCE(MATRIX_OP_SUMFD, m1->row * m1->col, matrix_reduce_len(m1, dir));
+
+    m_reduce(m1, dir, &(matrix_reduce_t){ .sum = result });
 }
 
 matrix_t *m_mulfd(const matrix_t *m1, matrix_dir_t dir){
@@ -695,19 +1507,13 @@ matrix_t *m_mulfd(const matrix_t *m1, matrix_dir_t dir){
     if(!m1)
         errx(MATRIX_NULL_POINTER, "m_mulfd: %s", MATRIX_NULL_POINTER_MESSAGE);
     
-    matrix_t *result;
-    if(dir == ROW)
-        result = matrix_of(1, m1->col, 1);
-    else
-        result = matrix_of(m1->row, 1, 1);
+    MATRIX_STAT_REDUCE(MATRIX_OP_MULFD, m1->row * m1->col, matrix_reduce_len(m1, dir));
 
-    for(size_t i = 0; i < m1->row; i++)
-        for(size_t j = 0; j < m1->col; j++)
-            if(dir == ROW)
-                result->data[j] *= m1->data[i*m1->col + j];
-            else
-                result->data[i] *= m1->data[i*m1->col + j];
+    matrix_t *result;
+    if(!(result = matrix_alloc(dir == COLUMN ? m1->row : 1, dir == ROW ? m1->col : 1)))
+        return NULL;
 
+    m_reduce(m1, dir, &(matrix_reduce_t){ .prod = result });
     return result;
 }
 
@@ -720,21 +1526,127 @@ void m_mulfdt(const matrix_t *m1, matrix_t *result, matrix_dir_t dir){
     */
     if(!m1 || !result)
         errx(MATRIX_NULL_POINTER, "m_mulfdt: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    if(result->row != (dir == COLUMN ? m1->row : 1) || result->col != (dir == ROW ? m1->col : 1))
+        errx(MATRIX_INVALID_DIMENSIONS, "m_mulfdt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
 
-    if(dir == ROW){
-        if(result->row != 1 || result->col != m1->col)
-            errx(MATRIX_INVALID_DIMENSIONS, "m_sumfdt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
-    }else{
-        if(result->row != m1->row || result->col != 1)
-            errx(MATRIX_INVALID_DIMENSIONS, "m_sumfdt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
-    }
+    MATRIX_STAT_REDUCE(MATRIX_OP_MULFD, m1->row * m1->col, matrix_reduce_len(m1, dir));
+
+    m_reduce(m1, dir, &(matrix_reduce_t){ .prod = result });
+}
+
+matrix_t *m_minfd(const matrix_t *m1, matrix_dir_t dir){
+    /*
+        * matrix minimum following a direction
+        * @params m1: pointer to the matrix
+        *         dir: direction
+        * @return matrix_t* : pointer to the result matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_minfd: %s", MATRIX_NULL_POINTER_MESSAGE);
     
-    for(size_t i = 0; i < m1->row; i++)
-        for(size_t j = 0; j < m1->col; j++)
-            if(dir == ROW)
-                result->data[j] *= m1->data[i*m1->col + j];
-            else
-                result->data[i] *= m1->data[i*m1->col + j];
+    MATRIX_STAT_REDUCE(MATRIX_OP_MINFD, m1->row * m1->col, matrix_reduce_len(m1, dir));
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(dir == COLUMN ? m1->row : 1, dir == ROW ? m1->col : 1)))
+        return NULL;
+
+    m_reduce(m1, dir, &(matrix_reduce_t){ .min = result });
+    return result;
+}
+
+void m_minfdt(const matrix_t *m1, matrix_t *result, matrix_dir_t dir){
+    /*
+        * matrix minimum following a direction to result
+        * @params m1: pointer to the matrix
+        *         result: pointer to the result matrix
+        *         dir: direction
+    */
+    if(!m1 || !result)
+        errx(MATRIX_NULL_POINTER, "m_minfdt: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    if(result->row != (dir == COLUMN ? m1->row : 1) || result->col != (dir == ROW ? m1->col : 1))
+        errx(MATRIX_INVALID_DIMENSIONS, "m_minfdt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT_REDUCE(MATRIX_OP_MINFD, m1->row * m1->col, matrix_reduce_len(m1, dir));
+
+    m_reduce(m1, dir, &(matrix_reduce_t){ .min = result });
+}
+
+matrix_t *m_maxfd(const matrix_t *m1, matrix_dir_t dir){
+    /*
+        * matrix maximum following a direction
+        * @params m1: pointer to the matrix
+        *         dir: direction
+        * @return matrix_t* : pointer to the result matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_maxfd: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    MATRIX_STAT_REDUCE(MATRIX_OP_MAXFD, m1->row * m1->col, matrix_reduce_len(m1, dir));
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(dir == COLUMN ? m1->row : 1, dir == ROW ? m1->col : 1)))
+        return NULL;
+
+    m_reduce(m1, dir, &(matrix_reduce_t){ .max = result });
+    return result;
+}
+
+void m_maxfdt(const matrix_t *m1, matrix_t *result, matrix_dir_t dir){
+    /*
+        * matrix maximum following a direction to result
+        * @params m1: pointer to the matrix
+        *         result: pointer to the result matrix
+        *         dir: direction
+    */
+    if(!m1 || !result)
+        errx(MATRIX_NULL_POINTER, "m_maxfdt: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    if(result->row != (dir == COLUMN ? m1->row : 1) || result->col != (dir == ROW ? m1->col : 1))
+        errx(MATRIX_INVALID_DIMENSIONS, "m_maxfdt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT_REDUCE(MATRIX_OP_MAXFD, m1->row * m1->col, matrix_reduce_len(m1, dir));
+
+    m_reduce(m1, dir, &(matrix_reduce_t){ .max = result });
+}
+
+matrix_t *m_meanfd(const matrix_t *m1, matrix_dir_t dir){
+    /*
+        * matrix mean following a direction
+        * @params m1: pointer to the matrix
+        *         dir: direction
+        * @return matrix_t* : pointer to the result matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_meanfd: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    MATRIX_STAT_REDUCE(MATRIX_OP_MEANFD, m1->row * m1->col, matrix_reduce_len(m1, dir));
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(dir == COLUMN ? m1->row : 1, dir == ROW ? m1->col : 1)))
+        return NULL;
+
+    m_reduce(m1, dir, &(matrix_reduce_t){ .mean = result });
+    return result;
+}
+
+void m_meanfdt(const matrix_t *m1, matrix_t *result, matrix_dir_t dir){
+    /*
+        * matrix mean following a direction to result
+        * @params m1: pointer to the matrix
+        *         result: pointer to the result matrix
+        *         dir: direction
+    */
+    if(!m1 || !result)
+        errx(MATRIX_NULL_POINTER, "m_meanfdt: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    if(result->row != (dir == COLUMN ? m1->row : 1) || result->col != (dir == ROW ? m1->col : 1))
+        errx(MATRIX_INVALID_DIMENSIONS, "m_meanfdt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT_REDUCE(MATRIX_OP_MEANFD, m1->row * m1->col, matrix_reduce_len(m1, dir));
+
+    m_reduce(m1, dir, &(matrix_reduce_t){ .mean = result });
 }
 
 matrix_t *m_apply(const matrix_t *m1, MATRIX_TYPE (*f)(MATRIX_TYPE)){
@@ -747,12 +1659,15 @@ matrix_t *m_apply(const matrix_t *m1, MATRIX_TYPE (*f)(MATRIX_TYPE)){
     if(!m1)
         errx(MATRIX_NULL_POINTER, "m_apply: %s", MATRIX_NULL_POINTER_MESSAGE);
     
+    MATRIX_STAT_MAP(MATRIX_OP_APPLY, m1->row * m1->col, 0, 2);
+
     matrix_t *result;
-    if(!(result = matrix_init(m1->row, m1->col)))
+    if(!(result = matrix_alloc(m1->row, m1->col)))
         return NULL;
 
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        result->data[i] = f(m1->data[i]);
+    for(size_t i = 0; i < m1->row; i++)
+        for(size_t j = 0; j < m1->col; j++)
+            MATRIX_AT(result, i, j) = f(MATRIX_AT(m1, i, j));
 
     return result;
 }
@@ -766,8 +1681,11 @@ void m_applyp(const matrix_t *m1, MATRIX_TYPE (*f)(MATRIX_TYPE)){
     if(!m1)
         errx(MATRIX_NULL_POINTER, "m_applyp: %s", MATRIX_NULL_POINTER_MESSAGE);
     
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        m1->data[i] = f(m1->data[i]);
+    MATRIX_STAT_MAP(MATRIX_OP_APPLY, m1->row * m1->col, 0, 2);
+
+    for(size_t i = 0; i < m1->row; i++)
+        for(size_t j = 0; j < m1->col; j++)
+            MATRIX_AT(m1, i, j) = f(MATRIX_AT(m1, i, j));
 }
 
 void m_applyt(const matrix_t *m1, matrix_t *result, MATRIX_TYPE (*f)(MATRIX_TYPE)){
@@ -783,6 +1701,197 @@ void m_applyt(const matrix_t *m1, matrix_t *result, MATRIX_TYPE (*f)(MATRIX_TYPE
     if(result->row != m1->row || result->col != m1->col)
         errx(MATRIX_INVALID_DIMENSIONS, "m_applyt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
     
-    for(size_t i = 0; i < m1->row * m1->col; i++)
-        result->data[i] = f(m1->data[i]);
+    MATRIX_STAT_MAP(MATRIX_OP_APPLY, m1->row * m1->col, 0, 2);
+
+    for(size_t i = 0; i < m1->row; i++)
+        for(size_t j = 0; j < m1->col; j++)
+            MATRIX_AT(result, i, j) = f(MATRIX_AT(m1, i, j));
+}
+
+matrix_t *m_applys(const matrix_t *m1, void (*f)(const MATRIX_TYPE *in, MATRIX_TYPE *out, size_t n)){
+    /*
+        * apply a span function to the matrix: f is called once per row, or once for
+        * the whole matrix when it is dense, so that it can vectorize its loop
+        * @params m1: pointer to the matrix
+        *         f: function computing out[0..n) from in[0..n)
+        * @return matrix_t* : pointer to the result matrix
+    */
+    if(!m1 || !f)
+        errx(MATRIX_NULL_POINTER, "m_applys: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    MATRIX_STAT_MAP(MATRIX_OP_APPLYS, m1->row * m1->col, 0, 2);
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(m1->row, m1->col)))
+        return NULL;
+
+    matrix_map1(f, m1, result);
+    return result;
+}
+
+void m_applysp(matrix_t *m1, void (*f)(const MATRIX_TYPE *in, MATRIX_TYPE *out, size_t n)){
+    /*
+        * apply a span function to the matrix in place (f is called with in == out)
+        * @params m1: pointer to the matrix
+        *         f: function computing out[0..n) from in[0..n)
+    */
+    if(!m1 || !f)
+        errx(MATRIX_NULL_POINTER, "m_applysp: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    MATRIX_STAT_MAP(MATRIX_OP_APPLYS, m1->row * m1->col, 0, 2);
+
+    matrix_map1(f, m1, m1);
+}
+
+void m_applyst(const matrix_t *m1, matrix_t *result, void (*f)(const MATRIX_TYPE *in, MATRIX_TYPE *out, size_t n)){
+    /*
+        * apply a span function to the matrix to result
+        * @params m1: pointer to the matrix
+        *         result: pointer to the result matrix
+        *         f: function computing out[0..n) from in[0..n)
+    */
+    if(!m1 || !result || !f)
+        errx(MATRIX_NULL_POINTER, "m_applyst: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    if(result->row != m1->row || result->col != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_applyst: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT_MAP(MATRIX_OP_APPLYS, m1->row * m1->col, 0, 2);
+
+    matrix_map1(f, m1, result);
+}
+
+matrix_t *m_map(const matrix_t *m1, matrix_fn_t fn){
+    /*
+        * apply a built-in function to each element of the matrix
+        * @params m1: pointer to the matrix
+        *         fn: MATRIX_FN_* function, optionally | MATRIX_FN_FAST
+        * @return matrix_t* : pointer to the result matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_map: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    matrix_math_t kernel;
+    if(!(kernel = matrix_math(fn)))
+        errx(MATRIX_INVALID_ARGUMENT, "m_map: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+    
+    MATRIX_STAT_MAP(MATRIX_OP_MAP, m1->row * m1->col, 0, 2);
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(m1->row, m1->col)))
+        return NULL;
+
+    matrix_map1(kernel, m1, result);
+    return result;
+}
+
+void m_mapp(matrix_t *m1, matrix_fn_t fn){
+    /*
+        * apply a built-in function to each element of the matrix in place
+        * @params m1: pointer to the matrix
+        *         fn: MATRIX_FN_* function, optionally | MATRIX_FN_FAST
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_mapp: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    matrix_math_t kernel;
+    if(!(kernel = matrix_math(fn)))
+        errx(MATRIX_INVALID_ARGUMENT, "m_mapp: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    MATRIX_STAT_MAP(MATRIX_OP_MAP, m1->row * m1->col, 0, 2);
+
+    matrix_map1(kernel, m1, m1);
+}
+
+void m_mapt(const matrix_t *m1, matrix_t *result, matrix_fn_t fn){
+    /*
+        * apply a built-in function to each element of the matrix to result
+        * @params m1: pointer to the matrix
+        *         result: pointer to the result matrix
+        *         fn: MATRIX_FN_* function, optionally | MATRIX_FN_FAST
+    */
+    if(!m1 || !result)
+        errx(MATRIX_NULL_POINTER, "m_mapt: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    if(result->row != m1->row || result->col != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_mapt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    matrix_math_t kernel;
+    if(!(kernel = matrix_math(fn)))
+        errx(MATRIX_INVALID_ARGUMENT, "m_mapt: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    MATRIX_STAT_MAP(MATRIX_OP_MAP, m1->row * m1->col, 0, 2);
+
+    matrix_map1(kernel, m1, result);
+}
+
+static void matrix_clamp(const matrix_t *m1, MATRIX_TYPE lo, MATRIX_TYPE hi, matrix_t *result){
+    if(matrix_dense(m1) && matrix_dense(result)){
+        matrix_math_clamp(m1->data, result->data, m1->row * m1->col, lo, hi);
+        return;
+    }
+    for(size_t i = 0; i < m1->row; i++)
+        matrix_math_clamp(m1->data + i*m1->stride, result->data + i*result->stride, m1->col, lo, hi);
+}
+
+matrix_t *m_clamp(const matrix_t *m1, MATRIX_TYPE lo, MATRIX_TYPE hi){
+    /*
+        * clamp each element of the matrix to [lo, hi]
+        * @params m1: pointer to the matrix
+        *         lo, hi: bounds, lo <= hi
+        * @return matrix_t* : pointer to the result matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_clamp: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    // NaN bounds fail the test as well
+    if(!(lo <= hi))
+        errx(MATRIX_INVALID_ARGUMENT, "m_clamp: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    MATRIX_STAT_MAP(MATRIX_OP_CLAMP, m1->row * m1->col, 0, 2);
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(m1->row, m1->col)))
+        return NULL;
+
+    matrix_clamp(m1, lo, hi, result);
+    return result;
+}
+
+void m_clampp(matrix_t *m1, MATRIX_TYPE lo, MATRIX_TYPE hi){
+    /*
+        * clamp each element of the matrix to [lo, hi] in place
+        * @params m1: pointer to the matrix
+        *         lo, hi: bounds, lo <= hi
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_clampp: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(!(lo <= hi))
+        errx(MATRIX_INVALID_ARGUMENT, "m_clampp: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    MATRIX_STAT_MAP(MATRIX_OP_CLAMP, m1->row * m1->col, 0, 2);
+
+    matrix_clamp(m1, lo, hi, m1);
+}
+
+void m_clampt(const matrix_t *m1, MATRIX_TYPE lo, MATRIX_TYPE hi, matrix_t *result){
+    /*
+        * clamp each element of the matrix to [lo, hi] to result
+        * @params m1: pointer to the matrix
+        *         lo, hi: bounds, lo <= hi
+        *         result: pointer to the result matrix
+    */
+    if(!m1 || !result)
+        errx(MATRIX_NULL_POINTER, "m_clampt: %s", MATRIX_NULL_POINTER_MESSAGE);
+    
+    if(result->row != m1->row || result->col != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_clampt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    if(!(lo <= hi))
+        errx(MATRIX_INVALID_ARGUMENT, "m_clampt: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    MATRIX_STAT_MAP(MATRIX_OP_CLAMP, m1->row * m1->col, 0, 2);
+
+    matrix_clamp(m1, lo, hi, result);
 }
\ No newline at end of file
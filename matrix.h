@@ -15,115 +15,375 @@
  * - matrix_Id: Initialize an identity matrix.
  * - matrix_nId: Initialize a matrix with a scalar multiplied identity matrix.
  * 
+ * Element access:
+ * - matrix_get / matrix_set, matrix_get_unchecked / matrix_set_unchecked (no check, inline).
+ * - matrix_row, matrix_get_data / matrix_set_data, matrix_gather / matrix_scatter, matrix_get_diag /
+ *   matrix_set_diag: bulk access, validated once per call instead of once per element.
+ * - m_addt_unchecked, m_mult_unchecked, ...: operations without validation (checked when the library is
+ *   built with MATRIX_DEBUG).
+ * 
  * Matrix Copy:
  * - matrix_copyto: Copy matrix to another (in-place).
  * - matrix_getcpy: Return a deep copy of the matrix.
  * 
+ * Matrix Views:
+ * - matrix_view, matrix_view_rows, matrix_view_data: O(1) non-owning views with a leading dimension,
+ *   usable wherever a matrix is expected (including as the output of the 't' and 'p' variants).
+ * 
  * Matrix Operations:
  * - Various operations for addition, subtraction, scalar addition, scalar subtraction, multiplication, power,
  *   scalar multiplication, scalar division, scalar product, transposition, sum along a direction, multiplication
  *   along a direction, and element-wise function application.
+ * - m_mult_batched: many small same-shape products over strided storage (matrix_batch_t), in one call.
+ * - matrix_set_strassen: opt-in Strassen-Winograd multiplication of large products (m_mul, m_mult, m_pow),
+ *   recursing down to a crossover size, with a normwise error bound.
+ * - m_gemm / m_gemmt: multiplication fused with alpha/beta scaling, bias broadcast and activation,
+ *   applied to each tile while it is still in cache.
+ * - m_gemv / m_gemvt: matrix-vector product y = alpha*op(A)*x + beta*y with SIMD accumulators, optionally
+ *   transposed (MATRIX_GEMV_TRANS) and accumulated in double (MATRIX_GEMV_WIDE); m_dotd: double precision m_dot.
+ * - m_reduce: sum, product, mean, min, max, argmin, argmax and norms along ROW, COLUMN or ALL in one pass,
+ *   with pairwise (default), Kahan or straight summation.
+ * - m_transpp: in-place transposition (square matrices, or dense rectangular ones by cycle following).
+ * - m_applys: element-wise function called on whole rows (one call per span instead of per element).
+ * - m_map: built-in SIMD exp, log, tanh, sigmoid, relu and sqrt (MATRIX_FN_*); m_clamp: clamp to [lo, hi].
+ * 
+ * Linear systems (floating point families):
+ * - matrix_lu: blocked LU factorization with partial pivoting, trailing updates through the GEMM kernels.
+ * - m_lu_solve, m_lu_inv, m_lu_det: solve, inverse and determinant reusing a factorization (O(n^2) per
+ *   right-hand side); m_solve, m_inv, m_det: the same from the matrix.
+ * - matrix_qr: blocked Householder QR (compact WY, the updates through the GEMM kernels); m_qr_q, m_qr_r.
+ * - m_qr_solve, m_lstsq: least squares; m_tsqr, m_tsqr_solve: tall-skinny QR, row blocks in parallel.
+ * 
+ * Sparse matrices:
+ * - matrix_csr_t / matrix_coo_t: CSR and COO storage, conversions from and to matrix_t.
+ * - m_spmv, m_spmul, m_spspmul, m_sppow: sparse x vector, x dense, x sparse products and powers.
+ * 
+ * Fixed-size matrices:
+ * - matrix_fixed.h: stack-allocated, fully unrolled 2x2, 3x3 and 4x4 matrices (m3_mul, m4_pow, ...).
+ * 
+ * Files:
+ * - matrix_save / matrix_load: versioned binary format (header, then page-aligned elements).
+ * - matrix_mmap: zero-copy load, the matrix is backed by the pages of the file.
+ * - m_mul_file, m_add_file, ...: out-of-core operations on files, tiled within a memory budget.
  * 
  * Memory Management:
  * - matrix_free: Free the memory occupied by a matrix.
+ * - matrix_allocator_use: Select the allocator of new matrices (default heap, size-class pool, arena or custom).
+ *   Matrix data is always MATRIX_ALIGN (64 bytes) aligned.
+ * 
+ * Threading:
+ * - matrix_set_num_threads / matrix_get_num_threads: Number of threads used by parallel operations.
+ * - matrix_async, m_mult_async, m_addt_async, m_reduce_async, ...: asynchronous operations returning a
+ *   future (matrix_future_wait / matrix_future_done), started once the futures they depend on complete.
+ * 
+ * Instrumentation (built with MATRIX_STATS):
+ * - matrix_stats: calls, elements, FLOPs, bytes, allocations and time of every operation.
+ * - matrix_stats_hook: callback after each call, for tracing.
+ * 
+ * Element types:
+ * - The typed part of the library is compiled from a single source once per element type, each
+ *   with its own kernels, into one family of symbols per type:
+ *   f32 (float): matrix_t, m_add, ... (the historical names, also matrix_f32_t)
+ *   f64 (double): matrix_f64_t, m_add_f64, ...
+ *   i32 (int32_t): matrix_i32_t, m_add_i32, ...
+ * - Defining MATRIX_FAMILY_F64 or MATRIX_FAMILY_I32 before including this header makes MATRIX_TYPE,
+ *   matrix_t, m_add, ... refer to that family, so that one source can target any of them.
+ * - matrix_<from>_to_<to> / matrix_<from>_to_<to>t: conversions between families.
+ * 
+ * Quantization:
+ * - matrix_q8_t: int8 matrix with a scale and zero point per row or for the whole matrix.
+ * - matrix_quantize / matrix_dequantize: from and to f32 matrices.
+ * - m_q8_mul, m_q8_mult_i32, m_q8_multq: int8 x int8 products accumulated in int32 (AVX-512 VNNI or AVX2
+ *   kernels), dequantized to f32, kept in int32 or requantized to int8.
  * 
  * Note: Please choose the appropriate function based on your specific requirements.
  */
 
 
 #include <stddef.h>
+#include <stdint.h>
 
-#define MATRIX_TYPE float
-
+// direction of a reduction: ROW collapses the rows (1 x col result), COLUMN the columns (row x 1),
+// ALL the whole matrix (1 x 1)
 typedef enum{
     ROW,
-    COLUMN
+    COLUMN,
+    ALL
 }matrix_dir_t;
 
+// summation algorithm of the reductions (m_reduce)
+typedef enum{
+    MATRIX_SUM_PAIRWISE,    // partial sums combined as a binary tree: O(log n) error growth, full speed
+    MATRIX_SUM_KAHAN,       // compensated summation: error independent of n, about half the speed
+    MATRIX_SUM_NAIVE        // straight accumulation
+}matrix_sum_t;
+
+// activation applied by the fused multiplication (m_gemm)
+typedef enum{
+    MATRIX_ACT_NONE,
+    MATRIX_ACT_RELU,
+    MATRIX_ACT_SIGMOID,
+    MATRIX_ACT_TANH
+}matrix_act_t;
+
+// built-in element-wise functions (m_map)
+typedef enum{
+    MATRIX_FN_EXP,
+    MATRIX_FN_LOG,
+    MATRIX_FN_TANH,
+    MATRIX_FN_SIGMOID,
+    MATRIX_FN_RELU,
+    MATRIX_FN_SQRT,
+    MATRIX_FN_FAST = 0x100  // or'ed with a function: lower degree approximation (relative error below 1e-5
+                            // on f32, 1e-9 on f64) instead of a couple of ulp
+}matrix_fn_t;
+
+// options of the matrix-vector product (m_gemv) and of m_dotd, or'ed
+typedef enum{
+    MATRIX_GEMV_DEFAULT = 0,
+    MATRIX_GEMV_TRANS = 1,  // multiply by the transpose of the matrix
+    MATRIX_GEMV_WIDE = 2    // accumulate every product in double (int64_t for the integer family)
+}matrix_gemv_t;
+
+// options of matrix_mmap, or'ed
+typedef enum{
+    MATRIX_MMAP_READ = 0,       // read-only matrix, writing to it faults
+    MATRIX_MMAP_PRIVATE = 1,    // writable, copy-on-write: the changes stay in the process
+    MATRIX_MMAP_SHARED = 2,     // writable, the changes are written back to the file
+    MATRIX_MMAP_POPULATE = 4    // read the whole file when mapping instead of page by page on first access
+}matrix_mmap_t;
+
+// operations counted by the instrumentation (matrix_stats), every variant and element type of an
+// operation together
+typedef enum{
+    MATRIX_OP_ADD,          // m_add
+    MATRIX_OP_KADD,         // m_kadd
+    MATRIX_OP_SUB,          // m_sub
+    MATRIX_OP_KSUB,         // m_ksub
+    MATRIX_OP_MUL,          // m_mul
+    MATRIX_OP_GEMM,         // m_gemm
+    MATRIX_OP_GEMV,         // m_gemv
+    MATRIX_OP_MUL_BATCHED,  // m_mult_batched
+    MATRIX_OP_POW,          // m_pow
+    MATRIX_OP_KMUL,         // m_kmul
+    MATRIX_OP_KDIV,         // m_kdiv
+    MATRIX_OP_DOT,          // m_dot, m_dotd
+    MATRIX_OP_TRANSP,       // m_transp
+    MATRIX_OP_SUMFD,        // m_sumfd
+    MATRIX_OP_MULFD,        // m_mulfd
+    MATRIX_OP_MINFD,        // m_minfd
+    MATRIX_OP_MAXFD,        // m_maxfd
+    MATRIX_OP_MEANFD,       // m_meanfd
+    MATRIX_OP_REDUCE,       // m_reduce
+    MATRIX_OP_APPLY,        // m_apply
+    MATRIX_OP_APPLYS,       // m_applys
+    MATRIX_OP_MAP,          // m_map
+    MATRIX_OP_CLAMP,        // m_clamp
+    MATRIX_OP_SPMV,         // m_spmv
+    MATRIX_OP_SPMUL,        // m_spmul
+    MATRIX_OP_SPSPMUL,      // m_spspmul
+    MATRIX_OP_SPPOW,        // m_sppow
+    MATRIX_OP_MUL_FILE,     // m_mul_file
+    MATRIX_OP_MAP_FILE,     // m_add_file, m_sub_file, m_kmul_file, m_map_file
+    MATRIX_OP_LU,           // matrix_lu
+    MATRIX_OP_SOLVE,        // m_lu_solve, m_solve
+    MATRIX_OP_INV,          // m_lu_inv, m_inv
+    MATRIX_OP_DET,          // m_lu_det, m_det
+    MATRIX_OP_QR,           // matrix_qr
+    MATRIX_OP_LSTSQ,        // m_qr_solve, m_lstsq, m_tsqr_solve
+    MATRIX_OP_TSQR,         // m_tsqr
+    MATRIX_OP_QUANTIZE,     // matrix_quantize, matrix_dequantize
+    MATRIX_OP_Q8_MUL,       // m_q8_mul
+    MATRIX_OP_COUNT
+}matrix_op_t;
+
+// counters of an operation (matrix_stats), or of a single call (matrix_stats_hook, calls = 1)
+typedef struct {
+    uint64_t calls;
+    uint64_t elements;      // elements of the results (non-zeros for sparse results)
+    uint64_t flops;         // arithmetic operations (multiply-add = 2), 0 for data movement, user functions
+                            // and m_sppow
+    uint64_t bytes;         // bytes of the operands read and of the results written, each once
+    uint64_t allocs;        // dense matrices allocated (results and temporaries)
+    uint64_t alloc_bytes;   // data bytes of those matrices
+    uint64_t ns;            // wall time
+}matrix_stat_t;
+
+// alignment of every block handed out by an allocator (one cache line)
+#define MATRIX_ALIGN 64
+
+// allocator flags
+#define MATRIX_ALLOC_INLINE 1   // header and data of a matrix share one block
+
+typedef struct matrix_allocator matrix_allocator_t;
+
+// pluggable allocator, custom ones embed this struct as their first member
+struct matrix_allocator {
+    // return a MATRIX_ALIGN aligned block of size bytes, NULL on failure
+    void *(*alloc)(matrix_allocator_t *self, size_t size);
+    // give back a block returned by alloc, with the same size
+    void (*free)(matrix_allocator_t *self, void *ptr, size_t size);
+    // release every block at once (may be NULL)
+    void (*reset)(matrix_allocator_t *self);
+    // release the allocator itself (may be NULL)
+    void (*destroy)(matrix_allocator_t *self);
+    int flags;
+};
+
+// allocator used by the calling thread for new matrices (NULL selects the default heap allocator)
+// returns the previous one
+matrix_allocator_t *matrix_allocator_use(matrix_allocator_t *alloc);
+// size-class pool: freed blocks are kept on per-size free lists for reuse
+matrix_allocator_t *matrix_pool_new(int flags);
+// arena: bump allocation in chunks of at least chunk bytes, freed all at once by reset
+matrix_allocator_t *matrix_arena_new(size_t chunk, int flags);
+// release every block of an allocator (every matrix it holds becomes invalid)
+void matrix_allocator_reset(matrix_allocator_t *alloc);
+// release an allocator and every block it holds
+void matrix_allocator_free(matrix_allocator_t *alloc);
+
+// number of threads used by parallel operations, caller included (0 restores the default)
+void matrix_set_num_threads(size_t n);
+size_t matrix_get_num_threads(void);
+
+// handle of an operation running asynchronously (matrix_async, m_mult_async, ...)
+typedef struct matrix_future matrix_future_t;
+
+// run fn(ctx) on a scheduler thread once every one of the ndeps futures of deps has completed
+// (deps may be NULL when ndeps is 0, and its futures released once this call returns)
+// returns the future of the call, NULL on failure
+matrix_future_t *matrix_async(void (*fn)(void *ctx), void *ctx, size_t ndeps, matrix_future_t *const *deps);
+// 1 if the operation of a future has completed, without blocking
+int matrix_future_done(const matrix_future_t *f);
+// wait for the operation of a future, or for every submitted one; the caller runs ready operations meanwhile
+void matrix_future_wait(const matrix_future_t *f);
+void matrix_future_wait_all(void);
+// release a future (its operation still runs if it has not completed)
+void matrix_future_free(matrix_future_t *f);
+
+// memory budget of the out-of-core operations (m_mul_file, ...) in bytes, tile buffers included
+// (0 restores the default: MATRIX_OOC_BUDGET, or 256 MiB)
+void matrix_set_ooc_budget(size_t bytes);
+size_t matrix_get_ooc_budget(void);
+
+// Strassen-Winograd multiplication (m_mul, m_mult, m_pow): a product whose three dimensions are all at
+// least crossover is split in 2 x 2 blocks computed with 7 block products instead of 8, recursively, the
+// smaller ones use the blocked kernel; 0 disables it (the default, unless set by the MATRIX_STRASSEN
+// environment variable), MATRIX_STRASSEN_AUTO selects the crossover tuned for each element type
+// the error bound is normwise instead of elementwise, see the README; the workspace is kept per thread, and
+// a product whose workspace cannot be allocated uses the blocked kernel
+#define MATRIX_STRASSEN_AUTO ((size_t)-1)
+void matrix_set_strassen(size_t crossover);
+size_t matrix_get_strassen(void);
+
+// instrumentation, recorded only when the library is built with MATRIX_STATS defined (otherwise
+// matrix_stats_enabled returns 0 and the counters stay at 0); a call is counted once, by the
+// outermost operation when operations call each other
+int matrix_stats_enabled(void);
+// copy the counters of every operation to stats, indexed by matrix_op_t
+void matrix_stats(matrix_stat_t stats[MATRIX_OP_COUNT]);
+void matrix_stats_reset(void);
+// name of an operation ("m_mul", ...)
+const char *matrix_op_name(matrix_op_t op);
+// hook called on the calling thread after each counted call (NULL removes it)
+void matrix_stats_hook(void (*hook)(matrix_op_t op, const matrix_stat_t *call, void *ctx), void *ctx);
+
+#include "matrix_names.h"
+
+// f32 family
+#define MATRIX_TYPE float
+#define MATRIX_NAME(name) name
+#define MATRIX_TNAME(name) name##_t
+#include "matrix_family.h"
+typedef matrix_t matrix_f32_t;
+typedef matrix_batch_t matrix_batch_f32_t;
+#undef MATRIX_TYPE
+#undef MATRIX_NAME
+#undef MATRIX_TNAME
+
+// f64 family
+#define MATRIX_TYPE double
+#define MATRIX_NAME(name) name##_f64
+#define MATRIX_TNAME(name) name##_f64_t
+#include "matrix_family.h"
+#undef MATRIX_TYPE
+#undef MATRIX_NAME
+#undef MATRIX_TNAME
+
+// i32 family
+#define MATRIX_TYPE int32_t
+#define MATRIX_NAME(name) name##_i32
+#define MATRIX_TNAME(name) name##_i32_t
+#include "matrix_family.h"
+#undef MATRIX_TYPE
+#undef MATRIX_NAME
+#undef MATRIX_TNAME
+
+// conversions between families, as a new matrix or to result (same dimensions)
+// floating point to integer rounds to nearest (halfway away from zero) and saturates, NaN gives 0
+matrix_f64_t *matrix_f32_to_f64(const matrix_f32_t *m1);
+void matrix_f32_to_f64t(const matrix_f32_t *m1, matrix_f64_t *result);
+matrix_i32_t *matrix_f32_to_i32(const matrix_f32_t *m1);
+void matrix_f32_to_i32t(const matrix_f32_t *m1, matrix_i32_t *result);
+matrix_f32_t *matrix_f64_to_f32(const matrix_f64_t *m1);
+void matrix_f64_to_f32t(const matrix_f64_t *m1, matrix_f32_t *result);
+matrix_i32_t *matrix_f64_to_i32(const matrix_f64_t *m1);
+void matrix_f64_to_i32t(const matrix_f64_t *m1, matrix_i32_t *result);
+matrix_f32_t *matrix_i32_to_f32(const matrix_i32_t *m1);
+void matrix_i32_to_f32t(const matrix_i32_t *m1, matrix_f32_t *result);
+matrix_f64_t *matrix_i32_to_f64(const matrix_i32_t *m1);
+void matrix_i32_to_f64t(const matrix_i32_t *m1, matrix_f64_t *result);
+
+// options of matrix_quantize and matrix_q8_init, or'ed
+typedef enum{
+    MATRIX_QUANT_TENSOR = 0,    // one scale and zero point for the whole matrix
+    MATRIX_QUANT_ROW = 1,       // one scale and zero point per row
+    MATRIX_QUANT_SYMMETRIC = 2  // zero point 0: the range [-max|x|, max|x|] instead of [min, max]
+}matrix_quant_t;
+
+// int8 matrix: element (i, j) stands for scale * (data[i*stride + j] - zero), with the scale and zero point
+// of row i (MATRIX_QUANT_ROW) or of the whole matrix; the elements are in [-127, 127]
 typedef struct {
     size_t row;
     size_t col;
-    MATRIX_TYPE* data;
-}matrix_t;
-
-// matrix initialisation with random values
-matrix_t* matrix_init(size_t row, size_t col);
-
-// matrix initialisation with x
-matrix_t* matrix_of(size_t row, size_t col, MATRIX_TYPE x);
-
-// Id matrix initialisation
-matrix_t* matrix_Id(size_t dim);
-// n*Id matrix initialisation
-matrix_t* matrix_nId(size_t dim, MATRIX_TYPE n);
-
-// getter and setter for element at (i,j)
-MATRIX_TYPE matrix_get(const matrix_t *m1, size_t i, size_t j);
-void matrix_set(matrix_t *m1, size_t i, size_t j, MATRIX_TYPE val);
-
-// deep copy of matrix
-void matrix_copyto(const matrix_t* src, matrix_t* dest);
-// return a deep copy of matrix
-matrix_t* matrix_getcpy(const matrix_t* src);
-
-// free matrix
-void matrix_free(matrix_t *m1);
-
-// matrix addition
-matrix_t *m_add(const matrix_t *m1, const matrix_t *m2);
-void m_addp(matrix_t *m1, const matrix_t *m2);
-void m_addt(const matrix_t *m1, const matrix_t *m2, matrix_t *result);
-
-// matrix scalar addition
-matrix_t* m_kadd(const matrix_t *m1, MATRIX_TYPE k);
-void m_kaddp(matrix_t *m1, MATRIX_TYPE k);
-void m_kaddt(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result);
-
-// matrix subtraction
-matrix_t *m_sub(const matrix_t *m1, const matrix_t *m2);
-void m_subp(matrix_t *m1, const matrix_t *m2);
-void m_subt(const matrix_t *m1, const matrix_t *m2, matrix_t *result);
-
-// matrix scalar subtraction
-matrix_t* m_ksub(const matrix_t *m1, MATRIX_TYPE k);
-void m_ksubp(matrix_t *m1, MATRIX_TYPE k);
-void m_ksubt(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result);
-
-// matrix multiplication
-matrix_t* m_mul(const matrix_t *m1, const matrix_t *m2);
-void m_mult(const matrix_t *m1, const matrix_t *m2, matrix_t *result);
-
-// matrix power
-matrix_t* m_pow(const matrix_t *m1, size_t n);
-void m_powp(matrix_t *m1, size_t n);
-void m_powt(const matrix_t *m1, size_t n, matrix_t *result);
-
-// matrix scalar multiplication
-matrix_t* m_kmul(const matrix_t *m1, MATRIX_TYPE k);
-void m_kmulp(matrix_t *m1, MATRIX_TYPE k);
-void m_kmult(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result);
-
-// matrix scalar division
-matrix_t* m_kdiv(const matrix_t *m1, MATRIX_TYPE k);
-void m_kdivp(matrix_t *m1, MATRIX_TYPE k);
-void m_kdivt(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result);
-
-// matrix scalar product
-MATRIX_TYPE m_dot(const matrix_t *m1, const matrix_t *m2);
-
-// matrix transposition
-matrix_t *m_transp(const matrix_t *m1);
-void m_transpt(const matrix_t *m1, matrix_t *result);
-
-// matrix sum following a direction
-matrix_t *m_sumfd(const matrix_t *m1, matrix_dir_t dir);
-void m_sumfdt(const matrix_t *m1, matrix_t *result, matrix_dir_t dir);
-
-// matrix multiplication following a direction
-matrix_t *m_mulfd(const matrix_t *m1, matrix_dir_t dir);
-void m_mulfdt(const matrix_t *m1, matrix_t *result, matrix_dir_t dir);
-
-// matrix apply function to all elements
-matrix_t *m_apply(const matrix_t *m1, MATRIX_TYPE (*f)(MATRIX_TYPE));
-void m_applyp(const matrix_t *m1, MATRIX_TYPE (*f)(MATRIX_TYPE));
-void m_applyt(const matrix_t *m1, matrix_t *result, MATRIX_TYPE (*f)(MATRIX_TYPE));
\ No newline at end of file
+    int8_t *data;
+    size_t stride;
+    matrix_allocator_t *alloc;
+    int flags;
+    matrix_quant_t quant;
+    float *scale;       // row scales with MATRIX_QUANT_ROW, otherwise one
+    int32_t *zero;      // zero points in [-127, 127], as many as scales
+}matrix_q8_t;
+
+// new int8 matrix with uninitialised data, scales 1 and zero points 0, NULL on failure
+matrix_q8_t *matrix_q8_init(size_t row, size_t col, matrix_quant_t quant);
+void matrix_q8_free(matrix_q8_t *q);
+// quantization of a f32 matrix, its range (or the range of each row) mapped to [-127, 127], rounded to nearest
+// and saturated, NaN to the zero point; matrix_quantizet keeps the scales and zero points of result
+matrix_q8_t *matrix_quantize(const matrix_f32_t *m1, matrix_quant_t quant);
+void matrix_quantizet(const matrix_f32_t *m1, matrix_q8_t *result);
+matrix_f32_t *matrix_dequantize(const matrix_q8_t *q);
+void matrix_dequantizet(const matrix_q8_t *q, matrix_f32_t *result);
+
+// int8 product A*B^T, A is m x k and B is n x k (the layout of weights, one row per output), k <= 131072,
+// accumulated in int32: as int32 without the scales (saturated), dequantized to f32, or requantized with the
+// scales and zero points of result; the int8 result may be one of the operands
+matrix_f32_t *m_q8_mul(const matrix_q8_t *a, const matrix_q8_t *b);
+void m_q8_mult(const matrix_q8_t *a, const matrix_q8_t *b, matrix_f32_t *result);
+void m_q8_mult_i32(const matrix_q8_t *a, const matrix_q8_t *b, matrix_i32_t *result);
+void m_q8_multq(const matrix_q8_t *a, const matrix_q8_t *b, matrix_q8_t *result);
+
+// family of the code including this header (f32 unless selected otherwise)
+#if defined(MATRIX_FAMILY_F64)
+#define MATRIX_TYPE double
+#define MATRIX_NAME(name) name##_f64
+#define MATRIX_TNAME(name) name##_f64_t
+#elif defined(MATRIX_FAMILY_I32)
+#define MATRIX_TYPE int32_t
+#define MATRIX_NAME(name) name##_i32
+#define MATRIX_TNAME(name) name##_i32_t
+#else
+#define MATRIX_TYPE float
+#define MATRIX_NAME(name) name
+#define MATRIX_TNAME(name) name##_t
+#endif
@@ -0,0 +1,302 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "matrix_alloc.h"
+#include "matrix_stats.h"
+
+// pooled size classes: four per power of two, from 64 bytes up to 1 GiB
+#define POOL_CLASSES 97
+#define POOL_MAX_CLASS_SIZE ((size_t)1 << 30)
+
+// header slot in front of the data of an inline matrix
+#define ALLOC_HEADER(size) ((((size) + MATRIX_ALIGN - 1) / MATRIX_ALIGN) * MATRIX_ALIGN)
+
+static void *heap_alloc(matrix_allocator_t *self, size_t size){
+    (void)self;
+    void *ptr;
+    return posix_memalign(&ptr, MATRIX_ALIGN, size ? size : 1) ? NULL : ptr;
+}
+
+static void heap_free(matrix_allocator_t *self, void *ptr, size_t size){
+    (void)self;
+    (void)size;
+    free(ptr);
+}
+
+static matrix_allocator_t matrix_heap = {
+    heap_alloc, heap_free, NULL, NULL, 0
+};
+
+static _Thread_local matrix_allocator_t *alloc_current;
+
+matrix_allocator_t *matrix_allocator_use(matrix_allocator_t *alloc){
+    /*
+        * select the allocator of the matrices created by the calling thread
+        * @params alloc: allocator, NULL for the default heap allocator
+        * @return matrix_allocator_t* : previously selected allocator
+    */
+    matrix_allocator_t *previous = alloc_current ? alloc_current : &matrix_heap;
+    alloc_current = alloc;
+    return previous;
+}
+
+void matrix_allocator_reset(matrix_allocator_t *alloc){
+    if(alloc && alloc->reset)
+        alloc->reset(alloc);
+}
+
+void matrix_allocator_free(matrix_allocator_t *alloc){
+    if(alloc && alloc->destroy)
+        alloc->destroy(alloc);
+}
+
+void *matrix_alloc_block(size_t header_size, size_t bytes, void **data, matrix_allocator_t **alloc, int *flags){
+    /*
+        * header and data of a new matrix, from the allocator of the calling thread
+        * @params header_size: size of the header (matrix_t of the family)
+        *         bytes: size of the data
+        *         data: set to the data
+        *         alloc: set to the allocator owning both blocks
+        *         flags: set to MATRIX_FLAG_INLINE when header and data share one block, 0 otherwise
+        * @return void* : header, NULL on failure
+    */
+    matrix_allocator_t *current = alloc_current ? alloc_current : &matrix_heap;
+    size_t offset = ALLOC_HEADER(header_size);
+    void *header;
+
+    if(bytes > SIZE_MAX - offset)
+        errx(MATRIX_INVALID_ARGUMENT, "matrix_alloc: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    if(current->flags & MATRIX_ALLOC_INLINE){
+        if(!(header = current->alloc(current, offset + bytes)))
+            return NULL;
+        *data = (char *)header + offset;
+        *flags = MATRIX_FLAG_INLINE;
+    }else{
+        if(!(header = current->alloc(current, header_size)))
+            return NULL;
+        if(!(*data = current->alloc(current, bytes))){
+            current->free(current, header, header_size);
+            return NULL;
+        }
+        *flags = 0;
+    }
+
+    MATRIX_STAT_ALLOC(bytes);
+    *alloc = current;
+    return header;
+}
+
+void matrix_release_block(void *header, size_t header_size, void *data, size_t bytes,
+                          matrix_allocator_t *alloc, int flags){
+    if(flags & MATRIX_FLAG_INLINE){
+        alloc->free(alloc, header, ALLOC_HEADER(header_size) + bytes);
+        return;
+    }
+    alloc->free(alloc, data, bytes);
+    alloc->free(alloc, header, header_size);
+}
+
+/*
+ * Size-class pool
+ * Blocks are rounded up to one of four sizes per power of two (at most 25%
+ * waste) and kept on the free list of their class when released.
+ */
+typedef struct pool_block {
+    struct pool_block *next;
+}pool_block_t;
+
+typedef struct {
+    matrix_allocator_t base;
+    pthread_mutex_t lock;
+    pool_block_t *free[POOL_CLASSES];
+}matrix_pool_t;
+
+static size_t pool_class(size_t size){
+    /*
+        * smallest class holding size bytes
+        * class c has (4 + c%4) << (c/4 + 4) bytes: 64, 80, 96, 112, 128, 160, ...
+    */
+    if(size <= 64)
+        return 0;
+
+    size_t h = 8 * sizeof(unsigned long long) - 1 - (size_t)__builtin_clzll((unsigned long long)(size - 1));
+    size_t step = (size_t)1 << (h - 2);
+    size_t sub = (size - ((size_t)1 << h) + step - 1) / step;
+    return 4 * (h - 6) + sub;
+}
+
+static size_t pool_class_size(size_t c){
+    return (4 + c % 4) << (c / 4 + 4);
+}
+
+static void *pool_alloc(matrix_allocator_t *self, size_t size){
+    matrix_pool_t *pool = (matrix_pool_t *)self;
+    if(size > POOL_MAX_CLASS_SIZE)
+        return heap_alloc(self, size);
+
+    size_t c = pool_class(size);
+    pthread_mutex_lock(&pool->lock);
+    pool_block_t *block = pool->free[c];
+    if(block)
+        pool->free[c] = block->next;
+    pthread_mutex_unlock(&pool->lock);
+
+    return block ? (void *)block : heap_alloc(self, pool_class_size(c));
+}
+
+static void pool_free(matrix_allocator_t *self, void *ptr, size_t size){
+    matrix_pool_t *pool = (matrix_pool_t *)self;
+    if(size > POOL_MAX_CLASS_SIZE){
+        free(ptr);
+        return;
+    }
+
+    size_t c = pool_class(size);
+    pool_block_t *block = ptr;
+    pthread_mutex_lock(&pool->lock);
+    block->next = pool->free[c];
+    pool->free[c] = block;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void pool_reset(matrix_allocator_t *self){
+    // give the cached blocks back to the system, blocks in use are left alone
+    matrix_pool_t *pool = (matrix_pool_t *)self;
+    pthread_mutex_lock(&pool->lock);
+    for(size_t c = 0; c < POOL_CLASSES; c++)
+        while(pool->free[c]){
+            pool_block_t *next = pool->free[c]->next;
+            free(pool->free[c]);
+            pool->free[c] = next;
+        }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void pool_destroy(matrix_allocator_t *self){
+    pool_reset(self);
+    pthread_mutex_destroy(&((matrix_pool_t *)self)->lock);
+    free(self);
+}
+
+matrix_allocator_t *matrix_pool_new(int flags){
+    /*
+        * size-class pool allocator
+        * @params flags: MATRIX_ALLOC_INLINE to keep header and data in one block
+        * @return matrix_allocator_t* : new allocator, NULL on failure
+    */
+    matrix_pool_t *pool = calloc(1, sizeof(matrix_pool_t));
+    if(!pool)
+        return NULL;
+
+    pool->base = (matrix_allocator_t){ pool_alloc, pool_free, pool_reset, pool_destroy, flags };
+    pthread_mutex_init(&pool->lock, NULL);
+    return &pool->base;
+}
+
+/*
+ * Arena
+ * Blocks are carved out of large chunks and never released one by one:
+ * reset releases everything and merges the chunks so that the next cycle
+ * of the same size fits in a single one.
+ */
+typedef struct arena_chunk {
+    struct arena_chunk *next;
+    size_t size;
+    size_t used;
+}arena_chunk_t;
+
+#define ARENA_CHUNK_HEADER (((sizeof(arena_chunk_t) + MATRIX_ALIGN - 1) / MATRIX_ALIGN) * MATRIX_ALIGN)
+
+typedef struct {
+    matrix_allocator_t base;
+    pthread_mutex_t lock;
+    arena_chunk_t *head;
+    size_t chunk;
+}matrix_arena_t;
+
+static arena_chunk_t *arena_chunk_new(size_t size, arena_chunk_t *next){
+    arena_chunk_t *chunk = heap_alloc(NULL, ARENA_CHUNK_HEADER + size);
+    if(chunk)
+        *chunk = (arena_chunk_t){ next, size, 0 };
+    return chunk;
+}
+
+static void *arena_alloc(matrix_allocator_t *self, size_t size){
+    matrix_arena_t *arena = (matrix_arena_t *)self;
+    size = (size + MATRIX_ALIGN - 1) / MATRIX_ALIGN * MATRIX_ALIGN;
+    void *ptr = NULL;
+
+    pthread_mutex_lock(&arena->lock);
+    arena_chunk_t *chunk = arena->head;
+    if(!chunk || chunk->size - chunk->used < size){
+        chunk = arena_chunk_new(size > arena->chunk ? size : arena->chunk, arena->head);
+        if(chunk)
+            arena->head = chunk;
+    }
+    if(chunk){
+        ptr = (char *)chunk + ARENA_CHUNK_HEADER + chunk->used;
+        chunk->used += size;
+    }
+    pthread_mutex_unlock(&arena->lock);
+
+    return ptr;
+}
+
+static void arena_free(matrix_allocator_t *self, void *ptr, size_t size){
+    // blocks are only reclaimed by reset
+    (void)self;
+    (void)ptr;
+    (void)size;
+}
+
+static void arena_reset(matrix_allocator_t *self){
+    matrix_arena_t *arena = (matrix_arena_t *)self;
+
+    pthread_mutex_lock(&arena->lock);
+    arena_chunk_t *head = arena->head;
+    if(head && head->next){
+        size_t total = 0;
+        while(head){
+            arena_chunk_t *next = head->next;
+            total += head->size;
+            free(head);
+            head = next;
+        }
+        head = arena_chunk_new(total, NULL);
+    }
+    if(head)
+        head->used = 0;
+    arena->head = head;
+    pthread_mutex_unlock(&arena->lock);
+}
+
+static void arena_destroy(matrix_allocator_t *self){
+    matrix_arena_t *arena = (matrix_arena_t *)self;
+    while(arena->head){
+        arena_chunk_t *next = arena->head->next;
+        free(arena->head);
+        arena->head = next;
+    }
+    pthread_mutex_destroy(&arena->lock);
+    free(arena);
+}
+
+matrix_allocator_t *matrix_arena_new(size_t chunk, int flags){
+    /*
+        * arena allocator
+        * @params chunk: minimal size of the chunks requested from the system, in bytes
+        *         flags: MATRIX_ALLOC_INLINE to keep header and data in one block
+        * @return matrix_allocator_t* : new allocator, NULL on failure
+    */
+    matrix_arena_t *arena = calloc(1, sizeof(matrix_arena_t));
+    if(!arena)
+        return NULL;
+
+    arena->base = (matrix_allocator_t){ arena_alloc, arena_free, arena_reset, arena_destroy, flags };
+    arena->chunk = chunk;
+    pthread_mutex_init(&arena->lock, NULL);
+    return &arena->base;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+/**
+ * @file matrix_alloc.h
+ * @brief Allocation of matrix headers and data
+ *
+ * Internal header: every matrix_t is created by matrix_alloc with the allocator
+ * selected by the calling thread (matrix_allocator_use) and released by
+ * matrix_release through the allocator recorded in the matrix.
+ *
+ * The allocators are shared by every element type family: the typed helpers
+ * below are inline and only pass sizes to the block functions.
+ */
+
+#include <stddef.h>
+#include <err.h>
+
+#include "matrix.h"
+#include "state.h"
+
+// matrix_t.flags: header and data live in one block
+#define MATRIX_FLAG_INLINE 1
+// matrix_t.flags: non-owning view, released by nobody
+#define MATRIX_FLAG_VIEW 2
+
+// header of header_size bytes and bytes of data from the allocator of the calling thread
+// returns the header (NULL on failure) and sets the data, owning allocator and MATRIX_FLAG_* flags
+void *matrix_alloc_block(size_t header_size, size_t bytes, void **data, matrix_allocator_t **alloc, int *flags);
+
+// give back a block returned by matrix_alloc_block
+void matrix_release_block(void *header, size_t header_size, void *data, size_t bytes,
+                          matrix_allocator_t *alloc, int flags);
+
+// bytes of row x col elements of size bytes, exits with MATRIX_INVALID_ARGUMENT if they do not fit in a size_t
+static inline size_t matrix_alloc_bytes(size_t row, size_t col, size_t size){
+    size_t bytes;
+    if(__builtin_mul_overflow(row, col, &bytes) || __builtin_mul_overflow(bytes, size, &bytes))
+        errx(MATRIX_INVALID_ARGUMENT, "matrix_alloc: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+    return bytes;
+}
+
+// new row x col matrix with uninitialised data, NULL on failure
+static inline matrix_t *matrix_alloc(size_t row, size_t col){
+    void *data;
+    matrix_allocator_t *alloc;
+    int flags;
+    matrix_t *m1 = matrix_alloc_block(sizeof(matrix_t), matrix_alloc_bytes(row, col, sizeof(MATRIX_TYPE)),
+                                      &data, &alloc, &flags);
+    if(m1)
+        *m1 = (matrix_t){ row, col, data, col, alloc, flags };
+    return m1;
+}
+
+// give back the header and the data of a matrix to its allocator
+static inline void matrix_release(matrix_t *m1){
+    if(m1->flags & MATRIX_FLAG_VIEW)
+        return;
+    matrix_release_block(m1, sizeof(matrix_t), m1->data, m1->row * m1->col * sizeof(MATRIX_TYPE),
+                         m1->alloc, m1->flags);
+}
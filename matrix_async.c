@@ -0,0 +1,179 @@
+#include <err.h>
+
+#include "matrix.h"
+#include "matrix_thread.h"
+#include "state.h"
+
+/*
+ * Asynchronous variants of the operations: the arguments are copied into the
+ * future and the synchronous operation runs on a scheduler thread (see
+ * matrix_thread.c) once the futures it depends on have completed.
+ *
+ * Only pointers are captured: the matrices must stay allocated, and must not
+ * be written by the caller, until the future has completed. Argument errors are
+ * detected when the operation runs and exit like those of the synchronous call.
+ */
+
+typedef struct {
+    const matrix_t *m1, *m2;
+    matrix_t *result;
+    MATRIX_TYPE k;
+    matrix_dir_t dir;
+    matrix_fn_t fn;
+    MATRIX_TYPE (*f)(MATRIX_TYPE);
+    matrix_reduce_t out;
+}async_args_t;
+
+static void async_mult(void *args){
+    async_args_t *a = args;
+    m_mult(a->m1, a->m2, a->result);
+}
+
+static void async_addt(void *args){
+    async_args_t *a = args;
+    m_addt(a->m1, a->m2, a->result);
+}
+
+static void async_subt(void *args){
+    async_args_t *a = args;
+    m_subt(a->m1, a->m2, a->result);
+}
+
+static void async_kmult(void *args){
+    async_args_t *a = args;
+    m_kmult(a->m1, a->k, a->result);
+}
+
+static void async_transpt(void *args){
+    async_args_t *a = args;
+    m_transpt(a->m1, a->result);
+}
+
+static void async_applyt(void *args){
+    async_args_t *a = args;
+    m_applyt(a->m1, a->result, a->f);
+}
+
+static void async_mapt(void *args){
+    async_args_t *a = args;
+    m_mapt(a->m1, a->result, a->fn);
+}
+
+static void async_reduce(void *args){
+    async_args_t *a = args;
+    m_reduce(a->m1, a->dir, &a->out);
+}
+
+matrix_future_t* m_mult_async(const matrix_t *m1, const matrix_t *m2, matrix_t *result,
+                              size_t ndeps, matrix_future_t *const *deps){
+    /*
+        * asynchronous m_mult
+        * @params m1: pointer to the first matrix
+        *         m2: pointer to the second matrix
+        *         result: pointer to the result matrix
+        *         ndeps: number of futures in deps
+        *         deps: futures that must complete before the operation starts (NULL when ndeps is 0)
+        * @return matrix_future_t* : future of the operation, released by matrix_future_free, NULL on failure
+    */
+    return matrix_submit(async_mult, &(async_args_t){ .m1 = m1, .m2 = m2, .result = result },
+                         sizeof(async_args_t), ndeps, deps);
+}
+
+matrix_future_t* m_addt_async(const matrix_t *m1, const matrix_t *m2, matrix_t *result,
+                              size_t ndeps, matrix_future_t *const *deps){
+    /*
+        * asynchronous m_addt
+        * @params m1: pointer to the first matrix
+        *         m2: pointer to the second matrix
+        *         result: pointer to the result matrix
+        *         ndeps, deps: futures that must complete before the operation starts
+        * @return matrix_future_t* : future of the operation, released by matrix_future_free, NULL on failure
+    */
+    return matrix_submit(async_addt, &(async_args_t){ .m1 = m1, .m2 = m2, .result = result },
+                         sizeof(async_args_t), ndeps, deps);
+}
+
+matrix_future_t* m_subt_async(const matrix_t *m1, const matrix_t *m2, matrix_t *result,
+                              size_t ndeps, matrix_future_t *const *deps){
+    /*
+        * asynchronous m_subt
+        * @params m1: pointer to the first matrix
+        *         m2: pointer to the second matrix
+        *         result: pointer to the result matrix
+        *         ndeps, deps: futures that must complete before the operation starts
+        * @return matrix_future_t* : future of the operation, released by matrix_future_free, NULL on failure
+    */
+    return matrix_submit(async_subt, &(async_args_t){ .m1 = m1, .m2 = m2, .result = result },
+                         sizeof(async_args_t), ndeps, deps);
+}
+
+matrix_future_t* m_kmult_async(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result,
+                               size_t ndeps, matrix_future_t *const *deps){
+    /*
+        * asynchronous m_kmult
+        * @params m1: pointer to the matrix
+        *         k: scalar value
+        *         result: pointer to the result matrix
+        *         ndeps, deps: futures that must complete before the operation starts
+        * @return matrix_future_t* : future of the operation, released by matrix_future_free, NULL on failure
+    */
+    return matrix_submit(async_kmult, &(async_args_t){ .m1 = m1, .k = k, .result = result },
+                         sizeof(async_args_t), ndeps, deps);
+}
+
+matrix_future_t* m_transpt_async(const matrix_t *m1, matrix_t *result, size_t ndeps, matrix_future_t *const *deps){
+    /*
+        * asynchronous m_transpt
+        * @params m1: pointer to the matrix
+        *         result: pointer to the result matrix
+        *         ndeps, deps: futures that must complete before the operation starts
+        * @return matrix_future_t* : future of the operation, released by matrix_future_free, NULL on failure
+    */
+    return matrix_submit(async_transpt, &(async_args_t){ .m1 = m1, .result = result },
+                         sizeof(async_args_t), ndeps, deps);
+}
+
+matrix_future_t* m_applyt_async(const matrix_t *m1, matrix_t *result, MATRIX_TYPE (*f)(MATRIX_TYPE),
+                                size_t ndeps, matrix_future_t *const *deps){
+    /*
+        * asynchronous m_applyt
+        * @params m1: pointer to the matrix
+        *         result: pointer to the result matrix
+        *         f: function applied to every element, called from the thread running the operation
+        *         ndeps, deps: futures that must complete before the operation starts
+        * @return matrix_future_t* : future of the operation, released by matrix_future_free, NULL on failure
+    */
+    return matrix_submit(async_applyt, &(async_args_t){ .m1 = m1, .result = result, .f = f },
+                         sizeof(async_args_t), ndeps, deps);
+}
+
+matrix_future_t* m_mapt_async(const matrix_t *m1, matrix_t *result, matrix_fn_t fn,
+                              size_t ndeps, matrix_future_t *const *deps){
+    /*
+        * asynchronous m_mapt
+        * @params m1: pointer to the matrix
+        *         result: pointer to the result matrix
+        *         fn: built-in function
+        *         ndeps, deps: futures that must complete before the operation starts
+        * @return matrix_future_t* : future of the operation, released by matrix_future_free, NULL on failure
+    */
+    return matrix_submit(async_mapt, &(async_args_t){ .m1 = m1, .result = result, .fn = fn },
+                         sizeof(async_args_t), ndeps, deps);
+}
+
+matrix_future_t* m_reduce_async(const matrix_t *m1, matrix_dir_t dir, const matrix_reduce_t *out,
+                                size_t ndeps, matrix_future_t *const *deps){
+    /*
+        * asynchronous m_reduce
+        * @params m1: pointer to the matrix
+        *         dir: direction
+        *         out: outputs, copied (the matrices and arrays it points to are written when the operation runs)
+        *         ndeps, deps: futures that must complete before the operation starts
+        * @return matrix_future_t* : future of the operation, released by matrix_future_free, NULL on failure
+    */
+    if(!out)
+        errx(MATRIX_NULL_POINTER, "m_reduce_async: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    return matrix_submit(async_reduce, &(async_args_t){ .m1 = m1, .dir = dir, .out = *out },
+                         sizeof(async_args_t), ndeps, deps);
+}
@@ -0,0 +1,74 @@
+#include <err.h>
+#include <math.h>
+
+#include "matrix.h"
+#include "matrix_alloc.h"
+#include "state.h"
+
+// element (i,j) of a matrix of any family
+#define CONVERT_AT(m, i, j) ((m)->data[(i)*(m)->stride + (j)])
+
+// nearest int32_t, halfway cases away from zero, saturated, NaN to 0
+#define CONVERT_I32(x) ((x) != (x) ? 0                          \
+                      : (x) >= 2147483647.0 ? INT32_MAX         \
+                      : (x) <= -2147483648.0 ? INT32_MIN        \
+                      : (int32_t)round(x))
+
+// plain conversion, rounding to nearest for narrowing floating point conversions
+#define CONVERT_CAST(x) (x)
+
+/*
+ * MATRIX_CONVERT(from, to, T, CONV) defines matrix_<from>_to_<to> and
+ * matrix_<from>_to_<to>t, converting the elements with CONV.
+ * The new matrix is allocated for the family to, of element type T.
+ */
+#define MATRIX_CONVERT(from, to, T, CONV)                                                   \
+void matrix_##from##_to_##to##t(const matrix_##from##_t *m1, matrix_##to##_t *result){      \
+    /*                                                                                      \
+        * convert a matrix to another element type                                          \
+        * @params m1: pointer to the matrix                                                 \
+        *         result: pointer to the result matrix, of the same dimensions              \
+    */                                                                                      \
+    if(!m1 || !result)                                                                      \
+        errx(MATRIX_NULL_POINTER, "matrix_" #from "_to_" #to "t: %s",                       \
+             MATRIX_NULL_POINTER_MESSAGE);                                                  \
+                                                                                            \
+    if(result->row != m1->row || result->col != m1->col)                                    \
+        errx(MATRIX_INVALID_DIMENSIONS, "matrix_" #from "_to_" #to "t: %s",                 \
+             MATRIX_INVALID_DIMENSIONS_MESSAGE);                                            \
+                                                                                            \
+    for(size_t i = 0; i < m1->row; i++)                                                     \
+        for(size_t j = 0; j < m1->col; j++)                                                 \
+            CONVERT_AT(result, i, j) = CONV(CONVERT_AT(m1, i, j));                          \
+}                                                                                           \
+                                                                                            \
+matrix_##to##_t *matrix_##from##_to_##to(const matrix_##from##_t *m1){                      \
+    /*                                                                                      \
+        * copy of a matrix with another element type                                        \
+        * @params m1: pointer to the matrix                                                 \
+        * @return matrix_<to>_t* : pointer to the new matrix, NULL on failure               \
+    */                                                                                      \
+    if(!m1)                                                                                 \
+        errx(MATRIX_NULL_POINTER, "matrix_" #from "_to_" #to ": %s",                        \
+             MATRIX_NULL_POINTER_MESSAGE);                                                  \
+                                                                                            \
+    void *data;                                                                             \
+    matrix_allocator_t *alloc;                                                              \
+    int flags;                                                                              \
+    size_t bytes = matrix_alloc_bytes(m1->row, m1->col, sizeof(T));                         \
+    matrix_##to##_t *result = matrix_alloc_block(sizeof(matrix_##to##_t), bytes,            \
+                                                 &data, &alloc, &flags);                    \
+    if(!result)                                                                             \
+        return NULL;                                                                        \
+    *result = (matrix_##to##_t){ m1->row, m1->col, data, m1->col, alloc, flags };           \
+                                                                                            \
+    matrix_##from##_to_##to##t(m1, result);                                                 \
+    return result;                                                                          \
+}
+
+MATRIX_CONVERT(f32, f64, double, CONVERT_CAST)
+MATRIX_CONVERT(f32, i32, int32_t, CONVERT_I32)
+MATRIX_CONVERT(f64, f32, float, CONVERT_CAST)
+MATRIX_CONVERT(f64, i32, int32_t, CONVERT_I32)
+MATRIX_CONVERT(i32, f32, float, CONVERT_CAST)
+MATRIX_CONVERT(i32, f64, double, CONVERT_CAST)
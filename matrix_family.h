@@ -0,0 +1,353 @@
+/**
+ * @file matrix_family.h
+ * @brief Declarations of one element type family
+ *
+ * Included by matrix.h once per element type (no include guard), with
+ * MATRIX_TYPE set to the element type and the names of matrix_names.h mapped to
+ * the symbols of the family (m_add, m_add_f64, m_add_i32, ...).
+ */
+
+typedef struct {
+    size_t row;
+    size_t col;
+    MATRIX_TYPE* data;
+    // elements between the starts of two consecutive rows (col unless a view)
+    size_t stride;
+    // allocator owning the header and the data (NULL for views)
+    matrix_allocator_t *alloc;
+    int flags;
+}matrix_t;
+
+// count dense row x col matrices laid out stride elements apart
+// a stride of 0 makes every matrix of the batch the same one
+typedef struct {
+    size_t count;
+    size_t row;
+    size_t col;
+    MATRIX_TYPE *data;
+    size_t stride;
+}matrix_batch_t;
+
+// outputs of a one-pass reduction (m_reduce): each non-NULL output is computed, the matrices are
+// 1 x col (ROW), row x 1 (COLUMN) or 1 x 1 (ALL), the index arrays hold as many elements
+typedef struct {
+    matrix_t *sum;
+    matrix_t *prod;
+    matrix_t *mean;
+    matrix_t *min;
+    matrix_t *max;
+    size_t *argmin;         // row (ROW), column (COLUMN) or i*col + j (ALL) of the first minimum
+    size_t *argmax;
+    matrix_t *norm1;        // sum of |x|
+    matrix_t *norm2;        // sqrt of the sum of x^2
+    matrix_t *norminf;      // max of |x|
+    matrix_sum_t mode;      // summation algorithm of sum, mean, norm1 and norm2
+}matrix_reduce_t;
+
+// matrix initialisation with random values
+matrix_t* matrix_init(size_t row, size_t col);
+
+// matrix initialisation with x
+matrix_t* matrix_of(size_t row, size_t col, MATRIX_TYPE x);
+
+// Id matrix initialisation
+matrix_t* matrix_Id(size_t dim);
+// n*Id matrix initialisation
+matrix_t* matrix_nId(size_t dim, MATRIX_TYPE n);
+
+// getter and setter for element at (i,j)
+MATRIX_TYPE matrix_get(const matrix_t *m1, size_t i, size_t j);
+void matrix_set(matrix_t *m1, size_t i, size_t j, MATRIX_TYPE val);
+
+// getter and setter without any check, for loops that validated their indices once
+static inline MATRIX_TYPE matrix_get_unchecked(const matrix_t *m1, size_t i, size_t j){
+    return m1->data[i * m1->stride + j];
+}
+static inline void matrix_set_unchecked(matrix_t *m1, size_t i, size_t j, MATRIX_TYPE val){
+    m1->data[i * m1->stride + j] = val;
+}
+
+// bulk access: pointer to row i (col elements), whole matrix from / to a row-major buffer of row*col elements
+MATRIX_TYPE* matrix_row(const matrix_t *m1, size_t i);
+void matrix_get_data(const matrix_t *m1, MATRIX_TYPE *dst);
+void matrix_set_data(matrix_t *m1, const MATRIX_TYPE *src);
+// n elements along a line from (i,j) by steps of (di,dj), from / to a buffer (bounds checked once)
+void matrix_gather(const matrix_t *m1, size_t i, size_t j, ptrdiff_t di, ptrdiff_t dj, size_t n, MATRIX_TYPE *dst);
+void matrix_scatter(matrix_t *m1, size_t i, size_t j, ptrdiff_t di, ptrdiff_t dj, size_t n, const MATRIX_TYPE *src);
+// main diagonal (min(row, col) elements) from / to a buffer
+void matrix_get_diag(const matrix_t *m1, MATRIX_TYPE *dst);
+void matrix_set_diag(matrix_t *m1, const MATRIX_TYPE *src);
+
+// deep copy of matrix
+void matrix_copyto(const matrix_t* src, matrix_t* dest);
+// return a deep copy of matrix
+matrix_t* matrix_getcpy(const matrix_t* src);
+
+// free matrix (does nothing on a view)
+void matrix_free(matrix_t *m1);
+
+// zero-copy view on the row x col block of m1 starting at (i,j)
+// views share the storage of m1, own nothing and are accepted by every operation
+matrix_t matrix_view(const matrix_t *m1, size_t i, size_t j, size_t row, size_t col);
+// zero-copy view on n rows of m1 starting at row i
+matrix_t matrix_view_rows(const matrix_t *m1, size_t i, size_t n);
+// view on external row-major storage with a leading dimension of stride elements
+matrix_t matrix_view_data(MATRIX_TYPE *data, size_t row, size_t col, size_t stride);
+
+// batch of count row x col matrices stored in data, stride elements apart
+matrix_batch_t matrix_batch(MATRIX_TYPE *data, size_t count, size_t row, size_t col, size_t stride);
+// view on matrix t of a batch
+matrix_t matrix_batch_at(const matrix_batch_t *b, size_t t);
+
+// matrix addition
+matrix_t *m_add(const matrix_t *m1, const matrix_t *m2);
+void m_addp(matrix_t *m1, const matrix_t *m2);
+void m_addt(const matrix_t *m1, const matrix_t *m2, matrix_t *result);
+void m_addt_unchecked(const matrix_t *m1, const matrix_t *m2, matrix_t *result);
+
+// matrix scalar addition
+matrix_t* m_kadd(const matrix_t *m1, MATRIX_TYPE k);
+void m_kaddp(matrix_t *m1, MATRIX_TYPE k);
+void m_kaddt(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result);
+void m_kaddt_unchecked(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result);
+
+// matrix subtraction
+matrix_t *m_sub(const matrix_t *m1, const matrix_t *m2);
+void m_subp(matrix_t *m1, const matrix_t *m2);
+void m_subt(const matrix_t *m1, const matrix_t *m2, matrix_t *result);
+void m_subt_unchecked(const matrix_t *m1, const matrix_t *m2, matrix_t *result);
+
+// matrix scalar subtraction
+matrix_t* m_ksub(const matrix_t *m1, MATRIX_TYPE k);
+void m_ksubp(matrix_t *m1, MATRIX_TYPE k);
+void m_ksubt(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result);
+
+// matrix multiplication
+matrix_t* m_mul(const matrix_t *m1, const matrix_t *m2);
+void m_mult(const matrix_t *m1, const matrix_t *m2, matrix_t *result);
+void m_mult_unchecked(const matrix_t *m1, const matrix_t *m2, matrix_t *result);
+
+// fused multiplication: result = act(alpha*m1*m2 + beta*result + bias)
+// bias is NULL, a 1 x n row (added to every row) or an m x 1 column (added to every column)
+matrix_t* m_gemm(MATRIX_TYPE alpha, const matrix_t *m1, const matrix_t *m2, const matrix_t *bias, matrix_act_t act);
+void m_gemmt(MATRIX_TYPE alpha, const matrix_t *m1, const matrix_t *m2, MATRIX_TYPE beta,
+             const matrix_t *bias, matrix_act_t act, matrix_t *result);
+
+// matrix-vector product: result = alpha*op(m1)*x + beta*result, op(m1) = m1, or its transpose with MATRIX_GEMV_TRANS
+// x and result are row or column vectors; m_gemv returns a vector oriented like x
+// MATRIX_GEMV_WIDE accumulates in double (int64_t for i32)
+matrix_t* m_gemv(MATRIX_TYPE alpha, const matrix_t *m1, const matrix_t *x, matrix_gemv_t flags);
+void m_gemvt(MATRIX_TYPE alpha, const matrix_t *m1, const matrix_t *x, MATRIX_TYPE beta,
+             matrix_gemv_t flags, matrix_t *result);
+
+// batched multiplication: matrix t of result = matrix t of m1 * matrix t of m2
+// a batch of one matrix is used for every product
+void m_mult_batched(const matrix_batch_t *m1, const matrix_batch_t *m2, matrix_batch_t *result);
+
+// matrix power
+matrix_t* m_pow(const matrix_t *m1, size_t n);
+void m_powp(matrix_t *m1, size_t n);
+void m_powt(const matrix_t *m1, size_t n, matrix_t *result);
+
+// matrix scalar multiplication
+matrix_t* m_kmul(const matrix_t *m1, MATRIX_TYPE k);
+void m_kmulp(matrix_t *m1, MATRIX_TYPE k);
+void m_kmult(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result);
+void m_kmult_unchecked(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result);
+
+// matrix scalar division
+matrix_t* m_kdiv(const matrix_t *m1, MATRIX_TYPE k);
+void m_kdivp(matrix_t *m1, MATRIX_TYPE k);
+void m_kdivt(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result);
+
+// matrix scalar product
+MATRIX_TYPE m_dot(const matrix_t *m1, const matrix_t *m2);
+MATRIX_TYPE m_dot_unchecked(const matrix_t *m1, const matrix_t *m2);
+// matrix scalar product accumulated and returned in double (accumulated in int64_t for i32)
+double m_dotd(const matrix_t *m1, const matrix_t *m2);
+
+// matrix transposition
+matrix_t *m_transp(const matrix_t *m1);
+void m_transpt(const matrix_t *m1, matrix_t *result);
+void m_transpp(matrix_t *m1);
+
+// matrix sum following a direction
+matrix_t *m_sumfd(const matrix_t *m1, matrix_dir_t dir);
+void m_sumfdt(const matrix_t *m1, matrix_t *result, matrix_dir_t dir);
+
+// matrix multiplication following a direction
+matrix_t *m_mulfd(const matrix_t *m1, matrix_dir_t dir);
+void m_mulfdt(const matrix_t *m1, matrix_t *result, matrix_dir_t dir);
+
+// matrix minimum following a direction
+matrix_t *m_minfd(const matrix_t *m1, matrix_dir_t dir);
+void m_minfdt(const matrix_t *m1, matrix_t *result, matrix_dir_t dir);
+
+// matrix maximum following a direction
+matrix_t *m_maxfd(const matrix_t *m1, matrix_dir_t dir);
+void m_maxfdt(const matrix_t *m1, matrix_t *result, matrix_dir_t dir);
+
+// matrix mean following a direction
+matrix_t *m_meanfd(const matrix_t *m1, matrix_dir_t dir);
+void m_meanfdt(const matrix_t *m1, matrix_t *result, matrix_dir_t dir);
+
+// several reductions following a direction in one pass over the matrix
+void m_reduce(const matrix_t *m1, matrix_dir_t dir, const matrix_reduce_t *out);
+
+// matrix apply function to all elements
+matrix_t *m_apply(const matrix_t *m1, MATRIX_TYPE (*f)(MATRIX_TYPE));
+void m_applyp(const matrix_t *m1, MATRIX_TYPE (*f)(MATRIX_TYPE));
+void m_applyt(const matrix_t *m1, matrix_t *result, MATRIX_TYPE (*f)(MATRIX_TYPE));
+
+// matrix apply span function: f(in, out, n) computes out[i] for the n elements of a span (in may equal out)
+matrix_t *m_applys(const matrix_t *m1, void (*f)(const MATRIX_TYPE *in, MATRIX_TYPE *out, size_t n));
+void m_applysp(matrix_t *m1, void (*f)(const MATRIX_TYPE *in, MATRIX_TYPE *out, size_t n));
+void m_applyst(const matrix_t *m1, matrix_t *result, void (*f)(const MATRIX_TYPE *in, MATRIX_TYPE *out, size_t n));
+
+// matrix apply built-in function (vectorized)
+matrix_t *m_map(const matrix_t *m1, matrix_fn_t fn);
+void m_mapp(matrix_t *m1, matrix_fn_t fn);
+void m_mapt(const matrix_t *m1, matrix_t *result, matrix_fn_t fn);
+
+// matrix clamp of every element to [lo, hi]
+matrix_t *m_clamp(const matrix_t *m1, MATRIX_TYPE lo, MATRIX_TYPE hi);
+void m_clampp(matrix_t *m1, MATRIX_TYPE lo, MATRIX_TYPE hi);
+void m_clampt(const matrix_t *m1, MATRIX_TYPE lo, MATRIX_TYPE hi, matrix_t *result);
+
+// sparse matrix in compressed sparse row format: the non-zeros of row i are val[k] in column idx[k]
+// for k in [ptr[i], ptr[i+1]), by increasing column; ptr has row + 1 elements, col <= UINT32_MAX
+typedef struct {
+    size_t row;
+    size_t col;
+    size_t nnz;
+    size_t *ptr;
+    uint32_t *idx;
+    MATRIX_TYPE *val;
+}matrix_csr_t;
+
+// sparse matrix in coordinate format: nnz triplets (ri[k], ci[k], val[k]) in any order, room for cap
+// duplicates are summed by the conversion to CSR; row, col <= UINT32_MAX
+typedef struct {
+    size_t row;
+    size_t col;
+    size_t nnz;
+    size_t cap;
+    uint32_t *ri;
+    uint32_t *ci;
+    MATRIX_TYPE *val;
+}matrix_coo_t;
+
+// empty row x col COO matrix with room for cap triplets, grown by matrix_coo_push
+matrix_coo_t* matrix_coo_init(size_t row, size_t col, size_t cap);
+// add val at (i,j)
+void matrix_coo_push(matrix_coo_t *m1, size_t i, size_t j, MATRIX_TYPE val);
+
+// conversions; from a dense matrix only the non-zero elements are kept
+matrix_csr_t* matrix_csr_from(const matrix_t *m1);
+matrix_csr_t* matrix_csr_from_coo(const matrix_coo_t *m1);
+matrix_coo_t* matrix_coo_from(const matrix_t *m1);
+matrix_coo_t* matrix_coo_from_csr(const matrix_csr_t *m1);
+// dense copy of a sparse matrix, as a new matrix or into dest (same dimensions)
+matrix_t* matrix_csr_to(const matrix_csr_t *m1);
+void matrix_csr_copyto(const matrix_csr_t *src, matrix_t *dest);
+matrix_t* matrix_coo_to(const matrix_coo_t *m1);
+
+// deep copy, element (i,j) and free
+matrix_csr_t* matrix_csr_getcpy(const matrix_csr_t *m1);
+MATRIX_TYPE matrix_csr_get(const matrix_csr_t *m1, size_t i, size_t j);
+void matrix_csr_free(matrix_csr_t *m1);
+void matrix_coo_free(matrix_coo_t *m1);
+
+// sparse x dense multiplication
+matrix_t* m_spmul(const matrix_csr_t *m1, const matrix_t *m2);
+void m_spmult(const matrix_csr_t *m1, const matrix_t *m2, matrix_t *result);
+
+// sparse matrix-vector product: result = alpha*m1*x + beta*result
+// x and result are row or column vectors; m_spmv returns a vector oriented like x
+matrix_t* m_spmv(MATRIX_TYPE alpha, const matrix_csr_t *m1, const matrix_t *x);
+void m_spmvt(MATRIX_TYPE alpha, const matrix_csr_t *m1, const matrix_t *x, MATRIX_TYPE beta, matrix_t *result);
+
+// sparse x sparse multiplication
+matrix_csr_t* m_spspmul(const matrix_csr_t *m1, const matrix_csr_t *m2);
+
+// sparse matrix power, sparse as long as the fill allows it (see matrix_sparse.c)
+matrix_csr_t* m_sppow(const matrix_csr_t *m1, size_t n);
+
+// binary matrix file (see matrix_io.h): save returns 0, or -1 with errno set
+// load and mmap return NULL with errno set on failure (EINVAL: not a matrix file of this element type)
+// a mapped matrix is released by matrix_free, which unmaps the file
+int matrix_save(const matrix_t *m1, const char *path);
+matrix_t* matrix_load(const char *path);
+matrix_t* matrix_mmap(const char *path, matrix_mmap_t flags);
+
+// out-of-core operations on matrix files, in tiles within the budget of matrix_set_ooc_budget (see matrix_ooc.c)
+// return 0, or -1 with errno set; the result file is replaced and may be one of the operands
+int m_mul_file(const char *m1, const char *m2, const char *result);
+int m_add_file(const char *m1, const char *m2, const char *result);
+int m_sub_file(const char *m1, const char *m2, const char *result);
+int m_kmul_file(const char *m1, MATRIX_TYPE k, const char *result);
+int m_map_file(const char *m1, matrix_fn_t fn, const char *result);
+
+// LU factorization with partial pivoting, P*A = L*U: lu holds U on and above the diagonal and the
+// unit lower triangular L below it, row i of P*A is row perm[i] of A, sign is the determinant of P
+// floating point families only: the i32 functions exit with MATRIX_INVALID_ARGUMENT
+typedef struct {
+    matrix_t *lu;
+    size_t *perm;
+    int sign;
+    int singular;
+}matrix_lu_t;
+
+// factorization of a square matrix (also of a singular one, which sets singular) and free
+matrix_lu_t* matrix_lu(const matrix_t *m1);
+void matrix_lu_free(matrix_lu_t *lu);
+// with a factorization of A: solution of A*X = B (one right-hand side per column of B, O(n^2) each),
+// inverse and determinant; solving and inverting a singular factorization exits with MATRIX_SINGULAR
+matrix_t* m_lu_solve(const matrix_lu_t *lu, const matrix_t *b);
+void m_lu_solvet(const matrix_lu_t *lu, const matrix_t *b, matrix_t *result);
+matrix_t* m_lu_inv(const matrix_lu_t *lu);
+MATRIX_TYPE m_lu_det(const matrix_lu_t *lu);
+// the same from the matrix, factored on each call
+matrix_t* m_solve(const matrix_t *a, const matrix_t *b);
+matrix_t* m_inv(const matrix_t *m1);
+MATRIX_TYPE m_det(const matrix_t *m1);
+
+// Householder QR factorization, A = Q*R: qr holds R on and above the diagonal and the Householder
+// vectors below it (their leading 1 implied), tau their min(m, n) scales, H_j = I - tau_j v_j v_j^T
+// floating point families only: the i32 functions exit with MATRIX_INVALID_ARGUMENT
+typedef struct {
+    matrix_t *qr;
+    MATRIX_TYPE *tau;
+}matrix_qr_t;
+
+// factorization of an m x n matrix and free
+matrix_qr_t* matrix_qr(const matrix_t *m1);
+void matrix_qr_free(matrix_qr_t *qr);
+// thin Q (m x min(m, n)) and R (min(m, n) x n) of a factorization
+matrix_t* m_qr_q(const matrix_qr_t *qr);
+matrix_t* m_qr_r(const matrix_qr_t *qr);
+// least squares solution of A*X = B (m >= n, rank n, one right-hand side per column of B), with a
+// factorization of A or from A; a rank deficient A exits with MATRIX_SINGULAR
+matrix_t* m_qr_solve(const matrix_qr_t *qr, const matrix_t *b);
+matrix_t* m_lstsq(const matrix_t *a, const matrix_t *b);
+// tall-skinny QR (m >> n): row blocks factored in parallel and combined; R factor only, and least squares
+matrix_t* m_tsqr(const matrix_t *m1);
+matrix_t* m_tsqr_solve(const matrix_t *a, const matrix_t *b);
+
+// asynchronous variants: the operation runs on a scheduler thread once the ndeps futures of deps have
+// completed; its matrices must stay allocated and unchanged by the caller until its own future completes
+matrix_future_t* m_mult_async(const matrix_t *m1, const matrix_t *m2, matrix_t *result,
+                              size_t ndeps, matrix_future_t *const *deps);
+matrix_future_t* m_addt_async(const matrix_t *m1, const matrix_t *m2, matrix_t *result,
+                              size_t ndeps, matrix_future_t *const *deps);
+matrix_future_t* m_subt_async(const matrix_t *m1, const matrix_t *m2, matrix_t *result,
+                              size_t ndeps, matrix_future_t *const *deps);
+matrix_future_t* m_kmult_async(const matrix_t *m1, MATRIX_TYPE k, matrix_t *result,
+                               size_t ndeps, matrix_future_t *const *deps);
+matrix_future_t* m_transpt_async(const matrix_t *m1, matrix_t *result, size_t ndeps, matrix_future_t *const *deps);
+matrix_future_t* m_applyt_async(const matrix_t *m1, matrix_t *result, MATRIX_TYPE (*f)(MATRIX_TYPE),
+                                size_t ndeps, matrix_future_t *const *deps);
+matrix_future_t* m_mapt_async(const matrix_t *m1, matrix_t *result, matrix_fn_t fn,
+                              size_t ndeps, matrix_future_t *const *deps);
+matrix_future_t* m_reduce_async(const matrix_t *m1, matrix_dir_t dir, const matrix_reduce_t *out,
+                                size_t ndeps, matrix_future_t *const *deps);
\ No newline at end of file
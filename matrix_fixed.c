@@ -0,0 +1,77 @@
+#include <err.h>
+
+#include "matrix_fixed.h"
+#include "matrix_alloc.h"
+#include "matrix_view.h"
+#include "state.h"
+
+#define MATRIX_FIXED_CONVERT(N)                                                             \
+MATRIX_TNAME(matrix##N) MATRIX_NAME(matrix##N##_from)(const matrix_t *m1){                  \
+    /*                                                                                      \
+        * fixed-size copy of an N x N matrix                                                \
+        * @params m1: pointer to the matrix                                                 \
+        * @return matrix##N##_t : the copy                                                  \
+    */                                                                                      \
+    if(!m1)                                                                                 \
+        errx(MATRIX_NULL_POINTER, "matrix" #N "_from: %s", MATRIX_NULL_POINTER_MESSAGE);    \
+                                                                                            \
+    if(m1->row != (N) || m1->col != (N))                                                    \
+        errx(MATRIX_INVALID_DIMENSIONS, "matrix" #N "_from: %s",                            \
+             MATRIX_INVALID_DIMENSIONS_MESSAGE);                                            \
+                                                                                            \
+    MATRIX_TNAME(matrix##N) result;                                                         \
+    MATRIX_FIXED_FOR(N, i, j)                                                               \
+        result.data[i][j] = MATRIX_AT(m1, i, j);                                            \
+    return result;                                                                          \
+}                                                                                           \
+                                                                                            \
+void MATRIX_NAME(matrix##N##_copyto)(const MATRIX_TNAME(matrix##N) *src, matrix_t *dest){   \
+    /*                                                                                      \
+        * copy a fixed-size matrix into an N x N matrix                                     \
+        * @params src: pointer to the fixed-size matrix                                     \
+        *         dest: pointer to the destination matrix                                   \
+    */                                                                                      \
+    if(!src || !dest)                                                                       \
+        errx(MATRIX_NULL_POINTER, "matrix" #N "_copyto: %s", MATRIX_NULL_POINTER_MESSAGE);  \
+                                                                                            \
+    if(dest->row != (N) || dest->col != (N))                                                \
+        errx(MATRIX_INVALID_DIMENSIONS, "matrix" #N "_copyto: %s",                          \
+             MATRIX_INVALID_DIMENSIONS_MESSAGE);                                            \
+                                                                                            \
+    MATRIX_FIXED_FOR(N, i, j)                                                               \
+        MATRIX_AT(dest, i, j) = src->data[i][j];                                            \
+}                                                                                           \
+                                                                                            \
+matrix_t *MATRIX_NAME(matrix##N##_to)(const MATRIX_TNAME(matrix##N) *m1){                   \
+    /*                                                                                      \
+        * new N x N matrix holding a copy of a fixed-size matrix                            \
+        * @params m1: pointer to the fixed-size matrix                                      \
+        * @return matrix_t* : pointer to the new matrix                                     \
+    */                                                                                      \
+    if(!m1)                                                                                 \
+        errx(MATRIX_NULL_POINTER, "matrix" #N "_to: %s", MATRIX_NULL_POINTER_MESSAGE);      \
+                                                                                            \
+    matrix_t *result;                                                                       \
+    if(!(result = matrix_alloc((N), (N))))                                                  \
+        return NULL;                                                                        \
+                                                                                            \
+    MATRIX_FIXED_FOR(N, i, j)                                                               \
+        MATRIX_AT(result, i, j) = m1->data[i][j];                                           \
+    return result;                                                                          \
+}                                                                                           \
+                                                                                            \
+matrix_t MATRIX_NAME(matrix##N##_view)(MATRIX_TNAME(matrix##N) *m1){                        \
+    /*                                                                                      \
+        * fixed-size matrix seen as an N x N matrix, without copy                           \
+        * @params m1: pointer to the fixed-size matrix                                      \
+        * @return matrix_t : the view, sharing the storage of m1                            \
+    */                                                                                      \
+    if(!m1)                                                                                 \
+        errx(MATRIX_NULL_POINTER, "matrix" #N "_view: %s", MATRIX_NULL_POINTER_MESSAGE);    \
+                                                                                            \
+    return matrix_view_data(&m1->data[0][0], (N), (N), (N));                                \
+}
+
+MATRIX_FIXED_CONVERT(2)
+MATRIX_FIXED_CONVERT(3)
+MATRIX_FIXED_CONVERT(4)
@@ -0,0 +1,146 @@
+#pragma once
+
+/**
+ * @file matrix_fixed.h
+ * @brief Fixed-size 2x2, 3x3 and 4x4 matrices
+ *
+ * matrix2_t, matrix3_t and matrix4_t hold their elements inline (row-major, no
+ * padding), so they live on the stack, are passed and returned by value and
+ * need no allocation and no free. Their dimensions are part of the type: the
+ * operations below do no checking and every loop has a constant trip count, so
+ * the compiler unrolls them completely and can fold them when the operands are
+ * constants. C has no constexpr: static constants are written with brace
+ * initialisers such as MATRIX3_ID.
+ *
+ * The operations follow the naming scheme of matrix.h with the size after the
+ * prefix: m3_mul(m1, m2) returns the product, m3_mulp(&m1, m2) updates m1.
+ * - construction: matrixN_Id, and MATRIXN_ID for static initialisers
+ * - operations: mN_add, mN_sub, mN_kmul, mN_mul, mN_pow, mN_transp, mN_apply (+ 'p' variants)
+ * - conversion: matrixN_from (matrix_t -> fixed), matrixN_to (fixed -> new matrix_t),
+ *   matrixN_copyto (fixed -> existing matrix_t), matrixN_view (fixed seen as a matrix_t, no copy)
+ *
+ * Every size exists for each element type family of matrix.h: matrix3_t and
+ * m3_mul work on float, matrix3_f64_t and m3_mul_f64 on double, matrix3_i32_t
+ * and m3_mul_i32 on int32_t.
+ *
+ * An array of fixed-size matrices is a matrix_batch_t with a stride of N*N.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "matrix.h"
+
+#define MATRIX2_ID {{{1, 0}, {0, 1}}}
+#define MATRIX3_ID {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}}
+#define MATRIX4_ID {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}}
+
+// for every element (i,j) of an N x N matrix, fully unrolled
+#define MATRIX_FIXED_FOR(N, i, j)                           \
+    _Pragma("GCC unroll 4") for(int i = 0; i < (N); i++)    \
+    _Pragma("GCC unroll 4") for(int j = 0; j < (N); j++)
+
+#define MATRIX_FIXED(N, T, S, tag)                                                          \
+typedef struct {                                                                            \
+    T data[N][N];                                                                           \
+}matrix##N##S##_t;                                                                          \
+                                                                                            \
+static inline matrix##N##S##_t matrix##N##_Id##S(void){                                     \
+    matrix##N##S##_t result = MATRIX##N##_ID;                                               \
+    return result;                                                                          \
+}                                                                                           \
+                                                                                            \
+static inline matrix##N##S##_t m##N##_add##S(matrix##N##S##_t m1, matrix##N##S##_t m2){     \
+    MATRIX_FIXED_FOR(N, i, j)                                                               \
+        m1.data[i][j] += m2.data[i][j];                                                     \
+    return m1;                                                                              \
+}                                                                                           \
+                                                                                            \
+static inline void m##N##_addp##S(matrix##N##S##_t *m1, matrix##N##S##_t m2){               \
+    *m1 = m##N##_add##S(*m1, m2);                                                           \
+}                                                                                           \
+                                                                                            \
+static inline matrix##N##S##_t m##N##_sub##S(matrix##N##S##_t m1, matrix##N##S##_t m2){     \
+    MATRIX_FIXED_FOR(N, i, j)                                                               \
+        m1.data[i][j] -= m2.data[i][j];                                                     \
+    return m1;                                                                              \
+}                                                                                           \
+                                                                                            \
+static inline void m##N##_subp##S(matrix##N##S##_t *m1, matrix##N##S##_t m2){               \
+    *m1 = m##N##_sub##S(*m1, m2);                                                           \
+}                                                                                           \
+                                                                                            \
+static inline matrix##N##S##_t m##N##_kmul##S(matrix##N##S##_t m1, T k){                    \
+    MATRIX_FIXED_FOR(N, i, j)                                                               \
+        m1.data[i][j] *= k;                                                                 \
+    return m1;                                                                              \
+}                                                                                           \
+                                                                                            \
+static inline void m##N##_kmulp##S(matrix##N##S##_t *m1, T k){                              \
+    *m1 = m##N##_kmul##S(*m1, k);                                                           \
+}                                                                                           \
+                                                                                            \
+static inline matrix##N##S##_t m##N##_mul##S(matrix##N##S##_t m1, matrix##N##S##_t m2){     \
+    matrix##N##S##_t result;                                                                \
+    MATRIX_FIXED_FOR(N, i, j){                                                              \
+        T sum = 0;                                                                          \
+        _Pragma("GCC unroll 4")                                                             \
+        for(int p = 0; p < (N); p++)                                                        \
+            sum += m1.data[i][p] * m2.data[p][j];                                           \
+        result.data[i][j] = sum;                                                            \
+    }                                                                                       \
+    return result;                                                                          \
+}                                                                                           \
+                                                                                            \
+static inline void m##N##_mulp##S(matrix##N##S##_t *m1, matrix##N##S##_t m2){               \
+    *m1 = m##N##_mul##S(*m1, m2);                                                           \
+}                                                                                           \
+                                                                                            \
+static inline matrix##N##S##_t m##N##_pow##S(matrix##N##S##_t m1, size_t n){                \
+    /* binary exponentiation, O(log n) products */                                          \
+    matrix##N##S##_t result = MATRIX##N##_ID;                                               \
+    for(; n; n >>= 1){                                                                      \
+        if(n & 1)                                                                           \
+            result = m##N##_mul##S(result, m1);                                             \
+        if(n > 1)                                                                           \
+            m1 = m##N##_mul##S(m1, m1);                                                     \
+    }                                                                                       \
+    return result;                                                                          \
+}                                                                                           \
+                                                                                            \
+static inline void m##N##_powp##S(matrix##N##S##_t *m1, size_t n){                          \
+    *m1 = m##N##_pow##S(*m1, n);                                                            \
+}                                                                                           \
+                                                                                            \
+static inline matrix##N##S##_t m##N##_transp##S(matrix##N##S##_t m1){                       \
+    matrix##N##S##_t result;                                                                \
+    MATRIX_FIXED_FOR(N, i, j)                                                               \
+        result.data[j][i] = m1.data[i][j];                                                  \
+    return result;                                                                          \
+}                                                                                           \
+                                                                                            \
+static inline void m##N##_transpp##S(matrix##N##S##_t *m1){                                 \
+    *m1 = m##N##_transp##S(*m1);                                                            \
+}                                                                                           \
+                                                                                            \
+static inline matrix##N##S##_t m##N##_apply##S(matrix##N##S##_t m1, T (*f)(T)){             \
+    MATRIX_FIXED_FOR(N, i, j)                                                               \
+        m1.data[i][j] = f(m1.data[i][j]);                                                   \
+    return m1;                                                                              \
+}                                                                                           \
+                                                                                            \
+static inline void m##N##_applyp##S(matrix##N##S##_t *m1, T (*f)(T)){                       \
+    *m1 = m##N##_apply##S(*m1, f);                                                          \
+}                                                                                           \
+                                                                                            \
+matrix_##tag##_t matrix##N##_view##S(matrix##N##S##_t *m1);                                 \
+matrix##N##S##_t matrix##N##_from##S(const matrix_##tag##_t *m1);                           \
+matrix_##tag##_t *matrix##N##_to##S(const matrix##N##S##_t *m1);                            \
+void matrix##N##_copyto##S(const matrix##N##S##_t *src, matrix_##tag##_t *dest);
+
+// the three sizes for one element type family: matrix3_t, m3_mul (f32), matrix3_f64_t, m3_mul_f64, ...
+#define MATRIX_FIXED_FAMILY(T, S, tag) MATRIX_FIXED(2, T, S, tag) MATRIX_FIXED(3, T, S, tag) MATRIX_FIXED(4, T, S, tag)
+
+MATRIX_FIXED_FAMILY(float, , f32)
+MATRIX_FIXED_FAMILY(double, _f64, f64)
+MATRIX_FIXED_FAMILY(int32_t, _i32, i32)
@@ -0,0 +1,579 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <err.h>
+
+#include "matrix_gemm.h"
+#include "matrix_math.h"
+#include "matrix_simd.h"
+#include "matrix_thread.h"
+#include "state.h"
+
+// let the compiler fuse the multiply-adds of the micro-kernels, even in ISO C mode
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize("fp-contract=fast")
+#endif
+
+// cache blocking (in elements), multiples of every micro-kernel tile size
+// KC is 1 KiB of a row of A so that the packed blocks keep the same cache footprint for every element type
+#define GEMM_MC 96
+#define GEMM_KC (1024 / sizeof(MATRIX_TYPE))
+#define GEMM_NC 2048
+
+// below this many multiply-adds, packing costs more than it saves
+#define GEMM_SMALL (32 * 32 * 32)
+
+// below this many multiply-adds, waking the worker pool costs more than it saves
+#define GEMM_PARALLEL (128 * 128 * 128)
+
+// tasks per thread for each packed panel of B, so that stealing can balance the load
+#define GEMM_TASKS_PER_THREAD 4
+
+// multiply-adds per task of a batched product
+#define GEMM_BATCH_TASK (64 * 64 * 64)
+
+#define GEMM_ALIGN 64
+
+// largest micro-kernel tile, used to size the edge buffer
+#define GEMM_MAX_MR 8
+#define GEMM_MAX_NR 64
+
+typedef void (*gemm_ukernel_t)(size_t kc, const MATRIX_TYPE *a, const MATRIX_TYPE *b,
+                               MATRIX_TYPE *c, size_t ldc, MATRIX_TYPE beta);
+
+typedef struct {
+    size_t mr;
+    size_t nr;
+    gemm_ukernel_t ukernel;
+}gemm_kernel_t;
+
+typedef struct {
+    MATRIX_TYPE *a;
+    MATRIX_TYPE *b;
+}gemm_workspace_t;
+
+// one packed panel of B multiplied by all the row blocks of A
+typedef struct {
+    const gemm_kernel_t *kern;
+    size_t m, nc, kc;
+    const MATRIX_TYPE *a;
+    size_t lda;
+    const MATRIX_TYPE *pb;
+    MATRIX_TYPE alpha, beta;
+    MATRIX_TYPE *c;
+    size_t ldc;
+    // column of C of the panel, for the epilogue
+    size_t jc;
+    // epilogue, set for the last K panel only
+    const gemm_epilogue_t *ep;
+    // tiling of the panel: columns per task and tasks per row block
+    size_t width;
+    size_t groups;
+}gemm_job_t;
+
+/*
+ * Micro-kernels: MR x (2 vectors) accumulators held in registers, written with
+ * compiler vector extensions so that one body serves every element type.
+ * GEMM_UKERNEL(name, attr, vb, MR) defines a kernel using vectors of vb bytes
+ * compiled with the function attributes attr.
+ */
+#define GEMM_UKERNEL(name, attr, vb, MR)                                                       \
+typedef MATRIX_TYPE name##_v __attribute__((vector_size(vb)));                                 \
+typedef MATRIX_TYPE name##_vu __attribute__((vector_size(vb), aligned(sizeof(MATRIX_TYPE))));  \
+                                                                                               \
+attr static void name(size_t kc, const MATRIX_TYPE *restrict a, const MATRIX_TYPE *restrict b, \
+                      MATRIX_TYPE *restrict c, size_t ldc, MATRIX_TYPE beta){                  \
+    enum { VL = (vb) / sizeof(MATRIX_TYPE) };                                                  \
+    name##_v acc[MR][2];                                                                       \
+    _Pragma("GCC unroll 16")                                                                   \
+    for(int r = 0; r < (MR); r++)                                                              \
+        acc[r][0] = acc[r][1] = (name##_v){0};                                                 \
+                                                                                               \
+    for(size_t p = 0; p < kc; p++){                                                            \
+        name##_v b0 = *(const name##_v *)b;                                                    \
+        name##_v b1 = *(const name##_v *)(b + VL);                                             \
+        _Pragma("GCC unroll 16")                                                               \
+        for(int r = 0; r < (MR); r++){                                                         \
+            acc[r][0] += a[r] * b0;                                                            \
+            acc[r][1] += a[r] * b1;                                                            \
+        }                                                                                      \
+        a += (MR);                                                                             \
+        b += 2 * VL;                                                                           \
+    }                                                                                          \
+                                                                                               \
+    _Pragma("GCC unroll 16")                                                                   \
+    for(int r = 0; r < (MR); r++, c += ldc){                                                   \
+        name##_vu *c0 = (name##_vu *)c, *c1 = (name##_vu *)(c + VL);                           \
+        if(beta != 0){                                                                         \
+            acc[r][0] += beta * *c0;                                                           \
+            acc[r][1] += beta * *c1;                                                           \
+        }                                                                                      \
+        *c0 = acc[r][0];                                                                       \
+        *c1 = acc[r][1];                                                                       \
+    }                                                                                          \
+}
+
+// 16 byte vectors: SSE2 / NEON baseline
+GEMM_UKERNEL(gemm_ukernel_generic, , 16, 4)
+
+static const gemm_kernel_t gemm_kernel_generic = {
+    4, 2 * 16 / sizeof(MATRIX_TYPE), gemm_ukernel_generic
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+// 12 of the 16 ymm registers hold accumulators
+GEMM_UKERNEL(gemm_ukernel_avx2, __attribute__((target("avx2,fma"))), 32, 6)
+// 16 of the 32 zmm registers hold accumulators
+GEMM_UKERNEL(gemm_ukernel_avx512, __attribute__((target("avx512f"))), 64, 8)
+
+static const gemm_kernel_t gemm_kernel_avx2 = {
+    6, 2 * 32 / sizeof(MATRIX_TYPE), gemm_ukernel_avx2
+};
+
+static const gemm_kernel_t gemm_kernel_avx512 = {
+    8, 2 * 64 / sizeof(MATRIX_TYPE), gemm_ukernel_avx512
+};
+#endif
+
+static const gemm_kernel_t *gemm_kernel(void){
+    /*
+        * micro-kernel matching the instruction set selected at startup
+        * @return const gemm_kernel_t* : kernel descriptor
+    */
+#if defined(__x86_64__) || defined(__i386__)
+    if(matrix_simd->level >= MATRIX_SIMD_AVX512)
+        return &gemm_kernel_avx512;
+    if(matrix_simd->level >= MATRIX_SIMD_AVX2)
+        return &gemm_kernel_avx2;
+#endif
+    return &gemm_kernel_generic;
+}
+
+static pthread_key_t gemm_key;
+static pthread_once_t gemm_key_once = PTHREAD_ONCE_INIT;
+
+static void gemm_workspace_free(void *p){
+    gemm_workspace_t *ws = p;
+    free(ws->a);
+    free(ws->b);
+    free(ws);
+}
+
+static void gemm_key_init(void){
+    if(pthread_key_create(&gemm_key, gemm_workspace_free))
+        errx(MATRIX_MEMORY_ERROR, "matrix_gemm: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+}
+
+static gemm_workspace_t *gemm_workspace(void){
+    /*
+        * per thread packing buffers, kept until the thread exits so that repeated
+        * products do not touch the heap
+        * the buffers themselves are allocated on first use: pool workers only pack A
+        * @return gemm_workspace_t* : workspace of the calling thread
+    */
+    pthread_once(&gemm_key_once, gemm_key_init);
+
+    gemm_workspace_t *ws = pthread_getspecific(gemm_key);
+    if(ws)
+        return ws;
+
+    if(!(ws = calloc(1, sizeof(gemm_workspace_t))) || pthread_setspecific(gemm_key, ws))
+        errx(MATRIX_MEMORY_ERROR, "matrix_gemm: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+
+    return ws;
+}
+
+static MATRIX_TYPE *gemm_buffer(MATRIX_TYPE **buf, size_t count){
+    if(!*buf && !(*buf = aligned_alloc(GEMM_ALIGN, count * sizeof(MATRIX_TYPE))))
+        errx(MATRIX_MEMORY_ERROR, "matrix_gemm: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+    return *buf;
+}
+
+static void gemm_pack_a(size_t mr, size_t mc, size_t kc, MATRIX_TYPE alpha,
+                        const MATRIX_TYPE *a, size_t lda, MATRIX_TYPE *pa){
+    /*
+        * pack an mc x kc block of alpha*A into micro-panels of mr rows
+        * each micro-panel is stored column by column, short rows are zero padded
+    */
+    for(size_t i = 0; i < mc; i += mr){
+        size_t rows = mc - i < mr ? mc - i : mr;
+        const MATRIX_TYPE *src = a + i*lda;
+        for(size_t p = 0; p < kc; p++){
+            size_t r = 0;
+            for(; r < rows; r++)
+                pa[r] = alpha * src[r*lda + p];
+            for(; r < mr; r++)
+                pa[r] = 0;
+            pa += mr;
+        }
+    }
+}
+
+static void gemm_pack_b(size_t nr, size_t kc, size_t nc, const MATRIX_TYPE *b, size_t ldb, MATRIX_TYPE *pb){
+    /*
+        * pack a kc x nc panel of B into micro-panels of nr columns
+        * each micro-panel is stored row by row, short columns are zero padded
+    */
+    for(size_t j = 0; j < nc; j += nr){
+        size_t cols = nc - j < nr ? nc - j : nr;
+        const MATRIX_TYPE *src = b + j;
+        for(size_t p = 0; p < kc; p++){
+            size_t c = 0;
+            for(; c < cols; c++)
+                pb[c] = src[p*ldb + c];
+            for(; c < nr; c++)
+                pb[c] = 0;
+            pb += nr;
+        }
+    }
+}
+
+static void gemm_epilogue(const gemm_epilogue_t *ep, size_t i0, size_t j0,
+                          size_t rows, size_t cols, MATRIX_TYPE *c, size_t ldc){
+    /*
+        * finish a tile of C: add the biases then apply the activation
+        * @params ep: epilogue
+        *         i0, j0: position of the tile in C, to index the biases
+        *         rows, cols: size of the tile
+        *         c, ldc: tile and its leading dimension
+    */
+    if(ep->row_bias)
+        for(size_t r = 0; r < rows; r++)
+            for(size_t s = 0; s < cols; s++)
+                c[r*ldc + s] += ep->row_bias[j0 + s];
+
+    if(ep->col_bias)
+        for(size_t r = 0; r < rows; r++){
+            MATRIX_TYPE bias = ep->col_bias[(i0 + r) * ep->col_bias_stride];
+            for(size_t s = 0; s < cols; s++)
+                c[r*ldc + s] += bias;
+        }
+
+    switch(ep->act){
+    case MATRIX_ACT_RELU:
+        for(size_t r = 0; r < rows; r++)
+            for(size_t s = 0; s < cols; s++)
+                c[r*ldc + s] = c[r*ldc + s] > 0 ? c[r*ldc + s] : 0;
+        break;
+    case MATRIX_ACT_SIGMOID:
+    case MATRIX_ACT_TANH:{
+        matrix_math_t f = matrix_math(ep->act == MATRIX_ACT_TANH ? MATRIX_FN_TANH : MATRIX_FN_SIGMOID);
+        for(size_t r = 0; r < rows; r++)
+            f(c + r*ldc, c + r*ldc, cols);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void gemm_macro(const gemm_kernel_t *kern, size_t mc, size_t nc, size_t kc,
+                       const MATRIX_TYPE *pa, const MATRIX_TYPE *pb,
+                       MATRIX_TYPE beta, MATRIX_TYPE *c, size_t ldc,
+                       const gemm_epilogue_t *ep, size_t i0, size_t j0){
+    /*
+        * multiply a packed block of A by a packed panel of B, one register tile at a time
+        * tiles crossing the edge of C are computed in a local buffer then merged
+        * the epilogue, if any, runs on each tile right after it is stored, while it is still in L1
+        * @params i0, j0: position of the block in C
+    */
+    MATRIX_TYPE edge[GEMM_MAX_MR * GEMM_MAX_NR] __attribute__((aligned(GEMM_ALIGN)));
+    size_t mr = kern->mr, nr = kern->nr;
+
+    for(size_t j = 0; j < nc; j += nr){
+        size_t cols = nc - j < nr ? nc - j : nr;
+        for(size_t i = 0; i < mc; i += mr){
+            size_t rows = mc - i < mr ? mc - i : mr;
+            MATRIX_TYPE *cij = c + i*ldc + j;
+
+            if(rows == mr && cols == nr){
+                kern->ukernel(kc, pa + i*kc, pb + j*kc, cij, ldc, beta);
+            }else{
+                kern->ukernel(kc, pa + i*kc, pb + j*kc, edge, nr, 0);
+                for(size_t r = 0; r < rows; r++)
+                    for(size_t s = 0; s < cols; s++)
+                        cij[r*ldc + s] = (beta != 0 ? beta * cij[r*ldc + s] : 0) + edge[r*nr + s];
+            }
+
+            if(ep)
+                gemm_epilogue(ep, i0 + i, j0 + j, rows, cols, cij, ldc);
+        }
+    }
+}
+
+static void gemm_small(size_t m, size_t n, size_t k, MATRIX_TYPE alpha,
+                       const MATRIX_TYPE *a, size_t lda,
+                       const MATRIX_TYPE *b, size_t ldb,
+                       MATRIX_TYPE beta, MATRIX_TYPE *c, size_t ldc){
+    /*
+        * unpacked i-k-j product for operands too small to amortize packing
+        * the inner loop walks rows of B and C contiguously
+    */
+    for(size_t i = 0; i < m; i++){
+        MATRIX_TYPE *ci = c + i*ldc;
+        for(size_t j = 0; j < n; j++)
+            ci[j] = beta != 0 ? beta * ci[j] : 0;
+
+        for(size_t p = 0; p < k; p++){
+            MATRIX_TYPE aip = alpha * a[i*lda + p];
+            const MATRIX_TYPE *bp = b + p*ldb;
+            for(size_t j = 0; j < n; j++)
+                ci[j] += aip * bp[j];
+        }
+    }
+}
+
+static void gemm_task(void *ctx, size_t task){
+    /*
+        * one tile of a panel job: pack a row block of A and multiply it by a group
+        * of columns of the shared packed panel of B
+        * @params ctx: gemm_job_t of the panel
+        *         task: row block * job->groups + column group
+    */
+    const gemm_job_t *job = ctx;
+    size_t ic = task / job->groups * GEMM_MC;
+    size_t j0 = task % job->groups * job->width;
+    size_t mc = job->m - ic < GEMM_MC ? job->m - ic : GEMM_MC;
+    size_t cols = job->nc - j0 < job->width ? job->nc - j0 : job->width;
+
+    MATRIX_TYPE *pa = gemm_buffer(&gemm_workspace()->a, GEMM_MC * GEMM_KC);
+    gemm_pack_a(job->kern->mr, mc, job->kc, job->alpha, job->a + ic*job->lda, job->lda, pa);
+    gemm_macro(job->kern, mc, cols, job->kc, pa, job->pb + j0*job->kc, job->beta,
+               job->c + ic*job->ldc + j0, job->ldc, job->ep, ic, job->jc + j0);
+}
+
+void matrix_gemm(size_t m, size_t n, size_t k, MATRIX_TYPE alpha,
+                 const MATRIX_TYPE *a, size_t lda,
+                 const MATRIX_TYPE *b, size_t ldb,
+                 MATRIX_TYPE beta, MATRIX_TYPE *c, size_t ldc){
+    matrix_gemm_fused(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc, NULL);
+}
+
+void matrix_gemm_fused(size_t m, size_t n, size_t k, MATRIX_TYPE alpha,
+                       const MATRIX_TYPE *a, size_t lda,
+                       const MATRIX_TYPE *b, size_t ldb,
+                       MATRIX_TYPE beta, MATRIX_TYPE *c, size_t ldc,
+                       const gemm_epilogue_t *ep){
+    /*
+        * blocked general matrix multiplication: C = ep(alpha*A*B + beta*C)
+        * @params m, n, k: dimensions (A is m x k, B is k x n, C is m x n)
+        *         alpha: scaling of the product
+        *         a, lda: first operand and its leading dimension
+        *         b, ldb: second operand and its leading dimension
+        *         beta: scaling of the previous content of C (0 to overwrite)
+        *         c, ldc: result and its leading dimension
+        *         ep: epilogue applied to each finished tile, or NULL
+    */
+    if(m == 0 || n == 0)
+        return;
+
+    if(m * n * k <= GEMM_SMALL){
+        gemm_small(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+        if(ep)
+            gemm_epilogue(ep, 0, 0, m, n, c, ldc);
+        return;
+    }
+
+    const gemm_kernel_t *kern = gemm_kernel();
+    gemm_workspace_t *ws = gemm_workspace();
+    MATRIX_TYPE *pb = gemm_buffer(&ws->b, GEMM_KC * GEMM_NC);
+    size_t threads = m * n * k >= GEMM_PARALLEL ? matrix_parallel_width() : 1;
+
+    for(size_t jc = 0; jc < n; jc += GEMM_NC){
+        size_t nc = n - jc < GEMM_NC ? n - jc : GEMM_NC;
+
+        gemm_job_t job = {
+            kern, m, nc, 0, a, lda, pb, alpha, beta, c + jc, ldc, jc, NULL, nc, 1
+        };
+
+        // split the panel by columns too when there are not enough row blocks
+        size_t blocks = (m + GEMM_MC - 1) / GEMM_MC;
+        while(blocks * job.groups < threads * GEMM_TASKS_PER_THREAD && job.width >= 4 * kern->nr){
+            job.width = (job.width / 2 + kern->nr - 1) / kern->nr * kern->nr;
+            job.groups = (nc + job.width - 1) / job.width;
+        }
+
+        for(size_t pc = 0; pc < k; pc += GEMM_KC){
+            job.kc = k - pc < GEMM_KC ? k - pc : GEMM_KC;
+            job.a = a + pc;
+            // later K panels accumulate on top of the first one
+            job.beta = pc == 0 ? beta : 1;
+            job.ep = pc + job.kc == k ? ep : NULL;
+
+            gemm_pack_b(kern->nr, job.kc, nc, b + pc*ldb + jc, ldb, pb);
+
+            if(threads > 1)
+                matrix_parallel_for(blocks * job.groups, gemm_task, &job);
+            else
+                for(size_t t = 0; t < blocks * job.groups; t++)
+                    gemm_task(&job, t);
+        }
+    }
+}
+
+/*
+ * Batched small products
+ * Each product of the batch is dense and small enough for its rows of B and C to
+ * live in registers: row i of C is accumulated as sum_p a[i][p] * B[p][:] with
+ * the whole row held in one vector of N elements (several registers when N
+ * exceeds the hardware width). Up to four rows are accumulated together so that
+ * the multiply-add chains overlap and each row of B is loaded once for them.
+ * No packing, no edge handling.
+ * GEMM_BATCH_KERNEL(name, attr, N, acc) defines the kernel for n == N compiled
+ * with the function attributes attr, with at most acc bytes of accumulators,
+ * plus a square variant with m == k == N known at compile time so that the
+ * loops unroll completely.
+ */
+typedef void (*gemm_batch_kernel_t)(size_t m, size_t k, const MATRIX_TYPE *a,
+                                    const MATRIX_TYPE *b, MATRIX_TYPE *c);
+
+#define GEMM_BATCH_KERNEL(name, attr, N, acc)                                                   \
+typedef MATRIX_TYPE name##_v                                                                    \
+    __attribute__((vector_size((N) * sizeof(MATRIX_TYPE)), aligned(sizeof(MATRIX_TYPE))));       \
+                                                                                                \
+attr static inline __attribute__((always_inline))                                               \
+void name##_body(size_t m, size_t k, const MATRIX_TYPE *restrict a,                             \
+                 const MATRIX_TYPE *restrict b, MATRIX_TYPE *restrict c){                       \
+    enum { ROWS = (acc) / ((N) * sizeof(MATRIX_TYPE)) >= 4 ? 4                                  \
+                : (acc) / ((N) * sizeof(MATRIX_TYPE)) >= 2 ? 2 : 1 };                           \
+    size_t i = 0;                                                                               \
+    for(; i + ROWS <= m; i += ROWS, a += ROWS*k, c += ROWS*(N)){                                \
+        name##_v sum[ROWS];                                                                     \
+        _Pragma("GCC unroll 4")                                                                 \
+        for(int r = 0; r < ROWS; r++)                                                           \
+            sum[r] = a[r*k] * *(const name##_v *)b;                                             \
+        _Pragma("GCC unroll 32")                                                                \
+        for(size_t p = 1; p < k; p++){                                                          \
+            name##_v bp = *(const name##_v *)(b + p*(N));                                       \
+            _Pragma("GCC unroll 4")                                                             \
+            for(int r = 0; r < ROWS; r++)                                                       \
+                sum[r] += a[r*k + p] * bp;                                                      \
+        }                                                                                       \
+        _Pragma("GCC unroll 4")                                                                 \
+        for(int r = 0; r < ROWS; r++)                                                           \
+            *(name##_v *)(c + r*(N)) = sum[r];                                                  \
+    }                                                                                           \
+    for(; i < m; i++, a += k, c += (N)){                                                        \
+        name##_v sum = a[0] * *(const name##_v *)b;                                             \
+        for(size_t p = 1; p < k; p++)                                                           \
+            sum += a[p] * *(const name##_v *)(b + p*(N));                                       \
+        *(name##_v *)c = sum;                                                                   \
+    }                                                                                           \
+}                                                                                               \
+                                                                                                \
+attr static void name(size_t m, size_t k, const MATRIX_TYPE *a,                                 \
+                      const MATRIX_TYPE *b, MATRIX_TYPE *c){                                    \
+    if(m == (N) && k == (N))                                                                    \
+        name##_body((N), (N), a, b, c);                                                         \
+    else                                                                                        \
+        name##_body(m, k, a, b, c);                                                             \
+}
+
+// widths with a dedicated kernel: n = 4 << index
+#define GEMM_BATCH_WIDTHS 4
+
+#define GEMM_BATCH_KERNELS(isa, attr, acc)                                                      \
+GEMM_BATCH_KERNEL(gemm_batch_##isa##_4, attr, 4, acc)                                           \
+GEMM_BATCH_KERNEL(gemm_batch_##isa##_8, attr, 8, acc)                                           \
+GEMM_BATCH_KERNEL(gemm_batch_##isa##_16, attr, 16, acc)                                         \
+GEMM_BATCH_KERNEL(gemm_batch_##isa##_32, attr, 32, acc)                                         \
+                                                                                                \
+static const gemm_batch_kernel_t gemm_batch_##isa[GEMM_BATCH_WIDTHS] = {                         \
+    gemm_batch_##isa##_4, gemm_batch_##isa##_8, gemm_batch_##isa##_16, gemm_batch_##isa##_32    \
+};
+
+// accumulators take half of the vector registers
+GEMM_BATCH_KERNELS(generic, , 8 * 16)
+
+#if defined(__x86_64__) || defined(__i386__)
+GEMM_BATCH_KERNELS(avx2, __attribute__((target("avx2,fma"))), 8 * 32)
+GEMM_BATCH_KERNELS(avx512, __attribute__((target("avx512f"))), 16 * 64)
+#endif
+
+static gemm_batch_kernel_t gemm_batch_kernel(size_t n){
+    /*
+        * register-row kernel for products with n columns
+        * @params n: columns of B and C
+        * @return gemm_batch_kernel_t : kernel, NULL if n has no dedicated kernel
+    */
+    if(n < 4 || n > 32 || (n & (n - 1)))
+        return NULL;
+
+    size_t w = (size_t)__builtin_ctzll(n) - 2;
+#if defined(__x86_64__) || defined(__i386__)
+    if(matrix_simd->level >= MATRIX_SIMD_AVX512)
+        return gemm_batch_avx512[w];
+    if(matrix_simd->level >= MATRIX_SIMD_AVX2)
+        return gemm_batch_avx2[w];
+#endif
+    return gemm_batch_generic[w];
+}
+
+typedef struct {
+    gemm_batch_kernel_t kern;
+    size_t count, m, n, k;
+    const MATRIX_TYPE *a;
+    size_t stride_a;
+    const MATRIX_TYPE *b;
+    size_t stride_b;
+    MATRIX_TYPE *c;
+    size_t stride_c;
+    // products per task
+    size_t chunk;
+}gemm_batch_job_t;
+
+static void gemm_batch_task(void *ctx, size_t task){
+    const gemm_batch_job_t *job = ctx;
+    size_t end = (task + 1) * job->chunk < job->count ? (task + 1) * job->chunk : job->count;
+
+    for(size_t t = task * job->chunk; t < end; t++){
+        const MATRIX_TYPE *a = job->a + t * job->stride_a;
+        const MATRIX_TYPE *b = job->b + t * job->stride_b;
+        MATRIX_TYPE *c = job->c + t * job->stride_c;
+        if(job->kern)
+            job->kern(job->m, job->k, a, b, c);
+        else
+            gemm_small(job->m, job->n, job->k, 1, a, job->k, b, job->n, 0, c, job->n);
+    }
+}
+
+void matrix_gemm_batched(size_t count, size_t m, size_t n, size_t k,
+                         const MATRIX_TYPE *a, size_t stride_a,
+                         const MATRIX_TYPE *b, size_t stride_b,
+                         MATRIX_TYPE *c, size_t stride_c){
+    /*
+        * strided-batched multiplication: C_t = A_t * B_t for t in [0, count)
+        * @params count: number of products
+        *         m, n, k: dimensions of each product (A_t is m x k, B_t is k x n, C_t is m x n)
+        *         a, stride_a: first A and elements between two consecutive ones (0 to reuse it)
+        *         b, stride_b: first B and elements between two consecutive ones (0 to reuse it)
+        *         c, stride_c: first C and elements between two consecutive ones
+    */
+    if(count == 0 || m == 0 || n == 0)
+        return;
+
+    if(k == 0){
+        for(size_t t = 0; t < count; t++)
+            memset(c + t * stride_c, 0, m * n * sizeof(MATRIX_TYPE));
+        return;
+    }
+
+    // large products parallelize on their own
+    if(m * n * k > GEMM_SMALL){
+        for(size_t t = 0; t < count; t++)
+            matrix_gemm(m, n, k, 1, a + t * stride_a, k, b + t * stride_b, n, 0, c + t * stride_c, n);
+        return;
+    }
+
+    size_t chunk = GEMM_BATCH_TASK / (m * n * k) + 1;
+    gemm_batch_job_t job = {
+        gemm_batch_kernel(n), count, m, n, k, a, stride_a, b, stride_b, c, stride_c, chunk
+    };
+    size_t ntasks = (count + chunk - 1) / chunk;
+
+    if(ntasks > 1 && count * m * n * k >= GEMM_PARALLEL)
+        matrix_parallel_for(ntasks, gemm_batch_task, &job);
+    else
+        for(size_t t = 0; t < ntasks; t++)
+            gemm_batch_task(&job, t);
+}
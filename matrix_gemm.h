@@ -0,0 +1,60 @@
+#pragma once
+
+/**
+ * @file matrix_gemm.h
+ * @brief General matrix multiplication engine used by m_mul / m_mult
+ *
+ * Internal header: operates on raw row-major storage with explicit leading
+ * dimensions so that every caller (matrix_t, sub-blocks, temporaries) can share
+ * the same kernel.
+ *
+ * The engine follows the classical three level blocking scheme:
+ * - B is packed by KC x NC panels that stay resident in L3,
+ * - A is packed by MC x KC blocks that stay resident in L2,
+ * - a register-tiled MR x NR micro-kernel streams KC x NR slivers of B from L1.
+ */
+
+#include <stddef.h>
+
+#include "matrix.h"
+
+// one engine per element type family
+#define matrix_gemm         MATRIX_NAME(matrix_gemm)
+#define matrix_gemm_fused   MATRIX_NAME(matrix_gemm_fused)
+#define matrix_gemm_batched MATRIX_NAME(matrix_gemm_batched)
+
+// applied to each tile of C once its product is complete:
+// c[i][j] = act(c[i][j] + row_bias[j] + col_bias[i*col_bias_stride])
+typedef struct {
+    // bias added to every row (one value per column), may be NULL
+    const MATRIX_TYPE *row_bias;
+    // bias added to every column (one value per row), may be NULL
+    const MATRIX_TYPE *col_bias;
+    size_t col_bias_stride;
+    matrix_act_t act;
+}gemm_epilogue_t;
+
+// C = alpha*A*B + beta*C
+// A is m x k (leading dimension lda), B is k x n (ldb), C is m x n (ldc)
+// when beta is 0, C is not read and may hold uninitialised values
+// C must not overlap A or B
+void matrix_gemm(size_t m, size_t n, size_t k, MATRIX_TYPE alpha,
+                 const MATRIX_TYPE *a, size_t lda,
+                 const MATRIX_TYPE *b, size_t ldb,
+                 MATRIX_TYPE beta, MATRIX_TYPE *c, size_t ldc);
+
+// C = ep(alpha*A*B + beta*C), same contract as matrix_gemm
+// ep may be NULL
+void matrix_gemm_fused(size_t m, size_t n, size_t k, MATRIX_TYPE alpha,
+                       const MATRIX_TYPE *a, size_t lda,
+                       const MATRIX_TYPE *b, size_t ldb,
+                       MATRIX_TYPE beta, MATRIX_TYPE *c, size_t ldc,
+                       const gemm_epilogue_t *ep);
+
+// strided-batched C_t = A_t*B_t for t in [0, count), every matrix dense (ld = its column count)
+// A_t = a + t*stride_a (likewise for B and C), a stride of 0 reuses the same operand
+// C_t must not overlap any A or B
+void matrix_gemm_batched(size_t count, size_t m, size_t n, size_t k,
+                         const MATRIX_TYPE *a, size_t stride_a,
+                         const MATRIX_TYPE *b, size_t stride_b,
+                         MATRIX_TYPE *c, size_t stride_c);
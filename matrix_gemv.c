@@ -0,0 +1,446 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "matrix_gemv.h"
+#include "matrix_simd.h"
+#include "matrix_thread.h"
+
+/*
+ * Matrix-vector and dot product engine behind m_gemv, m_dot, m_dotd and the
+ * vector cases of m_mult.
+ *
+ * - A*x: each task owns GEMV_ROWS rows of A. x is swept by blocks of GEMV_BLOCK
+ *   elements (gathered when it is strided) and every block is dotted with 4 rows
+ *   at a time, 2 accumulators per row: 8 independent chains share each load of x.
+ * - A^T*x: each task owns GEMV_COLS columns and sweeps down the rows, 4 at a
+ *   time: y_block += x[i]*A[i] + ... + x[i+3]*A[i+3], the y block staying in L1.
+ * - x.y: ranges of GEMV_TASK elements, combined in order.
+ * The work split depends on the dimensions only, so the result does not depend
+ * on the number of threads.
+ */
+
+// elements per block of a dot product, and of x in A*x
+#define GEMV_BLOCK 1024
+
+// rows per task of A*x
+#define GEMV_ROWS 32
+
+// columns per task of A^T*x
+#define GEMV_COLS 256
+
+// rows accumulated in MATRIX_TYPE before being folded into the wide sums, A^T*x
+#define GEMV_FOLD 256
+
+// elements per task of a dot product (a multiple of GEMV_BLOCK), and largest number of tasks
+#define GEMV_TASK ((size_t)1 << 16)
+#define GEMV_TASKS 64
+
+// below this many elements of A (or of x for a dot product), waking the worker pool costs more than it saves
+#define GEMV_PARALLEL ((size_t)1 << 18)
+
+// elements per vector
+#define GEMV_LANES (64 / sizeof(MATRIX_TYPE))
+
+typedef MATRIX_TYPE gemv_v __attribute__((vector_size(64)));
+typedef MATRIX_TYPE gemv_uv __attribute__((vector_size(64), aligned(sizeof(MATRIX_TYPE))));
+
+#define GEMV_LOAD(p) ((gemv_v)*(const gemv_uv *)(p))
+
+// acc += x*y on one vector, in MATRIX_TYPE
+#define GEMV_MAC(acc, x, y) ((acc) += (x) * (y))
+
+#ifdef MATRIX_FAMILY_F64
+// MATRIX_TYPE is already the wide type
+typedef gemv_v gemv_w;
+#define GEMV_MACW GEMV_MAC
+#else
+// vector of gemv_acc_t: one half of a gemv_v, widened
+typedef gemv_acc_t gemv_w __attribute__((vector_size(64)));
+typedef gemv_acc_t gemv_uw __attribute__((vector_size(64), aligned(sizeof(gemv_acc_t))));
+#define GEMV_LO(v) __builtin_convertvector(__builtin_shufflevector(v, v, 0, 1, 2, 3, 4, 5, 6, 7), gemv_w)
+#define GEMV_HI(v) __builtin_convertvector(__builtin_shufflevector(v, v, 8, 9, 10, 11, 12, 13, 14, 15), gemv_w)
+
+// acc += x*y on one vector, both halves widened
+#define GEMV_MACW(acc, x, y) ((acc) += GEMV_LO(x) * GEMV_LO(y) + GEMV_HI(x) * GEMV_HI(y))
+#endif
+
+#define GEMV_HSUM(s, acc)                                                                   \
+    for(size_t l = 0; l < sizeof(acc) / sizeof((acc)[0]); l++)                              \
+        s += (acc)[l]
+
+/*
+ * Dot product kernels: AV is the accumulator type (gemv_v or gemv_w) and MAC the
+ * matching product-accumulate. Products are summed in AV over GEMV_BLOCK
+ * elements, then added to the gemv_acc_t result.
+ */
+#define GEMV_DOT(name, attr, AV, MAC)                                                       \
+attr static gemv_acc_t name(const MATRIX_TYPE *restrict x, const MATRIX_TYPE *restrict y,   \
+                            size_t n){                                                      \
+    gemv_acc_t s = 0;                                                                       \
+    size_t i = 0;                                                                           \
+    while(i + 4*GEMV_LANES <= n){                                                           \
+        size_t end = n - i < GEMV_BLOCK ? n : i + GEMV_BLOCK;                               \
+        AV a0 = {0}, a1 = {0}, a2 = {0}, a3 = {0};                                          \
+        for(; i + 4*GEMV_LANES <= end; i += 4*GEMV_LANES){                                  \
+            MAC(a0, GEMV_LOAD(x + i), GEMV_LOAD(y + i));                                    \
+            MAC(a1, GEMV_LOAD(x + i + GEMV_LANES), GEMV_LOAD(y + i + GEMV_LANES));          \
+            MAC(a2, GEMV_LOAD(x + i + 2*GEMV_LANES), GEMV_LOAD(y + i + 2*GEMV_LANES));      \
+            MAC(a3, GEMV_LOAD(x + i + 3*GEMV_LANES), GEMV_LOAD(y + i + 3*GEMV_LANES));      \
+        }                                                                                   \
+        a0 += a1;                                                                           \
+        a2 += a3;                                                                           \
+        a0 += a2;                                                                           \
+        GEMV_HSUM(s, a0);                                                                   \
+    }                                                                                       \
+    if(i + GEMV_LANES <= n){                                                                \
+        AV a0 = {0};                                                                        \
+        for(; i + GEMV_LANES <= n; i += GEMV_LANES)                                         \
+            MAC(a0, GEMV_LOAD(x + i), GEMV_LOAD(y + i));                                    \
+        GEMV_HSUM(s, a0);                                                                   \
+    }                                                                                       \
+    for(; i < n; i++)                                                                       \
+        s += (gemv_acc_t)x[i] * y[i];                                                       \
+    return s;                                                                               \
+}
+
+// out[r] += row r of a . x for r in [0, 4), n <= GEMV_BLOCK
+#define GEMV_N4(name, attr, AV, MAC)                                                        \
+attr static void name(const MATRIX_TYPE *restrict a, size_t lda, const MATRIX_TYPE *restrict x, \
+                      size_t n, gemv_acc_t *restrict out){                                  \
+    const MATRIX_TYPE *a0 = a, *a1 = a + lda, *a2 = a + 2*lda, *a3 = a + 3*lda;             \
+    AV s0 = {0}, s1 = {0}, s2 = {0}, s3 = {0}, t0 = {0}, t1 = {0}, t2 = {0}, t3 = {0};      \
+    size_t j = 0;                                                                           \
+    for(; j + 2*GEMV_LANES <= n; j += 2*GEMV_LANES){                                        \
+        gemv_v x0 = GEMV_LOAD(x + j), x1 = GEMV_LOAD(x + j + GEMV_LANES);                   \
+        MAC(s0, GEMV_LOAD(a0 + j), x0);                                                     \
+        MAC(s1, GEMV_LOAD(a1 + j), x0);                                                     \
+        MAC(s2, GEMV_LOAD(a2 + j), x0);                                                     \
+        MAC(s3, GEMV_LOAD(a3 + j), x0);                                                     \
+        MAC(t0, GEMV_LOAD(a0 + j + GEMV_LANES), x1);                                        \
+        MAC(t1, GEMV_LOAD(a1 + j + GEMV_LANES), x1);                                        \
+        MAC(t2, GEMV_LOAD(a2 + j + GEMV_LANES), x1);                                        \
+        MAC(t3, GEMV_LOAD(a3 + j + GEMV_LANES), x1);                                        \
+    }                                                                                       \
+    if(j + GEMV_LANES <= n){                                                                \
+        gemv_v x0 = GEMV_LOAD(x + j);                                                       \
+        MAC(s0, GEMV_LOAD(a0 + j), x0);                                                     \
+        MAC(s1, GEMV_LOAD(a1 + j), x0);                                                     \
+        MAC(s2, GEMV_LOAD(a2 + j), x0);                                                     \
+        MAC(s3, GEMV_LOAD(a3 + j), x0);                                                     \
+        j += GEMV_LANES;                                                                    \
+    }                                                                                       \
+    s0 += t0;                                                                               \
+    s1 += t1;                                                                               \
+    s2 += t2;                                                                               \
+    s3 += t3;                                                                               \
+    gemv_acc_t r0 = 0, r1 = 0, r2 = 0, r3 = 0;                                              \
+    GEMV_HSUM(r0, s0);                                                                      \
+    GEMV_HSUM(r1, s1);                                                                      \
+    GEMV_HSUM(r2, s2);                                                                      \
+    GEMV_HSUM(r3, s3);                                                                      \
+    for(; j < n; j++){                                                                      \
+        r0 += (gemv_acc_t)a0[j] * x[j];                                                     \
+        r1 += (gemv_acc_t)a1[j] * x[j];                                                     \
+        r2 += (gemv_acc_t)a2[j] * x[j];                                                     \
+        r3 += (gemv_acc_t)a3[j] * x[j];                                                     \
+    }                                                                                       \
+    out[0] += r0;                                                                           \
+    out[1] += r1;                                                                           \
+    out[2] += r2;                                                                           \
+    out[3] += r3;                                                                           \
+}
+
+// acc[j] += sum over i in [0, rows) of a[i][j] * x[i*incx], j in [0, w), in MATRIX_TYPE
+#define GEMV_TN(name, attr)                                                                 \
+attr static void name(const MATRIX_TYPE *restrict a, size_t lda, const MATRIX_TYPE *restrict x, \
+                      size_t incx, size_t rows, size_t w, MATRIX_TYPE *restrict acc){       \
+    size_t i = 0;                                                                           \
+    for(; i + 4 <= rows; i += 4){                                                           \
+        const MATRIX_TYPE *a0 = a + i*lda, *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;  \
+        MATRIX_TYPE x0 = x[i*incx], x1 = x[(i+1)*incx], x2 = x[(i+2)*incx], x3 = x[(i+3)*incx]; \
+        size_t j = 0;                                                                       \
+        for(; j + GEMV_LANES <= w; j += GEMV_LANES)                                         \
+            *(gemv_uv *)(acc + j) = GEMV_LOAD(acc + j) + GEMV_LOAD(a0 + j) * x0             \
+                + GEMV_LOAD(a1 + j) * x1 + GEMV_LOAD(a2 + j) * x2 + GEMV_LOAD(a3 + j) * x3; \
+        for(; j < w; j++)                                                                   \
+            acc[j] += a0[j] * x0 + a1[j] * x1 + a2[j] * x2 + a3[j] * x3;                    \
+    }                                                                                       \
+    for(; i < rows; i++){                                                                   \
+        const MATRIX_TYPE *a0 = a + i*lda;                                                  \
+        MATRIX_TYPE x0 = x[i*incx];                                                         \
+        size_t j = 0;                                                                       \
+        for(; j + GEMV_LANES <= w; j += GEMV_LANES)                                         \
+            *(gemv_uv *)(acc + j) = GEMV_LOAD(acc + j) + GEMV_LOAD(a0 + j) * x0;            \
+        for(; j < w; j++)                                                                   \
+            acc[j] += a0[j] * x0;                                                           \
+    }                                                                                       \
+}
+
+#ifdef MATRIX_FAMILY_F64
+#define GEMV_TW(name, attr)
+#define GEMV_TW_NAME(isa) isa##_tn
+#else
+#define GEMV_TW_NAME(isa) isa##_tw
+
+// same as GEMV_TN, in gemv_acc_t: each vector of A is widened in two halves
+#define GEMV_TW(name, attr)                                                                 \
+attr static void name(const MATRIX_TYPE *restrict a, size_t lda, const MATRIX_TYPE *restrict x, \
+                      size_t incx, size_t rows, size_t w, gemv_acc_t *restrict acc){        \
+    size_t i = 0;                                                                           \
+    for(; i + 4 <= rows; i += 4){                                                           \
+        const MATRIX_TYPE *a0 = a + i*lda, *a1 = a0 + lda, *a2 = a1 + lda, *a3 = a2 + lda;  \
+        gemv_acc_t x0 = x[i*incx], x1 = x[(i+1)*incx], x2 = x[(i+2)*incx], x3 = x[(i+3)*incx]; \
+        size_t j = 0;                                                                       \
+        for(; j + GEMV_LANES <= w; j += GEMV_LANES){                                        \
+            gemv_v v0 = GEMV_LOAD(a0 + j), v1 = GEMV_LOAD(a1 + j);                          \
+            gemv_v v2 = GEMV_LOAD(a2 + j), v3 = GEMV_LOAD(a3 + j);                          \
+            *(gemv_uw *)(acc + j) += GEMV_LO(v0) * x0 + GEMV_LO(v1) * x1                    \
+                                   + GEMV_LO(v2) * x2 + GEMV_LO(v3) * x3;                   \
+            *(gemv_uw *)(acc + j + GEMV_LANES/2) += GEMV_HI(v0) * x0 + GEMV_HI(v1) * x1     \
+                                                  + GEMV_HI(v2) * x2 + GEMV_HI(v3) * x3;    \
+        }                                                                                   \
+        for(; j < w; j++)                                                                   \
+            acc[j] += a0[j] * x0 + a1[j] * x1 + a2[j] * x2 + a3[j] * x3;                    \
+    }                                                                                       \
+    for(; i < rows; i++){                                                                   \
+        const MATRIX_TYPE *a0 = a + i*lda;                                                  \
+        gemv_acc_t x0 = x[i*incx];                                                          \
+        size_t j = 0;                                                                       \
+        for(; j + GEMV_LANES <= w; j += GEMV_LANES){                                        \
+            gemv_v v0 = GEMV_LOAD(a0 + j);                                                  \
+            *(gemv_uw *)(acc + j) += GEMV_LO(v0) * x0;                                      \
+            *(gemv_uw *)(acc + j + GEMV_LANES/2) += GEMV_HI(v0) * x0;                       \
+        }                                                                                   \
+        for(; j < w; j++)                                                                   \
+            acc[j] += a0[j] * x0;                                                           \
+    }                                                                                       \
+}
+#endif
+
+typedef struct {
+    // x . y, products summed in MATRIX_TYPE by blocks [0] or in gemv_acc_t [1]
+    gemv_acc_t (*dot[2])(const MATRIX_TYPE *x, const MATRIX_TYPE *y, size_t n);
+    // out[r] += row r of a . x for 4 rows, same two precisions
+    void (*n4[2])(const MATRIX_TYPE *a, size_t lda, const MATRIX_TYPE *x, size_t n, gemv_acc_t *out);
+    // acc[j] += sum of a[i][j] * x[i], in MATRIX_TYPE and in gemv_acc_t
+    void (*tn)(const MATRIX_TYPE *a, size_t lda, const MATRIX_TYPE *x, size_t incx, size_t rows, size_t w, MATRIX_TYPE *acc);
+    void (*tw)(const MATRIX_TYPE *a, size_t lda, const MATRIX_TYPE *x, size_t incx, size_t rows, size_t w, gemv_acc_t *acc);
+}gemv_kernels_t;
+
+// GEMV_KERNELS(isa, attr) defines the kernel table gemv_isa, compiled with the function attributes attr
+#define GEMV_KERNELS(isa, attr)                                                             \
+GEMV_DOT(isa##_dot, attr, gemv_v, GEMV_MAC)                                                 \
+GEMV_DOT(isa##_dotw, attr, gemv_w, GEMV_MACW)                                               \
+GEMV_N4(isa##_n4, attr, gemv_v, GEMV_MAC)                                                   \
+GEMV_N4(isa##_n4w, attr, gemv_w, GEMV_MACW)                                                 \
+GEMV_TN(isa##_tn, attr)                                                                     \
+GEMV_TW(isa##_tw, attr)                                                                     \
+                                                                                            \
+static const gemv_kernels_t gemv_##isa = {                                                  \
+    { isa##_dot, isa##_dotw },                                                              \
+    { isa##_n4, isa##_n4w },                                                                \
+    isa##_tn, GEMV_TW_NAME(isa)                                                             \
+};
+
+GEMV_KERNELS(generic, )
+
+#if defined(__x86_64__) || defined(__i386__)
+GEMV_KERNELS(avx2, __attribute__((target("avx2"))))
+GEMV_KERNELS(avx512, __attribute__((target("avx512f"))))
+#endif
+
+static const gemv_kernels_t *gemv_kernels(void){
+    /*
+        * kernel table matching the instruction set selected at startup
+        * @return const gemv_kernels_t* : kernels
+    */
+#if defined(__x86_64__) || defined(__i386__)
+    if(matrix_simd->level >= MATRIX_SIMD_AVX512)
+        return &gemv_avx512;
+    if(matrix_simd->level >= MATRIX_SIMD_AVX2)
+        return &gemv_avx2;
+#endif
+    return &gemv_generic;
+}
+
+typedef struct {
+    const gemv_kernels_t *k;
+    int wide;
+    size_t m, n;
+    MATRIX_TYPE alpha, beta;
+    const MATRIX_TYPE *a;
+    size_t lda;
+    const MATRIX_TYPE *x;
+    size_t incx;
+    MATRIX_TYPE *y;
+    size_t incy;
+}gemv_job_t;
+
+static void gemv_store(const gemv_job_t *job, size_t i, gemv_acc_t s){
+    // y[i] = alpha*s + beta*y[i], rounded once
+    MATRIX_TYPE *y = job->y + i*job->incy;
+    if(job->beta == 0)
+        *y = (MATRIX_TYPE)(job->alpha * s);
+    else
+        *y = (MATRIX_TYPE)(job->alpha * s + job->beta * (gemv_acc_t)*y);
+}
+
+static void gemv_n_task(void *ctx, size_t task){
+    // A*x: rows [task*GEMV_ROWS, ...), x swept by blocks of GEMV_BLOCK
+    const gemv_job_t *job = ctx;
+    const gemv_kernels_t *k = job->k;
+    size_t i0 = task * GEMV_ROWS;
+    size_t rows = job->m - i0 < GEMV_ROWS ? job->m - i0 : GEMV_ROWS;
+    gemv_acc_t s[GEMV_ROWS] = {0};
+    MATRIX_TYPE buf[GEMV_BLOCK];
+
+    for(size_t j0 = 0; j0 < job->n; j0 += GEMV_BLOCK){
+        size_t len = job->n - j0 < GEMV_BLOCK ? job->n - j0 : GEMV_BLOCK;
+        const MATRIX_TYPE *x = job->x + j0*job->incx;
+        if(job->incx != 1){
+            for(size_t j = 0; j < len; j++)
+                buf[j] = x[j*job->incx];
+            x = buf;
+        }
+
+        const MATRIX_TYPE *a = job->a + i0*job->lda + j0;
+        size_t r = 0;
+        for(; r + 4 <= rows; r += 4)
+            k->n4[job->wide](a + r*job->lda, job->lda, x, len, s + r);
+        for(; r < rows; r++)
+            s[r] += k->dot[job->wide](a + r*job->lda, x, len);
+    }
+
+    for(size_t r = 0; r < rows; r++)
+        gemv_store(job, i0 + r, s[r]);
+}
+
+static void gemv_t_task(void *ctx, size_t task){
+    // A^T*x: columns [task*GEMV_COLS, ...), swept down the rows
+    const gemv_job_t *job = ctx;
+    const gemv_kernels_t *k = job->k;
+    size_t j0 = task * GEMV_COLS;
+    size_t w = job->n - j0 < GEMV_COLS ? job->n - j0 : GEMV_COLS;
+    const MATRIX_TYPE *a = job->a + j0;
+    gemv_acc_t s[GEMV_COLS] = {0};
+
+    if(job->wide)
+        k->tw(a, job->lda, job->x, job->incx, job->m, w, s);
+    else{
+        MATRIX_TYPE part[GEMV_COLS];
+        for(size_t i = 0; i < job->m; i += GEMV_FOLD){
+            size_t rows = job->m - i < GEMV_FOLD ? job->m - i : GEMV_FOLD;
+            memset(part, 0, w * sizeof(MATRIX_TYPE));
+            k->tn(a + i*job->lda, job->lda, job->x + i*job->incx, job->incx, rows, w, part);
+            for(size_t j = 0; j < w; j++)
+                s[j] += part[j];
+        }
+    }
+
+    for(size_t j = 0; j < w; j++)
+        gemv_store(job, j0 + j, s[j]);
+}
+
+void matrix_gemv(matrix_gemv_t flags, size_t m, size_t n, MATRIX_TYPE alpha,
+                 const MATRIX_TYPE *a, size_t lda,
+                 const MATRIX_TYPE *x, size_t incx,
+                 MATRIX_TYPE beta, MATRIX_TYPE *y, size_t incy){
+    /*
+        * y = alpha*op(A)*x + beta*y
+        * @params flags: MATRIX_GEMV_TRANS and / or MATRIX_GEMV_WIDE
+        *         m, n: dimensions of A
+        *         a, lda: A and its leading dimension
+        *         x, incx: x and its increment
+        *         y, incy: y and its increment
+    */
+    gemv_job_t job = { gemv_kernels(), !!(flags & MATRIX_GEMV_WIDE), m, n, alpha, beta, a, lda, x, incx, y, incy };
+    size_t ntasks;
+    void (*task)(void *, size_t);
+
+    if(flags & MATRIX_GEMV_TRANS){
+        ntasks = (n + GEMV_COLS - 1) / GEMV_COLS;
+        task = gemv_t_task;
+    }else{
+        ntasks = (m + GEMV_ROWS - 1) / GEMV_ROWS;
+        task = gemv_n_task;
+    }
+
+    if(m * n >= GEMV_PARALLEL && ntasks > 1)
+        matrix_parallel_for(ntasks, task, &job);
+    else
+        for(size_t t = 0; t < ntasks; t++)
+            task(&job, t);
+}
+
+typedef struct {
+    const gemv_kernels_t *k;
+    int wide;
+    size_t n, per_task;
+    const MATRIX_TYPE *x, *y;
+    size_t incx, incy;
+    gemv_acc_t *partial;
+}gemv_dot_job_t;
+
+static void gemv_dot_task(void *ctx, size_t task){
+    // x . y over the elements [task*per_task, ...), strided operands gathered by blocks
+    const gemv_dot_job_t *job = ctx;
+    size_t i0 = task * job->per_task;
+    size_t i1 = job->n - i0 < job->per_task ? job->n : i0 + job->per_task;
+    const MATRIX_TYPE *x = job->x + i0*job->incx, *y = job->y + i0*job->incy;
+
+    if(job->incx == 1 && job->incy == 1){
+        job->partial[task] = job->k->dot[job->wide](x, y, i1 - i0);
+        return;
+    }
+
+    MATRIX_TYPE bx[GEMV_BLOCK], by[GEMV_BLOCK];
+    gemv_acc_t s = 0;
+    for(size_t i = 0; i < i1 - i0; i += GEMV_BLOCK){
+        size_t len = i1 - i0 - i < GEMV_BLOCK ? i1 - i0 - i : GEMV_BLOCK;
+        const MATRIX_TYPE *px = x + i*job->incx, *py = y + i*job->incy;
+        if(job->incx != 1){
+            for(size_t l = 0; l < len; l++)
+                bx[l] = px[l*job->incx];
+            px = bx;
+        }
+        if(job->incy != 1){
+            for(size_t l = 0; l < len; l++)
+                by[l] = py[l*job->incy];
+            py = by;
+        }
+        s += job->k->dot[job->wide](px, py, len);
+    }
+    job->partial[task] = s;
+}
+
+gemv_acc_t matrix_dot(matrix_gemv_t flags, size_t n, const MATRIX_TYPE *x, size_t incx, const MATRIX_TYPE *y, size_t incy){
+    /*
+        * dot product
+        * @params flags: MATRIX_GEMV_WIDE or 0
+        *         n: number of elements
+        *         x, incx: first vector and its increment
+        *         y, incy: second vector and its increment
+        * @return gemv_acc_t : x . y
+    */
+    gemv_acc_t partial[GEMV_TASKS];
+    gemv_dot_job_t job = { gemv_kernels(), !!(flags & MATRIX_GEMV_WIDE), n, n ? n : 1, x, y, incx, incy, partial };
+
+    // at most GEMV_TASKS tasks of a whole number of blocks
+    if(n >= GEMV_PARALLEL){
+        size_t ntasks = (n + GEMV_TASK - 1) / GEMV_TASK;
+        if(ntasks > GEMV_TASKS)
+            ntasks = GEMV_TASKS;
+        job.per_task = ((n + ntasks - 1) / ntasks + GEMV_BLOCK - 1) / GEMV_BLOCK * GEMV_BLOCK;
+    }
+    size_t ntasks = (n + job.per_task - 1) / job.per_task;
+
+    if(ntasks > 1)
+        matrix_parallel_for(ntasks, gemv_dot_task, &job);
+    else if(ntasks)
+        gemv_dot_task(&job, 0);
+
+    gemv_acc_t s = 0;
+    for(size_t t = 0; t < ntasks; t++)
+        s += partial[t];
+    return s;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+/**
+ * @file matrix_gemv.h
+ * @brief Matrix-vector product and dot product kernels used by m_gemv / m_dot / m_mult
+ *
+ * Internal header: operates on raw row-major storage with explicit leading
+ * dimensions and vector increments, like the GEMM engine.
+ *
+ * A matrix-vector product reads every element of A exactly once, so it is bound
+ * by memory bandwidth rather than arithmetic: the kernels stream A through
+ * several independent SIMD accumulators (so that the FMA latency is hidden) and
+ * keep the x block, or the y block when A is transposed, resident in L1.
+ *
+ * Products are accumulated in MATRIX_TYPE over blocks of a few hundred elements
+ * and the block results are summed in gemv_acc_t, which bounds the rounding error
+ * of long vectors. With MATRIX_GEMV_WIDE every product is accumulated in
+ * gemv_acc_t directly.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "matrix.h"
+
+// one set of kernels per element type family
+#define matrix_gemv MATRIX_NAME(matrix_gemv)
+#define matrix_dot  MATRIX_NAME(matrix_dot)
+
+// wide accumulator: double, or int64_t for the integer family
+#ifdef MATRIX_FAMILY_I32
+typedef int64_t gemv_acc_t;
+#else
+typedef double gemv_acc_t;
+#endif
+
+// y = alpha*op(A)*x + beta*y, op(A) = A, or A^T with MATRIX_GEMV_TRANS
+// A is m x n (leading dimension lda), x and y have the lengths of op(A) with increments incx and incy
+// when beta is 0, y is not read and may hold uninitialised values
+// y must not overlap A or x
+void matrix_gemv(matrix_gemv_t flags, size_t m, size_t n, MATRIX_TYPE alpha,
+                 const MATRIX_TYPE *a, size_t lda,
+                 const MATRIX_TYPE *x, size_t incx,
+                 MATRIX_TYPE beta, MATRIX_TYPE *y, size_t incy);
+
+// sum of x[i*incx] * y[i*incy] for i in [0, n), accumulated as above (MATRIX_GEMV_WIDE is the only flag read)
+gemv_acc_t matrix_dot(matrix_gemv_t flags, size_t n, const MATRIX_TYPE *x, size_t incx, const MATRIX_TYPE *y, size_t incy);
@@ -0,0 +1,21 @@
+/*
+ * i32 element type family: matrix_i32_t, m_add_i32, ...
+ * The typed sources are compiled here a third time, with MATRIX_TYPE int32_t.
+ */
+#define MATRIX_FAMILY_I32
+
+#include "matrix.c"
+#include "matrix_fixed.c"
+#include "matrix_simd.c"
+#include "matrix_gemm.c"
+#include "matrix_strassen.c"
+#include "matrix_gemv.c"
+#include "matrix_transp.c"
+#include "matrix_reduce.c"
+#include "matrix_math.c"
+#include "matrix_sparse.c"
+#include "matrix_io.c"
+#include "matrix_ooc.c"
+#include "matrix_lu.c"
+#include "matrix_qr.c"
+#include "matrix_async.c"
@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <err.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "matrix.h"
+#include "matrix_alloc.h"
+#include "matrix_io.h"
+#include "matrix_view.h"
+#include "state.h"
+
+/*
+ * Binary matrix files (format in matrix_io.h).
+ *
+ * The data is page aligned, so matrix_mmap hands out a matrix whose elements
+ * are the pages of the file itself: nothing is read until it is touched, and
+ * processes mapping the same file share the page cache.
+ *
+ * A mapped matrix owns a small allocator (see matrix_alloc.h) that unmaps the
+ * file when matrix_free releases the data, so it is freed like any other.
+ */
+
+// mapping of one file, followed in the same block by the matrix header
+typedef struct {
+    matrix_allocator_t base;
+    void *addr;
+    size_t len;
+}io_map_t;
+
+#define IO_MAP_HEADER ((sizeof(io_map_t) + MATRIX_ALIGN - 1) / MATRIX_ALIGN * MATRIX_ALIGN)
+
+static void io_map_free(matrix_allocator_t *self, void *ptr, size_t size){
+    // the data goes first (unmap), then the matrix header, which lives in the block of the allocator
+    io_map_t *map = (io_map_t *)self;
+    (void)size;
+    if(ptr == (char *)map + IO_MAP_HEADER)
+        free(map);
+    else
+        munmap(map->addr, map->len);
+}
+
+int matrix_save(const matrix_t *m1, const char *path){
+    /*
+        * write a matrix to a binary file (see matrix_io.h for the format)
+        * @params m1: pointer to the matrix
+        *         path: path of the file, replaced if it exists
+        * @return int : 0 on success, -1 with errno set on failure
+    */
+    if(!m1 || !path)
+        errx(MATRIX_NULL_POINTER, "matrix_save: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    io_header_t h = matrix_io_header(m1->row, m1->col);
+    static const char zero[IO_ALIGN];
+
+    FILE *f;
+    if(!(f = fopen(path, "wb")))
+        return -1;
+
+    int ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(zero, IO_ALIGN - sizeof(h), 1, f) == 1;
+    if(matrix_dense(m1))
+        ok = ok && fwrite(m1->data, sizeof(MATRIX_TYPE), m1->row * m1->col, f) == m1->row * m1->col;
+    else
+        for(size_t i = 0; ok && i < m1->row; i++)
+            ok = fwrite(m1->data + i * m1->stride, sizeof(MATRIX_TYPE), m1->col, f) == m1->col;
+
+    int saved = errno;
+    if(fclose(f) || !ok){
+        errno = ok ? errno : saved;
+        return -1;
+    }
+    return 0;
+}
+
+int matrix_io_open(const char *path, int oflag, io_header_t *h, size_t *bytes){
+    /*
+        * open a matrix file and check its header against the file and the element type
+        * @params bytes: set to the size of the data, from the first element to the end of the last row
+        * @return int : file descriptor, -1 with errno set on failure (EINVAL for an invalid file)
+    */
+    int fd;
+    if((fd = open(path, oflag)) < 0)
+        return -1;
+
+    struct stat st;
+    if(fstat(fd, &st)){
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+
+    if(pread(fd, h, sizeof(*h), 0) != (ssize_t)sizeof(*h))
+        goto invalid;
+
+    // matrix_mmap hands out the elements in place: they must be aligned for MATRIX_TYPE
+    if(memcmp(h->magic, IO_MAGIC, sizeof(h->magic)) || h->version != IO_VERSION || h->bom != IO_BOM ||
+       h->type != IO_TYPE || h->offset < sizeof(*h) || h->align < sizeof(MATRIX_TYPE) ||
+       h->offset % h->align || h->offset % sizeof(MATRIX_TYPE) ||
+       (h->row > 1 && h->stride < h->col) || (size_t)h->row != h->row || (size_t)h->col != h->col)
+        goto invalid;
+
+    // bytes = ((row - 1)*stride + col)*sizeof(MATRIX_TYPE), without overflow
+    uint64_t n = 0;
+    if(h->row && h->col && (__builtin_mul_overflow(h->row - 1, h->stride, &n) ||
+                            __builtin_add_overflow(n, h->col, &n) ||
+                            __builtin_mul_overflow(n, sizeof(MATRIX_TYPE), &n)))
+        goto invalid;
+    if(n > (uint64_t)st.st_size || h->offset > (uint64_t)st.st_size - n)
+        goto invalid;
+
+    // the stride of a single row is not used
+    if(h->row <= 1)
+        h->stride = h->col;
+
+    *bytes = n;
+    return fd;
+
+invalid:
+    close(fd);
+    errno = EINVAL;
+    return -1;
+}
+
+matrix_t* matrix_load(const char *path){
+    /*
+        * read a matrix file into a new matrix
+        * @params path: path of the file
+        * @return matrix_t* : pointer to the matrix, NULL with errno set on failure
+        *                     (EINVAL if the file is not a matrix of this element type)
+    */
+    if(!path)
+        errx(MATRIX_NULL_POINTER, "matrix_load: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    io_header_t h;
+    size_t bytes;
+    int fd;
+    if((fd = matrix_io_open(path, O_RDONLY, &h, &bytes)) < 0)
+        return NULL;
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(h.row, h.col))){
+        close(fd);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    // straight into the matrix: one read for a dense file, one per row otherwise
+    size_t row = h.stride == h.col ? 1 : h.row, len = (h.stride == h.col ? h.row : 1) * h.col * sizeof(MATRIX_TYPE);
+    for(size_t i = 0; i < row && len; i++){
+        char *p = (char *)(result->data + i * h.col);
+        off_t at = (off_t)(h.offset + i * h.stride * sizeof(MATRIX_TYPE));
+        for(size_t done = 0; done < len;){
+            ssize_t r = pread(fd, p + done, len - done, at + (off_t)done);
+            if(r <= 0){
+                int saved = r ? errno : EIO;
+                matrix_free(result);
+                close(fd);
+                errno = saved;
+                return NULL;
+            }
+            done += (size_t)r;
+        }
+    }
+
+    close(fd);
+    return result;
+}
+
+matrix_t* matrix_mmap(const char *path, matrix_mmap_t flags){
+    /*
+        * map a matrix file: the elements of the matrix are the pages of the file (no copy)
+        * @params path: path of the file
+        *         flags: MATRIX_MMAP_READ (default) for a read-only matrix, MATRIX_MMAP_PRIVATE for a
+        *                writable copy-on-write one, MATRIX_MMAP_SHARED to write the changes to the file;
+        *                or'ed with MATRIX_MMAP_POPULATE to read the whole file at once
+        * @return matrix_t* : pointer to the matrix, released by matrix_free, NULL with errno set on failure
+        *                     (EINVAL if the file is not a matrix of this element type)
+    */
+    if(!path)
+        errx(MATRIX_NULL_POINTER, "matrix_mmap: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if((flags & MATRIX_MMAP_PRIVATE) && (flags & MATRIX_MMAP_SHARED))
+        errx(MATRIX_INVALID_ARGUMENT, "matrix_mmap: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    io_header_t h;
+    size_t bytes;
+    int fd;
+    if((fd = matrix_io_open(path, flags & MATRIX_MMAP_SHARED ? O_RDWR : O_RDONLY, &h, &bytes)) < 0)
+        return NULL;
+
+    // nothing to map
+    if(!bytes){
+        close(fd);
+        matrix_t *result = matrix_alloc(h.row, h.col);
+        if(!result)
+            errno = ENOMEM;
+        return result;
+    }
+
+    int prot = flags & (MATRIX_MMAP_PRIVATE | MATRIX_MMAP_SHARED) ? PROT_READ | PROT_WRITE : PROT_READ;
+    int mflags = flags & MATRIX_MMAP_PRIVATE ? MAP_PRIVATE : MAP_SHARED;
+#ifdef MAP_POPULATE
+    if(flags & MATRIX_MMAP_POPULATE)
+        mflags |= MAP_POPULATE;
+#endif
+
+    size_t len = h.offset + bytes;
+    void *addr = mmap(NULL, len, prot, mflags, fd, 0);
+    int saved = errno;
+    close(fd);
+    if(addr == MAP_FAILED){
+        errno = saved;
+        return NULL;
+    }
+
+    io_map_t *map;
+    if(!(map = malloc(IO_MAP_HEADER + sizeof(matrix_t)))){
+        munmap(addr, len);
+        errno = ENOMEM;
+        return NULL;
+    }
+    map->base = (matrix_allocator_t){ NULL, io_map_free, NULL, NULL, 0 };
+    map->addr = addr;
+    map->len = len;
+
+    matrix_t *result = (matrix_t *)((char *)map + IO_MAP_HEADER);
+    *result = (matrix_t){ h.row, h.col, (MATRIX_TYPE *)((char *)addr + h.offset), h.stride, &map->base, 0 };
+    return result;
+}
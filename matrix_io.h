@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+ * @file matrix_io.h
+ * @brief Binary matrix file format shared by matrix_save / matrix_load / matrix_mmap and the out-of-core operations
+ *
+ * Internal header. A file is a 64 byte header followed by the elements, row-major:
+ *
+ *   offset  size  field
+ *        0     8  magic "CMATRIX\0"
+ *        8     4  version (1)
+ *       12     4  element type: 1 f32, 2 f64, 3 i32
+ *       16     8  rows
+ *       24     8  columns
+ *       32     8  stride: elements between the starts of two rows (>= columns)
+ *       40     8  offset of the first element, a multiple of the alignment and of the element size
+ *       48     4  alignment of the data, at least the element size (IO_ALIGN when written by this library)
+ *       52     4  byte order mark 0x01020304, in the byte order of the elements
+ *       56     8  reserved (0)
+ *
+ * Row i starts at offset + i*stride*sizeof(element).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "matrix.h"
+
+// one set of functions per element type family
+#define matrix_io_open MATRIX_NAME(matrix_io_open)
+
+#define IO_MAGIC "CMATRIX"
+#define IO_VERSION 1
+#define IO_BOM 0x01020304u
+
+// alignment of the data written by the library (page size)
+#define IO_ALIGN 4096
+
+#if defined(MATRIX_FAMILY_F64)
+#define IO_TYPE 2
+#elif defined(MATRIX_FAMILY_I32)
+#define IO_TYPE 3
+#else
+#define IO_TYPE 1
+#endif
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t type;
+    uint64_t row;
+    uint64_t col;
+    uint64_t stride;
+    uint64_t offset;
+    uint32_t align;
+    uint32_t bom;
+    uint64_t reserved;
+}io_header_t;
+
+_Static_assert(sizeof(io_header_t) == 64, "io_header_t must be 64 bytes");
+
+// header of a row x col file of the family, rows packed, data at IO_ALIGN
+static inline io_header_t matrix_io_header(size_t row, size_t col){
+    return (io_header_t){ IO_MAGIC, IO_VERSION, IO_TYPE, row, col, col, IO_ALIGN, IO_ALIGN, IO_BOM, 0 };
+}
+
+// open a matrix file of the family with open(2) flags oflag and check its header against the file
+// sets bytes to the size of the data, from the first element to the end of the last row
+// returns the file descriptor, or -1 with errno set (EINVAL for an invalid file or another element type)
+int matrix_io_open(const char *path, int oflag, io_header_t *h, size_t *bytes);
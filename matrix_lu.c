@@ -0,0 +1,346 @@
+#include <stdlib.h>
+#include <string.h>
+#include <err.h>
+
+#include "matrix.h"
+#include "matrix_alloc.h"
+#include "matrix_gemm.h"
+#include "matrix_lu.h"
+#include "matrix_stats.h"
+#include "matrix_view.h"
+#include "state.h"
+
+/*
+ * LU factorization with partial pivoting, P*A = L*U, and the solvers built on it.
+ *
+ * The factorization is blocked and right-looking: a panel of LU_BLOCK columns is
+ * factored with row pivoting, the block row of U to its right is solved against
+ * the unit lower triangle of the panel, then the trailing matrix takes the rank
+ * LU_BLOCK update A22 -= L21*U12 through the GEMM engine. Nearly all of the
+ * 2n^3/3 operations end up in that update.
+ *
+ * Pivoting swaps whole rows, which are contiguous in row-major storage.
+ *
+ * A factorization is reused for any number of right-hand sides: each solve is
+ * two triangular solves, O(n^2) per column of B, whose off-diagonal blocks also
+ * go through GEMM.
+ *
+ * Only the floating point families factor: the i32 functions exit with
+ * MATRIX_INVALID_ARGUMENT (convert with matrix_i32_to_f64 first).
+ */
+
+// columns per panel, and rows per block of the triangular solves
+#define LU_BLOCK 64
+
+#define LU_INTEGER ((MATRIX_TYPE)0.5 == 0)
+
+static void lu_swap(MATRIX_TYPE *restrict x, MATRIX_TYPE *restrict y, size_t n){
+    for(size_t j = 0; j < n; j++){
+        MATRIX_TYPE t = x[j];
+        x[j] = y[j];
+        y[j] = t;
+    }
+}
+
+// y[j] -= a * x[j] for j in [0, n)
+static void lu_axpy(MATRIX_TYPE a, const MATRIX_TYPE *restrict x, MATRIX_TYPE *restrict y, size_t n){
+    for(size_t j = 0; j < n; j++)
+        y[j] -= a * x[j];
+}
+
+static void lu_panel(MATRIX_TYPE *a, size_t lda, size_t n, size_t k0, size_t kb, size_t *perm, int *sign, int *singular){
+    /*
+        * unblocked factorization of the panel of columns [k0, k0 + kb), rows [k0, n)
+        * the row swaps are applied to whole rows, the updates stay inside the panel
+    */
+    for(size_t j = k0; j < k0 + kb; j++){
+        size_t p = j;
+        MATRIX_TYPE best = a[j * lda + j] < 0 ? -a[j * lda + j] : a[j * lda + j];
+        for(size_t i = j + 1; i < n; i++){
+            MATRIX_TYPE v = a[i * lda + j] < 0 ? -a[i * lda + j] : a[i * lda + j];
+            if(v > best){
+                best = v;
+                p = i;
+            }
+        }
+
+        if(p != j){
+            lu_swap(a + j * lda, a + p * lda, n);
+            size_t t = perm[j];
+            perm[j] = perm[p];
+            perm[p] = t;
+            *sign = -*sign;
+        }
+
+        // a zero column below the diagonal: nothing to eliminate, U is singular
+        MATRIX_TYPE pivot = a[j * lda + j];
+        if(pivot == 0){
+            *singular = 1;
+            continue;
+        }
+
+        MATRIX_TYPE inv = 1 / pivot;
+        const MATRIX_TYPE *urow = a + j * lda + j + 1;
+        size_t w = k0 + kb - j - 1;
+        for(size_t i = j + 1; i < n; i++){
+            MATRIX_TYPE *row = a + i * lda + j;
+            row[0] *= inv;
+            lu_axpy(row[0], urow, row + 1, w);
+        }
+    }
+}
+
+void matrix_trsm_lower(size_t n, size_t k, const MATRIX_TYPE *l, size_t ldl, MATRIX_TYPE *x, size_t ldx){
+    for(size_t i0 = 0; i0 < n; i0 += LU_BLOCK){
+        size_t ib = n - i0 < LU_BLOCK ? n - i0 : LU_BLOCK;
+        if(i0 && k)
+            matrix_gemm(ib, k, i0, -1, l + i0 * ldl, ldl, x, ldx, 1, x + i0 * ldx, ldx);
+        for(size_t r = 1; r < ib; r++)
+            for(size_t c = 0; c < r; c++)
+                lu_axpy(l[(i0 + r) * ldl + i0 + c], x + (i0 + c) * ldx, x + (i0 + r) * ldx, k);
+    }
+}
+
+void matrix_trsm_upper(size_t n, size_t k, const MATRIX_TYPE *u, size_t ldu, MATRIX_TYPE *x, size_t ldx){
+    for(size_t end = n; end > 0;){
+        size_t ib = end < LU_BLOCK ? end : LU_BLOCK, i0 = end - ib;
+        if(end < n && k)
+            matrix_gemm(ib, k, n - end, -1, u + i0 * ldu + end, ldu, x + end * ldx, ldx, 1, x + i0 * ldx, ldx);
+        for(size_t r = ib; r-- > 0;){
+            MATRIX_TYPE *xr = x + (i0 + r) * ldx;
+            for(size_t c = r + 1; c < ib; c++)
+                lu_axpy(u[(i0 + r) * ldu + i0 + c], x + (i0 + c) * ldx, xr, k);
+            MATRIX_TYPE inv = 1 / u[(i0 + r) * ldu + i0 + r];
+            for(size_t j = 0; j < k; j++)
+                xr[j] *= inv;
+        }
+        end = i0;
+    }
+}
+
+matrix_lu_t* matrix_lu(const matrix_t *m1){
+    /*
+        * LU factorization with partial pivoting: P*m1 = L*U
+        * a singular matrix is factored too (singular is set), its determinant is 0
+        * @params m1: pointer to the square matrix
+        * @return matrix_lu_t* : pointer to the factorization, released by matrix_lu_free, NULL on failure
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_lu: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(m1->row != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "matrix_lu: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    if(LU_INTEGER)
+        errx(MATRIX_INVALID_ARGUMENT, "matrix_lu: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    size_t n = m1->row;
+    MATRIX_STAT(MATRIX_OP_LU, n * n, 2 * (uint64_t)n * n * n / 3, 2 * (uint64_t)n * n * sizeof(MATRIX_TYPE));
+
+    matrix_lu_t *result;
+    if(!(result = malloc(sizeof(matrix_lu_t) + n * sizeof(size_t))))
+        return NULL;
+    if(!(result->lu = matrix_getcpy(m1))){
+        free(result);
+        return NULL;
+    }
+    result->perm = (size_t *)(result + 1);
+    result->sign = 1;
+    result->singular = 0;
+    for(size_t i = 0; i < n; i++)
+        result->perm[i] = i;
+
+    MATRIX_TYPE *a = result->lu->data;
+    size_t lda = result->lu->stride;
+    for(size_t k0 = 0; k0 < n; k0 += LU_BLOCK){
+        size_t kb = n - k0 < LU_BLOCK ? n - k0 : LU_BLOCK, rest = n - k0 - kb;
+        lu_panel(a, lda, n, k0, kb, result->perm, &result->sign, &result->singular);
+        if(!rest)
+            break;
+
+        // U12 = L11^-1 * A12, then A22 -= L21 * U12
+        matrix_trsm_lower(kb, rest, a + k0 * lda + k0, lda, a + k0 * lda + k0 + kb, lda);
+        matrix_gemm(rest, rest, kb, -1, a + (k0 + kb) * lda + k0, lda, a + k0 * lda + k0 + kb, lda,
+                    1, a + (k0 + kb) * lda + k0 + kb, lda);
+    }
+
+    return result;
+}
+
+void matrix_lu_free(matrix_lu_t *lu){
+    /*
+        * free a factorization
+        * @params lu: pointer to the factorization
+    */
+    if(!lu)
+        errx(MATRIX_NULL_POINTER, "matrix_lu_free: %s", MATRIX_NULL_POINTER_MESSAGE);
+    matrix_free(lu->lu);
+    free(lu);
+}
+
+void m_lu_solvet(const matrix_lu_t *lu, const matrix_t *b, matrix_t *result){
+    /*
+        * solve A*X = B with the factorization of A, to result
+        * @params lu: pointer to the factorization of A (n x n, not singular)
+        *         b: pointer to the right-hand sides, n x k (one per column)
+        *         result: pointer to the solution X, n x k (may be b)
+    */
+    if(!lu || !b || !result)
+        errx(MATRIX_NULL_POINTER, "m_lu_solvet: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    size_t n = lu->lu->row, k = b->col;
+    if(b->row != n || result->row != n || result->col != k)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_lu_solvet: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    if(lu->singular)
+        errx(MATRIX_SINGULAR, "m_lu_solvet: %s", MATRIX_SINGULAR_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_SOLVE, n * k, 2 * (uint64_t)n * n * k, ((uint64_t)n * n + 2 * n * k) * sizeof(MATRIX_TYPE));
+
+    // X = P*B: rows are gathered from B, through a copy when result shares its storage
+    matrix_t *tmp = NULL;
+    const matrix_t *src = b;
+    if(matrix_overlap(result, b)){
+        if(!(tmp = matrix_getcpy(b)))
+            errx(MATRIX_MEMORY_ERROR, "m_lu_solvet: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+        src = tmp;
+    }
+    for(size_t i = 0; i < n; i++)
+        memcpy(result->data + i * result->stride, src->data + lu->perm[i] * src->stride, k * sizeof(MATRIX_TYPE));
+    if(tmp)
+        matrix_free(tmp);
+
+    const matrix_t *f = lu->lu;
+    matrix_trsm_lower(n, k, f->data, f->stride, result->data, result->stride);
+    matrix_trsm_upper(n, k, f->data, f->stride, result->data, result->stride);
+}
+
+matrix_t* m_lu_solve(const matrix_lu_t *lu, const matrix_t *b){
+    /*
+        * solve A*X = B with the factorization of A
+        * @params lu: pointer to the factorization of A (n x n, not singular)
+        *         b: pointer to the right-hand sides, n x k (one per column)
+        * @return matrix_t* : pointer to the solution X, n x k
+    */
+    if(!lu || !b)
+        errx(MATRIX_NULL_POINTER, "m_lu_solve: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(b->row, b->col)))
+        return NULL;
+
+    m_lu_solvet(lu, b, result);
+    return result;
+}
+
+MATRIX_TYPE m_lu_det(const matrix_lu_t *lu){
+    /*
+        * determinant from a factorization: sign of P times the product of the diagonal of U
+        * @params lu: pointer to the factorization
+        * @return MATRIX_TYPE : the determinant
+    */
+    if(!lu)
+        errx(MATRIX_NULL_POINTER, "m_lu_det: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    const matrix_t *f = lu->lu;
+    MATRIX_STAT(MATRIX_OP_DET, 1, f->row, f->row * sizeof(MATRIX_TYPE));
+
+    MATRIX_TYPE det = lu->sign;
+    for(size_t i = 0; i < f->row; i++)
+        det *= f->data[i * (f->stride + 1)];
+    return det;
+}
+
+matrix_t* m_lu_inv(const matrix_lu_t *lu){
+    /*
+        * inverse from a factorization: the solution of A*X = Id
+        * @params lu: pointer to the factorization of A (not singular)
+        * @return matrix_t* : pointer to the inverse
+    */
+    if(!lu)
+        errx(MATRIX_NULL_POINTER, "m_lu_inv: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(lu->singular)
+        errx(MATRIX_SINGULAR, "m_lu_inv: %s", MATRIX_SINGULAR_MESSAGE);
+
+    size_t n = lu->lu->row;
+    MATRIX_STAT(MATRIX_OP_INV, n * n, 2 * (uint64_t)n * n * n, 2 * (uint64_t)n * n * sizeof(MATRIX_TYPE));
+
+    matrix_t *result;
+    if(!(result = matrix_Id(n)))
+        return NULL;
+
+    m_lu_solvet(lu, result, result);
+    return result;
+}
+
+matrix_t* m_solve(const matrix_t *a, const matrix_t *b){
+    /*
+        * solve A*X = B (factorization of A, then two triangular solves)
+        * to solve against the same A several times, factor it once with matrix_lu and use m_lu_solve
+        * @params a: pointer to the square matrix A (not singular)
+        *         b: pointer to the right-hand sides, one per column
+        * @return matrix_t* : pointer to the solution X
+    */
+    if(!a || !b)
+        errx(MATRIX_NULL_POINTER, "m_solve: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(a->row != a->col || b->row != a->row)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_solve: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    matrix_lu_t *lu;
+    if(!(lu = matrix_lu(a)))
+        return NULL;
+
+    if(lu->singular)
+        errx(MATRIX_SINGULAR, "m_solve: %s", MATRIX_SINGULAR_MESSAGE);
+
+    matrix_t *result = m_lu_solve(lu, b);
+    matrix_lu_free(lu);
+    return result;
+}
+
+matrix_t* m_inv(const matrix_t *m1){
+    /*
+        * matrix inverse
+        * @params m1: pointer to the square matrix (not singular)
+        * @return matrix_t* : pointer to the inverse
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_inv: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(m1->row != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_inv: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    matrix_lu_t *lu;
+    if(!(lu = matrix_lu(m1)))
+        return NULL;
+
+    if(lu->singular)
+        errx(MATRIX_SINGULAR, "m_inv: %s", MATRIX_SINGULAR_MESSAGE);
+
+    matrix_t *result = m_lu_inv(lu);
+    matrix_lu_free(lu);
+    return result;
+}
+
+MATRIX_TYPE m_det(const matrix_t *m1){
+    /*
+        * matrix determinant
+        * @params m1: pointer to the square matrix
+        * @return MATRIX_TYPE : the determinant (0 for a singular matrix)
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_det: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(m1->row != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_det: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    matrix_lu_t *lu;
+    if(!(lu = matrix_lu(m1)))
+        errx(MATRIX_MEMORY_ERROR, "m_det: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+
+    MATRIX_TYPE det = lu->singular ? 0 : m_lu_det(lu);
+    matrix_lu_free(lu);
+    return det;
+}
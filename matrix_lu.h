@@ -0,0 +1,25 @@
+#pragma once
+
+/**
+ * @file matrix_lu.h
+ * @brief Triangular solves shared by the LU and QR solvers
+ *
+ * Internal header: operates on raw row-major storage with explicit leading
+ * dimensions, like the GEMM engine. X is solved in place by blocks of rows: the
+ * contribution of the blocks already solved is subtracted with one GEMM, then
+ * the block itself is solved row by row.
+ */
+
+#include <stddef.h>
+
+#include "matrix.h"
+
+// one set of kernels per element type family
+#define matrix_trsm_lower MATRIX_NAME(matrix_trsm_lower)
+#define matrix_trsm_upper MATRIX_NAME(matrix_trsm_upper)
+
+// X = L^-1 * X, L is n x n unit lower triangular (leading dimension ldl, diagonal not read), X is n x k (ldx)
+void matrix_trsm_lower(size_t n, size_t k, const MATRIX_TYPE *l, size_t ldl, MATRIX_TYPE *x, size_t ldx);
+
+// X = U^-1 * X, U is n x n upper triangular with a non-zero diagonal (leading dimension ldu), X is n x k (ldx)
+void matrix_trsm_upper(size_t n, size_t k, const MATRIX_TYPE *u, size_t ldu, MATRIX_TYPE *x, size_t ldx);
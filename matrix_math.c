@@ -0,0 +1,304 @@
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "matrix_math.h"
+#include "matrix_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MATH_X86 1
+#endif
+
+/*
+ * Scalar kernels: libm in double precision, also used by the integer family
+ * (truncated and saturated like the conversions of matrix_convert.c).
+ */
+#ifdef MATRIX_FAMILY_I32
+#define MATH_STORE(y) ((y) != (y) ? 0 : (y) >= 2147483647.0 ? INT32_MAX : (y) <= -2147483648.0 ? INT32_MIN : (int32_t)(y))
+#else
+#define MATH_STORE(y) ((MATRIX_TYPE)(y))
+#endif
+
+#define MATH_SCALAR(name, EXPR)                                                             \
+static void math_scalar_##name(const MATRIX_TYPE *in, MATRIX_TYPE *out, size_t n){          \
+    for(size_t i = 0; i < n; i++){                                                          \
+        double x = in[i], y = (EXPR);                                                       \
+        out[i] = MATH_STORE(y);                                                             \
+    }                                                                                       \
+}
+
+MATH_SCALAR(exp, exp(x))
+MATH_SCALAR(log, log(x))
+MATH_SCALAR(tanh, tanh(x))
+MATH_SCALAR(sigmoid, 1 / (1 + exp(-x)))
+MATH_SCALAR(relu, x > 0 ? x : 0)
+MATH_SCALAR(sqrt, sqrt(x))
+
+static const matrix_math_t math_scalar[] = {
+    math_scalar_exp, math_scalar_log, math_scalar_tanh, math_scalar_sigmoid, math_scalar_relu, math_scalar_sqrt
+};
+
+// vectors of 64 bytes (one zmm, two ymm or four xmm) and integers of the width of MATRIX_TYPE
+#define MATH_LANES (64 / sizeof(MATRIX_TYPE))
+#ifdef MATRIX_FAMILY_F64
+typedef int64_t math_int_t;
+#else
+typedef int32_t math_int_t;
+#endif
+typedef MATRIX_TYPE math_v __attribute__((vector_size(64)));
+typedef MATRIX_TYPE math_u __attribute__((vector_size(64), aligned(sizeof(MATRIX_TYPE))));
+typedef math_int_t math_i __attribute__((vector_size(64)));
+
+#define MATH_SPLAT(x) ((math_v){0} + (x))
+#define MATH_SEL(m, a, b) ((math_v)(((m) & (math_i)(a)) | (~(m) & (math_i)(b))))
+
+void matrix_math_clamp(const MATRIX_TYPE *in, MATRIX_TYPE *out, size_t n, MATRIX_TYPE lo, MATRIX_TYPE hi){
+    /*
+        * clamp each element to [lo, hi]
+        * @params in, out: source and destination spans (possibly the same)
+        *         n: number of elements
+        *         lo, hi: bounds
+    */
+    math_v vlo = MATH_SPLAT(lo), vhi = MATH_SPLAT(hi);
+    size_t i = 0;
+    for(; i + MATH_LANES <= n; i += MATH_LANES){
+        math_v x = *(const math_u *)(in + i);
+        x = MATH_SEL(x < vlo, vlo, x);
+        *(math_u *)(out + i) = MATH_SEL(x > vhi, vhi, x);
+    }
+    for(; i < n; i++)
+        out[i] = in[i] < lo ? lo : in[i] > hi ? hi : in[i];
+}
+
+#if defined(MATH_X86) && !defined(MATRIX_FAMILY_I32)
+
+// the helpers below return 64 byte vectors (and take them by address); they are always
+// inlined into the per-ISA kernels, so the ABI of an out-of-line call does not matter
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+/*
+ * Vector approximations.
+ * exp: x = n ln2 + r with |r| <= ln2/2 (ln2 split in two so that n ln2 is exact),
+ * e^r - 1 by its Taylor series, 2^n built in the exponent field in two halves so
+ * that neither overflows before the final product.
+ * log: x = 2^e m with m in [sqrt(1/2), sqrt(2)), f = m - 1, s = f / (2 + f) and
+ * log(m) = 2 atanh(s) = 2s + 2s (s^2/3 + s^4/5 + ...).
+ * tanh: expm1(2|x|) / (expm1(2|x|) + 2), accurate near zero, with the sign of x.
+ */
+#ifdef MATRIX_FAMILY_F64
+#define MATH_MANT 52
+#define MATH_BIAS 1023
+#define MATH_EXPMASK 0x7ff
+#define MATH_SIGN INT64_MIN
+#define MATH_MAGIC 6755399441055744.0       // 1.5 * 2^52: adding it rounds to an integer held in the low bits
+#define MATH_2P_MANT 4503599627370496.0     // 2^52
+#define MATH_LOG2E 1.44269504088896340736
+#define MATH_LN2_HI 6.93145751953125e-1
+#define MATH_LN2_LO 1.42860682030941723212e-6
+#define MATH_EXP_LO -746.0                  // below: 0
+#define MATH_EXP_HI 709.782712893384        // above: inf
+#define MATH_TANH_HI 20.0                   // above: +-1
+#define MATH_MIN_NORMAL 2.2250738585072014e-308
+#define MATH_SQRT2 1.41421356237309504880
+#define MATH_EXP_DEG 13
+#define MATH_EXP_DEG_FAST 8
+#define MATH_LOG_DEG 10
+#define MATH_LOG_DEG_FAST 5
+#else
+#define MATH_MANT 23
+#define MATH_BIAS 127
+#define MATH_EXPMASK 0xff
+#define MATH_SIGN INT32_MIN
+#define MATH_MAGIC 12582912.0f              // 1.5 * 2^23
+#define MATH_2P_MANT 8388608.0f             // 2^23
+#define MATH_LOG2E 1.44269504088896340736f
+#define MATH_LN2_HI 0.693359375f
+#define MATH_LN2_LO -2.12194440e-4f
+#define MATH_EXP_LO -104.0f
+#define MATH_EXP_HI 88.7228391f
+#define MATH_TANH_HI 10.0f
+#define MATH_MIN_NORMAL 1.17549435e-38f
+#define MATH_SQRT2 1.41421356f
+#define MATH_EXP_DEG 7
+#define MATH_EXP_DEG_FAST 5
+#define MATH_LOG_DEG 4
+#define MATH_LOG_DEG_FAST 2
+#endif
+
+// 1/k!
+static const MATRIX_TYPE math_inv_fact[] = {
+    1., 1., 1./2, 1./6, 1./24, 1./120, 1./720, 1./5040, 1./40320, 1./362880, 1./3628800,
+    1./39916800, 1./479001600, 1./6227020800., 1./87178291200.
+};
+
+// 2^n, n within the normal exponent range
+#define MATH_POW2(n) ((math_v)(((n) + MATH_BIAS) << MATH_MANT))
+
+static inline __attribute__((always_inline)) math_v math_expq(const math_v *px, math_v *s1, math_v *s2, int deg){
+    /*
+        * e^x = s1 * s2 * (1 + q), returns q = e^r - 1
+        * x must lie in [MATH_EXP_LO, MATH_EXP_HI]
+    */
+    math_v x = *px;
+    math_v t = x * MATH_LOG2E + MATH_MAGIC;
+    math_v nf = t - MATH_MAGIC;
+    math_i n = (math_i)t - (math_i)MATH_SPLAT(MATH_MAGIC);
+    math_v r = x - nf * MATH_LN2_HI - nf * MATH_LN2_LO;
+
+    math_v p = MATH_SPLAT(math_inv_fact[deg]);
+    _Pragma("GCC unroll 16")
+    for(int k = deg - 1; k >= 1; k--)
+        p = p * r + math_inv_fact[k];
+
+    math_i h = n >> 1;
+    *s1 = MATH_POW2(h);
+    *s2 = MATH_POW2(n - h);
+    return p * r;
+}
+
+static inline __attribute__((always_inline)) math_v math_exp(const math_v *px, int deg){
+    math_v x = *px;
+    math_v lo = MATH_SPLAT(MATH_EXP_LO), hi = MATH_SPLAT(MATH_EXP_HI);
+    math_v xc = MATH_SEL(x < lo, lo, x);
+    xc = MATH_SEL(xc > hi, hi, xc);
+
+    math_v s1, s2, q = math_expq(&xc, &s1, &s2, deg);
+    math_v y = (s1 + s1 * q) * s2;
+    y = MATH_SEL(x > hi, MATH_SPLAT(INFINITY), y);
+    return MATH_SEL(x < lo, MATH_SPLAT(0), y);
+}
+
+static inline __attribute__((always_inline)) math_v math_log(const math_v *px, int deg){
+    math_v x = *px;
+    // subnormals are scaled into the normal range first
+    math_i sub = x < MATH_MIN_NORMAL;
+    math_i bits = (math_i)MATH_SEL(sub, x * MATH_2P_MANT, x);
+    math_i e = ((bits >> MATH_MANT) & MATH_EXPMASK) - MATH_BIAS - (sub & MATH_MANT);
+    math_v m = (math_v)((bits & (((math_int_t)1 << MATH_MANT) - 1)) | ((math_int_t)MATH_BIAS << MATH_MANT));
+
+    math_i big = m > MATH_SQRT2;
+    m = MATH_SEL(big, m * (MATRIX_TYPE)0.5, m);
+    e -= big;
+
+    math_v f = m - 1;
+    math_v s = f / (f + 2);
+    math_v z = s * s;
+    math_v p = MATH_SPLAT((MATRIX_TYPE)1 / (2*deg + 1));
+    _Pragma("GCC unroll 16")
+    for(int k = deg - 1; k >= 1; k--)
+        p = p * z + (MATRIX_TYPE)1 / (2*k + 1);
+
+    // e as a floating point value, through the same magic constant as math_expq
+    math_v ef = (math_v)(e + (math_i)MATH_SPLAT(MATH_MAGIC)) - MATH_MAGIC;
+    math_v y = ef * MATH_LN2_HI + ((f - s * (f - 2 * z * p)) + ef * MATH_LN2_LO);
+
+    y = MATH_SEL(x == 0, MATH_SPLAT(-INFINITY), y);
+    y = MATH_SEL(x < 0, MATH_SPLAT(NAN), y);
+    y = MATH_SEL(x == INFINITY, x, y);
+    return MATH_SEL(x != x, x, y);
+}
+
+static inline __attribute__((always_inline)) math_v math_tanh(const math_v *px, int deg){
+    math_v x = *px;
+    math_i sign = (math_i)x & MATH_SIGN;
+    math_v a = (math_v)((math_i)x & ~sign);
+    a = MATH_SEL(a > MATH_TANH_HI, MATH_SPLAT(MATH_TANH_HI), a);
+    a += a;
+
+    math_v s1, s2, q = math_expq(&a, &s1, &s2, deg);
+    math_v s = s1 * s2;
+    math_v e = (s - 1) + s * q;
+    return (math_v)((math_i)(e / (e + 2)) | sign);
+}
+
+/*
+ * Span kernels: whole vectors, then the tail through a zero padded vector so
+ * that every element gets the same approximation.
+ */
+#define MATH_SPAN(name, attr, EXPR)                                                         \
+attr static void name(const MATRIX_TYPE *in, MATRIX_TYPE *out, size_t n){                   \
+    size_t i = 0;                                                                           \
+    for(; i + MATH_LANES <= n; i += MATH_LANES){                                            \
+        math_v x = *(const math_u *)(in + i);                                               \
+        *(math_u *)(out + i) = EXPR;                                                        \
+    }                                                                                       \
+    if(i < n){                                                                              \
+        math_v x = {0};                                                                     \
+        memcpy(&x, in + i, (n - i) * sizeof(MATRIX_TYPE));                                  \
+        x = EXPR;                                                                           \
+        memcpy(out + i, &x, (n - i) * sizeof(MATRIX_TYPE));                                 \
+    }                                                                                       \
+}
+
+#ifdef MATRIX_FAMILY_F64
+#define MATH_SQRT_sse2 __m128d, _mm_sqrt_pd
+#define MATH_SQRT_avx2 __m256d, _mm256_sqrt_pd
+#define MATH_SQRT_avx512 __m512d, _mm512_sqrt_pd
+#else
+#define MATH_SQRT_sse2 __m128, _mm_sqrt_ps
+#define MATH_SQRT_avx2 __m256, _mm256_sqrt_ps
+#define MATH_SQRT_avx512 __m512, _mm512_sqrt_ps
+#endif
+
+// square root of each lane, with the native register W and instruction FN of the instruction set
+#define MATH_SQRT(name, attr, W, FN)                                                        \
+attr static inline math_v name(const math_v *x){                                            \
+    union { math_v v; W w[sizeof(math_v) / sizeof(W)]; } u = { *x };                        \
+    for(size_t k = 0; k < sizeof(math_v) / sizeof(W); k++)                                  \
+        u.w[k] = FN(u.w[k]);                                                                \
+    return u.v;                                                                             \
+}
+#define MATH_SQRT_(name, attr, args) MATH_SQRT(name, attr, args)
+
+// MATH_KERNELS(isa, attr) defines the kernel table math_isa, compiled with the function attributes attr
+#define MATH_KERNELS(isa, attr)                                                             \
+MATH_SQRT_(isa##_vsqrt, attr, MATH_SQRT_##isa)                                              \
+MATH_SPAN(isa##_exp, attr, math_exp(&x, MATH_EXP_DEG))                                      \
+MATH_SPAN(isa##_exp_fast, attr, math_exp(&x, MATH_EXP_DEG_FAST))                            \
+MATH_SPAN(isa##_log, attr, math_log(&x, MATH_LOG_DEG))                                      \
+MATH_SPAN(isa##_log_fast, attr, math_log(&x, MATH_LOG_DEG_FAST))                            \
+MATH_SPAN(isa##_tanh, attr, math_tanh(&x, MATH_EXP_DEG))                                    \
+MATH_SPAN(isa##_tanh_fast, attr, math_tanh(&x, MATH_EXP_DEG_FAST))                          \
+MATH_SPAN(isa##_sigmoid, attr, (x = -x, 1 / (1 + math_exp(&x, MATH_EXP_DEG))))              \
+MATH_SPAN(isa##_sigmoid_fast, attr, (x = -x, 1 / (1 + math_exp(&x, MATH_EXP_DEG_FAST))))    \
+MATH_SPAN(isa##_relu, attr, MATH_SEL(x > 0, x, MATH_SPLAT(0)))                              \
+MATH_SPAN(isa##_sqrt, attr, isa##_vsqrt(&x))                                                \
+                                                                                            \
+static const matrix_math_t math_##isa[2][6] = {                                             \
+    { isa##_exp, isa##_log, isa##_tanh, isa##_sigmoid, isa##_relu, isa##_sqrt },            \
+    { isa##_exp_fast, isa##_log_fast, isa##_tanh_fast, isa##_sigmoid_fast, isa##_relu, isa##_sqrt } \
+};
+
+MATH_KERNELS(sse2, __attribute__((target("sse2"))))
+MATH_KERNELS(avx2, __attribute__((target("avx2"))))
+MATH_KERNELS(avx512, __attribute__((target("avx512f"))))
+
+#define MATH_VECTOR 1
+#endif
+
+matrix_math_t matrix_math(matrix_fn_t fn){
+    /*
+        * span kernel of a built-in function
+        * @params fn: MATRIX_FN_* function, optionally | MATRIX_FN_FAST
+        * @return matrix_math_t : kernel for the instruction set selected at startup, NULL if fn is unknown
+    */
+    unsigned f = fn & ~MATRIX_FN_FAST, fast = !!(fn & MATRIX_FN_FAST);
+    if(f > MATRIX_FN_SQRT)
+        return NULL;
+
+#ifdef MATH_VECTOR
+    switch(matrix_simd->level){
+    case MATRIX_SIMD_AVX512:
+        return math_avx512[fast][f];
+    case MATRIX_SIMD_AVX2:
+        return math_avx2[fast][f];
+    case MATRIX_SIMD_SSE2:
+        return math_sse2[fast][f];
+    default:
+        break;
+    }
+#endif
+    (void)fast;
+    return math_scalar[f];
+}
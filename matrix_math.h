@@ -0,0 +1,34 @@
+#pragma once
+
+/**
+ * @file matrix_math.h
+ * @brief Vectorized element-wise functions used by m_map / m_clamp and the GEMM epilogue
+ *
+ * Internal header: each built-in function is a span kernel out[i] = f(in[i]).
+ * The floating point families evaluate exp, log, tanh and sigmoid with SIMD
+ * range reduction and polynomial approximations instead of one libm call per
+ * element:
+ * - precise: within a couple of ulp of the correctly rounded result
+ * - fast (MATRIX_FN_FAST): lower degree polynomials, relative error below
+ *   1e-5 (f32) / 1e-9 (f64)
+ * The scalar kernel table and the integer family use libm (computed in double
+ * and truncated for integers).
+ */
+
+#include <stddef.h>
+
+#include "matrix.h"
+
+// one set of kernels per element type family
+#define matrix_math       MATRIX_NAME(matrix_math)
+#define matrix_math_clamp MATRIX_NAME(matrix_math_clamp)
+
+// out[i] = f(in[i]), in may equal out
+typedef void (*matrix_math_t)(const MATRIX_TYPE *in, MATRIX_TYPE *out, size_t n);
+
+// span kernel of the built-in function fn (MATRIX_FN_*, optionally | MATRIX_FN_FAST) for the host
+// instruction set, NULL if fn is not a built-in function
+matrix_math_t matrix_math(matrix_fn_t fn);
+
+// out[i] = in[i] clamped to [lo, hi], in may equal out
+void matrix_math_clamp(const MATRIX_TYPE *in, MATRIX_TYPE *out, size_t n, MATRIX_TYPE lo, MATRIX_TYPE hi);
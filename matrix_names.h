@@ -0,0 +1,160 @@
+#pragma once
+
+/**
+ * @file matrix_names.h
+ * @brief Names of the element type families
+ *
+ * Every type dependent name of the library is a macro resolved through the
+ * MATRIX_NAME / MATRIX_TNAME of the family in effect: with the f32 family they
+ * map to themselves (m_add, matrix_t), with the f64 family to m_add_f64 and
+ * matrix_f64_t, and so on. The definitions do not depend on the family, so they
+ * stay valid while matrix.h switches from one family to the next.
+ *
+ * A name added to matrix_family.h must be added here too.
+ */
+
+#define matrix_t MATRIX_TNAME(matrix)
+#define matrix_batch_t MATRIX_TNAME(matrix_batch)
+#define matrix_reduce_t MATRIX_TNAME(matrix_reduce)
+#define matrix_csr_t MATRIX_TNAME(matrix_csr)
+#define matrix_coo_t MATRIX_TNAME(matrix_coo)
+#define matrix_lu_t MATRIX_TNAME(matrix_lu)
+#define matrix_qr_t MATRIX_TNAME(matrix_qr)
+
+#define matrix_init      MATRIX_NAME(matrix_init)
+#define matrix_of        MATRIX_NAME(matrix_of)
+#define matrix_Id        MATRIX_NAME(matrix_Id)
+#define matrix_nId       MATRIX_NAME(matrix_nId)
+#define matrix_get       MATRIX_NAME(matrix_get)
+#define matrix_set       MATRIX_NAME(matrix_set)
+#define matrix_get_unchecked MATRIX_NAME(matrix_get_unchecked)
+#define matrix_set_unchecked MATRIX_NAME(matrix_set_unchecked)
+#define matrix_row       MATRIX_NAME(matrix_row)
+#define matrix_get_data  MATRIX_NAME(matrix_get_data)
+#define matrix_set_data  MATRIX_NAME(matrix_set_data)
+#define matrix_gather    MATRIX_NAME(matrix_gather)
+#define matrix_scatter   MATRIX_NAME(matrix_scatter)
+#define matrix_get_diag  MATRIX_NAME(matrix_get_diag)
+#define matrix_set_diag  MATRIX_NAME(matrix_set_diag)
+#define matrix_copyto    MATRIX_NAME(matrix_copyto)
+#define matrix_getcpy    MATRIX_NAME(matrix_getcpy)
+#define matrix_free      MATRIX_NAME(matrix_free)
+#define matrix_view      MATRIX_NAME(matrix_view)
+#define matrix_view_rows MATRIX_NAME(matrix_view_rows)
+#define matrix_view_data MATRIX_NAME(matrix_view_data)
+#define matrix_batch     MATRIX_NAME(matrix_batch)
+#define matrix_batch_at  MATRIX_NAME(matrix_batch_at)
+#define m_add            MATRIX_NAME(m_add)
+#define m_addp           MATRIX_NAME(m_addp)
+#define m_addt           MATRIX_NAME(m_addt)
+#define m_addt_unchecked MATRIX_NAME(m_addt_unchecked)
+#define m_kadd           MATRIX_NAME(m_kadd)
+#define m_kaddp          MATRIX_NAME(m_kaddp)
+#define m_kaddt          MATRIX_NAME(m_kaddt)
+#define m_kaddt_unchecked MATRIX_NAME(m_kaddt_unchecked)
+#define m_sub            MATRIX_NAME(m_sub)
+#define m_subp           MATRIX_NAME(m_subp)
+#define m_subt           MATRIX_NAME(m_subt)
+#define m_subt_unchecked MATRIX_NAME(m_subt_unchecked)
+#define m_ksub           MATRIX_NAME(m_ksub)
+#define m_ksubp          MATRIX_NAME(m_ksubp)
+#define m_ksubt          MATRIX_NAME(m_ksubt)
+#define m_mul            MATRIX_NAME(m_mul)
+#define m_mult           MATRIX_NAME(m_mult)
+#define m_mult_unchecked MATRIX_NAME(m_mult_unchecked)
+#define m_gemm           MATRIX_NAME(m_gemm)
+#define m_gemmt          MATRIX_NAME(m_gemmt)
+#define m_gemv           MATRIX_NAME(m_gemv)
+#define m_gemvt          MATRIX_NAME(m_gemvt)
+#define m_mult_batched   MATRIX_NAME(m_mult_batched)
+#define m_pow            MATRIX_NAME(m_pow)
+#define m_powp           MATRIX_NAME(m_powp)
+#define m_powt           MATRIX_NAME(m_powt)
+#define m_kmul           MATRIX_NAME(m_kmul)
+#define m_kmulp          MATRIX_NAME(m_kmulp)
+#define m_kmult          MATRIX_NAME(m_kmult)
+#define m_kmult_unchecked MATRIX_NAME(m_kmult_unchecked)
+#define m_kdiv           MATRIX_NAME(m_kdiv)
+#define m_kdivp          MATRIX_NAME(m_kdivp)
+#define m_kdivt          MATRIX_NAME(m_kdivt)
+#define m_dot            MATRIX_NAME(m_dot)
+#define m_dot_unchecked  MATRIX_NAME(m_dot_unchecked)
+#define m_dotd           MATRIX_NAME(m_dotd)
+#define m_transp         MATRIX_NAME(m_transp)
+#define m_transpt        MATRIX_NAME(m_transpt)
+#define m_transpp        MATRIX_NAME(m_transpp)
+#define m_sumfd          MATRIX_NAME(m_sumfd)
+#define m_sumfdt         MATRIX_NAME(m_sumfdt)
+#define m_mulfd          MATRIX_NAME(m_mulfd)
+#define m_mulfdt         MATRIX_NAME(m_mulfdt)
+#define m_minfd          MATRIX_NAME(m_minfd)
+#define m_minfdt         MATRIX_NAME(m_minfdt)
+#define m_maxfd          MATRIX_NAME(m_maxfd)
+#define m_maxfdt         MATRIX_NAME(m_maxfdt)
+#define m_meanfd         MATRIX_NAME(m_meanfd)
+#define m_meanfdt        MATRIX_NAME(m_meanfdt)
+#define m_reduce         MATRIX_NAME(m_reduce)
+#define m_apply          MATRIX_NAME(m_apply)
+#define m_applyp         MATRIX_NAME(m_applyp)
+#define m_applyt         MATRIX_NAME(m_applyt)
+#define m_applys         MATRIX_NAME(m_applys)
+#define m_applysp        MATRIX_NAME(m_applysp)
+#define m_applyst        MATRIX_NAME(m_applyst)
+#define m_map            MATRIX_NAME(m_map)
+#define m_mapp           MATRIX_NAME(m_mapp)
+#define m_mapt           MATRIX_NAME(m_mapt)
+#define m_clamp          MATRIX_NAME(m_clamp)
+#define m_clampp         MATRIX_NAME(m_clampp)
+#define m_clampt         MATRIX_NAME(m_clampt)
+#define matrix_coo_init  MATRIX_NAME(matrix_coo_init)
+#define matrix_coo_push  MATRIX_NAME(matrix_coo_push)
+#define matrix_csr_from  MATRIX_NAME(matrix_csr_from)
+#define matrix_csr_from_coo MATRIX_NAME(matrix_csr_from_coo)
+#define matrix_coo_from  MATRIX_NAME(matrix_coo_from)
+#define matrix_coo_from_csr MATRIX_NAME(matrix_coo_from_csr)
+#define matrix_csr_to    MATRIX_NAME(matrix_csr_to)
+#define matrix_csr_copyto MATRIX_NAME(matrix_csr_copyto)
+#define matrix_coo_to    MATRIX_NAME(matrix_coo_to)
+#define matrix_csr_getcpy MATRIX_NAME(matrix_csr_getcpy)
+#define matrix_csr_get   MATRIX_NAME(matrix_csr_get)
+#define matrix_csr_free  MATRIX_NAME(matrix_csr_free)
+#define matrix_coo_free  MATRIX_NAME(matrix_coo_free)
+#define m_spmul          MATRIX_NAME(m_spmul)
+#define m_spmult         MATRIX_NAME(m_spmult)
+#define m_spmv           MATRIX_NAME(m_spmv)
+#define m_spmvt          MATRIX_NAME(m_spmvt)
+#define m_spspmul        MATRIX_NAME(m_spspmul)
+#define m_sppow          MATRIX_NAME(m_sppow)
+#define matrix_save      MATRIX_NAME(matrix_save)
+#define matrix_load      MATRIX_NAME(matrix_load)
+#define matrix_mmap      MATRIX_NAME(matrix_mmap)
+#define m_mul_file       MATRIX_NAME(m_mul_file)
+#define m_add_file       MATRIX_NAME(m_add_file)
+#define m_sub_file       MATRIX_NAME(m_sub_file)
+#define m_kmul_file      MATRIX_NAME(m_kmul_file)
+#define m_map_file       MATRIX_NAME(m_map_file)
+#define matrix_lu        MATRIX_NAME(matrix_lu)
+#define matrix_lu_free   MATRIX_NAME(matrix_lu_free)
+#define m_lu_solve       MATRIX_NAME(m_lu_solve)
+#define m_lu_solvet      MATRIX_NAME(m_lu_solvet)
+#define m_lu_inv         MATRIX_NAME(m_lu_inv)
+#define m_lu_det         MATRIX_NAME(m_lu_det)
+#define m_solve          MATRIX_NAME(m_solve)
+#define m_inv            MATRIX_NAME(m_inv)
+#define m_det            MATRIX_NAME(m_det)
+#define matrix_qr        MATRIX_NAME(matrix_qr)
+#define matrix_qr_free   MATRIX_NAME(matrix_qr_free)
+#define m_qr_q           MATRIX_NAME(m_qr_q)
+#define m_qr_r           MATRIX_NAME(m_qr_r)
+#define m_qr_solve       MATRIX_NAME(m_qr_solve)
+#define m_lstsq          MATRIX_NAME(m_lstsq)
+#define m_tsqr           MATRIX_NAME(m_tsqr)
+#define m_tsqr_solve     MATRIX_NAME(m_tsqr_solve)
+#define m_mult_async     MATRIX_NAME(m_mult_async)
+#define m_addt_async     MATRIX_NAME(m_addt_async)
+#define m_subt_async     MATRIX_NAME(m_subt_async)
+#define m_kmult_async    MATRIX_NAME(m_kmult_async)
+#define m_transpt_async  MATRIX_NAME(m_transpt_async)
+#define m_applyt_async   MATRIX_NAME(m_applyt_async)
+#define m_mapt_async     MATRIX_NAME(m_mapt_async)
+#define m_reduce_async   MATRIX_NAME(m_reduce_async)
@@ -0,0 +1,611 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <err.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+#include "matrix.h"
+#include "matrix_gemm.h"
+#include "matrix_io.h"
+#include "matrix_math.h"
+#include "matrix_stats.h"
+#include "state.h"
+
+/*
+ * Out-of-core operations on matrix files (format in matrix_io.h).
+ *
+ * The operands never have to fit in memory: they are streamed through tile
+ * buffers whose total size stays within matrix_get_ooc_budget().
+ * - Every step reads its input tiles into one of two buffer slots. While a
+ *   step computes on one slot, the read-ahead thread of the operation fills
+ *   the other with the tiles of the next step, so reading overlaps computing.
+ * - GEMM walks the tiles of C; each one accumulates the products of a row
+ *   panel of A and a column panel of B, tile by tile along k, with the
+ *   in-memory GEMM kernel, and is written once complete.
+ * - Element-wise operations walk both operands in the same order, compute in
+ *   place in the tile of the first one and write it out.
+ * The result is written to a temporary file next to it and renamed over it at
+ * the end, so an operand may also be the result and a failed operation leaves
+ * no partial file behind.
+ */
+
+// default memory budget
+#define OOC_DEFAULT_BUDGET ((size_t)256 << 20)
+
+// GEMM tile sides are multiples of this
+#define OOC_TILE_ROUND 16
+
+// buffers of a GEMM: two slots of an A and a B tile, and the C tile
+#define OOC_GEMM_TILES 5
+
+// the budget is shared by the element type families: only the f32 object defines it
+#if !defined(MATRIX_FAMILY_F64) && !defined(MATRIX_FAMILY_I32)
+
+static _Atomic size_t ooc_budget;
+
+static size_t ooc_default_budget(void){
+    const char *env = getenv("MATRIX_OOC_BUDGET");
+    if(env && atoll(env) > 0)
+        return (size_t)atoll(env);
+    return OOC_DEFAULT_BUDGET;
+}
+
+void matrix_set_ooc_budget(size_t bytes){
+    /*
+        * set the memory budget of the out-of-core operations
+        * @params bytes: budget, 0 restores the default (MATRIX_OOC_BUDGET, or 256 MiB)
+    */
+    atomic_store_explicit(&ooc_budget, bytes ? bytes : ooc_default_budget(), memory_order_relaxed);
+}
+
+size_t matrix_get_ooc_budget(void){
+    /*
+        * memory budget of the out-of-core operations
+        * @return size_t : budget in bytes
+    */
+    size_t bytes = atomic_load_explicit(&ooc_budget, memory_order_relaxed);
+    return bytes ? bytes : ooc_default_budget();
+}
+
+#endif
+
+// a file operand: descriptor and header
+typedef struct {
+    int fd;
+    io_header_t h;
+}ooc_file_t;
+
+static int ooc_io(const ooc_file_t *f, int write, size_t i, size_t j, size_t m, size_t n, MATRIX_TYPE *buf){
+    /*
+        * transfer the block of rows [i, i+m) and columns [j, j+n) between a file and buf (leading dimension n)
+        * @params write: 0 to read the block into buf, 1 to write buf to the file
+        * @return int : 0 on success, -1 with errno set on failure
+    */
+    // packed rows are one contiguous range
+    size_t rows = m, len = n * sizeof(MATRIX_TYPE);
+    if(n == f->h.col && f->h.stride == f->h.col){
+        rows = m ? 1 : 0;
+        len *= m;
+    }
+
+    for(size_t r = 0; r < rows; r++){
+        char *p = (char *)(buf + r * n);
+        off_t at = (off_t)(f->h.offset + ((i + r) * f->h.stride + j) * sizeof(MATRIX_TYPE));
+        for(size_t done = 0; done < len;){
+            ssize_t k = write ? pwrite(f->fd, p + done, len - done, at + (off_t)done)
+                              : pread(f->fd, p + done, len - done, at + (off_t)done);
+            if(k <= 0){
+                if(!k)
+                    errno = EIO;
+                return -1;
+            }
+            done += (size_t)k;
+        }
+    }
+    return 0;
+}
+
+// tiles of one step
+typedef struct {
+    const ooc_file_t *f[2];
+    size_t i[2], j[2], m[2], n[2];
+    MATRIX_TYPE *buf[2];
+    size_t count;
+}ooc_fetch_t;
+
+// state of a buffer slot
+typedef enum{
+    OOC_SLOT_IDLE,
+    OOC_SLOT_POSTED,    // waiting for the read-ahead thread
+    OOC_SLOT_DONE       // tiles read, or err set
+}ooc_slot_t;
+
+// read-ahead thread of one operation, fed with the steps through the two slots in turn
+typedef struct {
+    ooc_fetch_t slot[2];
+    ooc_slot_t state[2];
+    int err[2];
+    size_t next;
+    int threaded;
+    int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+}ooc_reader_t;
+
+static int ooc_fetch_read(const ooc_fetch_t *f){
+    // read the tiles of a step, 0 on success, errno on failure
+    for(size_t t = 0; t < f->count; t++)
+        if(ooc_io(f->f[t], 0, f->i[t], f->j[t], f->m[t], f->n[t], f->buf[t]))
+            return errno;
+    return 0;
+}
+
+static void *ooc_reader_run(void *arg){
+    ooc_reader_t *r = arg;
+    pthread_mutex_lock(&r->lock);
+    for(;;){
+        while(!r->stop && r->state[r->next] != OOC_SLOT_POSTED)
+            pthread_cond_wait(&r->cond, &r->lock);
+        if(r->stop)
+            break;
+
+        size_t s = r->next;
+        pthread_mutex_unlock(&r->lock);
+        int err = ooc_fetch_read(&r->slot[s]);
+        pthread_mutex_lock(&r->lock);
+
+        r->err[s] = err;
+        r->state[s] = OOC_SLOT_DONE;
+        r->next = s ^ 1;
+        pthread_cond_broadcast(&r->cond);
+    }
+    pthread_mutex_unlock(&r->lock);
+    return NULL;
+}
+
+static void ooc_reader_start(ooc_reader_t *r){
+    // one thread for all the steps of an operation; without it, every step is read when posted
+    *r = (ooc_reader_t){ 0 };
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->cond, NULL);
+    r->threaded = !pthread_create(&r->thread, NULL, ooc_reader_run, r);
+}
+
+static void ooc_reader_post(ooc_reader_t *r, size_t s){
+    // hand the tiles filled in slot s to the thread; the steps go to the slots alternately
+    if(!r->threaded){
+        r->err[s] = ooc_fetch_read(&r->slot[s]);
+        r->state[s] = OOC_SLOT_DONE;
+        return;
+    }
+    pthread_mutex_lock(&r->lock);
+    r->state[s] = OOC_SLOT_POSTED;
+    pthread_cond_broadcast(&r->cond);
+    pthread_mutex_unlock(&r->lock);
+}
+
+static int ooc_reader_wait(ooc_reader_t *r, size_t s){
+    /*
+        * wait for the tiles of slot s
+        * @return int : 0 on success, -1 with errno set if a read failed
+    */
+    if(r->threaded){
+        pthread_mutex_lock(&r->lock);
+        while(r->state[s] != OOC_SLOT_DONE)
+            pthread_cond_wait(&r->cond, &r->lock);
+        r->state[s] = OOC_SLOT_IDLE;
+        pthread_mutex_unlock(&r->lock);
+    }else
+        r->state[s] = OOC_SLOT_IDLE;
+    if(r->err[s]){
+        errno = r->err[s];
+        return -1;
+    }
+    return 0;
+}
+
+static void ooc_reader_stop(ooc_reader_t *r){
+    // a failed step may leave the read of the next one running: it completes before the thread exits
+    if(r->threaded){
+        pthread_mutex_lock(&r->lock);
+        r->stop = 1;
+        pthread_cond_broadcast(&r->cond);
+        pthread_mutex_unlock(&r->lock);
+        pthread_join(r->thread, NULL);
+    }
+    pthread_cond_destroy(&r->cond);
+    pthread_mutex_destroy(&r->lock);
+}
+
+static int ooc_open(const char *path, ooc_file_t *f){
+    // open an operand, 0 on success, -1 with errno set on failure
+    size_t bytes;
+    return (f->fd = matrix_io_open(path, O_RDONLY, &f->h, &bytes)) < 0 ? -1 : 0;
+}
+
+static char *ooc_create(const char *path, size_t row, size_t col, ooc_file_t *f){
+    /*
+        * create the temporary file of a row x col result, filled with zeros
+        * @return char* : name of the temporary file, NULL with errno set on failure
+    */
+    size_t len = strlen(path);
+    char *tmp;
+    if(!(tmp = malloc(len + 8))){
+        errno = ENOMEM;
+        return NULL;
+    }
+    memcpy(tmp, path, len);
+    memcpy(tmp + len, ".XXXXXX", 8);
+
+    if((f->fd = mkstemp(tmp)) < 0){
+        free(tmp);
+        return NULL;
+    }
+
+    f->h = matrix_io_header(row, col);
+    if(fchmod(f->fd, 0644) || pwrite(f->fd, &f->h, sizeof(f->h), 0) != (ssize_t)sizeof(f->h) ||
+       ftruncate(f->fd, (off_t)(IO_ALIGN + row * col * sizeof(MATRIX_TYPE)))){
+        int saved = errno;
+        close(f->fd);
+        unlink(tmp);
+        free(tmp);
+        errno = saved;
+        return NULL;
+    }
+    return tmp;
+}
+
+static int ooc_finish(ooc_file_t *f, char *tmp, const char *path, int ok){
+    /*
+        * close the temporary result and move it to path if ok, remove it otherwise
+        * @return int : 0 on success, -1 with errno set on failure
+    */
+    int saved = errno;
+    if(close(f->fd))
+        ok = 0;
+    else if(ok && rename(tmp, path))
+        ok = 0;
+    else if(!ok)
+        errno = saved;
+
+    if(!ok){
+        saved = errno;
+        unlink(tmp);
+        errno = saved;
+    }
+    free(tmp);
+    return ok ? 0 : -1;
+}
+
+static size_t ooc_min(size_t a, size_t b){
+    return a < b ? a : b;
+}
+
+// tiling of an out-of-core GEMM
+typedef struct {
+    const ooc_file_t *a, *b;
+    size_t m, n, k;
+    size_t tm, tn, tk;
+    size_t nbi, nbj, nbk;
+    MATRIX_TYPE *buf;
+}ooc_gemm_t;
+
+static void ooc_gemm_step(const ooc_gemm_t *g, size_t s, size_t *bi, size_t *bj, size_t *bk){
+    // tile indices of step s: C tile (bi, bj), k tile bk varying fastest
+    *bk = s % g->nbk;
+    s /= g->nbk;
+    *bj = s % g->nbj;
+    *bi = s / g->nbj;
+}
+
+static void ooc_gemm_fetch(const ooc_gemm_t *g, size_t s, ooc_reader_t *r){
+    // start reading the A and B tiles of step s into slot s % 2
+    size_t bi, bj, bk;
+    ooc_gemm_step(g, s, &bi, &bj, &bk);
+    size_t mi = ooc_min(g->tm, g->m - bi * g->tm), kk = ooc_min(g->tk, g->k - bk * g->tk);
+    size_t nj = ooc_min(g->tn, g->n - bj * g->tn);
+    MATRIX_TYPE *slot = g->buf + (s % 2) * (g->tm * g->tk + g->tk * g->tn);
+
+    r->slot[s % 2] = (ooc_fetch_t){ { g->a, g->b }, { bi * g->tm, bk * g->tk }, { bk * g->tk, bj * g->tn },
+                                    { mi, kk }, { kk, nj }, { slot, slot + mi * kk }, 2 };
+    ooc_reader_post(r, s % 2);
+}
+
+int m_mul_file(const char *m1, const char *m2, const char *result){
+    /*
+        * out-of-core matrix multiplication of two matrix files
+        * @params m1: path of the first matrix
+        *         m2: path of the second matrix
+        *         result: path of the result, replaced if it exists (may be m1 or m2)
+        * @return int : 0 on success, -1 with errno set on failure
+    */
+    if(!m1 || !m2 || !result)
+        errx(MATRIX_NULL_POINTER, "m_mul_file: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    ooc_file_t a, b, c;
+    if(ooc_open(m1, &a))
+        return -1;
+    if(ooc_open(m2, &b)){
+        int saved = errno;
+        close(a.fd);
+        errno = saved;
+        return -1;
+    }
+
+    if(a.h.col != b.h.row)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_mul_file: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT_GEMM(MATRIX_OP_MUL_FILE, 1, a.h.row, b.h.col, a.h.col);
+
+    // square tiles of side t: OOC_GEMM_TILES t x t buffers fill the budget
+    size_t t = (size_t)sqrt((double)(matrix_get_ooc_budget() / sizeof(MATRIX_TYPE) / OOC_GEMM_TILES));
+    t = t < OOC_TILE_ROUND ? OOC_TILE_ROUND : t / OOC_TILE_ROUND * OOC_TILE_ROUND;
+
+    ooc_gemm_t g = { .a = &a, .b = &b, .m = a.h.row, .n = b.h.col, .k = a.h.col };
+    g.tm = ooc_min(t, g.m);
+    g.tn = ooc_min(t, g.n);
+    g.tk = ooc_min(t, g.k);
+    g.nbi = g.tm ? (g.m + g.tm - 1) / g.tm : 0;
+    g.nbj = g.tn ? (g.n + g.tn - 1) / g.tn : 0;
+    g.nbk = g.tk ? (g.k + g.tk - 1) / g.tk : 0;
+
+    // the result file starts as zeros, which is the product when k is 0
+    size_t tiles = 2 * (g.tm * g.tk + g.tk * g.tn);
+    char *tmp = NULL;
+    if(!(g.buf = malloc((tiles + g.tm * g.tn) * sizeof(MATRIX_TYPE) + 1)))
+        errno = ENOMEM;
+    else
+        tmp = ooc_create(result, g.m, g.n, &c);
+    if(!tmp){
+        int saved = errno;
+        free(g.buf);
+        close(a.fd);
+        close(b.fd);
+        errno = saved;
+        return -1;
+    }
+
+    MATRIX_TYPE *ctile = g.buf + tiles;
+    size_t steps = g.nbi * g.nbj * g.nbk;
+    ooc_reader_t r;
+    int ok = 1;
+
+    ooc_reader_start(&r);
+    if(steps)
+        ooc_gemm_fetch(&g, 0, &r);
+
+    for(size_t s = 0; s < steps; s++){
+        if(ooc_reader_wait(&r, s % 2)){
+            ok = 0;
+            break;
+        }
+
+        // the tiles of the next step are read while this one computes
+        const ooc_fetch_t *f = &r.slot[s % 2];
+        if(s + 1 < steps)
+            ooc_gemm_fetch(&g, s + 1, &r);
+
+        size_t bi, bj, bk, mi = f->m[0], kk = f->n[0], nj = f->n[1];
+        ooc_gemm_step(&g, s, &bi, &bj, &bk);
+        matrix_gemm(mi, nj, kk, 1, f->buf[0], kk, f->buf[1], nj, bk ? 1 : 0, ctile, nj);
+
+        if(bk == g.nbk - 1 && ooc_io(&c, 1, bi * g.tm, bj * g.tn, mi, nj, ctile)){
+            ok = 0;
+            break;
+        }
+    }
+
+    int saved = errno;
+    ooc_reader_stop(&r);
+    close(a.fd);
+    close(b.fd);
+    free(g.buf);
+    errno = saved;
+    return ooc_finish(&c, tmp, result, ok);
+}
+
+// element-wise operations
+typedef enum{
+    OOC_ADD,
+    OOC_SUB,
+    OOC_KMUL,
+    OOC_MAP
+}ooc_op_t;
+
+// tiling of an out-of-core element-wise operation
+typedef struct {
+    const ooc_file_t *f[2];
+    size_t count;
+    size_t row, col;
+    size_t tr, tc;
+    size_t nbj;
+    MATRIX_TYPE *buf;
+}ooc_map_t;
+
+static void ooc_map_fetch(const ooc_map_t *g, size_t s, ooc_reader_t *r){
+    // start reading the operand tiles of step s (tile (s / nbj, s % nbj)) into slot s % 2
+    size_t bi = s / g->nbj, bj = s % g->nbj;
+    size_t mi = ooc_min(g->tr, g->row - bi * g->tr), nj = ooc_min(g->tc, g->col - bj * g->tc);
+    MATRIX_TYPE *slot = g->buf + (s % 2) * g->count * g->tr * g->tc;
+
+    r->slot[s % 2] = (ooc_fetch_t){ { g->f[0], g->f[1] }, { bi * g->tr, bi * g->tr }, { bj * g->tc, bj * g->tc },
+                                    { mi, mi }, { nj, nj }, { slot, slot + mi * nj }, g->count };
+    ooc_reader_post(r, s % 2);
+}
+
+static void ooc_flatten(io_header_t *h){
+    // a file of packed rows seen as a single row
+    h->col *= h->row;
+    h->row = h->col ? 1 : 0;
+    h->stride = h->col;
+}
+
+static int ooc_map(const char *fname, ooc_op_t op, const char *m1, const char *m2, MATRIX_TYPE k,
+                   matrix_fn_t fn, const char *result){
+    /*
+        * out-of-core element-wise operation: result = m1 op m2, m1*k or fn(m1)
+        * @params m2: path of the second operand, NULL for the unary operations
+        * @return int : 0 on success, -1 with errno set on failure
+    */
+    size_t count = m2 ? 2 : 1;
+    ooc_file_t in[2], c;
+    for(size_t t = 0; t < count; t++)
+        if(ooc_open(t ? m2 : m1, &in[t])){
+            int saved = errno;
+            if(t)
+                close(in[0].fd);
+            errno = saved;
+            return -1;
+        }
+
+    if(m2 && (in[0].h.row != in[1].h.row || in[0].h.col != in[1].h.col))
+        errx(MATRIX_INVALID_DIMENSIONS, "%s: %s", fname, MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    if(op == OOC_MAP && !matrix_math(fn))
+        errx(MATRIX_INVALID_ARGUMENT, "%s: %s", fname, MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    MATRIX_STAT_MAP(MATRIX_OP_MAP_FILE, in[0].h.row * in[0].h.col, op == OOC_MAP ? 0 : 1, count + 1);
+
+    size_t row = in[0].h.row, col = in[0].h.col;
+    char *tmp;
+    if(!(tmp = ooc_create(result, row, col, &c))){
+        int saved = errno;
+        for(size_t t = 0; t < count; t++)
+            close(in[t].fd);
+        errno = saved;
+        return -1;
+    }
+
+    // packed operands are streamed as one long row, so the tiles do not depend on the row length
+    int packed = 1;
+    for(size_t t = 0; t < count; t++)
+        packed &= in[t].h.row <= 1 || in[t].h.stride == in[t].h.col;
+    if(packed){
+        for(size_t t = 0; t < count; t++)
+            ooc_flatten(&in[t].h);
+        ooc_flatten(&c.h);
+        row = c.h.row;
+        col = c.h.col;
+    }
+
+    // two slots of count tiles of e elements fill the budget; whole rows when they fit
+    size_t e = matrix_get_ooc_budget() / sizeof(MATRIX_TYPE) / (2 * count);
+    e = e ? e : 1;
+    ooc_map_t g = { .f = { &in[0], &in[1] }, .count = count, .row = row, .col = col };
+    g.tc = ooc_min(col, e);
+    g.tr = g.tc && g.tc == col ? ooc_min(row, e / col) : 1;
+    g.nbj = g.tc ? (col + g.tc - 1) / g.tc : 0;
+
+    size_t steps = g.tr ? (row + g.tr - 1) / g.tr * g.nbj : 0;
+    ooc_reader_t r;
+    int ok = 1;
+
+    ooc_reader_start(&r);
+    if(!(g.buf = malloc(2 * count * g.tr * g.tc * sizeof(MATRIX_TYPE) + 1))){
+        errno = ENOMEM;
+        ok = 0;
+    }else if(steps)
+        ooc_map_fetch(&g, 0, &r);
+
+    for(size_t s = 0; ok && s < steps; s++){
+        if(ooc_reader_wait(&r, s % 2)){
+            ok = 0;
+            break;
+        }
+
+        const ooc_fetch_t *f = &r.slot[s % 2];
+        if(s + 1 < steps)
+            ooc_map_fetch(&g, s + 1, &r);
+
+        // computed in place in the tile of m1, then written out
+        matrix_t x = matrix_view_data(f->buf[0], f->m[0], f->n[0], f->n[0]);
+        matrix_t y = matrix_view_data(f->buf[1], f->m[0], f->n[0], f->n[0]);
+        switch(op){
+            case OOC_ADD:
+                m_addp(&x, &y);
+                break;
+            case OOC_SUB:
+                m_subp(&x, &y);
+                break;
+            case OOC_KMUL:
+                m_kmulp(&x, k);
+                break;
+            case OOC_MAP:
+                m_mapp(&x, fn);
+                break;
+        }
+
+        if(ooc_io(&c, 1, f->i[0], f->j[0], f->m[0], f->n[0], f->buf[0])){
+            ok = 0;
+            break;
+        }
+    }
+
+    int saved = errno;
+    ooc_reader_stop(&r);
+    for(size_t t = 0; t < count; t++)
+        close(in[t].fd);
+    free(g.buf);
+    errno = saved;
+    return ooc_finish(&c, tmp, result, ok);
+}
+
+int m_add_file(const char *m1, const char *m2, const char *result){
+    /*
+        * out-of-core matrix addition of two matrix files
+        * @params m1: path of the first matrix
+        *         m2: path of the second matrix
+        *         result: path of the result, replaced if it exists (may be m1 or m2)
+        * @return int : 0 on success, -1 with errno set on failure
+    */
+    if(!m1 || !m2 || !result)
+        errx(MATRIX_NULL_POINTER, "m_add_file: %s", MATRIX_NULL_POINTER_MESSAGE);
+    return ooc_map("m_add_file", OOC_ADD, m1, m2, 0, 0, result);
+}
+
+int m_sub_file(const char *m1, const char *m2, const char *result){
+    /*
+        * out-of-core matrix subtraction of two matrix files
+        * @params m1: path of the first matrix
+        *         m2: path of the second matrix
+        *         result: path of the result, replaced if it exists (may be m1 or m2)
+        * @return int : 0 on success, -1 with errno set on failure
+    */
+    if(!m1 || !m2 || !result)
+        errx(MATRIX_NULL_POINTER, "m_sub_file: %s", MATRIX_NULL_POINTER_MESSAGE);
+    return ooc_map("m_sub_file", OOC_SUB, m1, m2, 0, 0, result);
+}
+
+int m_kmul_file(const char *m1, MATRIX_TYPE k, const char *result){
+    /*
+        * out-of-core scalar multiplication of a matrix file
+        * @params m1: path of the matrix
+        *         k: scalar
+        *         result: path of the result, replaced if it exists (may be m1)
+        * @return int : 0 on success, -1 with errno set on failure
+    */
+    if(!m1 || !result)
+        errx(MATRIX_NULL_POINTER, "m_kmul_file: %s", MATRIX_NULL_POINTER_MESSAGE);
+    return ooc_map("m_kmul_file", OOC_KMUL, m1, NULL, k, 0, result);
+}
+
+int m_map_file(const char *m1, matrix_fn_t fn, const char *result){
+    /*
+        * out-of-core application of a built-in function to a matrix file
+        * @params m1: path of the matrix
+        *         fn: MATRIX_FN_* function, optionally | MATRIX_FN_FAST
+        *         result: path of the result, replaced if it exists (may be m1)
+        * @return int : 0 on success, -1 with errno set on failure
+    */
+    if(!m1 || !result)
+        errx(MATRIX_NULL_POINTER, "m_map_file: %s", MATRIX_NULL_POINTER_MESSAGE);
+    return ooc_map("m_map_file", OOC_MAP, m1, NULL, 0, fn, result);
+}
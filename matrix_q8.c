@@ -0,0 +1,796 @@
+#include <err.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "matrix.h"
+#include "matrix_alloc.h"
+#include "matrix_simd.h"
+#include "matrix_stats.h"
+#include "matrix_thread.h"
+#include "state.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define Q8_X86 1
+#endif
+
+/*
+ * Int8 products, C = A*B^T with A m x k and B n x k (one row per column of C).
+ *
+ * Two schedules, both with int32 accumulators:
+ * - packed (m above Q8_DOT_ROWS): A is copied to rows padded to a multiple of
+ *   4 bytes and B to panels of nr of its rows, interleaved by groups of 4
+ *   bytes: the group g of a panel holds bytes 4g to 4g+3 of each of its rows,
+ *   one vector of the kernel. The kernel broadcasts 4 bytes of a row of A and
+ *   multiplies them with the group (vpdpbusd and vpmaddubsw add products by
+ *   groups of adjacent bytes), so that each lane accumulates one element of C.
+ * - in place (few rows in A, typically activations times weights): the copy of
+ *   B would cost as much as the product, which only reads it once. B is read
+ *   where it is, Q8_DOT_NR rows at a time, and each element of C is a dot
+ *   product along k followed by a horizontal sum. The rows of B are summed in
+ *   the same pass.
+ *
+ * The raw int32 tile of dot products goes at once through the epilogue, which
+ * takes off the zero points,
+ *
+ *   sum (a - za)(b - zb) = sum a*b - zb * sum a - za * sum b + k * za * zb,
+ *
+ * and writes it as int32, as float (times the scales) or requantized to int8.
+ *
+ * Kernels:
+ * - AVX-512 VNNI: vpdpbusd multiplies unsigned by signed bytes and adds groups
+ *   of 4 products to int32 lanes. The vector operand (the panels of B, or A in
+ *   place) is copied unsigned, plus 128 (its sign bit flipped), and the
+ *   epilogue takes 128 times the sums of the other operand back.
+ * - AVX2: vpmaddubsw multiplies unsigned by signed bytes into saturated int16
+ *   pairs. It gets |a| and b with the sign of a, whose pairs stay below
+ *   2 * 127 * 127, and vpmaddwd widens the pairs to int32.
+ * - scalar.
+ */
+
+// largest register tile of the packed kernels: rows of A by rows of B
+#define Q8_MR 8
+#define Q8_NR 32
+
+// register tile of the in-place kernels
+#define Q8_DOT_MR 4
+#define Q8_DOT_NR 4
+
+// largest m computed in place: below it, the copy of B costs more than the faster kernel saves
+#define Q8_DOT_ROWS 64
+
+// the copies of A and B are aligned on this many bytes, and the rows of A padded to it in place
+#define Q8_ALIGN 64
+
+// bytes of the rows of A (or of the panels of B) handled by a task, kept in the L2 cache
+#define Q8_BLOCK_BYTES ((size_t)1 << 18)
+
+// largest k: the dot products, at most k * 127 * 127, stay in int32
+#define Q8_MAX_K ((size_t)1 << 17)
+
+// below this many multiply-adds, a product runs on the calling thread
+#define Q8_PARALLEL ((uint64_t)1 << 22)
+
+typedef struct {
+    // packed: c[i * nr + j] = dot product of row i of a (rows of kp bytes) and row j of the panel b
+    void (*fn)(size_t kp, const int8_t *a, const int8_t *b, int32_t *c);
+    // in place: c[i * Q8_DOT_NR + j] = dot product of row i of a (rows of kp bytes, zero padded to a multiple
+    // of Q8_ALIGN) and the first k bytes of b[j]; bsum[j] = sum of those bytes when bsum is not NULL
+    void (*dot)(size_t k, size_t kp, const int8_t *a, const int8_t *const *b, int32_t *bsum, int32_t *c);
+    size_t mr, nr;
+    int offset;     // the unsigned operand is copied plus 128: B packed, A in place
+}q8_kernel_t;
+
+// output of the epilogue
+typedef enum{
+    Q8_OUT_I32,
+    Q8_OUT_F32,
+    Q8_OUT_Q8
+}q8_out_t;
+
+typedef struct {
+    q8_kernel_t kernel;
+    const matrix_q8_t *a, *b;
+    q8_out_t out;
+    void *result;
+    size_t kp, mc, nc, mb;      // bytes per row of the copies, rows of A and of B per task, tasks per column of C
+    uint32_t offset_a, offset_b;  // added to the elements of the copy of A or of B (unsigned bytes)
+    const int8_t *pa, *pb;      // copies of A and B (pb NULL in place)
+    const int32_t *asum, *bsum; // sums of the rows of A and B (bsum NULL in place)
+}q8_job_t;
+
+// 4 bytes of a row of A, as one int32 to broadcast
+static inline int32_t q8_group(const int8_t *a){
+    int32_t x;
+    memcpy(&x, a, sizeof(x));
+    return x;
+}
+
+#define Q8_SCALAR_MR 4
+#define Q8_SCALAR_NR 8
+
+static void q8_kernel_scalar(size_t kp, const int8_t *a, const int8_t *b, int32_t *c){
+    int32_t acc[Q8_SCALAR_MR * Q8_SCALAR_NR] = { 0 };
+    for(size_t p = 0; p < kp; p += 4, b += 4 * Q8_SCALAR_NR)
+        #pragma GCC unroll 8
+        for(size_t i = 0; i < Q8_SCALAR_MR; i++){
+            const int8_t *x = a + i * kp + p;
+            #pragma GCC unroll 8
+            for(size_t j = 0; j < Q8_SCALAR_NR; j++)
+                acc[i * Q8_SCALAR_NR + j] += x[0] * b[4 * j] + x[1] * b[4 * j + 1]
+                                           + x[2] * b[4 * j + 2] + x[3] * b[4 * j + 3];
+        }
+    memcpy(c, acc, sizeof(acc));
+}
+
+static void q8_dot_scalar(size_t k, size_t kp, const int8_t *a, const int8_t *const *b, int32_t *bsum, int32_t *c){
+    for(size_t j = 0; j < Q8_DOT_NR; j++){
+        int32_t acc[Q8_DOT_MR] = { 0 }, s = 0;
+        for(size_t p = 0; p < k; p++){
+            s += b[j][p];
+            #pragma GCC unroll 4
+            for(size_t i = 0; i < Q8_DOT_MR; i++)
+                acc[i] += a[i * kp + p] * b[j][p];
+        }
+        for(size_t i = 0; i < Q8_DOT_MR; i++)
+            c[i * Q8_DOT_NR + j] = acc[i];
+        if(bsum)
+            bsum[j] = s;
+    }
+}
+
+#ifdef Q8_X86
+
+__attribute__((target("avx2")))
+static inline __m256i q8_madd_avx2(__m256i acc, __m256i abs_x, __m256i x, __m256i y){
+    __m256i pairs = _mm256_maddubs_epi16(abs_x, _mm256_sign_epi8(y, x));
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, _mm256_set1_epi16(1)));
+}
+
+__attribute__((target("avx2")))
+static inline int32_t q8_hsum_avx2(__m256i v){
+    __m128i x = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, 0x4e));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, 0xb1));
+    return _mm_cvtsi128_si32(x);
+}
+
+// 4 x 16: 8 accumulators out of the 16 registers
+__attribute__((target("avx2")))
+static void q8_kernel_avx2(size_t kp, const int8_t *a, const int8_t *b, int32_t *c){
+    __m256i acc[4][2];
+    #pragma GCC unroll 4
+    for(size_t i = 0; i < 4; i++)
+        acc[i][0] = acc[i][1] = _mm256_setzero_si256();
+
+    for(size_t p = 0; p < kp; p += 4, b += 64){
+        __m256i y0 = _mm256_loadu_si256((const __m256i *)b);
+        __m256i y1 = _mm256_loadu_si256((const __m256i *)(b + 32));
+        #pragma GCC unroll 4
+        for(size_t i = 0; i < 4; i++){
+            __m256i x = _mm256_set1_epi32(q8_group(a + i * kp + p));
+            __m256i abs_x = _mm256_abs_epi8(x);
+            acc[i][0] = q8_madd_avx2(acc[i][0], abs_x, x, y0);
+            acc[i][1] = q8_madd_avx2(acc[i][1], abs_x, x, y1);
+        }
+    }
+
+    #pragma GCC unroll 4
+    for(size_t i = 0; i < 4; i++){
+        _mm256_storeu_si256((__m256i *)(c + i * 16), acc[i][0]);
+        _mm256_storeu_si256((__m256i *)(c + i * 16 + 8), acc[i][1]);
+    }
+}
+
+// two rows of A at a time, the last partial vector of the rows of B through a zero padded copy
+__attribute__((target("avx2")))
+static void q8_dot_avx2(size_t k, size_t kp, const int8_t *a, const int8_t *const *b, int32_t *bsum, int32_t *c){
+    int8_t tail[Q8_DOT_NR][32] __attribute__((aligned(32))) = {{ 0 }};
+    size_t kv = k / 32 * 32;
+    for(size_t j = 0; j < Q8_DOT_NR; j++)
+        memcpy(tail[j], b[j] + kv, k - kv);
+
+    for(size_t i = 0; i < Q8_DOT_MR; i += 2){
+        const int8_t *a0 = a + i * kp, *a1 = a0 + kp;
+        __m256i acc0[Q8_DOT_NR], acc1[Q8_DOT_NR], sum[Q8_DOT_NR];
+        #pragma GCC unroll 4
+        for(size_t j = 0; j < Q8_DOT_NR; j++)
+            acc0[j] = acc1[j] = sum[j] = _mm256_setzero_si256();
+
+        for(size_t p = 0; p < k; p += 32){
+            __m256i x0 = _mm256_load_si256((const __m256i *)(a0 + p));
+            __m256i x1 = _mm256_load_si256((const __m256i *)(a1 + p));
+            __m256i abs_x0 = _mm256_abs_epi8(x0), abs_x1 = _mm256_abs_epi8(x1);
+            #pragma GCC unroll 4
+            for(size_t j = 0; j < Q8_DOT_NR; j++){
+                __m256i y = _mm256_loadu_si256((const __m256i *)(p < kv ? b[j] + p : tail[j]));
+                acc0[j] = q8_madd_avx2(acc0[j], abs_x0, x0, y);
+                acc1[j] = q8_madd_avx2(acc1[j], abs_x1, x1, y);
+                if(bsum && !i)
+                    sum[j] = q8_madd_avx2(sum[j], _mm256_set1_epi8(1), _mm256_set1_epi8(1), y);
+            }
+        }
+
+        #pragma GCC unroll 4
+        for(size_t j = 0; j < Q8_DOT_NR; j++){
+            c[i * Q8_DOT_NR + j] = q8_hsum_avx2(acc0[j]);
+            c[(i + 1) * Q8_DOT_NR + j] = q8_hsum_avx2(acc1[j]);
+            if(bsum && !i)
+                bsum[j] = q8_hsum_avx2(sum[j]);
+        }
+    }
+}
+
+// 8 x 32: 16 accumulators out of the 32 registers
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static void q8_kernel_vnni(size_t kp, const int8_t *a, const int8_t *b, int32_t *c){
+    __m512i acc[8][2];
+    #pragma GCC unroll 8
+    for(size_t i = 0; i < 8; i++)
+        acc[i][0] = acc[i][1] = _mm512_setzero_si512();
+
+    for(size_t p = 0; p < kp; p += 4, b += 128){
+        __m512i y0 = _mm512_loadu_si512(b), y1 = _mm512_loadu_si512(b + 64);
+        #pragma GCC unroll 8
+        for(size_t i = 0; i < 8; i++){
+            __m512i x = _mm512_set1_epi32(q8_group(a + i * kp + p));
+            acc[i][0] = _mm512_dpbusd_epi32(acc[i][0], y0, x);
+            acc[i][1] = _mm512_dpbusd_epi32(acc[i][1], y1, x);
+        }
+    }
+
+    #pragma GCC unroll 8
+    for(size_t i = 0; i < 8; i++){
+        _mm512_storeu_si512(c + i * 32, acc[i][0]);
+        _mm512_storeu_si512(c + i * 32 + 16, acc[i][1]);
+    }
+}
+
+// 4 x 4 dot products, the last partial vector of the rows of B through a masked load
+__attribute__((target("avx512f,avx512bw,avx512vnni")))
+static void q8_dot_vnni(size_t k, size_t kp, const int8_t *a, const int8_t *const *b, int32_t *bsum, int32_t *c){
+    const __m512i ones = _mm512_set1_epi8(1);
+    __m512i acc[Q8_DOT_MR][Q8_DOT_NR], sum[Q8_DOT_NR];
+    #pragma GCC unroll 4
+    for(size_t j = 0; j < Q8_DOT_NR; j++){
+        sum[j] = _mm512_setzero_si512();
+        #pragma GCC unroll 4
+        for(size_t i = 0; i < Q8_DOT_MR; i++)
+            acc[i][j] = _mm512_setzero_si512();
+    }
+
+    for(size_t p = 0; p < k; p += 64){
+        __mmask64 mask = k - p >= 64 ? ~(__mmask64)0 : ((__mmask64)1 << (k - p)) - 1;
+        __m512i x[Q8_DOT_MR];
+        #pragma GCC unroll 4
+        for(size_t i = 0; i < Q8_DOT_MR; i++)
+            x[i] = _mm512_load_si512(a + i * kp + p);
+        #pragma GCC unroll 4
+        for(size_t j = 0; j < Q8_DOT_NR; j++){
+            __m512i y = _mm512_maskz_loadu_epi8(mask, b[j] + p);
+            #pragma GCC unroll 4
+            for(size_t i = 0; i < Q8_DOT_MR; i++)
+                acc[i][j] = _mm512_dpbusd_epi32(acc[i][j], x[i], y);
+            if(bsum)
+                sum[j] = _mm512_dpbusd_epi32(sum[j], ones, y);
+        }
+    }
+
+    #pragma GCC unroll 4
+    for(size_t j = 0; j < Q8_DOT_NR; j++){
+        #pragma GCC unroll 4
+        for(size_t i = 0; i < Q8_DOT_MR; i++)
+            c[i * Q8_DOT_NR + j] = _mm512_reduce_add_epi32(acc[i][j]);
+        if(bsum)
+            bsum[j] = _mm512_reduce_add_epi32(sum[j]);
+    }
+}
+
+#endif
+
+static q8_kernel_t q8_kernel(void){
+    /*
+        * pick the kernels of the host CPU, within the level of the element-wise kernels (MATRIX_SIMD)
+        * @return q8_kernel_t : kernels
+    */
+#ifdef Q8_X86
+    __builtin_cpu_init();
+    if(matrix_simd->level >= MATRIX_SIMD_AVX512 && __builtin_cpu_supports("avx512bw")
+       && __builtin_cpu_supports("avx512vnni"))
+        return (q8_kernel_t){ q8_kernel_vnni, q8_dot_vnni, 8, 32, 1 };
+    if(matrix_simd->level >= MATRIX_SIMD_AVX2)
+        return (q8_kernel_t){ q8_kernel_avx2, q8_dot_avx2, 4, 16, 0 };
+#endif
+    return (q8_kernel_t){ q8_kernel_scalar, q8_dot_scalar, Q8_SCALAR_MR, Q8_SCALAR_NR, 0 };
+}
+
+// nearest value of [-127, 127], nan for NaN
+static inline int8_t q8_round(float x, int32_t nan){
+    if(x != x)
+        return (int8_t)nan;
+    x = x < -127.0f ? -127.0f : x > 127.0f ? 127.0f : x;
+    return (int8_t)lrintf(x);
+}
+
+// index of the scale and zero point of row i
+static inline size_t q8_param(const matrix_q8_t *m1, size_t i){
+    return m1->quant & MATRIX_QUANT_ROW ? i : 0;
+}
+
+// sum of n bytes
+static int32_t q8_sum(const int8_t *x, size_t n){
+    int32_t s = 0;
+    size_t j = 0;
+    for(; j + 64 <= n; j += 64)
+        for(size_t q = 0; q < 64; q++)
+            s += x[j + q];
+    for(; j < n; j++)
+        s += x[j];
+    return s;
+}
+
+static void q8_pack_a(const matrix_q8_t *m1, size_t rows, size_t kp, int offset, int8_t *p, int32_t *sum){
+    /*
+        * copy the rows of A to rows of kp bytes, and sum them
+        * @params m1: pointer to the matrix
+        *         rows: rows of p, the ones past the end of A are zero
+        *         kp: bytes per row of p, zero padded
+        *         offset: 1 to add 128 to the elements (unsigned bytes), kp then a multiple of Q8_ALIGN
+        *         p: copied rows
+        *         sum: sum of each row
+    */
+    memset(p + m1->row * kp, 0, (rows - m1->row) * kp);
+    memset(sum + m1->row, 0, (rows - m1->row) * sizeof(int32_t));
+    for(size_t i = 0; i < m1->row; i++){
+        const int8_t *row = m1->data + i * m1->stride;
+        int8_t *out = p + i * kp;
+        memcpy(out, row, m1->col);
+        sum[i] = q8_sum(row, m1->col);
+        for(size_t j = 0; offset && j < m1->col; j += Q8_ALIGN)
+            for(size_t q = 0; q < Q8_ALIGN; q++)
+                out[j + q] ^= 0x80;
+        memset(out + m1->col, 0, kp - m1->col);
+    }
+}
+
+static void q8_pack_b(const matrix_q8_t *m1, size_t rows, size_t kp, size_t nr, int offset, int8_t *p, int32_t *sum){
+    /*
+        * copy the rows of B to panels of nr rows interleaved by groups of 4 bytes, and sum them
+        * @params m1: pointer to the matrix
+        *         rows: rows of p, a multiple of nr, the ones past the end of B are zero
+        *         kp: bytes per row, a multiple of 4, zero padded
+        *         nr: rows per panel
+        *         offset: 1 to add 128 to the elements (unsigned bytes)
+        *         p: panels, kp * nr bytes each
+        *         sum: sum of each row
+    */
+    uint32_t flip = offset ? 0x80808080u : 0;
+    size_t k4 = m1->col / 4 * 4;
+
+    for(size_t r0 = 0; r0 < rows; r0 += nr, p += kp * nr){
+        const int8_t *row[Q8_NR];
+        size_t valid = r0 >= m1->row ? 0 : m1->row - r0 < nr ? m1->row - r0 : nr;
+        memset(p, 0, kp * nr);
+        for(size_t r = 0; r < valid; r++){
+            row[r] = m1->data + (r0 + r) * m1->stride;
+            sum[r0 + r] = q8_sum(row[r], m1->col);
+            for(size_t q = 0; q < m1->col - k4; q++)
+                p[k4 * nr + 4 * r + q] = (int8_t)(row[r][k4 + q] ^ (int8_t)flip);
+        }
+        for(size_t r = valid; r < nr; r++)
+            sum[r0 + r] = 0;
+
+        // written in order, one group of each row in turn
+        for(size_t g = 0; g < k4; g += 4)
+            for(size_t r = 0; r < valid; r++){
+                uint32_t x;
+                memcpy(&x, row[r] + g, 4);
+                x ^= flip;
+                memcpy(p + g * nr + 4 * r, &x, 4);
+            }
+    }
+}
+
+static void q8_store(const q8_job_t *job, size_t i0, size_t j0, size_t mr, size_t nr, const int32_t *c,
+                     const int32_t *bsum){
+    /*
+        * epilogue of a tile: zero points, then the output of the product
+        * @params job: product
+        *         i0, j0: first row and column of the tile in C
+        *         mr, nr: dimensions of the tile
+        *         c: raw dot products of the tile
+        *         bsum: sums of the rows of B of the tile
+    */
+    const matrix_q8_t *a = job->a, *b = job->b;
+    size_t rows = a->row - i0 < mr ? a->row - i0 : mr;
+    size_t cols = b->row - j0 < nr ? b->row - j0 : nr;
+    int64_t k = a->col;
+
+    // sum (a - za)(b - zb) = dot - za * (sum b - k * zb) - zb * sum a, where dot, the raw sum less the
+    // offsets of the copies, is exact modulo 2^32 like the lanes and fits
+    uint32_t boff[Q8_NR];
+    int64_t bterm[Q8_NR], zb[Q8_NR];
+    float sb[Q8_NR];
+    for(size_t j = 0; j < cols; j++){
+        zb[j] = b->zero[q8_param(b, j0 + j)];
+        sb[j] = b->scale[q8_param(b, j0 + j)];
+        boff[j] = job->offset_a * (uint32_t)bsum[j];
+        bterm[j] = bsum[j] - k * zb[j];
+    }
+
+    for(size_t i = 0; i < rows; i++){
+        const int32_t *ci = c + i * nr;
+        int64_t za = a->zero[q8_param(a, i0 + i)], asum = job->asum[i0 + i];
+        uint32_t aoff = job->offset_b * (uint32_t)asum;
+        float sa = a->scale[q8_param(a, i0 + i)];
+
+        if(job->out == Q8_OUT_I32){
+            matrix_i32_t *r = job->result;
+            int32_t *out = r->data + (i0 + i) * r->stride + j0;
+            for(size_t j = 0; j < cols; j++){
+                int64_t s = (int32_t)((uint32_t)ci[j] - boff[j] - aoff) - za * bterm[j] - zb[j] * asum;
+                out[j] = s > INT32_MAX ? INT32_MAX : s < INT32_MIN ? INT32_MIN : (int32_t)s;
+            }
+        }else if(job->out == Q8_OUT_F32){
+            matrix_t *r = job->result;
+            float *out = r->data + (i0 + i) * r->stride + j0;
+            for(size_t j = 0; j < cols; j++){
+                int64_t s = (int32_t)((uint32_t)ci[j] - boff[j] - aoff) - za * bterm[j] - zb[j] * asum;
+                out[j] = (float)s * (sa * sb[j]);
+            }
+        }else{
+            matrix_q8_t *r = job->result;
+            int8_t *out = r->data + (i0 + i) * r->stride + j0;
+            float inv = sa / r->scale[q8_param(r, i0 + i)];
+            int32_t zr = r->zero[q8_param(r, i0 + i)];
+            for(size_t j = 0; j < cols; j++){
+                int64_t s = (int32_t)((uint32_t)ci[j] - boff[j] - aoff) - za * bterm[j] - zb[j] * asum;
+                out[j] = q8_round((float)s * (inv * sb[j]) + zr, zr);
+            }
+        }
+    }
+}
+
+static void q8_task(void *ctx, size_t task){
+    const q8_job_t *job = ctx;
+    size_t mr = job->kernel.mr, nr = job->kernel.nr;
+    size_t i0 = task % job->mb * job->mc, j0 = task / job->mb * job->nc;
+    size_t i1 = i0 + job->mc < job->a->row ? i0 + job->mc : job->a->row;
+    size_t j1 = j0 + job->nc < job->b->row ? j0 + job->nc : job->b->row;
+    int32_t c[Q8_MR * Q8_NR];
+
+    // a panel of B stays in cache while the block of A streams from L2
+    for(size_t j = j0; j < j1; j += nr)
+        for(size_t i = i0; i < i1; i += mr){
+            job->kernel.fn(job->kp, job->pa + i * job->kp, job->pb + j * job->kp, c);
+            q8_store(job, i, j, mr, nr, c, job->bsum + j);
+        }
+}
+
+static void q8_task_dot(void *ctx, size_t task){
+    const q8_job_t *job = ctx;
+    const matrix_q8_t *b = job->b;
+    size_t j0 = task * job->nc, j1 = j0 + job->nc < b->row ? j0 + job->nc : b->row;
+    int32_t c[Q8_DOT_MR * Q8_DOT_NR], bsum[Q8_DOT_NR];
+
+    // the rows of B are read once, and summed along with the first rows of A
+    for(size_t j = j0; j < j1; j += Q8_DOT_NR){
+        const int8_t *rows[Q8_DOT_NR];
+        for(size_t q = 0; q < Q8_DOT_NR; q++)
+            rows[q] = b->data + (j + q < b->row ? j + q : b->row - 1) * b->stride;
+        for(size_t i = 0; i < job->a->row; i += Q8_DOT_MR){
+            job->kernel.dot(b->col, job->kp, job->pa + i * job->kp, rows, i ? NULL : bsum, c);
+            q8_store(job, i, j, Q8_DOT_MR, Q8_DOT_NR, c, bsum);
+        }
+    }
+}
+
+// the data of two int8 matrices share bytes
+static int q8_overlap(const matrix_q8_t *q1, const matrix_q8_t *q2){
+    if(!q1->row || !q1->col || !q2->row || !q2->col)
+        return 0;
+    const int8_t *end1 = q1->data + (q1->row - 1) * q1->stride + q1->col;
+    const int8_t *end2 = q2->data + (q2->row - 1) * q2->stride + q2->col;
+    return q1->data < end2 && q2->data < end1;
+}
+
+static void q8_gemm(const matrix_q8_t *a, const matrix_q8_t *b, q8_out_t out, void *result, const char *fname){
+    /*
+        * C = A*B^T to result, operands already checked
+        * @params a: pointer to the m x k matrix
+        *         b: pointer to the n x k matrix
+        *         out: output of the epilogue
+        *         result: pointer to the m x n result (matrix_i32_t, matrix_t or matrix_q8_t)
+        *         fname: name of the public function, for the errors
+    */
+    size_t m = a->row, n = b->row, k = a->col;
+    if(k > Q8_MAX_K)
+        errx(MATRIX_INVALID_DIMENSIONS, "%s: %s", fname, MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_Q8_MUL, (uint64_t)m * n, (uint64_t)2 * m * n * k,
+                (uint64_t)(m + n) * k + (uint64_t)m * n * (out == Q8_OUT_Q8 ? 1 : 4));
+
+    if(!m || !n)
+        return;
+
+    q8_job_t job = { .kernel = q8_kernel(), .a = a, .b = b, .out = out, .result = result };
+    // the in place path reads the rows of B while the tiles are stored: B is packed first when the result
+    // overlaps it
+    int dot = m <= Q8_DOT_ROWS && !(out == Q8_OUT_Q8 && q8_overlap(result, b));
+    size_t mr = dot ? Q8_DOT_MR : job.kernel.mr, nr = dot ? Q8_DOT_NR : job.kernel.nr;
+    size_t mp = (m + mr - 1) / mr * mr, np = dot ? 0 : (n + nr - 1) / nr * nr;
+    job.kp = dot ? (k + Q8_ALIGN - 1) / Q8_ALIGN * Q8_ALIGN : (k + 3) / 4 * 4;
+    job.offset_a = dot && job.kernel.offset ? 128 : 0;
+    job.offset_b = !dot && job.kernel.offset ? 128 : 0;
+
+    // blocks of about Q8_BLOCK_BYTES of A and B, all of A in place
+    size_t rows = job.kp ? Q8_BLOCK_BYTES / job.kp : n;
+    job.mc = dot || rows / mr * mr >= mp ? mp : rows / mr * mr < mr ? mr : rows / mr * mr;
+    job.nc = rows / nr * nr >= n ? n : rows / nr * nr < nr ? nr : rows / nr * nr;
+    job.mb = (m + job.mc - 1) / job.mc;
+
+    size_t bytes = (mp + np) * job.kp;
+    size_t size = (bytes + (mp + np) * sizeof(int32_t) + Q8_ALIGN - 1) / Q8_ALIGN * Q8_ALIGN;
+    int8_t *buf = aligned_alloc(Q8_ALIGN, size);
+    if(!buf)
+        errx(MATRIX_MEMORY_ERROR, "%s: %s", fname, MATRIX_MEMORY_ERROR_MESSAGE);
+    job.pa = buf;
+    job.asum = (int32_t *)(buf + bytes);
+    q8_pack_a(a, mp, job.kp, job.offset_a != 0, buf, (int32_t *)job.asum);
+    if(!dot){
+        job.pb = buf + mp * job.kp;
+        job.bsum = job.asum + mp;
+        q8_pack_b(b, np, job.kp, nr, job.offset_b != 0, buf + mp * job.kp, (int32_t *)job.bsum);
+    }
+
+    size_t ntasks = job.mb * ((n + job.nc - 1) / job.nc);
+    void (*task)(void *ctx, size_t task) = dot ? q8_task_dot : q8_task;
+    if((uint64_t)m * n * k >= Q8_PARALLEL && ntasks > 1)
+        matrix_parallel_for(ntasks, task, &job);
+    else
+        for(size_t t = 0; t < ntasks; t++)
+            task(&job, t);
+
+    free(buf);
+}
+
+static void q8_check(const matrix_q8_t *a, const matrix_q8_t *b, const void *result,
+                     size_t row, size_t col, const char *fname){
+    /*
+        * check the operands of a product
+        * @params a, b: pointers to the operands
+        *         result: pointer to the result
+        *         row, col: dimensions of the result
+        *         fname: name of the public function
+    */
+    if(!a || !b || !result)
+        errx(MATRIX_NULL_POINTER, "%s: %s", fname, MATRIX_NULL_POINTER_MESSAGE);
+
+    if(a->col != b->col || row != a->row || col != b->row)
+        errx(MATRIX_INVALID_DIMENSIONS, "%s: %s", fname, MATRIX_INVALID_DIMENSIONS_MESSAGE);
+}
+
+matrix_q8_t* matrix_q8_init(size_t row, size_t col, matrix_quant_t quant){
+    /*
+        * new int8 matrix, with uninitialised data, scales 1 and zero points 0
+        * @params row: number of rows
+        *         col: number of columns
+        *         quant: MATRIX_QUANT_ROW for one scale and zero point per row, MATRIX_QUANT_TENSOR for one
+        * @return matrix_q8_t* : pointer to the new matrix, NULL on failure
+    */
+    if(quant & ~(MATRIX_QUANT_ROW | MATRIX_QUANT_SYMMETRIC))
+        errx(MATRIX_INVALID_ARGUMENT, "matrix_q8_init: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    size_t nparams = quant & MATRIX_QUANT_ROW ? row : 1;
+    void *data;
+    matrix_allocator_t *alloc;
+    int flags;
+    matrix_q8_t *q = matrix_alloc_block(sizeof(matrix_q8_t) + nparams * (sizeof(float) + sizeof(int32_t)),
+                                        matrix_alloc_bytes(row, col, 1), &data, &alloc, &flags);
+    if(!q)
+        return NULL;
+
+    *q = (matrix_q8_t){ row, col, data, col, alloc, flags, quant, (float *)(q + 1), NULL };
+    q->zero = (int32_t *)(q->scale + nparams);
+    for(size_t i = 0; i < nparams; i++){
+        q->scale[i] = 1;
+        q->zero[i] = 0;
+    }
+    return q;
+}
+
+void matrix_q8_free(matrix_q8_t *q){
+    /*
+        * free an int8 matrix
+        * @params q: pointer to the matrix
+    */
+    if(!q)
+        errx(MATRIX_NULL_POINTER, "matrix_q8_free: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    size_t nparams = q->quant & MATRIX_QUANT_ROW ? q->row : 1;
+    matrix_release_block(q, sizeof(matrix_q8_t) + nparams * (sizeof(float) + sizeof(int32_t)),
+                         q->data, q->row * q->col, q->alloc, q->flags);
+}
+
+void matrix_quantizet(const matrix_t *m1, matrix_q8_t *result){
+    /*
+        * quantize a matrix with the scales and zero points of result (calibrated beforehand)
+        * @params m1: pointer to the matrix
+        *         result: pointer to the int8 matrix, of the same dimensions
+    */
+    if(!m1 || !result)
+        errx(MATRIX_NULL_POINTER, "matrix_quantizet: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(result->row != m1->row || result->col != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "matrix_quantizet: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_QUANTIZE, (uint64_t)m1->row * m1->col, (uint64_t)2 * m1->row * m1->col,
+                (uint64_t)m1->row * m1->col * (sizeof(float) + 1));
+
+    for(size_t i = 0; i < m1->row; i++){
+        const float *x = m1->data + i * m1->stride;
+        int8_t *q = result->data + i * result->stride;
+        float inv = 1 / result->scale[q8_param(result, i)];
+        int32_t zero = result->zero[q8_param(result, i)];
+        for(size_t j = 0; j < m1->col; j++)
+            q[j] = q8_round(x[j] * inv + zero, zero);
+    }
+}
+
+static void q8_params(float lo, float hi, int symmetric, float *scale, int32_t *zero){
+    /*
+        * scale and zero point mapping a range of values to [-127, 127]
+        * @params lo, hi: smallest and largest value
+        *         symmetric: 1 for the zero point 0
+        *         scale, zero: outputs
+    */
+    lo = lo < 0 ? lo : 0;
+    hi = hi > 0 ? hi : 0;
+    if(symmetric){
+        float amax = -lo > hi ? -lo : hi;
+        *scale = amax > 0 ? amax / 127 : 1;
+        *zero = 0;
+        return;
+    }
+    *scale = hi > lo ? (hi - lo) / 254 : 1;
+    float z = -127 - lo / *scale;
+    *zero = z < -127 ? -127 : z > 127 ? 127 : (int32_t)lrintf(z);
+}
+
+matrix_q8_t* matrix_quantize(const matrix_t *m1, matrix_quant_t quant){
+    /*
+        * int8 copy of a matrix, with the scales and zero points that map the range of its values
+        * (of each row with MATRIX_QUANT_ROW) to [-127, 127]
+        * @params m1: pointer to the matrix
+        *         quant: MATRIX_QUANT_TENSOR or MATRIX_QUANT_ROW, or'ed with MATRIX_QUANT_SYMMETRIC
+        * @return matrix_q8_t* : pointer to the new matrix, NULL on failure
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_quantize: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(quant & ~(MATRIX_QUANT_ROW | MATRIX_QUANT_SYMMETRIC))
+        errx(MATRIX_INVALID_ARGUMENT, "matrix_quantize: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_QUANTIZE, (uint64_t)m1->row * m1->col, (uint64_t)4 * m1->row * m1->col,
+                (uint64_t)m1->row * m1->col * (sizeof(float) + 1));
+
+    matrix_q8_t *result = matrix_q8_init(m1->row, m1->col, quant);
+    if(!result)
+        return NULL;
+
+    // NaN compares false and is left out of the ranges
+    float lo = INFINITY, hi = -INFINITY;
+    for(size_t i = 0; i < m1->row; i++){
+        const float *x = m1->data + i * m1->stride;
+        if(quant & MATRIX_QUANT_ROW)
+            lo = INFINITY, hi = -INFINITY;
+        for(size_t j = 0; j < m1->col; j++){
+            lo = x[j] < lo ? x[j] : lo;
+            hi = x[j] > hi ? x[j] : hi;
+        }
+        if(quant & MATRIX_QUANT_ROW)
+            q8_params(lo, hi, quant & MATRIX_QUANT_SYMMETRIC, &result->scale[i], &result->zero[i]);
+    }
+    if(!(quant & MATRIX_QUANT_ROW))
+        q8_params(lo, hi, quant & MATRIX_QUANT_SYMMETRIC, &result->scale[0], &result->zero[0]);
+
+    matrix_quantizet(m1, result);
+    return result;
+}
+
+void matrix_dequantizet(const matrix_q8_t *q, matrix_t *result){
+    /*
+        * values of an int8 matrix, scale * (q - zero)
+        * @params q: pointer to the int8 matrix
+        *         result: pointer to the result matrix, of the same dimensions
+    */
+    if(!q || !result)
+        errx(MATRIX_NULL_POINTER, "matrix_dequantizet: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(result->row != q->row || result->col != q->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "matrix_dequantizet: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_QUANTIZE, (uint64_t)q->row * q->col, (uint64_t)2 * q->row * q->col,
+                (uint64_t)q->row * q->col * (sizeof(float) + 1));
+
+    for(size_t i = 0; i < q->row; i++){
+        const int8_t *x = q->data + i * q->stride;
+        float *y = result->data + i * result->stride;
+        float scale = q->scale[q8_param(q, i)];
+        int32_t zero = q->zero[q8_param(q, i)];
+        for(size_t j = 0; j < q->col; j++)
+            y[j] = scale * (float)(x[j] - zero);
+    }
+}
+
+matrix_t* matrix_dequantize(const matrix_q8_t *q){
+    /*
+        * float copy of an int8 matrix, scale * (q - zero)
+        * @params q: pointer to the int8 matrix
+        * @return matrix_t* : pointer to the new matrix, NULL on failure
+    */
+    if(!q)
+        errx(MATRIX_NULL_POINTER, "matrix_dequantize: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    matrix_t *result = matrix_alloc(q->row, q->col);
+    if(!result)
+        return NULL;
+
+    matrix_dequantizet(q, result);
+    return result;
+}
+
+void m_q8_mult_i32(const matrix_q8_t *a, const matrix_q8_t *b, matrix_i32_t *result){
+    /*
+        * int8 product A*B^T with int32 accumulation, zero points taken off (scales not applied)
+        * @params a: pointer to the m x k matrix
+        *         b: pointer to the n x k matrix (one row per column of the result)
+        *         result: pointer to the m x n result matrix
+    */
+    q8_check(a, b, result, result ? result->row : 0, result ? result->col : 0, "m_q8_mult_i32");
+    q8_gemm(a, b, Q8_OUT_I32, result, "m_q8_mult_i32");
+}
+
+void m_q8_mult(const matrix_q8_t *a, const matrix_q8_t *b, matrix_t *result){
+    /*
+        * int8 product A*B^T, dequantized: the int32 sums times the scales of their row of A and of B
+        * @params a: pointer to the m x k matrix
+        *         b: pointer to the n x k matrix (one row per column of the result)
+        *         result: pointer to the m x n result matrix
+    */
+    q8_check(a, b, result, result ? result->row : 0, result ? result->col : 0, "m_q8_mult");
+    q8_gemm(a, b, Q8_OUT_F32, result, "m_q8_mult");
+}
+
+matrix_t* m_q8_mul(const matrix_q8_t *a, const matrix_q8_t *b){
+    /*
+        * int8 product A*B^T, dequantized
+        * @params a: pointer to the m x k matrix
+        *         b: pointer to the n x k matrix (one row per column of the result)
+        * @return matrix_t* : pointer to the new m x n matrix, NULL on failure
+    */
+    if(!a || !b)
+        errx(MATRIX_NULL_POINTER, "m_q8_mul: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(a->col != b->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_q8_mul: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    matrix_t *result = matrix_alloc(a->row, b->row);
+    if(!result)
+        return NULL;
+
+    q8_gemm(a, b, Q8_OUT_F32, result, "m_q8_mul");
+    return result;
+}
+
+void m_q8_multq(const matrix_q8_t *a, const matrix_q8_t *b, matrix_q8_t *result){
+    /*
+        * int8 product A*B^T, requantized with the scales and zero points of result
+        * @params a: pointer to the m x k matrix
+        *         b: pointer to the n x k matrix (one row per column of the result)
+        *         result: pointer to the m x n int8 result matrix
+    */
+    q8_check(a, b, result, result ? result->row : 0, result ? result->col : 0, "m_q8_multq");
+    q8_gemm(a, b, Q8_OUT_Q8, result, "m_q8_multq");
+}
@@ -0,0 +1,586 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <err.h>
+
+#include "matrix.h"
+#include "matrix_alloc.h"
+#include "matrix_gemm.h"
+#include "matrix_lu.h"
+#include "matrix_stats.h"
+#include "matrix_thread.h"
+#include "matrix_transp.h"
+#include "state.h"
+
+/*
+ * Householder QR factorization, A = Q*R, least squares and tall-skinny QR.
+ *
+ * The factorization is blocked: the reflectors H_j = I - tau_j v_j v_j^T of a
+ * panel of QR_BLOCK columns are computed column by column, then gathered in the
+ * compact WY form H_1...H_b = I - V T V^T (T upper triangular, b x b), so that
+ * the rest of the matrix is updated by two GEMMs, C -= V (T^T (V^T C)), instead
+ * of one rank-1 update per column.
+ *
+ * Q is never formed by the solvers: Q^T B is applied panel by panel the same way.
+ *
+ * The tall-skinny variant (TSQR) factors row blocks of QR_TSQR_BYTES each on the
+ * worker threads, then combines their R factors pairwise up a binary tree. Every
+ * block is read once, while it fits in cache, and only its R is kept. The blocks
+ * go in waves of QR_TSQR_SLOTS: the tree of a wave reduces it to one R, which
+ * joins the next wave, so the memory in use does not depend on the number of
+ * rows. Least squares through TSQR factors [A B]: the top right block of its R
+ * is Q^T B.
+ *
+ * Only the floating point families factor: the i32 functions exit with
+ * MATRIX_INVALID_ARGUMENT (convert with matrix_i32_to_f64 first).
+ */
+
+// columns per panel
+#define QR_BLOCK 32
+
+// bytes of a row block of the tall-skinny factorization, sized for L2
+#define QR_TSQR_BYTES ((size_t)1 << 17)
+
+// R factors of the tall-skinny factorization held at once: the row blocks of a wave
+#define QR_TSQR_SLOTS 64
+
+// below this many elements, the tall-skinny factorization runs on the calling thread
+#define QR_PARALLEL ((size_t)1 << 16)
+
+#define QR_INTEGER ((MATRIX_TYPE)0.5 == 0)
+
+#define QR_MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// operations of the factorization of an m x n matrix
+#define QR_FLOPS(m, n) ((m) >= (n) ? 2 * (uint64_t)(n) * (n) * (3 * (m) - (n)) / 3 \
+                                   : 2 * (uint64_t)(m) * (m) * (3 * (n) - (m)) / 3)
+
+// buffers of the block reflectors, for panels of up to m rows and trailing matrices of up to n columns
+typedef struct {
+    MATRIX_TYPE *v;     // m x QR_BLOCK, V with its zeros and unit diagonal
+    MATRIX_TYPE *vt;    // QR_BLOCK x m, V^T
+    MATRIX_TYPE *t;     // QR_BLOCK x QR_BLOCK, T
+    MATRIX_TYPE *w;     // QR_BLOCK x n, V^T C
+    MATRIX_TYPE *g;     // QR_BLOCK x QR_BLOCK, V^T V
+}qr_work_t;
+
+static int qr_work_init(qr_work_t *work, size_t m, size_t n){
+    size_t b = QR_BLOCK;
+    MATRIX_TYPE *p;
+    if(!(p = malloc((2 * m * b + 2 * b * b + b * (n ? n : 1)) * sizeof(MATRIX_TYPE))))
+        return -1;
+    work->v = p;
+    work->vt = p + m * b;
+    work->t = work->vt + m * b;
+    work->g = work->t + b * b;
+    work->w = work->g + b * b;
+    return 0;
+}
+
+static void qr_reflector(size_t m, size_t n, MATRIX_TYPE *a, size_t lda, MATRIX_TYPE *tau){
+    /*
+        * unblocked factorization of the m x n panel at a, reflector by reflector
+        * column j ends up holding R above the diagonal, beta on it and v (v_0 = 1 implied) below
+    */
+    MATRIX_TYPE w[QR_BLOCK];
+    double s = 0;
+    for(size_t i = 1; i < m; i++)
+        s += (double)a[i * lda] * a[i * lda];
+
+    for(size_t j = 0; j < QR_MIN(m, n); j++){
+        MATRIX_TYPE *x = a + j * lda + j;
+        size_t nc = n - j - 1, rows = m - j;
+        double alpha = x[0];
+
+        // s: squares below the diagonal of column j, summed by the update of column j - 1
+        if(s == 0){
+            // already zero below the diagonal: H_j = I
+            tau[j] = 0;
+            for(size_t i = 2; i < rows && nc; i++)
+                s += (double)x[i * lda + 1] * x[i * lda + 1];
+            continue;
+        }
+
+        double norm = sqrt(alpha * alpha + s), beta = alpha >= 0 ? -norm : norm;
+        tau[j] = (beta - alpha) / beta;
+        MATRIX_TYPE scale = 1 / (alpha - beta);
+        for(size_t i = 1; i < rows; i++)
+            x[i * lda] *= scale;
+        x[0] = beta;
+        s = 0;
+        if(!nc)
+            continue;
+
+        // the rest of the panel: w = v^T A, A -= tau v w^T, with the squares of the next column
+        memcpy(w, x + 1, nc * sizeof(MATRIX_TYPE));
+        for(size_t i = 1; i < rows; i++)
+            for(size_t c = 0; c < nc; c++)
+                w[c] += x[i * lda] * x[i * lda + 1 + c];
+        for(size_t c = 0; c < nc; c++){
+            w[c] *= tau[j];
+            x[1 + c] -= w[c];
+        }
+        for(size_t i = 1; i < rows; i++){
+            MATRIX_TYPE *row = x + i * lda + 1, vi = x[i * lda];
+            for(size_t c = 0; c < nc; c++)
+                row[c] -= vi * w[c];
+            if(i >= 2)
+                s += (double)row[0] * row[0];
+        }
+    }
+}
+
+static void qr_block(size_t m, size_t b, const MATRIX_TYPE *a, size_t lda, const MATRIX_TYPE *tau, qr_work_t *work){
+    /*
+        * compact WY form of the b reflectors of the m x b panel at a: V and V^T explicit, and T such that
+        * H_1...H_b = I - V T V^T, by T_j = [T -tau_j T V^T v_j; 0 tau_j]
+    */
+    MATRIX_TYPE *v = work->v, *t = work->t, *g = work->g;
+    for(size_t i = 0; i < m; i++)
+        for(size_t c = 0; c < b; c++)
+            v[i * b + c] = c < i ? a[i * lda + c] : c == i;
+
+    matrix_transpose(m, b, v, b, work->vt, m);
+    matrix_gemm(b, b, m, 1, work->vt, m, v, b, 0, g, b);
+
+    for(size_t j = 0; j < b; j++){
+        for(size_t r = 0; r < j; r++){
+            MATRIX_TYPE s = 0;
+            for(size_t c = r; c < j; c++)
+                s += t[r * b + c] * g[c * b + j];
+            t[r * b + j] = -tau[j] * s;
+        }
+        t[j * b + j] = tau[j];
+        for(size_t r = j + 1; r < b; r++)
+            t[r * b + j] = 0;
+    }
+}
+
+static void qr_apply(size_t m, size_t n, size_t b, MATRIX_TYPE *c, size_t ldc, int trans, qr_work_t *work){
+    /*
+        * C = (I - V T V^T) C, or with T^T when trans (that is Q^T C), C m x n, V and T from qr_block
+    */
+    MATRIX_TYPE *t = work->t, *w = work->w;
+    if(!n)
+        return;
+    matrix_gemm(b, n, m, 1, work->vt, m, c, ldc, 0, w, n);
+
+    // W = T W or T^T W in place: T upper triangular, each row only reads rows not yet replaced
+    if(trans){
+        for(size_t r = b; r-- > 0;){
+            for(size_t j = 0; j < n; j++)
+                w[r * n + j] *= t[r * b + r];
+            for(size_t k = 0; k < r; k++)
+                for(size_t j = 0; j < n; j++)
+                    w[r * n + j] += t[k * b + r] * w[k * n + j];
+        }
+    }
+    else{
+        for(size_t r = 0; r < b; r++){
+            for(size_t j = 0; j < n; j++)
+                w[r * n + j] *= t[r * b + r];
+            for(size_t k = r + 1; k < b; k++)
+                for(size_t j = 0; j < n; j++)
+                    w[r * n + j] += t[r * b + k] * w[k * n + j];
+        }
+    }
+
+    matrix_gemm(m, n, b, -1, work->v, b, w, n, 1, c, ldc);
+}
+
+static int qr_factor(size_t m, size_t n, MATRIX_TYPE *a, size_t lda, MATRIX_TYPE *tau){
+    /*
+        * blocked factorization of the m x n matrix at a, in place
+        * @return int : 0, or -1 if the buffers cannot be allocated
+    */
+    size_t kmax = QR_MIN(m, n);
+    if(!kmax)
+        return 0;
+
+    // a single panel: no block reflector to build
+    if(n <= QR_BLOCK){
+        qr_reflector(m, n, a, lda, tau);
+        return 0;
+    }
+
+    qr_work_t work;
+    if(qr_work_init(&work, m, n) < 0)
+        return -1;
+
+    for(size_t j0 = 0; j0 < kmax; j0 += QR_BLOCK){
+        size_t b = QR_MIN(kmax - j0, QR_BLOCK), rows = m - j0;
+        MATRIX_TYPE *p = a + j0 * lda + j0;
+        qr_reflector(rows, b, p, lda, tau + j0);
+        if(j0 + b < n){
+            qr_block(rows, b, p, lda, tau + j0, &work);
+            qr_apply(rows, n - j0 - b, b, p + b, lda, 1, &work);
+        }
+    }
+
+    free(work.v);
+    return 0;
+}
+
+static int qr_apply_qt(const matrix_qr_t *qr, MATRIX_TYPE *c, size_t ldc, size_t k){
+    /*
+        * C = Q^T C, C m x k
+        * @return int : 0, or -1 if the buffers cannot be allocated
+    */
+    const matrix_t *f = qr->qr;
+    size_t m = f->row, kmax = QR_MIN(m, f->col);
+    qr_work_t work;
+    if(qr_work_init(&work, m, k) < 0)
+        return -1;
+
+    for(size_t j0 = 0; j0 < kmax; j0 += QR_BLOCK){
+        size_t b = QR_MIN(kmax - j0, QR_BLOCK);
+        qr_block(m - j0, b, f->data + j0 * f->stride + j0, f->stride, qr->tau + j0, &work);
+        qr_apply(m - j0, k, b, c + j0 * ldc, ldc, 1, &work);
+    }
+
+    free(work.v);
+    return 0;
+}
+
+static void qr_check_rank(const MATRIX_TYPE *r, size_t ldr, size_t m, size_t n, const char *fname){
+    /*
+        * exit if A (m x n) is numerically rank deficient, its least squares solution not unique: a diagonal
+        * element of R within n*sqrt(m)*eps of 0, relative to the largest one
+        * the rounding left in R by a dependent column grows like sqrt(m): a tolerance in n alone misses
+        * it on tall matrices, one in m reports tall full rank matrices as singular in f32
+    */
+    double max = 0, eps = sizeof(MATRIX_TYPE) == sizeof(float) ? FLT_EPSILON : DBL_EPSILON;
+    for(size_t i = 0; i < n; i++)
+        max = fmax(max, fabs((double)r[i * ldr + i]));
+    for(size_t i = 0; i < n; i++)
+        if(fabs((double)r[i * ldr + i]) <= max * eps * n * sqrt((double)m))
+            errx(MATRIX_SINGULAR, "%s: %s", fname, MATRIX_SINGULAR_MESSAGE);
+}
+
+matrix_qr_t* matrix_qr(const matrix_t *m1){
+    /*
+        * Householder QR factorization: m1 = Q*R
+        * @params m1: pointer to the matrix
+        * @return matrix_qr_t* : pointer to the factorization, released by matrix_qr_free, NULL on failure
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_qr: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(QR_INTEGER)
+        errx(MATRIX_INVALID_ARGUMENT, "matrix_qr: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    size_t m = m1->row, n = m1->col, kmax = QR_MIN(m, n);
+    MATRIX_STAT(MATRIX_OP_QR, m * n, QR_FLOPS(m, n), 2 * (uint64_t)m * n * sizeof(MATRIX_TYPE));
+
+    matrix_qr_t *result;
+    if(!(result = malloc(sizeof(matrix_qr_t) + kmax * sizeof(MATRIX_TYPE))))
+        return NULL;
+    if(!(result->qr = matrix_getcpy(m1))){
+        free(result);
+        return NULL;
+    }
+    result->tau = (MATRIX_TYPE *)(result + 1);
+
+    if(qr_factor(m, n, result->qr->data, result->qr->stride, result->tau) < 0){
+        matrix_qr_free(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+void matrix_qr_free(matrix_qr_t *qr){
+    /*
+        * free a factorization
+        * @params qr: pointer to the factorization
+    */
+    if(!qr)
+        errx(MATRIX_NULL_POINTER, "matrix_qr_free: %s", MATRIX_NULL_POINTER_MESSAGE);
+    matrix_free(qr->qr);
+    free(qr);
+}
+
+matrix_t* m_qr_q(const matrix_qr_t *qr){
+    /*
+        * explicit Q of a factorization, thin: the first min(m, n) columns
+        * @params qr: pointer to the factorization of an m x n matrix
+        * @return matrix_t* : pointer to Q, m x min(m, n), with orthonormal columns
+    */
+    if(!qr)
+        errx(MATRIX_NULL_POINTER, "m_qr_q: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    const matrix_t *f = qr->qr;
+    size_t m = f->row, kmax = QR_MIN(m, f->col);
+    matrix_t *result;
+    if(!(result = matrix_alloc(m, kmax)))
+        return NULL;
+    for(size_t i = 0; i < m; i++)
+        for(size_t j = 0; j < kmax; j++)
+            result->data[i * result->stride + j] = i == j;
+    if(!kmax)
+        return result;
+
+    qr_work_t work;
+    if(qr_work_init(&work, m, kmax) < 0){
+        matrix_free(result);
+        return NULL;
+    }
+
+    // Q = H_1...H_k I, from the last panel: the columns before a panel are still those of I below it
+    for(size_t j0 = (kmax - 1) / QR_BLOCK * QR_BLOCK;; j0 -= QR_BLOCK){
+        size_t b = QR_MIN(kmax - j0, QR_BLOCK);
+        qr_block(m - j0, b, f->data + j0 * f->stride + j0, f->stride, qr->tau + j0, &work);
+        qr_apply(m - j0, kmax - j0, b, result->data + j0 * result->stride + j0, result->stride, 0, &work);
+        if(!j0)
+            break;
+    }
+
+    free(work.v);
+    return result;
+}
+
+matrix_t* m_qr_r(const matrix_qr_t *qr){
+    /*
+        * R of a factorization
+        * @params qr: pointer to the factorization of an m x n matrix
+        * @return matrix_t* : pointer to R, min(m, n) x n, upper triangular
+    */
+    if(!qr)
+        errx(MATRIX_NULL_POINTER, "m_qr_r: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    const matrix_t *f = qr->qr;
+    size_t n = f->col, kmax = QR_MIN(f->row, n);
+    matrix_t *result;
+    if(!(result = matrix_alloc(kmax, n)))
+        return NULL;
+    for(size_t i = 0; i < kmax; i++)
+        for(size_t j = 0; j < n; j++)
+            result->data[i * result->stride + j] = j < i ? 0 : f->data[i * f->stride + j];
+    return result;
+}
+
+matrix_t* m_qr_solve(const matrix_qr_t *qr, const matrix_t *b){
+    /*
+        * least squares solution of A*X = B with the factorization of A: X minimizes ||A*X - B|| column by column
+        * @params qr: pointer to the factorization of A, m x n with m >= n and of rank n
+        *         b: pointer to the right-hand sides, m x k (one per column)
+        * @return matrix_t* : pointer to the solution X, n x k
+    */
+    if(!qr || !b)
+        errx(MATRIX_NULL_POINTER, "m_qr_solve: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    const matrix_t *f = qr->qr;
+    size_t m = f->row, n = f->col, k = b->col;
+    if(m < n || b->row != m)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_qr_solve: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    qr_check_rank(f->data, f->stride, m, n, "m_qr_solve");
+
+    MATRIX_STAT(MATRIX_OP_LSTSQ, n * k, (4 * (uint64_t)m * n - (uint64_t)n * n) * k,
+                ((uint64_t)m * n + 2 * (uint64_t)m * k) * sizeof(MATRIX_TYPE));
+
+    // Q^T B, then R X = its first n rows
+    matrix_t *c, *result;
+    if(!(c = matrix_getcpy(b)))
+        return NULL;
+    if(qr_apply_qt(qr, c->data, c->stride, k) < 0 || !(result = matrix_alloc(n, k))){
+        matrix_free(c);
+        return NULL;
+    }
+    matrix_t top = matrix_view_rows(c, 0, n);
+    matrix_copyto(&top, result);
+    matrix_free(c);
+
+    matrix_trsm_upper(n, k, f->data, f->stride, result->data, result->stride);
+    return result;
+}
+
+matrix_t* m_lstsq(const matrix_t *a, const matrix_t *b){
+    /*
+        * least squares solution of A*X = B, through the QR factorization of A
+        * for a tall and narrow A (many more rows than columns) m_tsqr_solve is faster
+        * @params a: pointer to A, m x n with m >= n and of rank n
+        *         b: pointer to the right-hand sides, m x k (one per column)
+        * @return matrix_t* : pointer to the solution X, n x k
+    */
+    if(!a || !b)
+        errx(MATRIX_NULL_POINTER, "m_lstsq: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(a->row < a->col || b->row != a->row)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_lstsq: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    matrix_qr_t *qr;
+    if(!(qr = matrix_qr(a)))
+        return NULL;
+
+    matrix_t *result = m_qr_solve(qr, b);
+    matrix_qr_free(qr);
+    return result;
+}
+
+// tall-skinny factorization of [A B] (B may be NULL): w = columns of A and B together
+typedef struct {
+    const matrix_t *a, *b;
+    size_t w;
+    size_t rows;        // rows per block
+    size_t first;       // first row block of the current wave
+    size_t slot;        // slot of the R of that block, after the R of the previous waves
+    size_t stride;      // distance between pairs of R combined at the current level of the tree
+    MATRIX_TYPE *r;     // QR_TSQR_SLOTS x w x w, the R factors of a wave, upper triangular
+}qr_tsqr_t;
+
+static void qr_tsqr_leaf(void *ctx, size_t task){
+    /*
+        * R factor of row block task of the wave of [A B]
+    */
+    qr_tsqr_t *job = ctx;
+    size_t w = job->w, na = job->a->col, i0 = (job->first + task) * job->rows;
+    size_t rows = QR_MIN(job->rows, job->a->row - i0);
+    MATRIX_TYPE *blk, *tau;
+    if(!(blk = malloc((rows * w + w) * sizeof(MATRIX_TYPE))))
+        errx(MATRIX_MEMORY_ERROR, "m_tsqr: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+    tau = blk + rows * w;
+
+    for(size_t i = 0; i < rows; i++){
+        memcpy(blk + i * w, job->a->data + (i0 + i) * job->a->stride, na * sizeof(MATRIX_TYPE));
+        if(job->b)
+            memcpy(blk + i * w + na, job->b->data + (i0 + i) * job->b->stride, (w - na) * sizeof(MATRIX_TYPE));
+    }
+
+    if(qr_factor(rows, w, blk, w, tau) < 0)
+        errx(MATRIX_MEMORY_ERROR, "m_tsqr: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+
+    MATRIX_TYPE *r = job->r + (job->slot + task) * w * w;
+    for(size_t i = 0; i < w; i++)
+        for(size_t j = 0; j < w; j++)
+            r[i * w + j] = i < rows && j >= i ? blk[i * w + j] : 0;
+    free(blk);
+}
+
+static void qr_tsqr_node(void *ctx, size_t task){
+    /*
+        * R factor of the two stacked R of a pair, into the first one
+    */
+    qr_tsqr_t *job = ctx;
+    size_t w = job->w, t = task * 2 * job->stride;
+    MATRIX_TYPE *blk, *tau, *r = job->r + t * w * w;
+    if(!(blk = malloc((2 * w * w + w) * sizeof(MATRIX_TYPE))))
+        errx(MATRIX_MEMORY_ERROR, "m_tsqr: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+    tau = blk + 2 * w * w;
+
+    memcpy(blk, r, w * w * sizeof(MATRIX_TYPE));
+    memcpy(blk + w * w, job->r + (t + job->stride) * w * w, w * w * sizeof(MATRIX_TYPE));
+    if(qr_factor(2 * w, w, blk, w, tau) < 0)
+        errx(MATRIX_MEMORY_ERROR, "m_tsqr: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+
+    for(size_t i = 0; i < w; i++)
+        for(size_t j = 0; j < w; j++)
+            r[i * w + j] = j >= i ? blk[i * w + j] : 0;
+    free(blk);
+}
+
+static matrix_t* qr_tsqr(const matrix_t *a, const matrix_t *b){
+    /*
+        * R factor of [A B], w x w with w the columns of A and B together
+        * @return matrix_t* : pointer to R, NULL on failure
+    */
+    size_t w = a->col + (b ? b->col : 0), m = a->row;
+    qr_tsqr_t job = { .a = a, .b = b, .w = w };
+    job.rows = QR_TSQR_BYTES / (w * sizeof(MATRIX_TYPE));
+    if(job.rows < 2 * w)
+        job.rows = 2 * w;
+    size_t nblocks = (m + job.rows - 1) / job.rows, slots = QR_MIN(nblocks, QR_TSQR_SLOTS);
+
+    matrix_t *result;
+    if(!(job.r = malloc(slots * w * w * sizeof(MATRIX_TYPE))))
+        return NULL;
+    if(!(result = matrix_alloc(w, w))){
+        free(job.r);
+        return NULL;
+    }
+
+    int parallel = m * w >= QR_PARALLEL;
+    for(job.first = 0; job.first < nblocks; job.slot = 1){
+        size_t count = QR_MIN(nblocks - job.first, slots - job.slot), used = job.slot + count;
+        if(parallel && count > 1)
+            matrix_parallel_for(count, qr_tsqr_leaf, &job);
+        else
+            for(size_t t = 0; t < count; t++)
+                qr_tsqr_leaf(&job, t);
+        job.first += count;
+
+        // binary tree: at each level the R of slot t absorbs that of slot t + stride
+        for(job.stride = 1; job.stride < used; job.stride *= 2){
+            size_t pairs = (used - job.stride + 2 * job.stride - 1) / (2 * job.stride);
+            if(parallel && pairs > 1)
+                matrix_parallel_for(pairs, qr_tsqr_node, &job);
+            else
+                for(size_t t = 0; t < pairs; t++)
+                    qr_tsqr_node(&job, t);
+        }
+    }
+
+    for(size_t i = 0; i < w; i++)
+        memcpy(result->data + i * result->stride, job.r + i * w, w * sizeof(MATRIX_TYPE));
+    free(job.r);
+    return result;
+}
+
+matrix_t* m_tsqr(const matrix_t *m1){
+    /*
+        * R factor of a tall and narrow matrix, by tall-skinny QR: row blocks factored in parallel, then combined
+        * R is unique up to the signs of its rows
+        * @params m1: pointer to the matrix, m x n with m >= n
+        * @return matrix_t* : pointer to R, n x n, upper triangular
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_tsqr: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(m1->row < m1->col || !m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_tsqr: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    if(QR_INTEGER)
+        errx(MATRIX_INVALID_ARGUMENT, "m_tsqr: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_TSQR, m1->col * m1->col, QR_FLOPS(m1->row, m1->col),
+                (m1->row + m1->col) * (uint64_t)m1->col * sizeof(MATRIX_TYPE));
+
+    return qr_tsqr(m1, NULL);
+}
+
+matrix_t* m_tsqr_solve(const matrix_t *a, const matrix_t *b){
+    /*
+        * least squares solution of A*X = B by tall-skinny QR of [A B]: Q is never stored and A and B are
+        * read once, in row blocks
+        * @params a: pointer to A, m x n with m >= n and of rank n
+        *         b: pointer to the right-hand sides, m x k (one per column)
+        * @return matrix_t* : pointer to the solution X, n x k
+    */
+    if(!a || !b)
+        errx(MATRIX_NULL_POINTER, "m_tsqr_solve: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(a->row < a->col || !a->col || b->row != a->row)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_tsqr_solve: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    if(QR_INTEGER)
+        errx(MATRIX_INVALID_ARGUMENT, "m_tsqr_solve: %s", MATRIX_INVALID_ARGUMENT_MESSAGE);
+
+    size_t n = a->col, k = b->col;
+    MATRIX_STAT(MATRIX_OP_LSTSQ, n * k, QR_FLOPS(a->row, n + k) + (uint64_t)n * n * k,
+                ((uint64_t)a->row * (n + k) + (uint64_t)n * k) * sizeof(MATRIX_TYPE));
+
+    matrix_t *r, *result;
+    if(!(r = qr_tsqr(a, b)))
+        return NULL;
+
+    // R = [R11 Q^T B; 0 ...]: R11 X = the top right block
+    qr_check_rank(r->data, r->stride, a->row, n, "m_tsqr_solve");
+    if((result = matrix_alloc(n, k))){
+        matrix_t qtb = matrix_view(r, 0, n, n, k);
+        matrix_copyto(&qtb, result);
+        matrix_trsm_upper(n, k, r->data, r->stride, result->data, result->stride);
+    }
+    matrix_free(r);
+    return result;
+}
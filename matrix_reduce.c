@@ -0,0 +1,726 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <err.h>
+
+#include "matrix.h"
+#include "matrix_simd.h"
+#include "matrix_stats.h"
+#include "matrix_thread.h"
+#include "matrix_view.h"
+#include "state.h"
+
+/*
+ * Reduction engine behind m_reduce and the m_*fd functions.
+ *
+ * Every requested statistic is computed during a single pass over the matrix:
+ * - COLUMN and ALL reduce contiguous spans. A span is cut into chunks of
+ *   REDUCE_CHUNK elements (L1 resident) and each requested kernel runs over the
+ *   chunk with several vector accumulators; the chunk results are then folded
+ *   into the running state (pairwise tree, compensated or straight sum).
+ * - ROW reduces down the columns: a strip of REDUCE_STRIP columns is swept row
+ *   by row, each row updating one vector accumulator per column. Sums are
+ *   gathered in blocks of REDUCE_BLOCK rows before being folded the same way.
+ * Rows (COLUMN), strips (ROW) or ranges of elements (ALL) are spread over the
+ * thread pool; partial results are always combined in the same order, so the
+ * result does not depend on the number of threads.
+ */
+
+// elements per chunk of a span (and pairwise leaf)
+#define REDUCE_CHUNK 256
+
+// columns per strip of a ROW reduction
+#define REDUCE_STRIP 256
+
+// rows summed straight before being folded, ROW reductions
+#define REDUCE_BLOCK 64
+
+// elements per task of the ALL and COLUMN reductions (a multiple of REDUCE_CHUNK)
+#define REDUCE_TASK ((size_t)1 << 16)
+
+// below this many elements, waking the worker pool costs more than it saves
+#define REDUCE_PARALLEL ((size_t)1 << 18)
+
+// levels of the pairwise tree: 2^64 chunks
+#define REDUCE_LEVELS 64
+
+// elements per vector accumulator
+#define REDUCE_LANES (64 / sizeof(MATRIX_TYPE))
+
+typedef MATRIX_TYPE reduce_v __attribute__((vector_size(64)));
+typedef MATRIX_TYPE reduce_uv __attribute__((vector_size(64), aligned(sizeof(MATRIX_TYPE))));
+// integers of the width of MATRIX_TYPE: comparison results (0 or -1) and row indices
+typedef __typeof__(__builtin_choose_expr(sizeof(MATRIX_TYPE) == 8, (int64_t)0, (int32_t)0)) reduce_idx_t;
+typedef reduce_idx_t reduce_m __attribute__((vector_size(64)));
+typedef reduce_idx_t reduce_um __attribute__((vector_size(64), aligned(sizeof(MATRIX_TYPE))));
+
+#define REDUCE_LOAD(p) ((reduce_v)*(const reduce_uv *)(p))
+#define REDUCE_SEL(m, a, b) ((reduce_v)(((m) & (reduce_m)(a)) | (~(m) & (reduce_m)(b))))
+
+// element transforms: vector (V) and scalar (S) forms
+#define REDUCE_IDV(x) (x)
+#define REDUCE_IDS(x) (x)
+#define REDUCE_ABSV(x) REDUCE_SEL((x) < 0, -(x), (x))
+#define REDUCE_ABSS(x) ((x) < 0 ? -(x) : (x))
+#define REDUCE_SQRV(x) ((x) * (x))
+#define REDUCE_SQRS(x) ((x) * (x))
+
+// the three summed quantities: x, |x| and x^2
+enum{
+    REDUCE_X,
+    REDUCE_ABS,
+    REDUCE_SQR
+};
+
+// statistics to compute
+#define REDUCE_SUM  (1 << REDUCE_X)
+#define REDUCE_ASUM (1 << REDUCE_ABS)
+#define REDUCE_SSQ  (1 << REDUCE_SQR)
+#define REDUCE_PROD 8
+#define REDUCE_MIN  16
+#define REDUCE_MAX  32
+#define REDUCE_AMAX 64
+
+static inline void reduce_neumaier(MATRIX_TYPE *s, MATRIX_TYPE *c, MATRIX_TYPE x){
+    // compensated addition of x to the sum s with compensation c (Neumaier's variant of Kahan)
+    MATRIX_TYPE t = *s + x;
+    if(REDUCE_ABSS(*s) >= REDUCE_ABSS(x))
+        *c += (*s - t) + x;
+    else
+        *c += (x - t) + *s;
+    *s = t;
+}
+
+/*
+ * Span kernels: reduce the n elements of x to one value.
+ */
+#define REDUCE_HSUM(name, attr, FV, FS)                                                     \
+attr static MATRIX_TYPE name(const MATRIX_TYPE *restrict x, size_t n){                      \
+    reduce_v a0 = {0}, a1 = {0};                                                            \
+    size_t i = 0;                                                                           \
+    for(; i + 2*REDUCE_LANES <= n; i += 2*REDUCE_LANES){                                    \
+        reduce_v x0 = REDUCE_LOAD(x + i), x1 = REDUCE_LOAD(x + i + REDUCE_LANES);           \
+        a0 += FV(x0);                                                                       \
+        a1 += FV(x1);                                                                       \
+    }                                                                                       \
+    if(i + REDUCE_LANES <= n){                                                              \
+        reduce_v x0 = REDUCE_LOAD(x + i);                                                   \
+        a0 += FV(x0);                                                                       \
+        i += REDUCE_LANES;                                                                  \
+    }                                                                                       \
+    a0 += a1;                                                                               \
+    MATRIX_TYPE s = 0;                                                                      \
+    for(size_t l = 0; l < REDUCE_LANES; l++)                                                \
+        s += a0[l];                                                                         \
+    for(; i < n; i++)                                                                       \
+        s += FS(x[i]);                                                                      \
+    return s;                                                                               \
+}
+
+#define REDUCE_HKAHAN(name, attr, FV, FS)                                                   \
+attr static MATRIX_TYPE name(const MATRIX_TYPE *restrict x, size_t n){                      \
+    reduce_v s = {0}, c = {0};                                                              \
+    size_t i = 0;                                                                           \
+    for(; i + REDUCE_LANES <= n; i += REDUCE_LANES){                                        \
+        reduce_v x0 = REDUCE_LOAD(x + i);                                                   \
+        reduce_v y = FV(x0) - c, t = s + y;                                                 \
+        c = (t - s) - y;                                                                    \
+        s = t;                                                                              \
+    }                                                                                       \
+    MATRIX_TYPE ss = 0, cc = 0;                                                             \
+    for(size_t l = 0; l < REDUCE_LANES; l++){                                               \
+        reduce_neumaier(&ss, &cc, s[l]);                                                    \
+        reduce_neumaier(&ss, &cc, -c[l]);                                                   \
+    }                                                                                       \
+    for(; i < n; i++)                                                                       \
+        reduce_neumaier(&ss, &cc, FS(x[i]));                                                \
+    return ss + cc;                                                                         \
+}
+
+#define REDUCE_HPROD(name, attr)                                                            \
+attr static MATRIX_TYPE name(const MATRIX_TYPE *restrict x, size_t n){                      \
+    reduce_v a0 = (reduce_v){0} + 1, a1 = a0;                                               \
+    size_t i = 0;                                                                           \
+    for(; i + 2*REDUCE_LANES <= n; i += 2*REDUCE_LANES){                                    \
+        a0 *= REDUCE_LOAD(x + i);                                                           \
+        a1 *= REDUCE_LOAD(x + i + REDUCE_LANES);                                            \
+    }                                                                                       \
+    a0 *= a1;                                                                               \
+    MATRIX_TYPE p = 1;                                                                      \
+    for(size_t l = 0; l < REDUCE_LANES; l++)                                                \
+        p *= a0[l];                                                                         \
+    for(; i < n; i++)                                                                       \
+        p *= x[i];                                                                          \
+    return p;                                                                               \
+}
+
+// n >= 1; NaN elements are skipped unless they come first
+#define REDUCE_HCMP(name, attr, FV, FS, OP)                                                 \
+attr static MATRIX_TYPE name(const MATRIX_TYPE *restrict x, size_t n){                      \
+    MATRIX_TYPE r = FS(x[0]);                                                               \
+    size_t i = 0;                                                                           \
+    if(n >= REDUCE_LANES){                                                                  \
+        reduce_v a = REDUCE_LOAD(x);                                                        \
+        a = FV(a);                                                                          \
+        for(i = REDUCE_LANES; i + REDUCE_LANES <= n; i += REDUCE_LANES){                    \
+            reduce_v x0 = REDUCE_LOAD(x + i);                                               \
+            x0 = FV(x0);                                                                    \
+            a = REDUCE_SEL(x0 OP a, x0, a);                                                 \
+        }                                                                                   \
+        r = a[0];                                                                           \
+        for(size_t l = 1; l < REDUCE_LANES; l++)                                            \
+            if(a[l] OP r)                                                                   \
+                r = a[l];                                                                   \
+    }                                                                                       \
+    for(; i < n; i++)                                                                       \
+        if(FS(x[i]) OP r)                                                                   \
+            r = FS(x[i]);                                                                   \
+    return r;                                                                               \
+}
+
+/*
+ * Column kernels: fold the w elements of row x into one accumulator per column.
+ */
+#define REDUCE_VSUM(name, attr, FV, FS)                                                     \
+attr static void name(const MATRIX_TYPE *restrict x, MATRIX_TYPE *restrict acc, size_t w){  \
+    size_t j = 0;                                                                           \
+    for(; j + REDUCE_LANES <= w; j += REDUCE_LANES){                                        \
+        reduce_v x0 = REDUCE_LOAD(x + j);                                                   \
+        *(reduce_uv *)(acc + j) = REDUCE_LOAD(acc + j) + FV(x0);                            \
+    }                                                                                       \
+    for(; j < w; j++)                                                                       \
+        acc[j] += FS(x[j]);                                                                 \
+}
+
+#define REDUCE_VPROD(name, attr)                                                            \
+attr static void name(const MATRIX_TYPE *restrict x, MATRIX_TYPE *restrict acc, size_t w){  \
+    size_t j = 0;                                                                           \
+    for(; j + REDUCE_LANES <= w; j += REDUCE_LANES)                                         \
+        *(reduce_uv *)(acc + j) = REDUCE_LOAD(acc + j) * REDUCE_LOAD(x + j);                \
+    for(; j < w; j++)                                                                       \
+        acc[j] *= x[j];                                                                     \
+}
+
+// ARG: also record the row index i where the accumulator changes
+#define REDUCE_VCMP(name, attr, FV, FS, OP, ARG)                                            \
+attr static void name(const MATRIX_TYPE *restrict x, MATRIX_TYPE *restrict acc,             \
+                      reduce_idx_t *restrict idx, size_t w, reduce_idx_t i){                \
+    reduce_m iv = (reduce_m){0} + i;                                                        \
+    size_t j = 0;                                                                           \
+    for(; j + REDUCE_LANES <= w; j += REDUCE_LANES){                                        \
+        reduce_v x0 = REDUCE_LOAD(x + j), a = REDUCE_LOAD(acc + j);                         \
+        x0 = FV(x0);                                                                        \
+        reduce_m m = x0 OP a;                                                               \
+        *(reduce_uv *)(acc + j) = REDUCE_SEL(m, x0, a);                                     \
+        if(ARG)                                                                             \
+            *(reduce_um *)(idx + j) = (m & iv) | (~m & *(const reduce_um *)(idx + j));      \
+    }                                                                                       \
+    for(; j < w; j++)                                                                       \
+        if(FS(x[j]) OP acc[j]){                                                             \
+            acc[j] = FS(x[j]);                                                              \
+            if(ARG)                                                                         \
+                idx[j] = i;                                                                 \
+        }                                                                                   \
+}
+
+typedef struct {
+    // span: sum of x, |x| and x^2, straight and compensated
+    MATRIX_TYPE (*sum[3])(const MATRIX_TYPE *x, size_t n);
+    MATRIX_TYPE (*kahan[3])(const MATRIX_TYPE *x, size_t n);
+    MATRIX_TYPE (*prod)(const MATRIX_TYPE *x, size_t n);
+    MATRIX_TYPE (*min)(const MATRIX_TYPE *x, size_t n);
+    MATRIX_TYPE (*max)(const MATRIX_TYPE *x, size_t n);
+    MATRIX_TYPE (*amax)(const MATRIX_TYPE *x, size_t n);
+
+    // columns: acc[j] += x[j], |x[j]|, x[j]^2
+    void (*vsum[3])(const MATRIX_TYPE *x, MATRIX_TYPE *acc, size_t w);
+    void (*vprod)(const MATRIX_TYPE *x, MATRIX_TYPE *acc, size_t w);
+    void (*vmin)(const MATRIX_TYPE *x, MATRIX_TYPE *acc, reduce_idx_t *idx, size_t w, reduce_idx_t i);
+    void (*vmax)(const MATRIX_TYPE *x, MATRIX_TYPE *acc, reduce_idx_t *idx, size_t w, reduce_idx_t i);
+    void (*vamax)(const MATRIX_TYPE *x, MATRIX_TYPE *acc, reduce_idx_t *idx, size_t w, reduce_idx_t i);
+}reduce_kernels_t;
+
+// REDUCE_KERNELS(isa, attr) defines the kernel table reduce_isa, compiled with the function attributes attr
+#define REDUCE_KERNELS(isa, attr)                                                           \
+REDUCE_HSUM(isa##_sum, attr, REDUCE_IDV, REDUCE_IDS)                                        \
+REDUCE_HSUM(isa##_asum, attr, REDUCE_ABSV, REDUCE_ABSS)                                     \
+REDUCE_HSUM(isa##_ssq, attr, REDUCE_SQRV, REDUCE_SQRS)                                      \
+REDUCE_HKAHAN(isa##_ksum, attr, REDUCE_IDV, REDUCE_IDS)                                     \
+REDUCE_HKAHAN(isa##_kasum, attr, REDUCE_ABSV, REDUCE_ABSS)                                  \
+REDUCE_HKAHAN(isa##_kssq, attr, REDUCE_SQRV, REDUCE_SQRS)                                   \
+REDUCE_HPROD(isa##_prod, attr)                                                              \
+REDUCE_HCMP(isa##_min, attr, REDUCE_IDV, REDUCE_IDS, <)                                     \
+REDUCE_HCMP(isa##_max, attr, REDUCE_IDV, REDUCE_IDS, >)                                     \
+REDUCE_HCMP(isa##_amax, attr, REDUCE_ABSV, REDUCE_ABSS, >)                                  \
+REDUCE_VSUM(isa##_vsum, attr, REDUCE_IDV, REDUCE_IDS)                                       \
+REDUCE_VSUM(isa##_vasum, attr, REDUCE_ABSV, REDUCE_ABSS)                                    \
+REDUCE_VSUM(isa##_vssq, attr, REDUCE_SQRV, REDUCE_SQRS)                                     \
+REDUCE_VPROD(isa##_vprod, attr)                                                             \
+REDUCE_VCMP(isa##_vmin, attr, REDUCE_IDV, REDUCE_IDS, <, 1)                                 \
+REDUCE_VCMP(isa##_vmax, attr, REDUCE_IDV, REDUCE_IDS, >, 1)                                 \
+REDUCE_VCMP(isa##_vamax, attr, REDUCE_ABSV, REDUCE_ABSS, >, 0)                              \
+                                                                                            \
+static const reduce_kernels_t reduce_##isa = {                                              \
+    { isa##_sum, isa##_asum, isa##_ssq },                                                   \
+    { isa##_ksum, isa##_kasum, isa##_kssq },                                                \
+    isa##_prod, isa##_min, isa##_max, isa##_amax,                                           \
+    { isa##_vsum, isa##_vasum, isa##_vssq },                                                \
+    isa##_vprod, isa##_vmin, isa##_vmax, isa##_vamax                                        \
+};
+
+REDUCE_KERNELS(generic, )
+
+#if defined(__x86_64__) || defined(__i386__)
+REDUCE_KERNELS(avx2, __attribute__((target("avx2"))))
+REDUCE_KERNELS(avx512, __attribute__((target("avx512f"))))
+#endif
+
+static const reduce_kernels_t *reduce_kernels(void){
+    /*
+        * kernel table matching the instruction set selected at startup
+        * @return const reduce_kernels_t* : kernels
+    */
+#if defined(__x86_64__) || defined(__i386__)
+    if(matrix_simd->level >= MATRIX_SIMD_AVX512)
+        return &reduce_avx512;
+    if(matrix_simd->level >= MATRIX_SIMD_AVX2)
+        return &reduce_avx2;
+#endif
+    return &reduce_generic;
+}
+
+/*
+ * Running sums: straight, compensated (s + c) or pairwise. In pairwise mode the
+ * chunk partials are merged like a binary counter: level k holds the sum of 2^k
+ * chunks and is occupied when bit k of the chunk count is set.
+ */
+typedef struct {
+    MATRIX_TYPE s, c;
+    MATRIX_TYPE level[REDUCE_LEVELS];
+    uint64_t count;
+}reduce_sum_t;
+
+static void reduce_sum_push(reduce_sum_t *r, matrix_sum_t mode, MATRIX_TYPE p){
+    // fold the partial sum p into r
+    switch(mode){
+    case MATRIX_SUM_NAIVE:
+        r->s += p;
+        break;
+    case MATRIX_SUM_KAHAN:
+        reduce_neumaier(&r->s, &r->c, p);
+        break;
+    default:{
+        int k = 0;
+        for(; r->count >> k & 1; k++)
+            p = r->level[k] + p;
+        r->level[k] = p;
+        r->count++;
+    }
+    }
+}
+
+static MATRIX_TYPE reduce_sum_value(const reduce_sum_t *r, matrix_sum_t mode){
+    // total of the partial sums folded into r
+    if(mode != MATRIX_SUM_PAIRWISE)
+        return r->s + r->c;
+
+    MATRIX_TYPE s = 0;
+    for(int k = 0; k < REDUCE_LEVELS && r->count >> k; k++)
+        if(r->count >> k & 1)
+            s = r->level[k] + s;
+    return s;
+}
+
+// reduction of one output element in progress
+typedef struct {
+    size_t n;
+    reduce_sum_t sum[3];
+    MATRIX_TYPE prod, min, max, amax;
+    size_t argmin, argmax;
+}reduce_cell_t;
+
+// reduction of one output element, done
+typedef struct {
+    size_t n;
+    MATRIX_TYPE sum[3];
+    MATRIX_TYPE prod, min, max, amax;
+    size_t argmin, argmax;
+    MATRIX_TYPE comp[3];        // MATRIX_SUM_KAHAN: compensation of sum, kept apart until the partials are merged
+}reduce_out_t;
+
+typedef struct {
+    const reduce_kernels_t *k;
+    const matrix_t *m1;
+    matrix_dir_t dir;
+    const matrix_reduce_t *out;
+    int stats;
+    size_t per_task;            // rows (COLUMN) or elements (ALL) per task
+    reduce_out_t *partial;      // ALL: result of each task
+}reduce_job_t;
+
+static void reduce_cell_init(reduce_cell_t *cell){
+    cell->n = 0;
+    for(int k = 0; k < 3; k++){
+        cell->sum[k].s = cell->sum[k].c = 0;
+        cell->sum[k].count = 0;
+    }
+    cell->prod = 1;
+    cell->min = cell->max = cell->amax = 0;
+    cell->argmin = cell->argmax = 0;
+}
+
+static size_t reduce_find(const MATRIX_TYPE *x, size_t n, MATRIX_TYPE v){
+    // index of the first element equal to v
+    for(size_t i = 0; i < n; i++)
+        if(x[i] == v)
+            return i;
+    return 0;
+}
+
+static void reduce_span(const reduce_job_t *job, reduce_cell_t *cell, const MATRIX_TYPE *x, size_t n, size_t base){
+    /*
+        * fold the span x[0..n) into cell, chunk by chunk
+        * @params base: index of x[0] reported by argmin / argmax
+    */
+    const reduce_kernels_t *k = job->k;
+    matrix_sum_t mode = job->out->mode;
+    int stats = job->stats;
+
+    for(size_t i = 0; i < n; i += REDUCE_CHUNK){
+        const MATRIX_TYPE *p = x + i;
+        size_t len = n - i < REDUCE_CHUNK ? n - i : REDUCE_CHUNK;
+
+        for(int s = 0; s < 3; s++)
+            if(stats & 1 << s)
+                reduce_sum_push(&cell->sum[s], mode, mode == MATRIX_SUM_KAHAN ? k->kahan[s](p, len) : k->sum[s](p, len));
+        if(stats & REDUCE_PROD)
+            cell->prod *= k->prod(p, len);
+        if(stats & REDUCE_MIN){
+            MATRIX_TYPE v = k->min(p, len);
+            if(!cell->n || v < cell->min){
+                cell->min = v;
+                cell->argmin = base + i + reduce_find(p, len, v);
+            }
+        }
+        if(stats & REDUCE_MAX){
+            MATRIX_TYPE v = k->max(p, len);
+            if(!cell->n || v > cell->max){
+                cell->max = v;
+                cell->argmax = base + i + reduce_find(p, len, v);
+            }
+        }
+        if(stats & REDUCE_AMAX){
+            MATRIX_TYPE v = k->amax(p, len);
+            if(v > cell->amax)
+                cell->amax = v;
+        }
+        cell->n += len;
+    }
+}
+
+static void reduce_cell_done(const reduce_job_t *job, const reduce_cell_t *cell, reduce_out_t *r){
+    matrix_sum_t mode = job->out->mode;
+    r->n = cell->n;
+    for(int s = 0; s < 3; s++){
+        r->sum[s] = mode == MATRIX_SUM_KAHAN ? cell->sum[s].s : reduce_sum_value(&cell->sum[s], mode);
+        r->comp[s] = mode == MATRIX_SUM_KAHAN ? cell->sum[s].c : 0;
+    }
+    r->prod = cell->prod;
+    r->min = cell->min;
+    r->max = cell->max;
+    r->amax = cell->amax;
+    r->argmin = cell->argmin;
+    r->argmax = cell->argmax;
+}
+
+static void reduce_merge(reduce_out_t *a, const reduce_out_t *b, matrix_sum_t mode){
+    // a = reduction of a followed by b, the sums added in the summation mode
+    if(!b->n)
+        return;
+    if(!a->n){
+        *a = *b;
+        return;
+    }
+    for(int s = 0; s < 3; s++)
+        if(mode == MATRIX_SUM_KAHAN){
+            reduce_neumaier(&a->sum[s], &a->comp[s], b->sum[s]);
+            a->comp[s] += b->comp[s];
+        }else
+            a->sum[s] += b->sum[s];
+    a->prod *= b->prod;
+    if(b->min < a->min){
+        a->min = b->min;
+        a->argmin = b->argmin;
+    }
+    if(b->max > a->max){
+        a->max = b->max;
+        a->argmax = b->argmax;
+    }
+    if(b->amax > a->amax)
+        a->amax = b->amax;
+    a->n += b->n;
+}
+
+static void reduce_store(const reduce_job_t *job, size_t c, const reduce_out_t *r){
+    // write the requested outputs of element c of the result
+    const matrix_reduce_t *out = job->out;
+    size_t i = job->dir == COLUMN ? c : 0, j = job->dir == ROW ? c : 0;
+    MATRIX_TYPE sum = r->sum[REDUCE_X] + r->comp[REDUCE_X];
+
+    if(out->sum)
+        MATRIX_AT(out->sum, i, j) = sum;
+    if(out->mean)
+        MATRIX_AT(out->mean, i, j) = r->n ? sum / (MATRIX_TYPE)r->n : 0;
+    if(out->prod)
+        MATRIX_AT(out->prod, i, j) = r->prod;
+    if(out->min)
+        MATRIX_AT(out->min, i, j) = r->min;
+    if(out->max)
+        MATRIX_AT(out->max, i, j) = r->max;
+    if(out->argmin)
+        out->argmin[c] = r->argmin;
+    if(out->argmax)
+        out->argmax[c] = r->argmax;
+    if(out->norm1)
+        MATRIX_AT(out->norm1, i, j) = r->sum[REDUCE_ABS] + r->comp[REDUCE_ABS];
+    if(out->norm2)
+        MATRIX_AT(out->norm2, i, j) = (MATRIX_TYPE)sqrt((double)(r->sum[REDUCE_SQR] + r->comp[REDUCE_SQR]));
+    if(out->norminf)
+        MATRIX_AT(out->norminf, i, j) = r->amax;
+}
+
+static void reduce_columns_task(void *ctx, size_t task){
+    // COLUMN: rows [task*per_task, ...), each one reduced to one element
+    const reduce_job_t *job = ctx;
+    const matrix_t *m1 = job->m1;
+    size_t i0 = task * job->per_task;
+    size_t i1 = m1->row - i0 < job->per_task ? m1->row : i0 + job->per_task;
+
+    for(size_t i = i0; i < i1; i++){
+        reduce_cell_t cell;
+        reduce_out_t r;
+        reduce_cell_init(&cell);
+        reduce_span(job, &cell, &MATRIX_AT(m1, i, 0), m1->col, 0);
+        reduce_cell_done(job, &cell, &r);
+        reduce_store(job, i, &r);
+    }
+}
+
+static void reduce_all_task(void *ctx, size_t task){
+    // ALL: elements [task*per_task, ...) in row-major order, reduced to one partial result
+    const reduce_job_t *job = ctx;
+    const matrix_t *m1 = job->m1;
+    size_t n = m1->row * m1->col;
+    size_t f = task * job->per_task;
+    size_t f1 = n - f < job->per_task ? n : f + job->per_task;
+    reduce_cell_t cell;
+    reduce_cell_init(&cell);
+
+    if(matrix_dense(m1))
+        reduce_span(job, &cell, m1->data + f, f1 - f, f);
+    else
+        while(f < f1){
+            size_t i = f / m1->col, j = f % m1->col;
+            size_t len = m1->col - j < f1 - f ? m1->col - j : f1 - f;
+            reduce_span(job, &cell, &MATRIX_AT(m1, i, j), len, f);
+            f += len;
+        }
+
+    reduce_cell_done(job, &cell, &job->partial[task]);
+}
+
+static void reduce_fold_columns(matrix_sum_t mode, MATRIX_TYPE *restrict b, MATRIX_TYPE *restrict s,
+                                MATRIX_TYPE *restrict c, MATRIX_TYPE *restrict level, size_t w, size_t count){
+    /*
+        * fold the block partials b of w columns into their running sums, the columns
+        * counterpart of reduce_sum_push
+        * @params s, c: running sums and compensations
+        *         level: pairwise levels, w elements each
+        *         count: blocks folded so far
+    */
+    switch(mode){
+    case MATRIX_SUM_NAIVE:
+        for(size_t j = 0; j < w; j++)
+            s[j] += b[j];
+        break;
+    case MATRIX_SUM_KAHAN:
+        for(size_t j = 0; j < w; j++)
+            reduce_neumaier(&s[j], &c[j], b[j]);
+        break;
+    default:{
+        int k = 0;
+        for(; count >> k & 1; k++)
+            for(size_t j = 0; j < w; j++)
+                b[j] = level[k*w + j] + b[j];
+        memcpy(level + k*w, b, w * sizeof(MATRIX_TYPE));
+    }
+    }
+}
+
+static void reduce_rows_task(void *ctx, size_t task){
+    // ROW: columns [task*REDUCE_STRIP, ...), swept down the rows
+    const reduce_job_t *job = ctx;
+    const reduce_kernels_t *k = job->k;
+    const matrix_t *m1 = job->m1;
+    matrix_sum_t mode = job->out->mode;
+    int stats = job->stats;
+    size_t j0 = task * REDUCE_STRIP;
+    size_t w = m1->col - j0 < REDUCE_STRIP ? m1->col - j0 : REDUCE_STRIP;
+    size_t blocks = (m1->row + REDUCE_BLOCK - 1) / REDUCE_BLOCK;
+
+    // pairwise levels: one per bit of the block count
+    size_t depth = 1;
+    for(size_t b = blocks; b > 1; b >>= 1)
+        depth++;
+
+    // per summed quantity: block partials, sums, compensations and levels
+    size_t per_sum = (3 + depth) * w;
+    MATRIX_TYPE *ws = malloc((3*per_sum + 4*w) * sizeof(MATRIX_TYPE) + 2*w * sizeof(reduce_idx_t));
+    if(!ws)
+        errx(MATRIX_MEMORY_ERROR, "m_reduce: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+
+    MATRIX_TYPE *blk[3], *sum[3], *comp[3], *level[3];
+    for(int s = 0; s < 3; s++){
+        blk[s] = ws + s*per_sum;
+        sum[s] = blk[s] + w;
+        comp[s] = sum[s] + w;
+        level[s] = comp[s] + w;
+        memset(sum[s], 0, 2*w * sizeof(MATRIX_TYPE));
+    }
+    MATRIX_TYPE *prod = ws + 3*per_sum, *min = prod + w, *max = min + w, *amax = max + w;
+    reduce_idx_t *argmin = (reduce_idx_t *)(amax + w), *argmax = argmin + w;
+
+    for(size_t j = 0; j < w; j++){
+        prod[j] = 1;
+        amax[j] = 0;
+        min[j] = max[j] = m1->row ? MATRIX_AT(m1, 0, j0 + j) : 0;
+        argmin[j] = argmax[j] = 0;
+    }
+
+    for(size_t b = 0; b < blocks; b++){
+        size_t i0 = b * REDUCE_BLOCK;
+        size_t i1 = m1->row - i0 < REDUCE_BLOCK ? m1->row : i0 + REDUCE_BLOCK;
+
+        for(int s = 0; s < 3; s++)
+            if(stats & 1 << s)
+                memset(blk[s], 0, w * sizeof(MATRIX_TYPE));
+
+        for(size_t i = i0; i < i1; i++){
+            const MATRIX_TYPE *x = &MATRIX_AT(m1, i, j0);
+            for(int s = 0; s < 3; s++)
+                if(stats & 1 << s)
+                    k->vsum[s](x, blk[s], w);
+            if(stats & REDUCE_PROD)
+                k->vprod(x, prod, w);
+            if(stats & REDUCE_MIN)
+                k->vmin(x, min, argmin, w, (reduce_idx_t)i);
+            if(stats & REDUCE_MAX)
+                k->vmax(x, max, argmax, w, (reduce_idx_t)i);
+            if(stats & REDUCE_AMAX)
+                k->vamax(x, amax, NULL, w, 0);
+        }
+
+        for(int s = 0; s < 3; s++)
+            if(stats & 1 << s)
+                reduce_fold_columns(mode, blk[s], sum[s], comp[s], level[s], w, b);
+    }
+
+    for(size_t j = 0; j < w; j++){
+        reduce_out_t r = { m1->row, {0}, prod[j], min[j], max[j], amax[j], (size_t)argmin[j], (size_t)argmax[j], {0} };
+        for(int s = 0; s < 3; s++){
+            if(!(stats & 1 << s))
+                continue;
+            if(mode != MATRIX_SUM_PAIRWISE)
+                r.sum[s] = sum[s][j] + comp[s][j];
+            else
+                for(size_t d = 0; d < depth; d++)
+                    if(blocks >> d & 1)
+                        r.sum[s] = level[s][d*w + j] + r.sum[s];
+        }
+        reduce_store(job, j0 + j, &r);
+    }
+
+    free(ws);
+}
+
+static void reduce_check(const matrix_t *out, size_t row, size_t col){
+    if(out && (out->row != row || out->col != col))
+        errx(MATRIX_INVALID_DIMENSIONS, "m_reduce: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+}
+
+void m_reduce(const matrix_t *m1, matrix_dir_t dir, const matrix_reduce_t *out){
+    /*
+        * several reductions following a direction, in one pass over the matrix
+        * every non-NULL output of out is written; the outputs must not overlap m1
+        * @params m1: pointer to the matrix
+        *         dir: direction (ROW, COLUMN or ALL)
+        *         out: pointer to the outputs and the summation mode
+    */
+    if(!m1 || !out)
+        errx(MATRIX_NULL_POINTER, "m_reduce: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    size_t row = dir == COLUMN ? m1->row : 1, col = dir == ROW ? m1->col : 1;
+    reduce_check(out->sum, row, col);
+    reduce_check(out->prod, row, col);
+    reduce_check(out->mean, row, col);
+    reduce_check(out->min, row, col);
+    reduce_check(out->max, row, col);
+    reduce_check(out->norm1, row, col);
+    reduce_check(out->norm2, row, col);
+    reduce_check(out->norminf, row, col);
+
+    MATRIX_STAT_REDUCE(MATRIX_OP_REDUCE, m1->row * m1->col, row * col);
+
+    reduce_job_t job = { reduce_kernels(), m1, dir, out, 0, 0, NULL };
+    if(out->sum || out->mean)
+        job.stats |= REDUCE_SUM;
+    if(out->norm1)
+        job.stats |= REDUCE_ASUM;
+    if(out->norm2)
+        job.stats |= REDUCE_SSQ;
+    if(out->prod)
+        job.stats |= REDUCE_PROD;
+    if(out->min || out->argmin)
+        job.stats |= REDUCE_MIN;
+    if(out->max || out->argmax)
+        job.stats |= REDUCE_MAX;
+    if(out->norminf)
+        job.stats |= REDUCE_AMAX;
+
+    size_t n = m1->row * m1->col, ntasks;
+    void (*task)(void *, size_t);
+
+    switch(dir){
+    case ROW:
+        ntasks = (m1->col + REDUCE_STRIP - 1) / REDUCE_STRIP;
+        task = reduce_rows_task;
+        break;
+    case COLUMN:
+        job.per_task = m1->col < REDUCE_TASK ? REDUCE_TASK / (m1->col ? m1->col : 1) : 1;
+        ntasks = (m1->row + job.per_task - 1) / job.per_task;
+        task = reduce_columns_task;
+        break;
+    default:
+        job.per_task = REDUCE_TASK;
+        ntasks = n ? (n + REDUCE_TASK - 1) / REDUCE_TASK : 1;
+        task = reduce_all_task;
+        if(!(job.partial = malloc(ntasks * sizeof(reduce_out_t))))
+            errx(MATRIX_MEMORY_ERROR, "m_reduce: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+    }
+
+    if(n >= REDUCE_PARALLEL && ntasks > 1)
+        matrix_parallel_for(ntasks, task, &job);
+    else
+        for(size_t t = 0; t < ntasks; t++)
+            task(&job, t);
+
+    if(job.partial){
+        // the partials of consecutive tasks merged as a binary tree: O(log ntasks) error growth when pairwise
+        for(size_t step = 1; step < ntasks; step *= 2)
+            for(size_t t = 0; t + step < ntasks; t += 2 * step)
+                reduce_merge(&job.partial[t], &job.partial[t + step], out->mode);
+        reduce_store(&job, 0, &job.partial[0]);
+        free(job.partial);
+    }
+}
@@ -0,0 +1,198 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "matrix_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+// outputs at least this large bypass the cache (non-temporal stores)
+#define SIMD_STREAM_BYTES ((size_t)8 << 20)
+
+static void scalar_add(const MATRIX_TYPE *a, const MATRIX_TYPE *b, MATRIX_TYPE *out, size_t n){
+    for(size_t i = 0; i < n; i++)
+        out[i] = a[i] + b[i];
+}
+
+static void scalar_sub(const MATRIX_TYPE *a, const MATRIX_TYPE *b, MATRIX_TYPE *out, size_t n){
+    for(size_t i = 0; i < n; i++)
+        out[i] = a[i] - b[i];
+}
+
+static void scalar_kadd(const MATRIX_TYPE *a, MATRIX_TYPE k, MATRIX_TYPE *out, size_t n){
+    for(size_t i = 0; i < n; i++)
+        out[i] = a[i] + k;
+}
+
+static void scalar_kmul(const MATRIX_TYPE *a, MATRIX_TYPE k, MATRIX_TYPE *out, size_t n){
+    for(size_t i = 0; i < n; i++)
+        out[i] = a[i] * k;
+}
+
+static void scalar_fill(MATRIX_TYPE *out, MATRIX_TYPE x, size_t n){
+    for(size_t i = 0; i < n; i++)
+        out[i] = x;
+}
+
+static void scalar_copy(const MATRIX_TYPE *a, MATRIX_TYPE *out, size_t n){
+    memmove(out, a, n * sizeof(MATRIX_TYPE));
+}
+
+static const matrix_simd_t simd_scalar = {
+    MATRIX_SIMD_SCALAR, "scalar",
+    scalar_add, scalar_sub, scalar_kadd, scalar_kmul, scalar_fill, scalar_copy
+};
+
+const matrix_simd_t *matrix_simd = &simd_scalar;
+
+#ifdef SIMD_X86
+
+/*
+ * The vector variants are generated from a single body per operation, written
+ * with compiler vector extensions so that they work for any MATRIX_TYPE.
+ * Each instruction set provides:
+ * - SIMD_TARGET_<isa>: the target attribute of its functions
+ * - SIMD_STREAM_<isa>(p, v): a non-temporal store of one vector
+ */
+#define SIMD_TARGET_sse2 __attribute__((target("sse2")))
+#define SIMD_TARGET_avx2 __attribute__((target("avx2")))
+#define SIMD_TARGET_avx512 __attribute__((target("avx512f")))
+
+#define SIMD_STREAM_sse2(p, v) _mm_stream_si128((__m128i *)(p), (__m128i)(v))
+#define SIMD_STREAM_avx2(p, v) _mm256_stream_si256((__m256i *)(p), (__m256i)(v))
+#define SIMD_STREAM_avx512(p, v) _mm512_stream_si512((void *)(p), (__m512i)(v))
+
+// vector of type V at element i of p
+#define SIMD_AT(V, p, i) (*(V *)&(p)[i])
+
+// p and q have the same offset modulo the vector size
+#define SIMD_COALIGNED(p, q, vb) ((((uintptr_t)(p) ^ (uintptr_t)(q)) % (vb)) == 0)
+
+/*
+ * Loop skeleton shared by all kernels, writing out[0..n)
+ * - ALIGNED: whether the inputs share the misalignment of out
+ * - VEXPR(V): value of the vector at element i, for vector type V
+ * - SEXPR: value of the element i
+ */
+#define SIMD_LOOP(isa, vb, ALIGNED, VEXPR, SEXPR)                                              \
+    const size_t vl = (vb) / sizeof(MATRIX_TYPE);                                              \
+    size_t i = 0;                                                                              \
+    if(ALIGNED){                                                                               \
+        for(; i < n && (uintptr_t)&out[i] % (vb); i++)                                         \
+            out[i] = SEXPR;                                                                    \
+        if(n * sizeof(MATRIX_TYPE) >= SIMD_STREAM_BYTES){                                      \
+            for(; i + vl <= n; i += vl)                                                        \
+                SIMD_STREAM_##isa(&out[i], VEXPR(simd_##isa##_a));                             \
+            _mm_sfence();                                                                      \
+        }else{                                                                                 \
+            for(; i + vl <= n; i += vl)                                                        \
+                SIMD_AT(simd_##isa##_a, out, i) = VEXPR(simd_##isa##_a);                       \
+        }                                                                                      \
+    }                                                                                          \
+    for(; i + vl <= n; i += vl)                                                                \
+        SIMD_AT(simd_##isa##_u, out, i) = VEXPR(simd_##isa##_u);                               \
+    for(; i < n; i++)                                                                          \
+        out[i] = SEXPR;
+
+#define SIMD_ADD_V(V) (SIMD_AT(V, a, i) + SIMD_AT(V, b, i))
+#define SIMD_SUB_V(V) (SIMD_AT(V, a, i) - SIMD_AT(V, b, i))
+#define SIMD_KADD_V(V) (SIMD_AT(V, a, i) + k)
+#define SIMD_KMUL_V(V) (SIMD_AT(V, a, i) * k)
+#define SIMD_FILL_V(V) ((V){0} + x)
+#define SIMD_COPY_V(V) (SIMD_AT(V, a, i))
+
+#define SIMD_KERNELS(isa, vb, level)                                                           \
+typedef MATRIX_TYPE simd_##isa##_a __attribute__((vector_size(vb)));                           \
+typedef MATRIX_TYPE simd_##isa##_u __attribute__((vector_size(vb), aligned(sizeof(MATRIX_TYPE)))); \
+                                                                                               \
+SIMD_TARGET_##isa static void isa##_add(const MATRIX_TYPE *a, const MATRIX_TYPE *b,            \
+                                        MATRIX_TYPE *out, size_t n){                           \
+    SIMD_LOOP(isa, vb, SIMD_COALIGNED(a, out, vb) && SIMD_COALIGNED(b, out, vb),               \
+              SIMD_ADD_V, a[i] + b[i])                                                         \
+}                                                                                              \
+                                                                                               \
+SIMD_TARGET_##isa static void isa##_sub(const MATRIX_TYPE *a, const MATRIX_TYPE *b,            \
+                                        MATRIX_TYPE *out, size_t n){                           \
+    SIMD_LOOP(isa, vb, SIMD_COALIGNED(a, out, vb) && SIMD_COALIGNED(b, out, vb),               \
+              SIMD_SUB_V, a[i] - b[i])                                                         \
+}                                                                                              \
+                                                                                               \
+SIMD_TARGET_##isa static void isa##_kadd(const MATRIX_TYPE *a, MATRIX_TYPE k,                  \
+                                         MATRIX_TYPE *out, size_t n){                          \
+    SIMD_LOOP(isa, vb, SIMD_COALIGNED(a, out, vb), SIMD_KADD_V, a[i] + k)                      \
+}                                                                                              \
+                                                                                               \
+SIMD_TARGET_##isa static void isa##_kmul(const MATRIX_TYPE *a, MATRIX_TYPE k,                  \
+                                         MATRIX_TYPE *out, size_t n){                          \
+    SIMD_LOOP(isa, vb, SIMD_COALIGNED(a, out, vb), SIMD_KMUL_V, a[i] * k)                      \
+}                                                                                              \
+                                                                                               \
+SIMD_TARGET_##isa static void isa##_fill(MATRIX_TYPE *out, MATRIX_TYPE x, size_t n){           \
+    SIMD_LOOP(isa, vb, 1, SIMD_FILL_V, x)                                                      \
+}                                                                                              \
+                                                                                               \
+SIMD_TARGET_##isa static void isa##_copy(const MATRIX_TYPE *a, MATRIX_TYPE *out, size_t n){    \
+    if(out == a)                                                                               \
+        return;                                                                                \
+    /* forward vector loads are only safe when out does not start inside a */                  \
+    if(out > a && out < a + n){                                                                \
+        memmove(out, a, n * sizeof(MATRIX_TYPE));                                              \
+        return;                                                                                \
+    }                                                                                          \
+    SIMD_LOOP(isa, vb, SIMD_COALIGNED(a, out, vb), SIMD_COPY_V, a[i])                          \
+}                                                                                              \
+                                                                                               \
+static const matrix_simd_t simd_##isa = {                                                      \
+    level, #isa, isa##_add, isa##_sub, isa##_kadd, isa##_kmul, isa##_fill, isa##_copy              \
+};
+
+SIMD_KERNELS(sse2, 16, MATRIX_SIMD_SSE2)
+SIMD_KERNELS(avx2, 32, MATRIX_SIMD_AVX2)
+SIMD_KERNELS(avx512, 64, MATRIX_SIMD_AVX512)
+
+#endif
+
+static const matrix_simd_t *const simd_tables[] = {
+    &simd_scalar,
+#ifdef SIMD_X86
+    &simd_sse2,
+    &simd_avx2,
+    &simd_avx512,
+#endif
+};
+
+static const matrix_simd_t *simd_select(void){
+    /*
+        * pick the widest kernel table supported by the host
+        * MATRIX_SIMD may lower (never raise) the selection
+        * @return const matrix_simd_t* : selected kernel table
+    */
+    matrix_simd_level_t level = MATRIX_SIMD_SCALAR;
+
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("sse2"))
+        level = MATRIX_SIMD_SSE2;
+    // the avx2 GEMM kernels are compiled with fma as well
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        level = MATRIX_SIMD_AVX2;
+    if(__builtin_cpu_supports("avx512f"))
+        level = MATRIX_SIMD_AVX512;
+#endif
+
+    const char *env = getenv("MATRIX_SIMD");
+    if(env)
+        for(size_t i = 0; i <= level; i++)
+            if(!strcmp(env, simd_tables[i]->name))
+                return simd_tables[i];
+
+    return simd_tables[level];
+}
+
+__attribute__((constructor))
+static void simd_init(void){
+    matrix_simd = simd_select();
+}
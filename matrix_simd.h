@@ -0,0 +1,50 @@
+#pragma once
+
+/**
+ * @file matrix_simd.h
+ * @brief Runtime dispatched element-wise kernels
+ *
+ * Internal header: every element-wise operation of the library ends up in one of
+ * the span kernels below. Several instruction set variants are compiled into the
+ * same binary and the best one for the host CPU is selected once at startup
+ * (CPUID). The selection can be forced with the MATRIX_SIMD environment variable
+ * (scalar, sse2, avx2 or avx512), which is mostly useful for benchmarking.
+ *
+ * Each kernel processes a contiguous span of n elements: an aligned vector loop
+ * when all operands share the same misalignment, an unaligned one otherwise, and
+ * a scalar tail. Large outputs are written with non-temporal stores so that
+ * streaming operations do not pay for a read-for-ownership of the destination.
+ */
+
+#include <stddef.h>
+
+#include "matrix.h"
+
+typedef enum{
+    MATRIX_SIMD_SCALAR,
+    MATRIX_SIMD_SSE2,
+    MATRIX_SIMD_AVX2,
+    MATRIX_SIMD_AVX512
+}matrix_simd_level_t;
+
+typedef struct {
+    matrix_simd_level_t level;
+    const char *name;
+
+    // out[i] = a[i] + b[i]
+    void (*add)(const MATRIX_TYPE *a, const MATRIX_TYPE *b, MATRIX_TYPE *out, size_t n);
+    // out[i] = a[i] - b[i]
+    void (*sub)(const MATRIX_TYPE *a, const MATRIX_TYPE *b, MATRIX_TYPE *out, size_t n);
+    // out[i] = a[i] + k
+    void (*kadd)(const MATRIX_TYPE *a, MATRIX_TYPE k, MATRIX_TYPE *out, size_t n);
+    // out[i] = a[i] * k
+    void (*kmul)(const MATRIX_TYPE *a, MATRIX_TYPE k, MATRIX_TYPE *out, size_t n);
+    // out[i] = x
+    void (*fill)(MATRIX_TYPE *out, MATRIX_TYPE x, size_t n);
+    // out[i] = a[i]
+    void (*copy)(const MATRIX_TYPE *a, MATRIX_TYPE *out, size_t n);
+}matrix_simd_t;
+
+// kernel table of the host CPU (scalar until the startup selection has run), one per element type family
+#define matrix_simd MATRIX_NAME(matrix_simd)
+extern const matrix_simd_t *matrix_simd;
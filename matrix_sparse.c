@@ -0,0 +1,943 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <err.h>
+
+#include "matrix.h"
+#include "matrix_alloc.h"
+#include "matrix_simd.h"
+#include "matrix_stats.h"
+#include "matrix_thread.h"
+#include "matrix_view.h"
+#include "state.h"
+
+/*
+ * Sparse matrices: CSR for computing, COO for assembling.
+ *
+ * Storage and time scale with the number of non-zeros:
+ * - a CSR matrix is one block: the header, row + 1 offsets, nnz values and nnz
+ *   32-bit column indices,
+ * - sparse x dense (and x vector) products split the rows into tasks holding the
+ *   same share of non-zeros plus rows, so a few heavy rows do not serialise the
+ *   product; each row is a sum of scaled rows of the dense operand (AXPY),
+ * - sparse x sparse products follow Gustavson's algorithm: a symbolic pass counts
+ *   the non-zeros of each row of the result, then a numeric pass fills them, both
+ *   with a dense accumulator of one row (marked by row, never cleared).
+ */
+
+// weight (non-zeros + rows) per task of a product, and below this weight the products run serially
+#define SPARSE_TASK ((size_t)1 << 14)
+#define SPARSE_PARALLEL ((size_t)1 << 16)
+
+// sparse x sparse: rows per task, and largest number of tasks per thread (each holds a dense row)
+#define SPARSE_ROWS 64
+#define SPARSE_TASKS_PER_THREAD 4
+
+// m_sppow switches to dense products once a factor or the product fills this fraction of its elements
+#define SPARSE_DENSE_FILL 16
+
+// rows of the result shorter than this are sorted by insertion
+#define SPARSE_INSERTION 32
+
+// elements per vector
+#define SPARSE_LANES (64 / sizeof(MATRIX_TYPE))
+
+typedef MATRIX_TYPE sparse_v __attribute__((vector_size(64)));
+typedef MATRIX_TYPE sparse_uv __attribute__((vector_size(64), aligned(sizeof(MATRIX_TYPE))));
+
+#define SPARSE_LOAD(p) ((sparse_v)*(const sparse_uv *)(p))
+
+// c[j] += a * b[j] for j in [0, n)
+#define SPARSE_AXPY(name, attr)                                                             \
+attr static void name(MATRIX_TYPE a, const MATRIX_TYPE *restrict b, MATRIX_TYPE *restrict c, size_t n){ \
+    size_t j = 0;                                                                           \
+    for(; j + 2*SPARSE_LANES <= n; j += 2*SPARSE_LANES){                                    \
+        *(sparse_uv *)(c + j) = SPARSE_LOAD(c + j) + a * SPARSE_LOAD(b + j);                \
+        *(sparse_uv *)(c + j + SPARSE_LANES) = SPARSE_LOAD(c + j + SPARSE_LANES)            \
+                                             + a * SPARSE_LOAD(b + j + SPARSE_LANES);       \
+    }                                                                                       \
+    if(j + SPARSE_LANES <= n){                                                              \
+        *(sparse_uv *)(c + j) = SPARSE_LOAD(c + j) + a * SPARSE_LOAD(b + j);                \
+        j += SPARSE_LANES;                                                                  \
+    }                                                                                       \
+    for(; j < n; j++)                                                                       \
+        c[j] += a * b[j];                                                                   \
+}
+
+SPARSE_AXPY(sparse_axpy_generic, )
+
+#if defined(__x86_64__) || defined(__i386__)
+SPARSE_AXPY(sparse_axpy_avx2, __attribute__((target("avx2"))))
+SPARSE_AXPY(sparse_axpy_avx512, __attribute__((target("avx512f"))))
+#endif
+
+typedef void (*sparse_axpy_t)(MATRIX_TYPE a, const MATRIX_TYPE *b, MATRIX_TYPE *c, size_t n);
+
+static sparse_axpy_t sparse_axpy(void){
+    /*
+        * AXPY kernel matching the instruction set selected at startup
+        * @return sparse_axpy_t : kernel
+    */
+#if defined(__x86_64__) || defined(__i386__)
+    if(matrix_simd->level >= MATRIX_SIMD_AVX512)
+        return sparse_axpy_avx512;
+    if(matrix_simd->level >= MATRIX_SIMD_AVX2)
+        return sparse_axpy_avx2;
+#endif
+    return sparse_axpy_generic;
+}
+
+static matrix_csr_t *sparse_csr_alloc(size_t row, size_t col, size_t nnz){
+    /*
+        * CSR matrix with uninitialised offsets and non-zeros, in one block
+        * @return matrix_csr_t* : the matrix, NULL on failure
+    */
+    size_t bytes = sizeof(matrix_csr_t) + (row + 1) * sizeof(size_t) + nnz * (sizeof(MATRIX_TYPE) + sizeof(uint32_t));
+    matrix_csr_t *m1;
+    if(!(m1 = malloc(bytes)))
+        return NULL;
+
+    m1->row = row;
+    m1->col = col;
+    m1->nnz = nnz;
+    m1->ptr = (size_t *)(m1 + 1);
+    m1->val = (MATRIX_TYPE *)(m1->ptr + row + 1);
+    m1->idx = (uint32_t *)(m1->val + nnz);
+    return m1;
+}
+
+matrix_coo_t* matrix_coo_init(size_t row, size_t col, size_t cap){
+    /*
+        * empty COO matrix
+        * @params row: number of rows
+        *         col: number of columns
+        *         cap: number of triplets the matrix can hold before growing
+        * @return matrix_coo_t* : pointer to the matrix
+    */
+    if(row > UINT32_MAX || col > UINT32_MAX)
+        errx(MATRIX_INVALID_DIMENSIONS, "matrix_coo_init: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    matrix_coo_t *m1;
+    if(!(m1 = malloc(sizeof(matrix_coo_t))))
+        return NULL;
+
+    *m1 = (matrix_coo_t){ row, col, 0, cap, malloc(cap * sizeof(uint32_t)), malloc(cap * sizeof(uint32_t)),
+                          malloc(cap * sizeof(MATRIX_TYPE)) };
+    if(cap && (!m1->ri || !m1->ci || !m1->val)){
+        matrix_coo_free(m1);
+        return NULL;
+    }
+    return m1;
+}
+
+void matrix_coo_push(matrix_coo_t *m1, size_t i, size_t j, MATRIX_TYPE val){
+    /*
+        * add a triplet, the storage doubles when it is full
+        * @params m1: pointer to the matrix
+        *         i: row index
+        *         j: column index
+        *         val: value, summed with the other values at (i,j) by the conversions
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_coo_push: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(i >= m1->row || j >= m1->col)
+        errx(MATRIX_INDEX_OUT_OF_BOUNDS, "matrix_coo_push: %s", MATRIX_INDEX_OUT_OF_BOUNDS_MESSAGE);
+
+    if(m1->nnz == m1->cap){
+        size_t cap = m1->cap ? 2 * m1->cap : 16;
+        uint32_t *ri = realloc(m1->ri, cap * sizeof(uint32_t));
+        if(ri)
+            m1->ri = ri;
+        uint32_t *ci = realloc(m1->ci, cap * sizeof(uint32_t));
+        if(ci)
+            m1->ci = ci;
+        MATRIX_TYPE *v = realloc(m1->val, cap * sizeof(MATRIX_TYPE));
+        if(v)
+            m1->val = v;
+        if(!ri || !ci || !v)
+            errx(MATRIX_MEMORY_ERROR, "matrix_coo_push: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+        m1->cap = cap;
+    }
+
+    m1->ri[m1->nnz] = (uint32_t)i;
+    m1->ci[m1->nnz] = (uint32_t)j;
+    m1->val[m1->nnz] = val;
+    m1->nnz++;
+}
+
+void matrix_coo_free(matrix_coo_t *m1){
+    /*
+        * free COO matrix
+        * @params m1: pointer to the matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_coo_free: %s", MATRIX_NULL_POINTER_MESSAGE);
+    free(m1->ri);
+    free(m1->ci);
+    free(m1->val);
+    free(m1);
+}
+
+void matrix_csr_free(matrix_csr_t *m1){
+    /*
+        * free CSR matrix
+        * @params m1: pointer to the matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_csr_free: %s", MATRIX_NULL_POINTER_MESSAGE);
+    free(m1);
+}
+
+matrix_csr_t* matrix_csr_from(const matrix_t *m1){
+    /*
+        * CSR copy of the non-zero elements of a matrix
+        * @params m1: pointer to the matrix
+        * @return matrix_csr_t* : pointer to the sparse matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_csr_from: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(m1->col > UINT32_MAX)
+        errx(MATRIX_INVALID_DIMENSIONS, "matrix_csr_from: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    size_t nnz = 0;
+    for(size_t i = 0; i < m1->row; i++)
+        for(size_t j = 0; j < m1->col; j++)
+            nnz += MATRIX_AT(m1, i, j) != 0;
+
+    matrix_csr_t *result;
+    if(!(result = sparse_csr_alloc(m1->row, m1->col, nnz)))
+        return NULL;
+
+    size_t k = 0;
+    result->ptr[0] = 0;
+    for(size_t i = 0; i < m1->row; i++){
+        for(size_t j = 0; j < m1->col; j++)
+            if(MATRIX_AT(m1, i, j) != 0){
+                result->idx[k] = (uint32_t)j;
+                result->val[k++] = MATRIX_AT(m1, i, j);
+            }
+        result->ptr[i + 1] = k;
+    }
+    return result;
+}
+
+// (column, value) pair of a row being sorted
+typedef struct {
+    uint32_t col;
+    MATRIX_TYPE val;
+}sparse_entry_t;
+
+static int sparse_entry_cmp(const void *a, const void *b){
+    uint32_t x = ((const sparse_entry_t *)a)->col, y = ((const sparse_entry_t *)b)->col;
+    return (x > y) - (x < y);
+}
+
+matrix_csr_t* matrix_csr_from_coo(const matrix_coo_t *m1){
+    /*
+        * CSR copy of a COO matrix, the values of repeated (i,j) are summed
+        * @params m1: pointer to the COO matrix
+        * @return matrix_csr_t* : pointer to the sparse matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_csr_from_coo: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    // bucket the triplets by row (stable counting sort)
+    size_t *start = calloc(m1->row + 1, sizeof(size_t));
+    sparse_entry_t *e = malloc(m1->nnz * sizeof(sparse_entry_t) + 1);
+    if(!start || !e){
+        free(start);
+        free(e);
+        return NULL;
+    }
+    for(size_t k = 0; k < m1->nnz; k++)
+        start[m1->ri[k] + 1]++;
+    for(size_t i = 0; i < m1->row; i++)
+        start[i + 1] += start[i];
+    for(size_t k = 0; k < m1->nnz; k++)
+        e[start[m1->ri[k]]++] = (sparse_entry_t){ m1->ci[k], m1->val[k] };
+    for(size_t i = m1->row; i > 0; i--)
+        start[i] = start[i - 1];
+    start[0] = 0;
+
+    // sort each row by column and merge its duplicates, compacting the rows towards the front of e;
+    // start[i + 1] becomes the end of row i once merged (writes never pass the entry being read)
+    size_t nnz = 0, begin = 0;
+    for(size_t i = 0; i < m1->row; i++){
+        size_t end = start[i + 1];
+        qsort(e + begin, end - begin, sizeof(sparse_entry_t), sparse_entry_cmp);
+        for(size_t k = begin; k < end; k++)
+            if(nnz > start[i] && e[nnz - 1].col == e[k].col)
+                e[nnz - 1].val += e[k].val;
+            else
+                e[nnz++] = e[k];
+        start[i + 1] = nnz;
+        begin = end;
+    }
+
+    matrix_csr_t *result;
+    if((result = sparse_csr_alloc(m1->row, m1->col, nnz))){
+        memcpy(result->ptr, start, (m1->row + 1) * sizeof(size_t));
+        for(size_t k = 0; k < nnz; k++){
+            result->idx[k] = e[k].col;
+            result->val[k] = e[k].val;
+        }
+    }
+
+    free(start);
+    free(e);
+    return result;
+}
+
+matrix_coo_t* matrix_coo_from(const matrix_t *m1){
+    /*
+        * COO copy of the non-zero elements of a matrix, in row-major order
+        * @params m1: pointer to the matrix
+        * @return matrix_coo_t* : pointer to the sparse matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_coo_from: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    size_t nnz = 0;
+    for(size_t i = 0; i < m1->row; i++)
+        for(size_t j = 0; j < m1->col; j++)
+            nnz += MATRIX_AT(m1, i, j) != 0;
+
+    matrix_coo_t *result;
+    if(!(result = matrix_coo_init(m1->row, m1->col, nnz)))
+        return NULL;
+
+    for(size_t i = 0; i < m1->row; i++)
+        for(size_t j = 0; j < m1->col; j++)
+            if(MATRIX_AT(m1, i, j) != 0){
+                result->ri[result->nnz] = (uint32_t)i;
+                result->ci[result->nnz] = (uint32_t)j;
+                result->val[result->nnz++] = MATRIX_AT(m1, i, j);
+            }
+    return result;
+}
+
+matrix_coo_t* matrix_coo_from_csr(const matrix_csr_t *m1){
+    /*
+        * COO copy of a CSR matrix, in row-major order
+        * @params m1: pointer to the CSR matrix
+        * @return matrix_coo_t* : pointer to the sparse matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_coo_from_csr: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    matrix_coo_t *result;
+    if(!(result = matrix_coo_init(m1->row, m1->col, m1->nnz)))
+        return NULL;
+
+    for(size_t i = 0; i < m1->row; i++)
+        for(size_t k = m1->ptr[i]; k < m1->ptr[i + 1]; k++)
+            result->ri[k] = (uint32_t)i;
+    memcpy(result->ci, m1->idx, m1->nnz * sizeof(uint32_t));
+    memcpy(result->val, m1->val, m1->nnz * sizeof(MATRIX_TYPE));
+    result->nnz = m1->nnz;
+    return result;
+}
+
+static void sparse_zero(matrix_t *m1){
+    // every element of m1 set to 0
+    if(matrix_dense(m1))
+        matrix_simd->fill(m1->data, 0, m1->row * m1->col);
+    else
+        for(size_t i = 0; i < m1->row; i++)
+            matrix_simd->fill(m1->data + i * m1->stride, 0, m1->col);
+}
+
+void matrix_csr_copyto(const matrix_csr_t *src, matrix_t *dest){
+    /*
+        * dense copy of a CSR matrix to dest
+        * @params src: pointer to the CSR matrix
+        *         dest: pointer to the destination matrix (same dimensions)
+    */
+    if(!src || !dest)
+        errx(MATRIX_NULL_POINTER, "matrix_csr_copyto: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(src->row != dest->row || src->col != dest->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "matrix_csr_copyto: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    sparse_zero(dest);
+    for(size_t i = 0; i < src->row; i++)
+        for(size_t k = src->ptr[i]; k < src->ptr[i + 1]; k++)
+            MATRIX_AT(dest, i, src->idx[k]) = src->val[k];
+}
+
+matrix_t* matrix_csr_to(const matrix_csr_t *m1){
+    /*
+        * dense copy of a CSR matrix
+        * @params m1: pointer to the CSR matrix
+        * @return matrix_t* : pointer to the new matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_csr_to: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(m1->row, m1->col)))
+        return NULL;
+
+    matrix_csr_copyto(m1, result);
+    return result;
+}
+
+matrix_t* matrix_coo_to(const matrix_coo_t *m1){
+    /*
+        * dense copy of a COO matrix, the values of repeated (i,j) are summed
+        * @params m1: pointer to the COO matrix
+        * @return matrix_t* : pointer to the new matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_coo_to: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(m1->row, m1->col)))
+        return NULL;
+
+    sparse_zero(result);
+    for(size_t k = 0; k < m1->nnz; k++)
+        MATRIX_AT(result, m1->ri[k], m1->ci[k]) += m1->val[k];
+    return result;
+}
+
+matrix_csr_t* matrix_csr_getcpy(const matrix_csr_t *m1){
+    /*
+        * copy of a CSR matrix
+        * @params m1: pointer to the CSR matrix
+        * @return matrix_csr_t* : pointer to the copy
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_csr_getcpy: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    matrix_csr_t *result;
+    if(!(result = sparse_csr_alloc(m1->row, m1->col, m1->nnz)))
+        return NULL;
+
+    memcpy(result->ptr, m1->ptr, (m1->row + 1) * sizeof(size_t));
+    memcpy(result->idx, m1->idx, m1->nnz * sizeof(uint32_t));
+    memcpy(result->val, m1->val, m1->nnz * sizeof(MATRIX_TYPE));
+    return result;
+}
+
+MATRIX_TYPE matrix_csr_get(const matrix_csr_t *m1, size_t i, size_t j){
+    /*
+        * element (i,j) of a CSR matrix, found by binary search in row i
+        * @params m1: pointer to the CSR matrix
+        *         i: row index
+        *         j: column index
+        * @return MATRIX_TYPE : the element, 0 if it is not stored
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "matrix_csr_get: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(i >= m1->row || j >= m1->col)
+        errx(MATRIX_INDEX_OUT_OF_BOUNDS, "matrix_csr_get: %s", MATRIX_INDEX_OUT_OF_BOUNDS_MESSAGE);
+
+    size_t lo = m1->ptr[i], hi = m1->ptr[i + 1];
+    while(lo < hi){
+        size_t mid = lo + (hi - lo) / 2;
+        if(m1->idx[mid] < j)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < m1->ptr[i + 1] && m1->idx[lo] == j ? m1->val[lo] : 0;
+}
+
+static size_t sparse_tasks(const matrix_csr_t *m1){
+    /*
+        * number of tasks of a product by m1, from its dimensions and non-zeros only
+        * @return size_t : task count, 1 below SPARSE_PARALLEL
+    */
+    size_t weight = m1->nnz + m1->row;
+    if(weight < SPARSE_PARALLEL)
+        return 1;
+    size_t ntasks = weight / SPARSE_TASK;
+    return ntasks < m1->row ? ntasks : m1->row;
+}
+
+static size_t sparse_row_at(const matrix_csr_t *m1, size_t task, size_t ntasks){
+    /*
+        * first row of a task: the rows are split so that every task gets the same weight
+        * (non-zeros + rows), the weight ptr[i] + i before row i is increasing
+        * @return size_t : first row of task, m1->row for task == ntasks
+    */
+    if(task >= ntasks)
+        return m1->row;
+    size_t target = (m1->nnz + m1->row) / ntasks * task;
+    size_t lo = 0, hi = m1->row;
+    while(lo < hi){
+        size_t mid = lo + (hi - lo) / 2;
+        if(m1->ptr[mid] + mid < target)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// y = alpha*A*x + beta*y over rows of a task
+typedef struct {
+    const matrix_csr_t *a;
+    MATRIX_TYPE alpha, beta;
+    const MATRIX_TYPE *x;
+    size_t incx;
+    MATRIX_TYPE *y;
+    size_t incy;
+    size_t ntasks;
+}sparse_spmv_t;
+
+static void sparse_spmv_task(void *ctx, size_t task){
+    const sparse_spmv_t *c = ctx;
+    const matrix_csr_t *a = c->a;
+    size_t end = sparse_row_at(a, task + 1, c->ntasks);
+
+    for(size_t i = sparse_row_at(a, task, c->ntasks); i < end; i++){
+        // two accumulators: the gathers of x are independent loads
+        MATRIX_TYPE s0 = 0, s1 = 0;
+        size_t k = a->ptr[i], stop = a->ptr[i + 1];
+        for(; k + 2 <= stop; k += 2){
+            s0 += a->val[k] * c->x[a->idx[k] * c->incx];
+            s1 += a->val[k + 1] * c->x[a->idx[k + 1] * c->incx];
+        }
+        if(k < stop)
+            s0 += a->val[k] * c->x[a->idx[k] * c->incx];
+
+        MATRIX_TYPE *y = c->y + i * c->incy;
+        *y = c->beta == 0 ? c->alpha * (s0 + s1) : c->alpha * (s0 + s1) + c->beta * *y;
+    }
+}
+
+static void sparse_spmv(MATRIX_TYPE alpha, const matrix_csr_t *m1, const matrix_t *x, MATRIX_TYPE beta, matrix_t *result){
+    // result = alpha*m1*x + beta*result, result not overlapping x
+    sparse_spmv_t ctx = { m1, alpha, beta, x->data, matrix_vec_inc(x), result->data, matrix_vec_inc(result),
+                          sparse_tasks(m1) };
+    if(ctx.ntasks == 1)
+        sparse_spmv_task(&ctx, 0);
+    else
+        matrix_parallel_for(ctx.ntasks, sparse_spmv_task, &ctx);
+}
+
+static inline uint64_t sparse_bytes(const matrix_csr_t *m1){
+    // storage of a CSR matrix, for the instrumentation
+    return (uint64_t)m1->nnz * (sizeof(*m1->val) + sizeof(*m1->idx)) + (m1->row + 1) * sizeof(*m1->ptr);
+}
+
+matrix_t* m_spmv(MATRIX_TYPE alpha, const matrix_csr_t *m1, const matrix_t *x){
+    /*
+        * sparse matrix-vector product: alpha*m1*x
+        * @params alpha: scaling of the product
+        *         m1: pointer to the CSR matrix
+        *         x: pointer to the vector (row or column)
+        * @return matrix_t* : pointer to the result vector, a row if x is a row, a column otherwise
+    */
+    if(!m1 || !x)
+        errx(MATRIX_NULL_POINTER, "m_spmv: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(!matrix_is_vec(x) || x->row * x->col != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_spmv: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_SPMV, m1->row, 2 * (uint64_t)m1->nnz,
+                sparse_bytes(m1) + ((uint64_t)m1->row + m1->col) * sizeof(MATRIX_TYPE));
+
+    matrix_t *result;
+    if(!(result = x->row == 1 && x->col != 1 ? matrix_alloc(1, m1->row) : matrix_alloc(m1->row, 1)))
+        return NULL;
+
+    sparse_spmv(alpha, m1, x, 0, result);
+    return result;
+}
+
+void m_spmvt(MATRIX_TYPE alpha, const matrix_csr_t *m1, const matrix_t *x, MATRIX_TYPE beta, matrix_t *result){
+    /*
+        * sparse matrix-vector product to result: result = alpha*m1*x + beta*result
+        * @params alpha: scaling of the product
+        *         m1: pointer to the CSR matrix
+        *         x: pointer to the vector (row or column)
+        *         beta: scaling of the previous content of result (0 to overwrite)
+        *         result: pointer to the result vector (row or column)
+    */
+    if(!m1 || !x || !result)
+        errx(MATRIX_NULL_POINTER, "m_spmvt: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(!matrix_is_vec(x) || x->row * x->col != m1->col || !matrix_is_vec(result) || result->row * result->col != m1->row)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_spmvt: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_SPMV, m1->row, 2 * (uint64_t)m1->nnz,
+                sparse_bytes(m1) + ((uint64_t)m1->row + m1->col) * sizeof(MATRIX_TYPE));
+
+    // the rows write y while other rows still read x: go through a temporary when they overlap
+    if(matrix_overlap(result, x)){
+        matrix_t *tmp;
+        if(!(tmp = matrix_getcpy(x)))
+            errx(MATRIX_MEMORY_ERROR, "m_spmvt: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+        sparse_spmv(alpha, m1, tmp, beta, result);
+        matrix_free(tmp);
+        return;
+    }
+
+    sparse_spmv(alpha, m1, x, beta, result);
+}
+
+// C = A*B over rows of a task
+typedef struct {
+    const matrix_csr_t *a;
+    const matrix_t *b;
+    matrix_t *c;
+    sparse_axpy_t axpy;
+    size_t ntasks;
+}sparse_spmm_t;
+
+static void sparse_spmm_task(void *ctx, size_t task){
+    const sparse_spmm_t *c = ctx;
+    const matrix_csr_t *a = c->a;
+    size_t n = c->b->col, end = sparse_row_at(a, task + 1, c->ntasks);
+
+    for(size_t i = sparse_row_at(a, task, c->ntasks); i < end; i++){
+        MATRIX_TYPE *crow = c->c->data + i * c->c->stride;
+        matrix_simd->fill(crow, 0, n);
+        for(size_t k = a->ptr[i]; k < a->ptr[i + 1]; k++)
+            c->axpy(a->val[k], c->b->data + a->idx[k] * c->b->stride, crow, n);
+    }
+}
+
+static void sparse_spmm(const matrix_csr_t *m1, const matrix_t *m2, matrix_t *result){
+    // result = m1*m2, result not overlapping m2
+    if(m2->col == 1){
+        sparse_spmv(1, m1, m2, 0, result);
+        return;
+    }
+
+    sparse_spmm_t ctx = { m1, m2, result, sparse_axpy(), sparse_tasks(m1) };
+    if(ctx.ntasks == 1)
+        sparse_spmm_task(&ctx, 0);
+    else
+        matrix_parallel_for(ctx.ntasks, sparse_spmm_task, &ctx);
+}
+
+matrix_t* m_spmul(const matrix_csr_t *m1, const matrix_t *m2){
+    /*
+        * sparse x dense matrix multiplication
+        * @params m1: pointer to the CSR matrix
+        *         m2: pointer to the dense matrix
+        * @return matrix_t* : pointer to the result matrix
+    */
+    if(!m1 || !m2)
+        errx(MATRIX_NULL_POINTER, "m_spmul: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(m1->col != m2->row)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_spmul: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_SPMUL, (uint64_t)m1->row * m2->col, 2 * (uint64_t)m1->nnz * m2->col,
+                sparse_bytes(m1) + ((uint64_t)m2->row + m1->row) * m2->col * sizeof(MATRIX_TYPE));
+
+    matrix_t *result;
+    if(!(result = matrix_alloc(m1->row, m2->col)))
+        return NULL;
+
+    sparse_spmm(m1, m2, result);
+    return result;
+}
+
+void m_spmult(const matrix_csr_t *m1, const matrix_t *m2, matrix_t *result){
+    /*
+        * sparse x dense matrix multiplication to result
+        * @params m1: pointer to the CSR matrix
+        *         m2: pointer to the dense matrix
+        *         result: pointer to the result matrix
+    */
+    if(!m1 || !m2 || !result)
+        errx(MATRIX_NULL_POINTER, "m_spmult: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(m1->col != m2->row || result->row != m1->row || result->col != m2->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_spmult: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_SPMUL, (uint64_t)m1->row * m2->col, 2 * (uint64_t)m1->nnz * m2->col,
+                sparse_bytes(m1) + ((uint64_t)m2->row + m1->row) * m2->col * sizeof(MATRIX_TYPE));
+
+    // the rows write C while other rows still read B: go through a temporary when they overlap
+    if(matrix_overlap(result, m2)){
+        matrix_t *tmp;
+        if(!(tmp = m_spmul(m1, m2)))
+            errx(MATRIX_MEMORY_ERROR, "m_spmult: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+        matrix_copyto(tmp, result);
+        matrix_free(tmp);
+        return;
+    }
+
+    sparse_spmm(m1, m2, result);
+}
+
+static int sparse_idx_cmp(const void *a, const void *b){
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void sparse_sort(uint32_t *v, size_t n){
+    // sort of the column indices of a row of the result
+    if(n >= SPARSE_INSERTION){
+        qsort(v, n, sizeof(uint32_t), sparse_idx_cmp);
+        return;
+    }
+    for(size_t i = 1; i < n; i++){
+        uint32_t x = v[i];
+        size_t j = i;
+        for(; j > 0 && v[j - 1] > x; j--)
+            v[j] = v[j - 1];
+        v[j] = x;
+    }
+}
+
+// C = A*B (Gustavson), per task: a range of rows and a dense accumulator of one row
+typedef struct {
+    const matrix_csr_t *a, *b;
+    matrix_csr_t *c;          // NULL during the symbolic phase
+    size_t *count;            // symbolic phase: non-zeros of each row of C
+    size_t *mark;             // ntasks x b->col stamps, 0 initially
+    MATRIX_TYPE *acc;         // ntasks x b->col
+    uint32_t *list;           // ntasks x b->col
+    size_t ntasks;
+}sparse_spgemm_t;
+
+static void sparse_spgemm_task(void *ctx, size_t task){
+    const sparse_spgemm_t *c = ctx;
+    const matrix_csr_t *a = c->a, *b = c->b;
+    size_t n = b->col, rows = a->row;
+    size_t *mark = c->mark + task * n;
+    MATRIX_TYPE *acc = c->acc + task * n;
+    uint32_t *list = c->list + task * n;
+
+    // stamps are row + 1 in the symbolic phase and row + 1 + rows in the numeric one: mark is never cleared
+    size_t first = rows * task / c->ntasks, end = rows * (task + 1) / c->ntasks;
+    for(size_t i = first; i < end; i++){
+        size_t stamp = c->c ? i + 1 + rows : i + 1, len = 0;
+
+        if(!c->c){
+            for(size_t k = a->ptr[i]; k < a->ptr[i + 1]; k++)
+                for(size_t l = b->ptr[a->idx[k]]; l < b->ptr[a->idx[k] + 1]; l++)
+                    if(mark[b->idx[l]] != stamp){
+                        mark[b->idx[l]] = stamp;
+                        len++;
+                    }
+            c->count[i] = len;
+            continue;
+        }
+
+        for(size_t k = a->ptr[i]; k < a->ptr[i + 1]; k++){
+            MATRIX_TYPE v = a->val[k];
+            for(size_t l = b->ptr[a->idx[k]]; l < b->ptr[a->idx[k] + 1]; l++){
+                uint32_t j = b->idx[l];
+                if(mark[j] != stamp){
+                    mark[j] = stamp;
+                    acc[j] = v * b->val[l];
+                    list[len++] = j;
+                }else
+                    acc[j] += v * b->val[l];
+            }
+        }
+
+        // a dense row is cheaper to collect by scanning the marks than by sorting
+        size_t out = c->c->ptr[i];
+        if(len > n / 8){
+            for(size_t j = 0; j < n; j++)
+                if(mark[j] == stamp){
+                    c->c->idx[out] = (uint32_t)j;
+                    c->c->val[out++] = acc[j];
+                }
+        }else{
+            sparse_sort(list, len);
+            for(size_t l = 0; l < len; l++){
+                c->c->idx[out + l] = list[l];
+                c->c->val[out + l] = acc[list[l]];
+            }
+        }
+    }
+}
+
+static matrix_csr_t *sparse_spgemm(const matrix_csr_t *m1, const matrix_csr_t *m2){
+    /*
+        * m1*m2 in two passes over the rows: count the non-zeros of C, then compute them
+        * the entries of C are the structural non-zeros (products that cancel are kept)
+        * @return matrix_csr_t* : the product, NULL on failure
+    */
+    size_t n = m2->col, rows = m1->row;
+    size_t *count = malloc((rows + 1) * sizeof(size_t));
+
+    size_t ntasks = (rows + SPARSE_ROWS - 1) / SPARSE_ROWS, width = SPARSE_TASKS_PER_THREAD * matrix_parallel_width();
+    if(ntasks > width)
+        ntasks = width;
+    if(m1->nnz + m2->nnz < SPARSE_PARALLEL || !ntasks)
+        ntasks = 1;
+
+    sparse_spgemm_t ctx = { m1, m2, NULL, count, calloc(ntasks * n + 1, sizeof(size_t)),
+                            malloc(ntasks * n * sizeof(MATRIX_TYPE) + 1), malloc(ntasks * n * sizeof(uint32_t) + 1), ntasks };
+    matrix_csr_t *result = NULL;
+    if(!count || !ctx.mark || !ctx.acc || !ctx.list)
+        goto out;
+
+    if(ntasks == 1)
+        sparse_spgemm_task(&ctx, 0);
+    else
+        matrix_parallel_for(ntasks, sparse_spgemm_task, &ctx);
+
+    size_t nnz = 0;
+    for(size_t i = 0; i < rows; i++)
+        nnz += count[i];
+
+    if(!(result = sparse_csr_alloc(rows, n, nnz)))
+        goto out;
+
+    result->ptr[0] = 0;
+    for(size_t i = 0; i < rows; i++)
+        result->ptr[i + 1] = result->ptr[i] + count[i];
+
+    ctx.c = result;
+    if(ntasks == 1)
+        sparse_spgemm_task(&ctx, 0);
+    else
+        matrix_parallel_for(ntasks, sparse_spgemm_task, &ctx);
+
+out:
+    free(count);
+    free(ctx.mark);
+    free(ctx.acc);
+    free(ctx.list);
+    return result;
+}
+
+static inline uint64_t sparse_spgemm_flops(const matrix_csr_t *m1, const matrix_csr_t *m2){
+    // multiply-adds of m1*m2: one per pair of an element of m1 and an element of the row of m2 it selects
+    uint64_t n = 0;
+    for(size_t k = 0; k < m1->nnz; k++)
+        n += m2->ptr[m1->idx[k] + 1] - m2->ptr[m1->idx[k]];
+    return 2 * n;
+}
+
+matrix_csr_t* m_spspmul(const matrix_csr_t *m1, const matrix_csr_t *m2){
+    /*
+        * sparse x sparse matrix multiplication
+        * @params m1: pointer to the first CSR matrix
+        *         m2: pointer to the second CSR matrix
+        * @return matrix_csr_t* : pointer to the result matrix
+    */
+    if(!m1 || !m2)
+        errx(MATRIX_NULL_POINTER, "m_spspmul: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(m1->col != m2->row)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_spspmul: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    MATRIX_STAT(MATRIX_OP_SPSPMUL, 0, sparse_spgemm_flops(m1, m2), sparse_bytes(m1) + sparse_bytes(m2));
+
+    matrix_csr_t *result = sparse_spgemm(m1, m2);
+    MATRIX_STAT_ADD(elements, result ? result->nnz : 0);
+    MATRIX_STAT_ADD(bytes, result ? sparse_bytes(result) : 0);
+    return result;
+}
+
+static matrix_csr_t *sparse_pow_dense(const matrix_csr_t *acc, const matrix_csr_t *base, size_t n){
+    /*
+        * acc*base^n with dense products, acc NULL for the identity
+        * @return matrix_csr_t* : the product, NULL on failure
+    */
+    matrix_t *b = NULL, *p = NULL, *r = NULL;
+    matrix_csr_t *result = NULL;
+
+    if(!(b = matrix_csr_to(base)) || !(p = m_pow(b, n)))
+        goto out;
+
+    if(acc){
+        if(!(r = m_spmul(acc, p)))
+            goto out;
+        result = matrix_csr_from(r);
+    }else
+        result = matrix_csr_from(p);
+
+out:
+    if(b)
+        matrix_free(b);
+    if(p)
+        matrix_free(p);
+    if(r)
+        matrix_free(r);
+    return result;
+}
+
+matrix_csr_t* m_sppow(const matrix_csr_t *m1, size_t n){
+    /*
+        * sparse matrix power by binary exponentiation
+        * powers fill in: once a factor holds more than 1/SPARSE_DENSE_FILL of its elements,
+        * the remaining products are dense (GEMM) and the result is converted back to CSR
+        * @params m1: pointer to the square CSR matrix
+        *         n: power
+        * @return matrix_csr_t* : pointer to the result matrix
+    */
+    if(!m1)
+        errx(MATRIX_NULL_POINTER, "m_sppow: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(m1->row != m1->col)
+        errx(MATRIX_INVALID_DIMENSIONS, "m_sppow: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    // the products depend on the fill-in of the powers: only the operand is known in advance
+    MATRIX_STAT(MATRIX_OP_SPPOW, 0, 0, sparse_bytes(m1));
+
+    size_t dim = m1->row, limit = dim * dim / SPARSE_DENSE_FILL;
+    matrix_csr_t *acc = NULL, *base, *next;
+
+    if(n == 0){
+        if(!(acc = sparse_csr_alloc(dim, dim, dim)))
+            return NULL;
+        for(size_t i = 0; i < dim; i++){
+            acc->ptr[i] = i;
+            acc->idx[i] = (uint32_t)i;
+            acc->val[i] = 1;
+        }
+        acc->ptr[dim] = dim;
+        return acc;
+    }
+
+    if(!(base = matrix_csr_getcpy(m1)))
+        return NULL;
+
+    for(;;){
+        if(base->nnz > limit || (acc && acc->nnz > limit)){
+            next = sparse_pow_dense(acc, base, n);
+            break;
+        }
+
+        if(n & 1){
+            if(!acc){
+                acc = base;
+                if(n == 1)
+                    return acc;
+                if(!(base = matrix_csr_getcpy(acc))){
+                    next = NULL;
+                    break;
+                }
+            }else{
+                if(!(next = sparse_spgemm(acc, base)))
+                    break;
+                matrix_csr_free(acc);
+                acc = next;
+            }
+        }
+
+        if(!(n >>= 1)){
+            next = acc;
+            acc = NULL;
+            break;
+        }
+
+        if(!(next = sparse_spgemm(base, base)))
+            break;
+        matrix_csr_free(base);
+        base = next;
+    }
+
+    if(acc)
+        matrix_csr_free(acc);
+    matrix_csr_free(base);
+    return next;
+}
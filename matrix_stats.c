@@ -0,0 +1,199 @@
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "matrix.h"
+#include "matrix_stats.h"
+
+/*
+ * Counters of the instrumentation (see matrix_stats.h).
+ *
+ * Every field is a relaxed atomic added once per outermost call: a snapshot is
+ * consistent per field, not across fields of a call still being recorded.
+ */
+
+static const char *const stats_names[MATRIX_OP_COUNT] = {
+    [MATRIX_OP_ADD] = "m_add",
+    [MATRIX_OP_KADD] = "m_kadd",
+    [MATRIX_OP_SUB] = "m_sub",
+    [MATRIX_OP_KSUB] = "m_ksub",
+    [MATRIX_OP_MUL] = "m_mul",
+    [MATRIX_OP_GEMM] = "m_gemm",
+    [MATRIX_OP_GEMV] = "m_gemv",
+    [MATRIX_OP_MUL_BATCHED] = "m_mult_batched",
+    [MATRIX_OP_POW] = "m_pow",
+    [MATRIX_OP_KMUL] = "m_kmul",
+    [MATRIX_OP_KDIV] = "m_kdiv",
+    [MATRIX_OP_DOT] = "m_dot",
+    [MATRIX_OP_TRANSP] = "m_transp",
+    [MATRIX_OP_SUMFD] = "m_sumfd",
+    [MATRIX_OP_MULFD] = "m_mulfd",
+    [MATRIX_OP_MINFD] = "m_minfd",
+    [MATRIX_OP_MAXFD] = "m_maxfd",
+    [MATRIX_OP_MEANFD] = "m_meanfd",
+    [MATRIX_OP_REDUCE] = "m_reduce",
+    [MATRIX_OP_APPLY] = "m_apply",
+    [MATRIX_OP_APPLYS] = "m_applys",
+    [MATRIX_OP_MAP] = "m_map",
+    [MATRIX_OP_CLAMP] = "m_clamp",
+    [MATRIX_OP_SPMV] = "m_spmv",
+    [MATRIX_OP_SPMUL] = "m_spmul",
+    [MATRIX_OP_SPSPMUL] = "m_spspmul",
+    [MATRIX_OP_SPPOW] = "m_sppow",
+    [MATRIX_OP_MUL_FILE] = "m_mul_file",
+    [MATRIX_OP_MAP_FILE] = "m_map_file",
+    [MATRIX_OP_LU] = "matrix_lu",
+    [MATRIX_OP_SOLVE] = "m_lu_solve",
+    [MATRIX_OP_INV] = "m_lu_inv",
+    [MATRIX_OP_DET] = "m_lu_det",
+    [MATRIX_OP_QR] = "matrix_qr",
+    [MATRIX_OP_LSTSQ] = "m_lstsq",
+    [MATRIX_OP_TSQR] = "m_tsqr",
+    [MATRIX_OP_QUANTIZE] = "matrix_quantize",
+    [MATRIX_OP_Q8_MUL] = "m_q8_mul",
+};
+
+typedef struct {
+    _Atomic uint64_t calls, elements, flops, bytes, allocs, alloc_bytes, ns;
+}stats_counter_t;
+
+static stats_counter_t stats_counters[MATRIX_OP_COUNT];
+
+// the hook and its context change together, under the lock; stats_hooked skips the lock while no hook is set
+typedef struct {
+    void (*fn)(matrix_op_t op, const matrix_stat_t *call, void *ctx);
+    void *ctx;
+}stats_hook_t;
+
+static pthread_mutex_t stats_hook_lock = PTHREAD_MUTEX_INITIALIZER;
+static stats_hook_t stats_hook;
+static atomic_int stats_hooked;
+
+#ifdef MATRIX_STATS
+
+// depth of the scopes open on this thread, and its allocations so far
+static _Thread_local int stats_depth;
+static _Thread_local uint64_t stats_allocs, stats_alloc_bytes;
+
+static uint64_t stats_now(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+static inline void stats_add(_Atomic uint64_t *counter, uint64_t x){
+    atomic_fetch_add_explicit(counter, x, memory_order_relaxed);
+}
+
+void matrix_stat_begin(matrix_stat_scope_t *scope, matrix_op_t op, uint64_t elements, uint64_t flops, uint64_t bytes){
+    scope->op = op;
+    scope->call = (matrix_stat_t){ 1, elements, flops, bytes, stats_allocs, stats_alloc_bytes, 0 };
+    scope->outer = !stats_depth++;
+    scope->start = scope->outer ? stats_now() : 0;
+}
+
+void matrix_stat_end(matrix_stat_scope_t *scope){
+    stats_depth--;
+    if(!scope->outer)
+        return;
+
+    matrix_stat_t *call = &scope->call;
+    call->ns = stats_now() - scope->start;
+    call->allocs = stats_allocs - call->allocs;
+    call->alloc_bytes = stats_alloc_bytes - call->alloc_bytes;
+
+    stats_counter_t *c = &stats_counters[scope->op];
+    stats_add(&c->calls, 1);
+    stats_add(&c->elements, call->elements);
+    stats_add(&c->flops, call->flops);
+    stats_add(&c->bytes, call->bytes);
+    stats_add(&c->allocs, call->allocs);
+    stats_add(&c->alloc_bytes, call->alloc_bytes);
+    stats_add(&c->ns, call->ns);
+
+    // called outside the lock: the hook may run operations itself
+    if(atomic_load_explicit(&stats_hooked, memory_order_relaxed)){
+        pthread_mutex_lock(&stats_hook_lock);
+        stats_hook_t hook = stats_hook;
+        pthread_mutex_unlock(&stats_hook_lock);
+        if(hook.fn)
+            hook.fn(scope->op, call, hook.ctx);
+    }
+}
+
+void matrix_stat_alloc(size_t bytes){
+    stats_allocs++;
+    stats_alloc_bytes += bytes;
+}
+
+#endif
+
+int matrix_stats_enabled(void){
+    /*
+        * the library records the instrumentation counters
+        * @return int : 1 if built with MATRIX_STATS, 0 otherwise
+    */
+#ifdef MATRIX_STATS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+void matrix_stats(matrix_stat_t stats[MATRIX_OP_COUNT]){
+    /*
+        * snapshot of the counters of every operation
+        * @params stats: MATRIX_OP_COUNT counters, indexed by matrix_op_t
+    */
+    for(size_t i = 0; i < MATRIX_OP_COUNT; i++){
+        stats_counter_t *c = &stats_counters[i];
+        stats[i] = (matrix_stat_t){
+            atomic_load_explicit(&c->calls, memory_order_relaxed),
+            atomic_load_explicit(&c->elements, memory_order_relaxed),
+            atomic_load_explicit(&c->flops, memory_order_relaxed),
+            atomic_load_explicit(&c->bytes, memory_order_relaxed),
+            atomic_load_explicit(&c->allocs, memory_order_relaxed),
+            atomic_load_explicit(&c->alloc_bytes, memory_order_relaxed),
+            atomic_load_explicit(&c->ns, memory_order_relaxed)
+        };
+    }
+}
+
+void matrix_stats_reset(void){
+    /*
+        * set every counter back to 0
+    */
+    for(size_t i = 0; i < MATRIX_OP_COUNT; i++){
+        stats_counter_t *c = &stats_counters[i];
+        atomic_store_explicit(&c->calls, 0, memory_order_relaxed);
+        atomic_store_explicit(&c->elements, 0, memory_order_relaxed);
+        atomic_store_explicit(&c->flops, 0, memory_order_relaxed);
+        atomic_store_explicit(&c->bytes, 0, memory_order_relaxed);
+        atomic_store_explicit(&c->allocs, 0, memory_order_relaxed);
+        atomic_store_explicit(&c->alloc_bytes, 0, memory_order_relaxed);
+        atomic_store_explicit(&c->ns, 0, memory_order_relaxed);
+    }
+}
+
+const char *matrix_op_name(matrix_op_t op){
+    /*
+        * name of an operation
+        * @params op: operation
+        * @return const char* : name of its basic variant, "?" for an unknown operation
+    */
+    return (unsigned)op < MATRIX_OP_COUNT ? stats_names[op] : "?";
+}
+
+void matrix_stats_hook(void (*hook)(matrix_op_t op, const matrix_stat_t *call, void *ctx), void *ctx){
+    /*
+        * set the hook called after each counted call, on the thread that made it
+        * @params hook: function receiving the operation and the counters of the call, NULL to remove it
+        *         ctx: passed to hook, always together with the hook it was set with
+        *              (a call already past its hook lookup may still run the previous pair)
+    */
+    pthread_mutex_lock(&stats_hook_lock);
+    stats_hook = (stats_hook_t){ hook, ctx };
+    atomic_store_explicit(&stats_hooked, hook != NULL, memory_order_relaxed);
+    pthread_mutex_unlock(&stats_hook_lock);
+}
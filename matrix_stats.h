@@ -0,0 +1,69 @@
+#pragma once
+
+/**
+ * @file matrix_stats.h
+ * @brief Instrumentation points of the operations
+ *
+ * Internal header: with MATRIX_STATS defined, MATRIX_STAT opens the scope of an
+ * operation, closed when the enclosing function returns. The scope opened first
+ * on a thread counts the call and its time; the scopes of the operations it
+ * calls in turn only nest. Matrix allocations are counted per thread by
+ * matrix_alloc_block and charged to the outermost scope open at that time.
+ *
+ * Without MATRIX_STATS every point expands to nothing and its arguments are
+ * not evaluated. The query API of matrix.h is always present.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "matrix.h"
+
+#ifdef MATRIX_STATS
+
+typedef struct {
+    matrix_op_t op;
+    int outer;
+    uint64_t start;
+    matrix_stat_t call;
+}matrix_stat_scope_t;
+
+// open the scope of an operation on the calling thread, with the work it is about to do
+void matrix_stat_begin(matrix_stat_scope_t *scope, matrix_op_t op, uint64_t elements, uint64_t flops, uint64_t bytes);
+
+// close a scope: the outermost one adds its call to the counters and calls the hook
+void matrix_stat_end(matrix_stat_scope_t *scope);
+
+// count a matrix allocation of bytes on the calling thread
+void matrix_stat_alloc(size_t bytes);
+
+// declaration: the scope closes when the block of the declaration ends
+#define MATRIX_STAT(op, elements, flops, bytes) \
+    matrix_stat_scope_t matrix_stat_scope __attribute__((cleanup(matrix_stat_end))); \
+    matrix_stat_begin(&matrix_stat_scope, op, elements, flops, bytes)
+
+// work known only once the operation has started (after MATRIX_STAT, in the same function)
+#define MATRIX_STAT_ADD(field, x) ((void)(matrix_stat_scope.call.field += (x)))
+
+#define MATRIX_STAT_ALLOC(bytes) matrix_stat_alloc(bytes)
+
+#else
+
+#define MATRIX_STAT(op, elements, flops, bytes) ((void)0)
+#define MATRIX_STAT_ADD(field, x) ((void)0)
+#define MATRIX_STAT_ALLOC(bytes) ((void)0)
+
+#endif
+
+// element-wise operation on n elements: flops per element, operands read and written (result included)
+#define MATRIX_STAT_MAP(op, n, flops, operands) \
+    MATRIX_STAT(op, (n), (uint64_t)(n) * (flops), (uint64_t)(n) * (operands) * sizeof(MATRIX_TYPE))
+
+// m x k by k x n product, repeated count times
+#define MATRIX_STAT_GEMM(op, count, m, n, k) \
+    MATRIX_STAT(op, (uint64_t)(count) * (m) * (n), (uint64_t)(count) * 2 * (m) * (n) * (k), \
+                (uint64_t)(count) * ((m) * (k) + (k) * (n) + (m) * (n)) * sizeof(MATRIX_TYPE))
+
+// reduction of n elements to len results
+#define MATRIX_STAT_REDUCE(op, n, len) \
+    MATRIX_STAT(op, (len), (n), ((uint64_t)(n) + (len)) * sizeof(MATRIX_TYPE))
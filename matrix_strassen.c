@@ -0,0 +1,237 @@
+#include <err.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "matrix.h"
+#include "matrix_gemm.h"
+#include "matrix_strassen.h"
+#include "matrix_thread.h"
+#include "state.h"
+
+/*
+ * One level of the recursion, C = A*B with A, B and C split in 2 x 2 blocks:
+ *
+ *   S1 = A21 + A22   T1 = B12 - B11   P1 = A11*B11   P5 = S1*T1   U2 = P1 + P6
+ *   S2 = S1 - A11    T2 = B22 - T1    P2 = A12*B21   P6 = S2*T2   U3 = U2 + P7
+ *   S3 = A11 - A21   T3 = B22 - B12   P3 = S4*B22    P7 = S3*T3   U4 = U2 + P5
+ *   S4 = A12 - S2    T4 = T2 - B21    P4 = A22*T4
+ *
+ *   C11 = P1 + P2    C12 = U4 + P3    C21 = U3 - P4    C22 = U3 + P5
+ *
+ * The S and T operands go to two temporaries X and Y, P1 to a third one Z, and
+ * the other products straight to the blocks of C that are not final yet.
+ */
+
+// default crossover (matrix_set_strassen(MATRIX_STRASSEN_AUTO)): the size at which a level of
+// recursion starts to beat the blocked kernel, where the 7/8 products outweigh the added passes
+#define STRASSEN_CROSSOVER (sizeof(MATRIX_TYPE) == 8 ? 1024 : 1536)
+
+// smallest crossover accepted, below it the block additions cost more than the products they save
+#define STRASSEN_MIN 64
+
+// rows per task of a block addition
+#define STRASSEN_ROWS 64
+
+// below this many elements, a block addition runs on the calling thread
+#define STRASSEN_PARALLEL ((size_t)1 << 18)
+
+// Z = X + sign*Y, m x n blocks, Z may be X or Y
+typedef struct {
+    size_t m, n;
+    const MATRIX_TYPE *x, *y;
+    size_t ldx, ldy;
+    MATRIX_TYPE *z;
+    size_t ldz;
+    int sign;
+}strassen_add_t;
+
+static void strassen_add_task(void *ctx, size_t task){
+    strassen_add_t *job = ctx;
+    size_t end = (task + 1) * STRASSEN_ROWS < job->m ? (task + 1) * STRASSEN_ROWS : job->m;
+    for(size_t i = task * STRASSEN_ROWS; i < end; i++){
+        const MATRIX_TYPE *x = job->x + i * job->ldx, *y = job->y + i * job->ldy;
+        MATRIX_TYPE *z = job->z + i * job->ldz;
+        if(job->sign > 0)
+            for(size_t j = 0; j < job->n; j++)
+                z[j] = x[j] + y[j];
+        else
+            for(size_t j = 0; j < job->n; j++)
+                z[j] = x[j] - y[j];
+    }
+}
+
+static void strassen_add(size_t m, size_t n, const MATRIX_TYPE *x, size_t ldx, int sign,
+                         const MATRIX_TYPE *y, size_t ldy, MATRIX_TYPE *z, size_t ldz){
+    strassen_add_t job = { m, n, x, y, ldx, ldy, z, ldz, sign };
+    size_t ntasks = (m + STRASSEN_ROWS - 1) / STRASSEN_ROWS;
+
+    if(m * n >= STRASSEN_PARALLEL && ntasks > 1)
+        matrix_parallel_for(ntasks, strassen_add_task, &job);
+    else
+        for(size_t t = 0; t < ntasks; t++)
+            strassen_add_task(&job, t);
+}
+
+// the crossover setting is shared by the element type families: only the f32 object defines it
+#if !defined(MATRIX_FAMILY_F64) && !defined(MATRIX_FAMILY_I32)
+
+// not set yet: the MATRIX_STRASSEN environment variable applies
+#define STRASSEN_UNSET ((size_t)-2)
+
+static _Atomic size_t strassen_crossover = STRASSEN_UNSET;
+
+static size_t strassen_default(void){
+    const char *env = getenv("MATRIX_STRASSEN");
+    if(!env)
+        return 0;
+    if(!strcmp(env, "auto"))
+        return MATRIX_STRASSEN_AUTO;
+    return atoll(env) > 0 ? (size_t)atoll(env) : 0;
+}
+
+void matrix_set_strassen(size_t crossover){
+    /*
+        * set the crossover of the Strassen-Winograd multiplication
+        * @params crossover: smallest dimension split by the recursion, 0 to disable it,
+        *                    MATRIX_STRASSEN_AUTO for the tuned one
+    */
+    atomic_store_explicit(&strassen_crossover, crossover == STRASSEN_UNSET ? MATRIX_STRASSEN_AUTO : crossover,
+                          memory_order_relaxed);
+}
+
+size_t matrix_get_strassen(void){
+    /*
+        * crossover of the Strassen-Winograd multiplication
+        * @return size_t : smallest dimension split by the recursion, 0 when disabled, or MATRIX_STRASSEN_AUTO
+    */
+    size_t crossover = atomic_load_explicit(&strassen_crossover, memory_order_relaxed);
+    return crossover == STRASSEN_UNSET ? strassen_default() : crossover;
+}
+
+#endif
+
+// workspace of the calling thread, grown to the largest product it has computed
+typedef struct {
+    MATRIX_TYPE *data;
+    size_t size;
+}strassen_workspace_t;
+
+static pthread_key_t strassen_key;
+static pthread_once_t strassen_key_once = PTHREAD_ONCE_INIT;
+
+static void strassen_workspace_free(void *p){
+    strassen_workspace_t *ws = p;
+    free(ws->data);
+    free(ws);
+}
+
+static void strassen_key_init(void){
+    if(pthread_key_create(&strassen_key, strassen_workspace_free))
+        errx(MATRIX_MEMORY_ERROR, "matrix_strassen: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+}
+
+size_t matrix_strassen_crossover(void){
+    size_t x = matrix_get_strassen();
+    if(x == MATRIX_STRASSEN_AUTO)
+        return STRASSEN_CROSSOVER;
+    return x && x < STRASSEN_MIN ? STRASSEN_MIN : x;
+}
+
+size_t matrix_strassen_ws(size_t m, size_t n, size_t k, size_t crossover){
+    size_t ws = 0;
+    while(crossover && m >= crossover && n >= crossover && k >= crossover){
+        m /= 2;
+        n /= 2;
+        k /= 2;
+        ws += m * k + k * n + m * n;
+    }
+    return ws;
+}
+
+MATRIX_TYPE *matrix_strassen_workspace(size_t count){
+    /*
+        * workspace of the calling thread, kept until the thread exits so that repeated products do not
+        * map and fault in a new one
+        * @params count: number of elements
+        * @return MATRIX_TYPE* : at least count elements, NULL when they cannot be allocated
+    */
+    pthread_once(&strassen_key_once, strassen_key_init);
+
+    strassen_workspace_t *ws = pthread_getspecific(strassen_key);
+    if(!ws){
+        if(!(ws = calloc(1, sizeof(strassen_workspace_t))))
+            return NULL;
+        if(pthread_setspecific(strassen_key, ws)){
+            free(ws);
+            return NULL;
+        }
+    }
+
+    if(ws->size < count){
+        free(ws->data);
+        ws->size = 0;
+        if(!(ws->data = malloc(count * sizeof(MATRIX_TYPE))))
+            return NULL;
+        ws->size = count;
+    }
+    return ws->data;
+}
+
+void matrix_strassen(size_t m, size_t n, size_t k,
+                     const MATRIX_TYPE *a, size_t lda,
+                     const MATRIX_TYPE *b, size_t ldb,
+                     MATRIX_TYPE *c, size_t ldc,
+                     size_t crossover, MATRIX_TYPE *ws){
+    if(!crossover || m < crossover || n < crossover || k < crossover){
+        matrix_gemm(m, n, k, 1, a, lda, b, ldb, 0, c, ldc);
+        return;
+    }
+
+    size_t m2 = m / 2, n2 = n / 2, k2 = k / 2;
+    const MATRIX_TYPE *a11 = a, *a12 = a + k2, *a21 = a + m2 * lda, *a22 = a21 + k2;
+    const MATRIX_TYPE *b11 = b, *b12 = b + n2, *b21 = b + k2 * ldb, *b22 = b21 + n2;
+    MATRIX_TYPE *c11 = c, *c12 = c + n2, *c21 = c + m2 * ldc, *c22 = c21 + n2;
+    MATRIX_TYPE *x = ws, *y = x + m2 * k2, *z = y + k2 * n2, *next = z + m2 * n2;
+
+    // C21 = P7, C22 = P5, C12 = P6
+    strassen_add(m2, k2, a11, lda, -1, a21, lda, x, k2);
+    strassen_add(k2, n2, b22, ldb, -1, b12, ldb, y, n2);
+    matrix_strassen(m2, n2, k2, x, k2, y, n2, c21, ldc, crossover, next);
+    strassen_add(m2, k2, a21, lda, 1, a22, lda, x, k2);
+    strassen_add(k2, n2, b12, ldb, -1, b11, ldb, y, n2);
+    matrix_strassen(m2, n2, k2, x, k2, y, n2, c22, ldc, crossover, next);
+    strassen_add(m2, k2, x, k2, -1, a11, lda, x, k2);
+    strassen_add(k2, n2, b22, ldb, -1, y, n2, y, n2);
+    matrix_strassen(m2, n2, k2, x, k2, y, n2, c12, ldc, crossover, next);
+
+    // Z = P1, C12 = U2, C21 = U3, C12 = U4, C22 = U3 + P5
+    matrix_strassen(m2, n2, k2, a11, lda, b11, ldb, z, n2, crossover, next);
+    strassen_add(m2, n2, c12, ldc, 1, z, n2, c12, ldc);
+    strassen_add(m2, n2, c21, ldc, 1, c12, ldc, c21, ldc);
+    strassen_add(m2, n2, c12, ldc, 1, c22, ldc, c12, ldc);
+    strassen_add(m2, n2, c22, ldc, 1, c21, ldc, c22, ldc);
+
+    // C11 = P3, C12 = U4 + P3
+    strassen_add(m2, k2, a12, lda, -1, x, k2, x, k2);
+    matrix_strassen(m2, n2, k2, x, k2, b22, ldb, c11, ldc, crossover, next);
+    strassen_add(m2, n2, c12, ldc, 1, c11, ldc, c12, ldc);
+
+    // C11 = P4, C21 = U3 - P4
+    strassen_add(k2, n2, y, n2, -1, b21, ldb, y, n2);
+    matrix_strassen(m2, n2, k2, a22, lda, y, n2, c11, ldc, crossover, next);
+    strassen_add(m2, n2, c21, ldc, -1, c11, ldc, c21, ldc);
+
+    // C11 = P2 + P1
+    matrix_strassen(m2, n2, k2, a12, lda, b21, ldb, c11, ldc, crossover, next);
+    strassen_add(m2, n2, c11, ldc, 1, z, n2, c11, ldc);
+
+    // odd dimensions: the last inner index, then the last column and row of C
+    if(k & 1)
+        matrix_gemm(2 * m2, 2 * n2, 1, 1, a + 2 * k2, lda, b + 2 * k2 * ldb, ldb, 1, c, ldc);
+    if(n & 1)
+        matrix_gemm(m, 1, k, 1, a, lda, b + 2 * n2, ldb, 0, c + 2 * n2, ldc);
+    if(m & 1)
+        matrix_gemm(1, 2 * n2, k, 1, a + 2 * m2 * lda, lda, b, ldb, 0, c + 2 * m2 * ldc, ldc);
+}
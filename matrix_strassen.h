@@ -0,0 +1,48 @@
+#pragma once
+
+/**
+ * @file matrix_strassen.h
+ * @brief Strassen-Winograd multiplication used by m_mul / m_mult / m_pow
+ *
+ * Internal header: operates on raw row-major storage with explicit leading
+ * dimensions, like the GEMM engine. A product whose three dimensions are all at
+ * least the crossover is split in 2 x 2 blocks and computed with the 7 block
+ * products and 15 block additions of Winograd's variant, recursively; smaller
+ * products go to matrix_gemm. An odd last row, column or inner index is peeled
+ * off and handled by matrix_gemm.
+ *
+ * The temporaries of every level are carved from a single workspace, sized up
+ * front by matrix_strassen_ws, so the recursion does not allocate. m_mul and
+ * m_mult take it from matrix_strassen_workspace, which keeps one per thread;
+ * when it cannot be allocated, the product goes to matrix_gemm instead.
+ */
+
+#include <stddef.h>
+
+#include "matrix.h"
+
+// one engine per element type family
+#define matrix_strassen_crossover MATRIX_NAME(matrix_strassen_crossover)
+#define matrix_strassen_ws        MATRIX_NAME(matrix_strassen_ws)
+#define matrix_strassen_workspace MATRIX_NAME(matrix_strassen_workspace)
+#define matrix_strassen           MATRIX_NAME(matrix_strassen)
+
+// crossover in effect for this element type (see matrix_set_strassen), 0 when disabled
+size_t matrix_strassen_crossover(void);
+
+// elements of workspace of an m x k by k x n product with this crossover, 0 when it goes to matrix_gemm
+// (crossover 0 or a dimension below it)
+size_t matrix_strassen_ws(size_t m, size_t n, size_t k, size_t crossover);
+
+// workspace of the calling thread with at least count elements, reused by the next calls on that thread
+// (released when it exits), NULL when it cannot be allocated
+MATRIX_TYPE *matrix_strassen_workspace(size_t count);
+
+// C = A*B, A is m x k (leading dimension lda), B is k x n (ldb), C is m x n (ldc)
+// ws holds matrix_strassen_ws(m, n, k, crossover) elements, the same crossover must be passed
+// C must not overlap A, B or ws
+void matrix_strassen(size_t m, size_t n, size_t k,
+                     const MATRIX_TYPE *a, size_t lda,
+                     const MATRIX_TYPE *b, size_t ldb,
+                     MATRIX_TYPE *c, size_t ldc,
+                     size_t crossover, MATRIX_TYPE *ws);
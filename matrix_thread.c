@@ -0,0 +1,579 @@
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <err.h>
+
+#include "matrix.h"
+#include "matrix_thread.h"
+#include "state.h"
+
+#define THREAD_CACHE_LINE 64
+
+// task range of one participant: low 32 bits next task, high 32 bits end
+typedef struct {
+    _Atomic uint64_t range;
+    char pad[THREAD_CACHE_LINE - sizeof(uint64_t)];
+}thread_slot_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    // held by the thread driving the current parallel loop
+    pthread_mutex_t busy;
+
+    size_t limit;
+    size_t nworkers;
+    thread_slot_t *slots;
+
+    // current loop, published under lock
+    unsigned long generation;
+    size_t participants;
+    size_t active;
+    void (*fn)(void *ctx, size_t task);
+    void *ctx;
+}thread_pool_t;
+
+static thread_pool_t pool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    PTHREAD_MUTEX_INITIALIZER, 0, 0, NULL, 0, 0, 0, NULL, NULL
+};
+
+// set in pool workers and in the driving thread while a loop runs
+static _Thread_local int thread_in_pool;
+
+// threads at work for the library, kept within the thread limit: the pool workers taking part in the
+// current loop, and the threads running an asynchronous operation (thread_counted set on those)
+static _Atomic size_t thread_busy;
+static _Thread_local int thread_counted;
+
+static void sched_notify(void);
+static void thread_atfork(void);
+
+static inline uint64_t thread_range(uint32_t begin, uint32_t end){
+    return (uint64_t)end << 32 | begin;
+}
+
+static int thread_pop(thread_slot_t *slot, size_t *task){
+    /*
+        * take the next task of a range, from the front
+        * @return int : 1 if a task was taken, 0 if the range is empty
+    */
+    uint64_t r = atomic_load_explicit(&slot->range, memory_order_relaxed);
+    for(;;){
+        uint32_t begin = (uint32_t)r, end = (uint32_t)(r >> 32);
+        if(begin >= end)
+            return 0;
+        if(atomic_compare_exchange_weak(&slot->range, &r, thread_range(begin + 1, end))){
+            *task = begin;
+            return 1;
+        }
+    }
+}
+
+static int thread_steal(thread_slot_t *victim, uint32_t *begin, uint32_t *end){
+    /*
+        * take the back half of another participant's range
+        * @return int : 1 if tasks [begin, end) were taken, 0 if the range is empty
+    */
+    uint64_t r = atomic_load_explicit(&victim->range, memory_order_relaxed);
+    for(;;){
+        uint32_t b = (uint32_t)r, e = (uint32_t)(r >> 32);
+        if(b >= e)
+            return 0;
+        uint32_t mid = b + (e - b) / 2;
+        if(atomic_compare_exchange_weak(&victim->range, &r, thread_range(b, mid))){
+            *begin = mid;
+            *end = e;
+            return 1;
+        }
+    }
+}
+
+static void thread_run(size_t me, size_t participants, void (*fn)(void *, size_t), void *ctx){
+    /*
+        * execute tasks until every range of the loop is empty
+        * @params me: slot of the calling participant
+        *         participants: number of slots in use
+    */
+    thread_slot_t *own = &pool.slots[me];
+    size_t task;
+
+    for(;;){
+        while(thread_pop(own, &task))
+            fn(ctx, task);
+
+        int stolen = 0;
+        for(size_t k = 1; k < participants && !stolen; k++){
+            uint32_t begin, end;
+            if(thread_steal(&pool.slots[(me + k) % participants], &begin, &end)){
+                atomic_store_explicit(&own->range, thread_range(begin, end), memory_order_relaxed);
+                stolen = 1;
+            }
+        }
+        if(!stolen)
+            return;
+    }
+}
+
+static void *thread_worker(void *arg){
+    size_t id = (size_t)arg;
+    unsigned long seen = 0;
+    thread_in_pool = 1;
+
+    pthread_mutex_lock(&pool.lock);
+    for(;;){
+        while(pool.generation == seen)
+            pthread_cond_wait(&pool.wake, &pool.lock);
+        seen = pool.generation;
+
+        // slot 0 belongs to the driving thread
+        if(id + 1 >= pool.participants)
+            continue;
+
+        size_t participants = pool.participants;
+        void (*fn)(void *, size_t) = pool.fn;
+        void *ctx = pool.ctx;
+        pthread_mutex_unlock(&pool.lock);
+
+        thread_run(id + 1, participants, fn, ctx);
+
+        pthread_mutex_lock(&pool.lock);
+        if(--pool.active == 0)
+            pthread_cond_signal(&pool.done);
+    }
+    return NULL;
+}
+
+static size_t thread_default_limit(void){
+    const char *env = getenv("MATRIX_NUM_THREADS");
+    if(env && atol(env) > 0)
+        return (size_t)atol(env);
+
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (size_t)n : 1;
+}
+
+static void thread_grow(size_t n){
+    /*
+        * spawn workers until n threads (caller included) can take part, pool.lock held
+        * workers are never stopped, a lower limit only leaves some of them idle
+    */
+    if(n <= pool.nworkers + 1)
+        return;
+    thread_atfork();
+
+    thread_slot_t *slots;
+    if(posix_memalign((void **)&slots, THREAD_CACHE_LINE, n * sizeof(thread_slot_t)))
+        errx(MATRIX_MEMORY_ERROR, "matrix_parallel_for: %s", MATRIX_MEMORY_ERROR_MESSAGE);
+    // no loop is running: the busy lock is held by the caller
+    free(pool.slots);
+    pool.slots = slots;
+
+    while(pool.nworkers + 1 < n){
+        pthread_t thread;
+        if(pthread_create(&thread, NULL, thread_worker, (void *)pool.nworkers))
+            break;
+        pthread_detach(thread);
+        pool.nworkers++;
+    }
+}
+
+void matrix_set_num_threads(size_t n){
+    /*
+        * set the number of threads used by parallel operations, the caller included
+        * @params n: thread count, 0 restores the default
+        *           (MATRIX_NUM_THREADS, or one thread per online CPU)
+    */
+    pthread_mutex_lock(&pool.lock);
+    pool.limit = n ? n : thread_default_limit();
+    pthread_mutex_unlock(&pool.lock);
+}
+
+size_t matrix_get_num_threads(void){
+    /*
+        * number of threads used by parallel operations, the caller included
+        * @return size_t : thread count
+    */
+    pthread_mutex_lock(&pool.lock);
+    if(!pool.limit)
+        pool.limit = thread_default_limit();
+    size_t n = pool.limit;
+    pthread_mutex_unlock(&pool.lock);
+    return n;
+}
+
+size_t matrix_parallel_width(void){
+    // the room left by the other threads at work, the calling thread always included
+    if(thread_in_pool)
+        return 1;
+    size_t n = matrix_get_num_threads();
+    size_t busy = atomic_load_explicit(&thread_busy, memory_order_relaxed) - (size_t)thread_counted;
+    return busy < n ? n - busy : 1;
+}
+
+void matrix_parallel_for(size_t ntasks, void (*fn)(void *ctx, size_t task), void *ctx){
+    /*
+        * run fn(ctx, task) for every task in [0, ntasks) on the worker pool
+        * @params ntasks: number of tasks, at most MATRIX_MAX_TASKS
+        *         fn: task body, called concurrently from several threads
+        *         ctx: shared argument of fn
+    */
+    if(ntasks > MATRIX_MAX_TASKS)
+        errx(MATRIX_INVALID_DIMENSIONS, "matrix_parallel_for: %s", MATRIX_INVALID_DIMENSIONS_MESSAGE);
+
+    size_t width = ntasks > 1 ? matrix_parallel_width() : 1;
+    if(width <= 1 || pthread_mutex_trylock(&pool.busy)){
+        for(size_t t = 0; t < ntasks; t++)
+            fn(ctx, t);
+        return;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    thread_grow(width);
+    size_t participants = width < ntasks ? width : ntasks;
+    if(participants > pool.nworkers + 1)
+        participants = pool.nworkers + 1;
+
+    for(size_t i = 0; i < participants; i++){
+        uint32_t begin = (uint32_t)(ntasks * i / participants);
+        uint32_t end = (uint32_t)(ntasks * (i + 1) / participants);
+        atomic_store_explicit(&pool.slots[i].range, thread_range(begin, end), memory_order_relaxed);
+    }
+
+    atomic_fetch_add_explicit(&thread_busy, participants - 1, memory_order_relaxed);
+    pool.fn = fn;
+    pool.ctx = ctx;
+    pool.participants = participants;
+    pool.active = participants - 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    thread_in_pool = 1;
+    thread_run(0, participants, fn, ctx);
+    thread_in_pool = 0;
+
+    pthread_mutex_lock(&pool.lock);
+    while(pool.active)
+        pthread_cond_wait(&pool.done, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+
+    pthread_mutex_unlock(&pool.busy);
+
+    // the workers are free again: operations held back by the limit may start
+    atomic_fetch_sub_explicit(&thread_busy, participants - 1, memory_order_relaxed);
+    if(participants > 1)
+        sched_notify();
+}
+
+/*
+ * Scheduler of the asynchronous operations (matrix_async and the m_*_async functions).
+ *
+ * A future becomes ready once every future it depends on has completed, and is
+ * then queued in submission order. Scheduler threads, as many as
+ * matrix_get_num_threads(), run ready futures one each, and a thread waiting for
+ * a future runs ready ones meanwhile.
+ *
+ * Every thread running an operation counts in thread_busy, with the pool
+ * workers of the current loop, and a ready future only starts while the count
+ * is below the thread limit. An operation running alone gets the whole pool for
+ * its parallel loops; several at once share the limit: the loop of one of them
+ * takes the threads the others leave (matrix_parallel_width), and the others
+ * run their loops serially.
+ *
+ * A future is referenced by its submitter until matrix_future_free and by the
+ * scheduler until it completes, and freed when both are done with it.
+ */
+
+// entry of the list of futures waiting for another one, one per dependency of the waiter
+typedef struct sched_link {
+    matrix_future_t *waiter;
+    struct sched_link *next;
+}sched_link_t;
+
+struct matrix_future {
+    void (*run)(void *args);
+    void *args;
+    _Atomic int done;
+    int refs;
+    size_t pending;             // dependencies not completed yet
+    sched_link_t *waiters;      // futures depending on this one
+    matrix_future_t *next;      // ready queue
+    sched_link_t links[];       // one per dependency, followed by the arguments of run
+};
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    pthread_cond_t done;
+    matrix_future_t *head, *tail;
+    size_t outstanding;         // submitted, not completed
+    size_t nworkers;
+}sched_t;
+
+static sched_t sched = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL, 0, 0
+};
+
+static void sched_push(matrix_future_t *f){
+    // queue a ready future, sched.lock held
+    f->next = NULL;
+    if(sched.tail)
+        sched.tail->next = f;
+    else
+        sched.head = f;
+    sched.tail = f;
+    pthread_cond_signal(&sched.ready);
+}
+
+static matrix_future_t *sched_pop(void){
+    // next ready future or NULL, sched.lock held
+    matrix_future_t *f = sched.head;
+    if(f && !(sched.head = f->next))
+        sched.tail = NULL;
+    return f;
+}
+
+static void sched_release(matrix_future_t *f){
+    // drop a reference, sched.lock held
+    if(!--f->refs)
+        free(f);
+}
+
+static matrix_future_t *sched_take(void){
+    // next ready future if the thread limit leaves room to run it, NULL otherwise, sched.lock held
+    // a thread already running an operation (waiting for a future inside it) keeps its place
+    if(!thread_counted && atomic_load_explicit(&thread_busy, memory_order_relaxed) >= matrix_get_num_threads())
+        return NULL;
+    return sched_pop();
+}
+
+static void sched_execute(matrix_future_t *f){
+    // run a future taken from the queue and complete it, sched.lock held (released while it runs)
+    int counted = thread_counted;
+    if(!counted){
+        atomic_fetch_add_explicit(&thread_busy, 1, memory_order_relaxed);
+        thread_counted = 1;
+    }
+    pthread_mutex_unlock(&sched.lock);
+    f->run(f->args);
+    pthread_mutex_lock(&sched.lock);
+    if(!counted){
+        atomic_fetch_sub_explicit(&thread_busy, 1, memory_order_relaxed);
+        thread_counted = 0;
+        pthread_cond_signal(&sched.ready);
+    }
+
+    atomic_store_explicit(&f->done, 1, memory_order_release);
+    for(sched_link_t *l = f->waiters; l; l = l->next)
+        if(!--l->waiter->pending)
+            sched_push(l->waiter);
+    f->waiters = NULL;
+    sched.outstanding--;
+    pthread_cond_broadcast(&sched.done);
+    sched_release(f);
+}
+
+static void *sched_worker(void *arg){
+    (void)arg;
+    pthread_mutex_lock(&sched.lock);
+    for(;;){
+        matrix_future_t *f;
+        while(!(f = sched_take()))
+            pthread_cond_wait(&sched.ready, &sched.lock);
+        sched_execute(f);
+    }
+    return NULL;
+}
+
+static void sched_notify(void){
+    // wake the threads waiting for room under the thread limit
+    pthread_mutex_lock(&sched.lock);
+    pthread_cond_broadcast(&sched.ready);
+    pthread_cond_broadcast(&sched.done);
+    pthread_mutex_unlock(&sched.lock);
+}
+
+static void sched_grow(void){
+    // spawn scheduler threads up to matrix_get_num_threads(), sched.lock held
+    size_t n = matrix_get_num_threads();
+    if(sched.nworkers < n)
+        thread_atfork();
+    while(sched.nworkers < n){
+        pthread_t thread;
+        if(pthread_create(&thread, NULL, sched_worker, NULL))
+            break;
+        pthread_detach(thread);
+        sched.nworkers++;
+    }
+}
+
+static void thread_fork_child(void){
+    /*
+        * child of fork: only the forking thread is left, so the pool and the scheduler start over
+        * with fresh locks and no threads (a condition variable still counting the waiters of the
+        * parent would block the child). Operations running in the parent at the fork never complete
+    */
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.wake, NULL);
+    pthread_cond_init(&pool.done, NULL);
+    pthread_mutex_init(&pool.busy, NULL);
+    pool.nworkers = 0;
+    pool.participants = 0;
+    pool.active = 0;
+
+    pthread_mutex_init(&sched.lock, NULL);
+    pthread_cond_init(&sched.ready, NULL);
+    pthread_cond_init(&sched.done, NULL);
+    sched.nworkers = 0;
+    atomic_store_explicit(&thread_busy, (size_t)thread_counted, memory_order_relaxed);
+}
+
+static void thread_fork_register(void){
+    pthread_atfork(NULL, NULL, thread_fork_child);
+}
+
+static void thread_atfork(void){
+    // reset the pool and the scheduler in forked children, once the first thread is spawned
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, thread_fork_register);
+}
+
+matrix_future_t *matrix_submit(void (*run)(void *args), const void *args, size_t size,
+                               size_t ndeps, matrix_future_t *const *deps){
+    /*
+        * queue run(copy of args) for asynchronous execution once every future of deps has completed
+        * @params run: operation, called from a scheduler thread or from a thread waiting for a future
+        *         args, size: arguments of run, copied into the future (max_align_t aligned)
+        *         ndeps, deps: futures the operation depends on
+        * @return matrix_future_t* : future of the operation, NULL on failure
+    */
+    if(ndeps && !deps)
+        errx(MATRIX_NULL_POINTER, "matrix_submit: %s", MATRIX_NULL_POINTER_MESSAGE);
+    for(size_t i = 0; i < ndeps; i++)
+        if(!deps[i])
+            errx(MATRIX_NULL_POINTER, "matrix_submit: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    size_t head = sizeof(matrix_future_t) + ndeps * sizeof(sched_link_t), align = _Alignof(max_align_t);
+    head = (head + align - 1) / align * align;
+    matrix_future_t *f;
+    if(!(f = malloc(head + size)))
+        return NULL;
+
+    f->run = run;
+    f->args = (char *)f + head;
+    if(size)
+        memcpy(f->args, args, size);
+    atomic_init(&f->done, 0);
+    f->refs = 2;
+    f->pending = 0;
+    f->waiters = NULL;
+
+    pthread_mutex_lock(&sched.lock);
+    sched_grow();
+    sched.outstanding++;
+    for(size_t i = 0; i < ndeps; i++){
+        if(atomic_load_explicit(&deps[i]->done, memory_order_relaxed))
+            continue;
+        f->links[i] = (sched_link_t){ f, deps[i]->waiters };
+        deps[i]->waiters = &f->links[i];
+        f->pending++;
+    }
+    if(!f->pending)
+        sched_push(f);
+    pthread_mutex_unlock(&sched.lock);
+    return f;
+}
+
+typedef struct {
+    void (*fn)(void *ctx);
+    void *ctx;
+}sched_call_t;
+
+static void sched_call(void *args){
+    sched_call_t *call = args;
+    call->fn(call->ctx);
+}
+
+matrix_future_t *matrix_async(void (*fn)(void *ctx), void *ctx, size_t ndeps, matrix_future_t *const *deps){
+    /*
+        * run fn(ctx) asynchronously once every future of deps has completed
+        * @params fn: function to run, on a scheduler thread or a thread waiting for a future
+        *         ctx: argument of fn
+        *         ndeps: number of futures in deps
+        *         deps: futures to wait for, may be NULL when ndeps is 0
+        * @return matrix_future_t* : future of the call, released by matrix_future_free, NULL on failure
+    */
+    if(!fn)
+        errx(MATRIX_NULL_POINTER, "matrix_async: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    return matrix_submit(sched_call, &(sched_call_t){ fn, ctx }, sizeof(sched_call_t), ndeps, deps);
+}
+
+int matrix_future_done(const matrix_future_t *f){
+    /*
+        * poll a future
+        * @params f: pointer to the future
+        * @return int : 1 if its operation has completed, 0 otherwise
+    */
+    if(!f)
+        errx(MATRIX_NULL_POINTER, "matrix_future_done: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    return atomic_load_explicit(&f->done, memory_order_acquire);
+}
+
+void matrix_future_wait(const matrix_future_t *f){
+    /*
+        * wait until the operation of a future has completed, running ready operations meanwhile
+        * its results are then visible to the calling thread
+        * @params f: pointer to the future
+    */
+    if(!f)
+        errx(MATRIX_NULL_POINTER, "matrix_future_wait: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    if(atomic_load_explicit(&f->done, memory_order_acquire))
+        return;
+
+    pthread_mutex_lock(&sched.lock);
+    while(!atomic_load_explicit(&f->done, memory_order_relaxed)){
+        matrix_future_t *ready;
+        if((ready = sched_take()))
+            sched_execute(ready);
+        else
+            pthread_cond_wait(&sched.done, &sched.lock);
+    }
+    pthread_mutex_unlock(&sched.lock);
+}
+
+void matrix_future_wait_all(void){
+    /*
+        * wait until every submitted operation has completed, running ready operations meanwhile
+    */
+    pthread_mutex_lock(&sched.lock);
+    while(sched.outstanding){
+        matrix_future_t *ready;
+        if((ready = sched_take()))
+            sched_execute(ready);
+        else
+            pthread_cond_wait(&sched.done, &sched.lock);
+    }
+    pthread_mutex_unlock(&sched.lock);
+}
+
+void matrix_future_free(matrix_future_t *f){
+    /*
+        * release a future; its operation still runs if it has not completed, but can no longer be waited for
+        * @params f: pointer to the future
+    */
+    if(!f)
+        errx(MATRIX_NULL_POINTER, "matrix_future_free: %s", MATRIX_NULL_POINTER_MESSAGE);
+
+    pthread_mutex_lock(&sched.lock);
+    sched_release(f);
+    pthread_mutex_unlock(&sched.lock);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+/**
+ * @file matrix_thread.h
+ * @brief Persistent worker pool shared by the parallel operations
+ *
+ * Internal header: the pool is created on first use and reused by every call.
+ * A parallel loop hands each participating thread an even share of the task
+ * range; a thread that runs out of work steals half of the remaining range of
+ * another one, so irregular task costs still balance.
+ *
+ * The calling thread always takes part. Calls made from inside a task, or while
+ * another thread of the application already drives the pool, run serially on
+ * the calling thread instead of waiting.
+ *
+ * The number of threads is set with matrix_set_num_threads (see matrix.h).
+ *
+ * The scheduler of the asynchronous operations runs on threads of its own, each
+ * running one operation at a time. The threads running operations and the pool
+ * workers stay within the thread limit together: the parallel loops of an
+ * operation use the threads the others leave.
+ *
+ * A child of fork starts with an empty pool and no scheduler threads; both are
+ * spawned again on first use.
+ */
+
+#include <stddef.h>
+
+#include "matrix.h"
+
+// largest task count accepted by matrix_parallel_for
+#define MATRIX_MAX_TASKS ((size_t)0xffffffffu)
+
+// run fn(ctx, task) for every task in [0, ntasks), returns once all of them are done
+void matrix_parallel_for(size_t ntasks, void (*fn)(void *ctx, size_t task), void *ctx);
+
+// number of threads (caller included) a parallel loop started now would use
+size_t matrix_parallel_width(void);
+
+// queue run(args) for asynchronous execution once every future of deps has completed, args (size bytes)
+// is copied into the future; returns the future, NULL on failure
+matrix_future_t *matrix_submit(void (*run)(void *args), const void *args, size_t size,
+                               size_t ndeps, matrix_future_t *const *deps);
@@ -0,0 +1,293 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "matrix_transp.h"
+#include "matrix_simd.h"
+#include "matrix_thread.h"
+#include "state.h"
+
+// side of the blocks transposed as a whole (in elements): two of them fit in L1
+#define TRANSP_BLOCK 64
+
+// below this many elements, waking the worker pool costs more than it saves
+#define TRANSP_PARALLEL ((size_t)1 << 20)
+
+// side of the register tiles
+#define TRANSP_TILE 8
+
+typedef void (*transp_tile_t)(const MATRIX_TYPE *a, size_t lda, MATRIX_TYPE *b, size_t ldb);
+
+/*
+ * 8x8 tile kernels: the eight rows of the tile are loaded as vectors of eight
+ * elements and transposed by three butterfly stages of two-input shuffles
+ * (2x2, then 4x4, then 8x8 blocks), then stored as the eight rows of the
+ * transposed tile. Written with compiler vector extensions so that one body
+ * serves every element type: the shuffles become unpck / shuf / perm
+ * instructions of the target ISA.
+ * TRANSP_TILE_KERNEL(name, attr) defines a kernel compiled with the function
+ * attributes attr.
+ */
+#define TRANSP_TILE_KERNEL(name, attr)                                                      \
+typedef MATRIX_TYPE name##_v                                                                \
+    __attribute__((vector_size(TRANSP_TILE * sizeof(MATRIX_TYPE)), aligned(sizeof(MATRIX_TYPE)))); \
+                                                                                            \
+attr static void name(const MATRIX_TYPE *restrict a, size_t lda, MATRIX_TYPE *restrict b, size_t ldb){ \
+    name##_v r[8], t[8];                                                                    \
+    _Pragma("GCC unroll 8")                                                                 \
+    for(int i = 0; i < 8; i++)                                                              \
+        r[i] = *(const name##_v *)(a + i*lda);                                              \
+                                                                                            \
+    _Pragma("GCC unroll 4")                                                                 \
+    for(int i = 0; i < 8; i += 2){                                                          \
+        t[i] = __builtin_shufflevector(r[i], r[i+1], 0, 8, 2, 10, 4, 12, 6, 14);            \
+        t[i+1] = __builtin_shufflevector(r[i], r[i+1], 1, 9, 3, 11, 5, 13, 7, 15);          \
+    }                                                                                       \
+    _Pragma("GCC unroll 2")                                                                 \
+    for(int i = 0; i < 8; i += 4)                                                           \
+        _Pragma("GCC unroll 2")                                                             \
+        for(int j = i; j < i + 2; j++){                                                     \
+            r[j] = __builtin_shufflevector(t[j], t[j+2], 0, 1, 8, 9, 4, 5, 12, 13);         \
+            r[j+2] = __builtin_shufflevector(t[j], t[j+2], 2, 3, 10, 11, 6, 7, 14, 15);     \
+        }                                                                                   \
+    _Pragma("GCC unroll 4")                                                                 \
+    for(int j = 0; j < 4; j++){                                                             \
+        t[j] = __builtin_shufflevector(r[j], r[j+4], 0, 1, 2, 3, 8, 9, 10, 11);             \
+        t[j+4] = __builtin_shufflevector(r[j], r[j+4], 4, 5, 6, 7, 12, 13, 14, 15);         \
+    }                                                                                       \
+                                                                                            \
+    _Pragma("GCC unroll 8")                                                                 \
+    for(int i = 0; i < 8; i++)                                                              \
+        *(name##_v *)(b + i*ldb) = t[i];                                                    \
+}
+
+TRANSP_TILE_KERNEL(transp_tile_generic, )
+
+#if defined(__x86_64__) || defined(__i386__)
+TRANSP_TILE_KERNEL(transp_tile_avx2, __attribute__((target("avx2"))))
+TRANSP_TILE_KERNEL(transp_tile_avx512, __attribute__((target("avx512f"))))
+#endif
+
+static transp_tile_t transp_tile(void){
+    /*
+        * tile kernel matching the instruction set selected at startup
+        * @return transp_tile_t : kernel
+    */
+#if defined(__x86_64__) || defined(__i386__)
+    if(matrix_simd->level >= MATRIX_SIMD_AVX512)
+        return transp_tile_avx512;
+    if(matrix_simd->level >= MATRIX_SIMD_AVX2)
+        return transp_tile_avx2;
+#endif
+    return transp_tile_generic;
+}
+
+static void transp_block(transp_tile_t tile, size_t rows, size_t cols,
+                         const MATRIX_TYPE *a, size_t lda, MATRIX_TYPE *b, size_t ldb){
+    /*
+        * transpose a block that fits in cache, by register tiles, the edges element by element
+    */
+    size_t rt = rows - rows % TRANSP_TILE, ct = cols - cols % TRANSP_TILE;
+
+    for(size_t i = 0; i < rt; i += TRANSP_TILE)
+        for(size_t j = 0; j < ct; j += TRANSP_TILE)
+            tile(a + i*lda + j, lda, b + j*ldb + i, ldb);
+
+    for(size_t i = 0; i < rows; i++)
+        for(size_t j = i < rt ? ct : 0; j < cols; j++)
+            b[j*ldb + i] = a[i*lda + j];
+}
+
+static void transp_rec(transp_tile_t tile, size_t rows, size_t cols,
+                       const MATRIX_TYPE *a, size_t lda, MATRIX_TYPE *b, size_t ldb){
+    /*
+        * cache-oblivious transposition: halve the larger dimension (on a tile boundary)
+        * until the block fits in cache
+    */
+    while(rows > TRANSP_BLOCK || cols > TRANSP_BLOCK){
+        if(rows >= cols){
+            size_t h = rows / 2 / TRANSP_TILE * TRANSP_TILE;
+            transp_rec(tile, h, cols, a, lda, b, ldb);
+            a += h*lda;
+            b += h;
+            rows -= h;
+        }else{
+            size_t h = cols / 2 / TRANSP_TILE * TRANSP_TILE;
+            transp_rec(tile, rows, h, a, lda, b, ldb);
+            a += h;
+            b += h*ldb;
+            cols -= h;
+        }
+    }
+    transp_block(tile, rows, cols, a, lda, b, ldb);
+}
+
+typedef struct {
+    transp_tile_t tile;
+    size_t rows, cols;
+    const MATRIX_TYPE *a;
+    size_t lda;
+    MATRIX_TYPE *b;
+    size_t ldb;
+}transp_job_t;
+
+static void transp_task(void *ctx, size_t task){
+    // one strip of TRANSP_BLOCK rows of A
+    const transp_job_t *job = ctx;
+    size_t i = task * TRANSP_BLOCK;
+    size_t rows = job->rows - i < TRANSP_BLOCK ? job->rows - i : TRANSP_BLOCK;
+    transp_rec(job->tile, rows, job->cols, job->a + i*job->lda, job->lda, job->b + i, job->ldb);
+}
+
+void matrix_transpose(size_t rows, size_t cols, const MATRIX_TYPE *a, size_t lda, MATRIX_TYPE *b, size_t ldb){
+    /*
+        * out of place transposition: B = A^T
+        * @params rows, cols: dimensions of A
+        *         a, lda: source and its leading dimension
+        *         b, ldb: destination (cols x rows) and its leading dimension
+    */
+    transp_job_t job = { transp_tile(), rows, cols, a, lda, b, ldb };
+
+    if(rows * cols >= TRANSP_PARALLEL)
+        matrix_parallel_for((rows + TRANSP_BLOCK - 1) / TRANSP_BLOCK, transp_task, &job);
+    else
+        transp_rec(job.tile, rows, cols, a, lda, b, ldb);
+}
+
+/*
+ * In place square transposition: the block pairs (I,J) / (J,I) above and below
+ * the diagonal are swapped, each tile of the pair being transposed in registers
+ * on its way to the other one.
+ */
+static void transp_swap_block(transp_tile_t tile, size_t rows, size_t cols,
+                              MATRIX_TYPE *x, MATRIX_TYPE *y, size_t lda){
+    /*
+        * X, Y = Y^T, X^T for the rows x cols block X and the cols x rows block Y
+        * X and Y do not overlap
+    */
+    MATRIX_TYPE tx[TRANSP_TILE * TRANSP_TILE], ty[TRANSP_TILE * TRANSP_TILE];
+    size_t rt = rows - rows % TRANSP_TILE, ct = cols - cols % TRANSP_TILE;
+
+    for(size_t i = 0; i < rt; i += TRANSP_TILE)
+        for(size_t j = 0; j < ct; j += TRANSP_TILE){
+            MATRIX_TYPE *xt = x + i*lda + j, *yt = y + j*lda + i;
+            tile(xt, lda, tx, TRANSP_TILE);
+            tile(yt, lda, ty, TRANSP_TILE);
+            for(size_t r = 0; r < TRANSP_TILE; r++){
+                memcpy(yt + r*lda, tx + r*TRANSP_TILE, TRANSP_TILE * sizeof(MATRIX_TYPE));
+                memcpy(xt + r*lda, ty + r*TRANSP_TILE, TRANSP_TILE * sizeof(MATRIX_TYPE));
+            }
+        }
+
+    for(size_t i = 0; i < rows; i++)
+        for(size_t j = i < rt ? ct : 0; j < cols; j++){
+            MATRIX_TYPE tmp = x[i*lda + j];
+            x[i*lda + j] = y[j*lda + i];
+            y[j*lda + i] = tmp;
+        }
+}
+
+static void transp_diag_block(transp_tile_t tile, size_t n, MATRIX_TYPE *a, size_t lda){
+    // in place transposition of a diagonal block
+    MATRIX_TYPE tx[TRANSP_TILE * TRANSP_TILE];
+    size_t nt = n - n % TRANSP_TILE;
+
+    for(size_t i = 0; i < nt; i += TRANSP_TILE){
+        MATRIX_TYPE *d = a + i*lda + i;
+        tile(d, lda, tx, TRANSP_TILE);
+        for(size_t r = 0; r < TRANSP_TILE; r++)
+            memcpy(d + r*lda, tx + r*TRANSP_TILE, TRANSP_TILE * sizeof(MATRIX_TYPE));
+        if(i + TRANSP_TILE < n)
+            transp_swap_block(tile, TRANSP_TILE, n - i - TRANSP_TILE, d + TRANSP_TILE,
+                              d + TRANSP_TILE*lda, lda);
+    }
+
+    for(size_t i = nt; i < n; i++)
+        for(size_t j = i + 1; j < n; j++){
+            MATRIX_TYPE tmp = a[i*lda + j];
+            a[i*lda + j] = a[j*lda + i];
+            a[j*lda + i] = tmp;
+        }
+}
+
+typedef struct {
+    transp_tile_t tile;
+    size_t n;
+    MATRIX_TYPE *a;
+    size_t lda;
+}transp_square_job_t;
+
+static void transp_square_task(void *ctx, size_t task){
+    // block row I: the diagonal block and the pairs (I,J) / (J,I) for J > I
+    const transp_square_job_t *job = ctx;
+    size_t i = task * TRANSP_BLOCK, lda = job->lda;
+    size_t rows = job->n - i < TRANSP_BLOCK ? job->n - i : TRANSP_BLOCK;
+
+    transp_diag_block(job->tile, rows, job->a + i*lda + i, lda);
+    for(size_t j = i + TRANSP_BLOCK; j < job->n; j += TRANSP_BLOCK){
+        size_t cols = job->n - j < TRANSP_BLOCK ? job->n - j : TRANSP_BLOCK;
+        transp_swap_block(job->tile, rows, cols, job->a + i*lda + j, job->a + j*lda + i, lda);
+    }
+}
+
+void matrix_transpose_square(size_t n, MATRIX_TYPE *a, size_t lda){
+    /*
+        * in place transposition of a square matrix
+        * @params n: dimension
+        *         a, lda: matrix and its leading dimension
+    */
+    transp_square_job_t job = { transp_tile(), n, a, lda };
+    size_t blocks = (n + TRANSP_BLOCK - 1) / TRANSP_BLOCK;
+
+    if(n * n >= TRANSP_PARALLEL)
+        matrix_parallel_for(blocks, transp_square_task, &job);
+    else
+        for(size_t t = 0; t < blocks; t++)
+            transp_square_task(&job, t);
+}
+
+int matrix_transpose_inplace(size_t rows, size_t cols, MATRIX_TYPE *a){
+    /*
+        * in place transposition of a dense rectangular matrix by cycle following
+        * the element at k = i*cols + j moves to j*rows + i = k*rows mod (n-1), so the
+        * element landing at k comes from k*cols mod (n-1); each cycle of this permutation
+        * is rotated once, a bitmap marking the positions already written
+        * @params rows, cols: dimensions of the source
+        *         a: dense storage of rows*cols elements
+        * @return int : 0 on success, MATRIX_MEMORY_ERROR if the bitmap cannot be allocated
+    */
+    size_t n = rows * cols;
+    if(rows <= 1 || cols <= 1)
+        return 0;
+
+    if(rows == cols){
+        matrix_transpose_square(rows, a, cols);
+        return 0;
+    }
+
+    uint64_t *done = calloc((n + 63) / 64, sizeof(uint64_t));
+    if(!done)
+        return MATRIX_MEMORY_ERROR;
+
+    // the first and last elements never move
+    for(size_t start = 1; start < n - 1; start++){
+        if(done[start / 64] >> (start % 64) & 1)
+            continue;
+
+        MATRIX_TYPE first = a[start];
+        size_t k = start;
+        for(;;){
+            size_t prev = (size_t)((unsigned __int128)k * cols % (n - 1));
+            done[k / 64] |= (uint64_t)1 << (k % 64);
+            if(prev == start){
+                a[k] = first;
+                break;
+            }
+            a[k] = a[prev];
+            k = prev;
+        }
+    }
+
+    free(done);
+    return 0;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * @file matrix_transp.h
+ * @brief Transposition kernels used by m_transp / m_transpt / m_transpp
+ *
+ * Internal header: operates on raw row-major storage with explicit leading
+ * dimensions, like the GEMM engine.
+ *
+ * The out-of-place transposition splits the larger dimension in two until a
+ * block fits in L1 (cache-oblivious), then walks the block by 8x8 tiles that are
+ * transposed in registers: reads and writes both stay on whole cache lines
+ * instead of striding through B one element at a time.
+ */
+
+#include <stddef.h>
+
+#include "matrix.h"
+
+// one set of kernels per element type family
+#define matrix_transpose         MATRIX_NAME(matrix_transpose)
+#define matrix_transpose_square  MATRIX_NAME(matrix_transpose_square)
+#define matrix_transpose_inplace MATRIX_NAME(matrix_transpose_inplace)
+
+// B = A^T, A is rows x cols (leading dimension lda), B is cols x rows (ldb)
+// A and B must not overlap
+void matrix_transpose(size_t rows, size_t cols, const MATRIX_TYPE *a, size_t lda, MATRIX_TYPE *b, size_t ldb);
+
+// in place transposition of the n x n matrix at a (leading dimension lda)
+void matrix_transpose_square(size_t n, MATRIX_TYPE *a, size_t lda);
+
+// in place transposition of the dense rows x cols matrix at a into a dense cols x rows one,
+// by following the cycles of the permutation: one bit of extra memory per element
+// returns 0, or MATRIX_MEMORY_ERROR if the bitmap cannot be allocated
+int matrix_transpose_inplace(size_t rows, size_t cols, MATRIX_TYPE *a);
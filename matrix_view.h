@@ -0,0 +1,47 @@
+#pragma once
+
+/**
+ * @file matrix_view.h
+ * @brief Storage layout helpers shared by the operations
+ *
+ * Internal header: a matrix_t is row-major with a leading dimension (stride)
+ * that may exceed its column count when it is a view on a larger matrix.
+ * Kernels working on contiguous spans use these helpers to decide whether the
+ * whole matrix is one span or must be walked row by row.
+ */
+
+#include <stddef.h>
+
+#include "matrix.h"
+
+// address of element (i,j)
+#define MATRIX_AT(m, i, j) ((m)->data[(i)*(m)->stride + (j)])
+
+// the elements of m1 form a single contiguous span of row*col elements
+static inline int matrix_dense(const matrix_t *m1){
+    return m1->stride == m1->col || m1->row <= 1;
+}
+
+// m1 and m2 share at least one byte of storage
+static inline int matrix_overlap(const matrix_t *m1, const matrix_t *m2){
+    if(!m1->row || !m1->col || !m2->row || !m2->col)
+        return 0;
+    const MATRIX_TYPE *end1 = m1->data + (m1->row - 1) * m1->stride + m1->col;
+    const MATRIX_TYPE *end2 = m2->data + (m2->row - 1) * m2->stride + m2->col;
+    return m1->data < end2 && m2->data < end1;
+}
+
+// element k of a row or column vector
+static inline MATRIX_TYPE *matrix_vec_at(const matrix_t *v, size_t k){
+    return v->row == 1 ? v->data + k : v->data + k * v->stride;
+}
+
+// v is a row or a column vector
+static inline int matrix_is_vec(const matrix_t *v){
+    return v->row == 1 || v->col == 1;
+}
+
+// distance between consecutive elements of a row or column vector
+static inline size_t matrix_vec_inc(const matrix_t *v){
+    return v->row == 1 ? 1 : v->stride;
+}
@@ -14,4 +14,10 @@
 #define MATRIX_NULL_POINTER_MESSAGE "Null pointer"
 
 #define MATRIX_POWER_NEGATIVE_EXPONENT 5
-#define MATRIX_POWER_NEGATIVE_EXPONENT_MESSAGE "Negative exponent"
\ No newline at end of file
+#define MATRIX_POWER_NEGATIVE_EXPONENT_MESSAGE "Negative exponent"
+
+#define MATRIX_INVALID_ARGUMENT 6
+#define MATRIX_INVALID_ARGUMENT_MESSAGE "Invalid argument"
+
+#define MATRIX_SINGULAR 7
+#define MATRIX_SINGULAR_MESSAGE "Singular matrix"
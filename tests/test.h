@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * @file test.h
+ * @brief Minimal harness of the test suite (make test)
+ *
+ * Every check compares an operation of the library with reference loops
+ * computed in double (exactly, for the integer family). A failed check prints
+ * its location and the values involved, and the run goes on; main returns 1 if
+ * any check failed.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+extern int test_checks, test_failures;
+
+// count a check, print the message (printf format) when cond is false
+#define TEST_CHECK(cond, ...) do{ \
+        test_checks++; \
+        if(!(cond)){ \
+            test_failures++; \
+            fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__); \
+            fputc('\n', stderr); \
+        } \
+    }while(0)
+
+// deterministic pseudo-random numbers: integers, and uniform in [lo, hi)
+uint32_t test_rand(void);
+double test_uniform(double lo, double hi);
+
+// 1 if fn(ctx) exits with status code, run in a child process (for the errx paths)
+int test_exits(void (*fn)(void *ctx), void *ctx, int code);
+
+// temporary file path, removed at exit
+const char *test_tmpfile(void);
+
+// entry points of a typed test file, compiled once per element type family (test_typed.h)
+#define TEST_TYPED(name) void name(void); void name##_f64(void); void name##_i32(void)
+#define TEST_RUN_TYPED(name) do{ name(); name##_f64(); name##_i32(); }while(0)
+
+// typed test files
+TEST_TYPED(test_gemm);
+TEST_TYPED(test_batched);
+TEST_TYPED(test_fixed);
+TEST_TYPED(test_kdiv);
+TEST_TYPED(test_transp);
+TEST_TYPED(test_reduce);
+TEST_TYPED(test_math);
+TEST_TYPED(test_gemv);
+TEST_TYPED(test_sparse);
+TEST_TYPED(test_io);
+TEST_TYPED(test_ooc);
+TEST_TYPED(test_access);
+TEST_TYPED(test_lu);
+TEST_TYPED(test_qr);
+TEST_TYPED(test_strassen);
+TEST_TYPED(test_async);
+
+// test files of the parts without element type
+void test_alloc(void);
+void test_convert(void);
+void test_stats(void);
+void test_q8(void);
@@ -0,0 +1,173 @@
+/*
+ * Tests of the element access: the unchecked getter and setter, the bulk
+ * accessors on views, matrix_gather / matrix_scatter along rows, columns and
+ * both diagonals with their bounds, and the _unchecked operations against the
+ * checked ones.
+ */
+#include <string.h>
+
+#include "test_typed.h"
+#include "state.h"
+
+// element (i,j) of the reference, with the same value in every family
+#define TEST_ACCESS_VALUE(i, j) ((MATRIX_TYPE)((i) * 100 + (j)))
+
+static void test_access_elements(void){
+    matrix_t *big = matrix_init(9, 11), v = matrix_view(big, 2, 3, 5, 7);
+    for(size_t i = 0; i < 5; i++)
+        for(size_t j = 0; j < 7; j++)
+            matrix_set_unchecked(&v, i, j, TEST_ACCESS_VALUE(i, j));
+
+    int same = 1;
+    for(size_t i = 0; i < 5; i++)
+        for(size_t j = 0; j < 7; j++)
+            same &= matrix_get(&v, i, j) == TEST_ACCESS_VALUE(i, j) && matrix_get_unchecked(&v, i, j) == TEST_ACCESS_VALUE(i, j)
+                    && matrix_row(&v, i)[j] == TEST_ACCESS_VALUE(i, j);
+    TEST_CHECK(same && big->data[2 * 11 + 3] == TEST_ACCESS_VALUE(0, 0),
+               TEST_NAME " matrix_set_unchecked / matrix_get_unchecked / matrix_row on a view");
+
+    // row-major buffer in and out of the view, the elements around it untouched
+    MATRIX_TYPE buf[35], back[35];
+    for(size_t k = 0; k < 35; k++)
+        buf[k] = (MATRIX_TYPE)(k + 1);
+    matrix_set_data(&v, buf);
+    matrix_get_data(&v, back);
+    same = !memcmp(buf, back, sizeof(buf)) && AT(&v, 4, 6) == 35 && big->data[2 * 11 + 2] == 0 && big->data[7 * 11 + 3] == 0;
+    TEST_CHECK(same, TEST_NAME " matrix_set_data / matrix_get_data on a view");
+
+    // diagonal of a wide view
+    MATRIX_TYPE diag[5] = { 1, 2, 3, 4, 5 }, dback[5];
+    matrix_set_diag(&v, diag);
+    matrix_get_diag(&v, dback);
+    TEST_CHECK(!memcmp(diag, dback, sizeof(diag)) && AT(&v, 3, 3) == 4 && AT(&v, 3, 4) == buf[3 * 7 + 4],
+               TEST_NAME " matrix_set_diag / matrix_get_diag");
+
+    matrix_t *id = matrix_Id(4), *nid = matrix_nId(3, 7);
+    same = 1;
+    for(size_t i = 0; i < 4; i++)
+        for(size_t j = 0; j < 4; j++)
+            same &= AT(id, i, j) == (i == j) && (i >= 3 || j >= 3 || AT(nid, i, j) == (i == j ? 7 : 0));
+    TEST_CHECK(same, TEST_NAME " matrix_Id / matrix_nId");
+    matrix_free(id);
+    matrix_free(nid);
+    matrix_free(big);
+}
+
+static void test_access_lines(void){
+    // lines in every direction on a strided view: (i, j, di, dj, n)
+    static const ptrdiff_t lines[][5] = {
+        {2, 0, 0, 1, 7}, {0, 4, 1, 0, 5}, {0, 0, 1, 1, 5}, {0, 6, 1, -1, 5}, {4, 6, -1, -1, 5},
+        {3, 2, 0, 0, 4}, {1, 1, 1, 2, 3}, {4, 0, -1, 0, 5}, {2, 3, 0, 1, 0},
+    };
+    matrix_t *big = matrix_init(8, 10), v = matrix_view(big, 1, 2, 5, 7);
+    for(size_t i = 0; i < 5; i++)
+        for(size_t j = 0; j < 7; j++)
+            matrix_set_unchecked(&v, i, j, TEST_ACCESS_VALUE(i, j));
+
+    for(size_t l = 0; l < sizeof(lines) / sizeof(lines[0]); l++){
+        ptrdiff_t i = lines[l][0], j = lines[l][1], di = lines[l][2], dj = lines[l][3];
+        size_t n = (size_t)lines[l][4];
+        MATRIX_TYPE buf[8];
+        matrix_gather(&v, (size_t)i, (size_t)j, di, dj, n, buf);
+        int same = 1;
+        for(size_t k = 0; k < n; k++)
+            same &= buf[k] == TEST_ACCESS_VALUE(i + (ptrdiff_t)k * di, j + (ptrdiff_t)k * dj);
+        TEST_CHECK(same, TEST_NAME " matrix_gather (%td,%td) by (%td,%td)", i, j, di, dj);
+
+        // scattered negated, then gathered back; with a zero step the last element stays
+        for(size_t k = 0; k < n; k++)
+            buf[k] = (MATRIX_TYPE)-buf[k];
+        matrix_scatter(&v, (size_t)i, (size_t)j, di, dj, n, buf);
+        same = 1;
+        for(size_t k = 0; k < n; k++)
+            same &= AT(&v, i + (ptrdiff_t)k * di, j + (ptrdiff_t)k * dj) == (di || dj ? buf[k] : buf[n - 1]);
+        TEST_CHECK(same, TEST_NAME " matrix_scatter (%td,%td) by (%td,%td)", i, j, di, dj);
+        for(size_t k = 0; k < n; k++){
+            size_t ik = (size_t)(i + (ptrdiff_t)k * di), jk = (size_t)(j + (ptrdiff_t)k * dj);
+            matrix_set_unchecked(&v, ik, jk, TEST_ACCESS_VALUE(ik, jk));
+        }
+    }
+
+    // the storage around the view is never written
+    int outside = 1;
+    for(size_t i = 0; i < 8; i++)
+        for(size_t j = 0; j < 10; j++)
+            outside &= (i >= 1 && i < 6 && j >= 2 && j < 9) || big->data[i * 10 + j] == 0;
+    TEST_CHECK(outside, TEST_NAME " matrix_scatter: written outside the view");
+    matrix_free(big);
+}
+
+// line of 3 elements leaving a 5 x 7 view: (i, j, di, dj)
+typedef struct {
+    size_t i, j;
+    ptrdiff_t di, dj;
+}test_access_line_t;
+
+static void test_access_gather_out(void *ctx){
+    const test_access_line_t *l = ctx;
+    matrix_t *big = matrix_init(8, 10), v = matrix_view(big, 1, 2, 5, 7);
+    MATRIX_TYPE buf[3];
+    matrix_gather(&v, l->i, l->j, l->di, l->dj, 3, buf);
+}
+
+static void test_access_scatter_out(void *ctx){
+    const test_access_line_t *l = ctx;
+    matrix_t *big = matrix_init(8, 10), v = matrix_view(big, 1, 2, 5, 7);
+    MATRIX_TYPE buf[3] = { 0 };
+    matrix_scatter(&v, l->i, l->j, l->di, l->dj, 3, buf);
+}
+
+static void test_access_bounds(void){
+    static const test_access_line_t out[] = {
+        {0, 5, 0, 1}, {3, 0, 1, 0}, {1, 1, -1, 0}, {0, 1, 0, -1}, {5, 0, 0, 1}, {0, 7, 0, 0}, {3, 5, 1, 1},
+    };
+    for(size_t l = 0; l < sizeof(out) / sizeof(out[0]); l++){
+        TEST_CHECK(test_exits(test_access_gather_out, (void *)&out[l], MATRIX_INDEX_OUT_OF_BOUNDS),
+                   TEST_NAME " matrix_gather (%zu,%zu) by (%td,%td) out of the view accepted", out[l].i, out[l].j,
+                   out[l].di, out[l].dj);
+        TEST_CHECK(test_exits(test_access_scatter_out, (void *)&out[l], MATRIX_INDEX_OUT_OF_BOUNDS),
+                   TEST_NAME " matrix_scatter (%zu,%zu) by (%td,%td) out of the view accepted", out[l].i, out[l].j,
+                   out[l].di, out[l].dj);
+    }
+}
+
+static void test_access_unchecked_ops(void){
+    // the same results as the checked operations, on strided views
+    matrix_t *big = test_random(30, 40);
+    matrix_t a = matrix_view(big, 1, 2, 13, 17), b = matrix_view(big, 14, 20, 13, 17), bt = matrix_view(big, 3, 21, 17, 9);
+    matrix_t *r1 = matrix_init(13, 17), *r2 = matrix_init(13, 17), *p1 = matrix_init(13, 9), *p2 = matrix_init(13, 9);
+
+    m_addt(&a, &b, r1);
+    m_addt_unchecked(&a, &b, r2);
+    TEST_CHECK(!memcmp(r1->data, r2->data, 13 * 17 * sizeof(MATRIX_TYPE)), TEST_NAME " m_addt_unchecked: not m_addt");
+    m_subt(&a, &b, r1);
+    m_subt_unchecked(&a, &b, r2);
+    TEST_CHECK(!memcmp(r1->data, r2->data, 13 * 17 * sizeof(MATRIX_TYPE)), TEST_NAME " m_subt_unchecked: not m_subt");
+    m_kaddt(&a, 3, r1);
+    m_kaddt_unchecked(&a, 3, r2);
+    TEST_CHECK(!memcmp(r1->data, r2->data, 13 * 17 * sizeof(MATRIX_TYPE)), TEST_NAME " m_kaddt_unchecked: not m_kaddt");
+    m_kmult(&a, 3, r1);
+    m_kmult_unchecked(&a, 3, r2);
+    TEST_CHECK(!memcmp(r1->data, r2->data, 13 * 17 * sizeof(MATRIX_TYPE)), TEST_NAME " m_kmult_unchecked: not m_kmult");
+    matrix_t row = matrix_view(big, 5, 3, 1, 17), col = matrix_view(big, 10, 30, 17, 1);
+    TEST_CHECK(m_dot(&row, &col) == m_dot_unchecked(&row, &col), TEST_NAME " m_dot_unchecked: not m_dot");
+
+    m_mult(&a, &bt, p1);
+    m_mult_unchecked(&a, &bt, p2);
+    double err = test_mul_error(&a, &bt, p2);
+    TEST_CHECK(err <= test_mul_bound(&a, &bt, 2) && !memcmp(p1->data, p2->data, 13 * 9 * sizeof(MATRIX_TYPE)),
+               TEST_NAME " m_mult_unchecked: error %g, not m_mult", err);
+
+    matrix_free(big);
+    matrix_free(r1);
+    matrix_free(r2);
+    matrix_free(p1);
+    matrix_free(p2);
+}
+
+void MATRIX_NAME(test_access)(void){
+    test_access_elements();
+    test_access_lines();
+    test_access_bounds();
+    test_access_unchecked_ops();
+}
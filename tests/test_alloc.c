@@ -0,0 +1,94 @@
+/*
+ * Tests of the allocators: the size classes of the pool at every boundary up
+ * to 4 MiB, the arena across reset, matrices created through both, and the
+ * sizes that do not fit in a size_t.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "matrix.h"
+#include "state.h"
+#include "test.h"
+
+// size of class c of the pool: 64, 80, 96, 112, 128, 160, ...
+#define ALLOC_CLASS_SIZE(c) ((size_t)(4 + (c) % 4) << ((c) / 4 + 4))
+
+static void test_pool_classes(void){
+    matrix_allocator_t *pool = matrix_pool_new(0);
+    int aligned = 1;
+    for(size_t c = 1; c < 72; c++){
+        size_t size = ALLOC_CLASS_SIZE(c), below = ALLOC_CLASS_SIZE(c - 1);
+
+        // a block holds the whole class, and comes back for any size of the class
+        char *p = pool->alloc(pool, size);
+        memset(p, 0x5a, size);
+        aligned &= (uintptr_t)p % MATRIX_ALIGN == 0;
+        pool->free(pool, p, size);
+        char *q = pool->alloc(pool, below + 1);
+        TEST_CHECK(q == p, "pool: %zu bytes not served from the cached block of %zu", below + 1, size);
+        pool->free(pool, q, below + 1);
+
+        // one byte more is the next class
+        char *r = pool->alloc(pool, size + 1);
+        TEST_CHECK(r != p, "pool: %zu bytes served from the class of %zu", size + 1, size);
+        aligned &= (uintptr_t)r % MATRIX_ALIGN == 0;
+        pool->free(pool, r, size + 1);
+    }
+    TEST_CHECK(aligned, "pool: block not aligned on %d bytes", MATRIX_ALIGN);
+
+    // past the largest class: straight from the heap
+    size_t huge = ((size_t)1 << 30) + 1;
+    char *h = pool->alloc(pool, huge);
+    TEST_CHECK(h && (uintptr_t)h % MATRIX_ALIGN == 0, "pool: block of %zu bytes", huge);
+    pool->free(pool, h, huge);
+    matrix_allocator_free(pool);
+}
+
+static void test_alloc_matrices(void){
+    // the same products through the heap, the pools and the arenas, inline or not
+    matrix_allocator_t *allocs[] = {
+        NULL, matrix_pool_new(0), matrix_pool_new(MATRIX_ALLOC_INLINE), matrix_arena_new(4096, 0),
+        matrix_arena_new(4096, MATRIX_ALLOC_INLINE),
+    };
+    matrix_t *a = matrix_of(30, 50, 1), *b = matrix_of(50, 20, 2);
+    for(size_t i = 0; i < sizeof(allocs) / sizeof(allocs[0]); i++){
+        matrix_allocator_t *previous = matrix_allocator_use(allocs[i]);
+        for(int cycle = 0; cycle < 3; cycle++){
+            matrix_t *c = m_mul(a, b), *d = matrix_getcpy(c);
+            int same = c->alloc == (allocs[i] ? allocs[i] : previous) && (uintptr_t)c->data % MATRIX_ALIGN == 0;
+            for(size_t k = 0; k < 30 * 20; k++)
+                same &= c->data[k] == 100 && d->data[k] == 100;
+            TEST_CHECK(same, "allocator %zu cycle %d: wrong product", i, cycle);
+            matrix_free(d);
+            matrix_free(c);
+            // the arenas start over from one chunk
+            matrix_allocator_reset(allocs[i]);
+        }
+        matrix_allocator_use(previous);
+        matrix_allocator_free(allocs[i]);
+    }
+    matrix_free(a);
+    matrix_free(b);
+}
+
+static void test_alloc_huge(void *ctx){
+    (void)ctx;
+    matrix_init(SIZE_MAX / 2, 3);
+}
+
+static void test_alloc_wrap(void *ctx){
+    (void)ctx;
+    matrix_init_f64((size_t)1 << 32, (size_t)1 << 29);
+}
+
+static void test_alloc_overflow(void){
+    TEST_CHECK(test_exits(test_alloc_huge, NULL, MATRIX_INVALID_ARGUMENT), "matrix_init: row * col overflow accepted");
+    TEST_CHECK(test_exits(test_alloc_wrap, NULL, MATRIX_INVALID_ARGUMENT), "matrix_init_f64: byte count overflow accepted");
+}
+
+void test_alloc(void){
+    test_pool_classes();
+    test_alloc_matrices();
+    test_alloc_overflow();
+}
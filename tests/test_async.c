@@ -0,0 +1,202 @@
+/*
+ * Tests of the asynchronous operations: futures against the synchronous
+ * calls, dependency chains and diamonds, the parallel loops of an operation
+ * running on the pool, the thread limit shared by the operations and the
+ * loops, and argument errors reported when the operation runs.
+ */
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "test_typed.h"
+#include "matrix_thread.h"
+#include "state.h"
+
+static void test_async_ops(void){
+    // (A*B + C*D) * 3, by the futures and synchronously
+    matrix_t *a = test_random(70, 50), *b = test_random(50, 60), *c = test_random(70, 40), *d = test_random(40, 60);
+    matrix_t *ab = matrix_init(70, 60), *cd = matrix_init(70, 60), *sum = matrix_init(70, 60), *res = matrix_init(70, 60);
+    matrix_future_t *p1 = m_mult_async(a, b, ab, 0, NULL), *p2 = m_mult_async(c, d, cd, 0, NULL);
+    matrix_future_t *s = m_addt_async(ab, cd, sum, 2, (matrix_future_t *[]){ p1, p2 });
+    matrix_future_t *k = m_kmult_async(sum, 3, res, 1, &s);
+    matrix_future_wait(k);
+    TEST_CHECK(matrix_future_done(p1) && matrix_future_done(p2) && matrix_future_done(s) && matrix_future_done(k),
+               TEST_NAME " matrix_future_wait: dependencies not done");
+
+    matrix_t *rab = m_mul(a, b), *rcd = m_mul(c, d), *rsum = m_add(rab, rcd);
+    m_kmulp(rsum, 3);
+    double err = 0;
+    for(size_t i = 0; i < 70; i++)
+        for(size_t j = 0; j < 60; j++)
+            err = fmax(err, fabs(AT(res, i, j) - AT(rsum, i, j)));
+    TEST_CHECK(err <= 3 * (test_mul_bound(a, b, 2) + test_mul_bound(c, d, 2)), TEST_NAME " async (A*B + C*D)*3: error %g", err);
+
+    // a dependency already complete
+    matrix_t *t = matrix_init(60, 70);
+    matrix_future_t *tr = m_transpt_async(res, t, 1, &k);
+    matrix_future_wait(tr);
+    int same = 1;
+    for(size_t i = 0; i < 70; i++)
+        for(size_t j = 0; j < 60; j++)
+            same &= AT(t, j, i) == AT(res, i, j);
+    TEST_CHECK(same, TEST_NAME " m_transpt_async after a completed future");
+
+    matrix_future_t *futures[] = { p1, p2, s, k, tr };
+    for(size_t i = 0; i < 5; i++)
+        matrix_future_free(futures[i]);
+    matrix_t *ms[] = { a, b, c, d, ab, cd, sum, res, rab, rcd, rsum, t };
+    for(size_t i = 0; i < 12; i++)
+        matrix_free(ms[i]);
+}
+
+// log of a chain of calls
+typedef struct {
+    size_t log[64];
+    _Atomic size_t len;
+}test_async_log_t;
+
+typedef struct {
+    test_async_log_t *log;
+    size_t id;
+}test_async_step_t;
+
+static void test_async_append(void *ctx){
+    test_async_step_t *step = ctx;
+    // a short pause, so that an out-of-order step would overtake the previous one
+    if(step->id % 8 == 0)
+        usleep(200);
+    size_t at = atomic_fetch_add(&step->log->len, 1);
+    step->log->log[at] = step->id;
+}
+
+static void test_async_chain(void){
+    // each call depends on the previous one: they run in order
+    test_async_log_t log = { .len = 0 };
+    test_async_step_t steps[64];
+    matrix_future_t *f[64];
+    for(size_t i = 0; i < 64; i++){
+        steps[i] = (test_async_step_t){ &log, i };
+        f[i] = matrix_async(test_async_append, &steps[i], i ? 1 : 0, i ? &f[i - 1] : NULL);
+    }
+    matrix_future_wait(f[63]);
+    int ordered = atomic_load(&log.len) == 64;
+    for(size_t i = 0; ordered && i < 64; i++)
+        ordered &= log.log[i] == i;
+    TEST_CHECK(ordered, TEST_NAME " matrix_async chain: out of order");
+
+    // diamond: the last call after the two middle ones, after the first
+    test_async_log_t dlog = { .len = 0 };
+    test_async_step_t dsteps[4] = { { &dlog, 0 }, { &dlog, 8 }, { &dlog, 2 }, { &dlog, 3 } };
+    matrix_future_t *d0 = matrix_async(test_async_append, &dsteps[0], 0, NULL);
+    matrix_future_t *d1 = matrix_async(test_async_append, &dsteps[1], 1, &d0);
+    matrix_future_t *d2 = matrix_async(test_async_append, &dsteps[2], 1, &d0);
+    matrix_future_t *d3 = matrix_async(test_async_append, &dsteps[3], 2, (matrix_future_t *[]){ d1, d2 });
+    matrix_future_wait_all();
+    TEST_CHECK(atomic_load(&dlog.len) == 4 && dlog.log[0] == 0 && dlog.log[3] == 3 && matrix_future_done(d3),
+               TEST_NAME " matrix_async diamond: out of order");
+
+    for(size_t i = 0; i < 64; i++)
+        matrix_future_free(f[i]);
+    matrix_future_free(d0);
+    matrix_future_free(d1);
+    matrix_future_free(d2);
+    matrix_future_free(d3);
+}
+
+// threads inside the tasks of the parallel loops, now and at most, and the threads seen
+static _Atomic int test_async_now, test_async_max;
+static pthread_t test_async_seen[64];
+static _Atomic size_t test_async_nseen;
+
+static void test_async_task(void *ctx, size_t task){
+    (void)ctx;
+    (void)task;
+    int now = atomic_fetch_add(&test_async_now, 1) + 1, max = atomic_load(&test_async_max);
+    while(now > max && !atomic_compare_exchange_weak(&test_async_max, &max, now))
+        ;
+    size_t at = atomic_fetch_add(&test_async_nseen, 1);
+    if(at < 64)
+        test_async_seen[at] = pthread_self();
+    usleep(500);
+    atomic_fetch_sub(&test_async_now, 1);
+}
+
+static void test_async_loop(void *ctx){
+    (void)ctx;
+    matrix_parallel_for(32, test_async_task, NULL);
+}
+
+static void test_async_threads(void){
+    size_t saved = matrix_get_num_threads();
+    matrix_set_num_threads(4);
+
+    // an operation running alone on a scheduler thread (polled, not run by a waiting thread) spreads its
+    // loop over the pool
+    atomic_store(&test_async_nseen, 0);
+    matrix_future_t *f = matrix_async(test_async_loop, NULL, 0, NULL);
+    while(!matrix_future_done(f))
+        usleep(100);
+    matrix_future_free(f);
+    size_t distinct = 0, n = atomic_load(&test_async_nseen) < 32 ? atomic_load(&test_async_nseen) : 32;
+    for(size_t i = 0; i < n; i++){
+        int first = 1;
+        for(size_t j = 0; j < i; j++)
+            first &= !pthread_equal(test_async_seen[i], test_async_seen[j]);
+        distinct += first;
+    }
+    TEST_CHECK(n == 32 && distinct > 1, TEST_NAME " matrix_async: parallel loop on %zu thread(s)", distinct);
+
+    // operations at once, and a loop of the application thread: the limit, plus the application thread
+    atomic_store(&test_async_max, 0);
+    matrix_future_t *fs[6];
+    for(size_t i = 0; i < 6; i++)
+        fs[i] = matrix_async(test_async_loop, NULL, 0, NULL);
+    matrix_parallel_for(32, test_async_task, NULL);
+    matrix_future_wait_all();
+    for(size_t i = 0; i < 6; i++)
+        matrix_future_free(fs[i]);
+    TEST_CHECK(atomic_load(&test_async_max) <= 4 + 1, TEST_NAME " matrix_async: %d threads at once, limit 4",
+               atomic_load(&test_async_max));
+
+    matrix_set_num_threads(saved);
+}
+
+static void test_async_bad_mult(void *ctx){
+    (void)ctx;
+    matrix_t *a = matrix_init(3, 4), *b = matrix_init(5, 6), *c = matrix_init(3, 6);
+    matrix_future_wait(m_mult_async(a, b, c, 0, NULL));
+}
+
+static void test_async_nothing(void *ctx){
+    (void)ctx;
+}
+
+static void test_async_bad_chain(void *ctx){
+    // the error of a dependency ends the program before its dependents run
+    (void)ctx;
+    matrix_t *a = matrix_init(3, 4), *b = matrix_init(3, 5), *c = matrix_init(3, 4);
+    matrix_future_t *bad = m_addt_async(a, b, c, 0, NULL);
+    matrix_future_t *next = matrix_async(test_async_nothing, NULL, 1, &bad);
+    matrix_future_wait(next);
+}
+
+static void test_async_null_dep(void *ctx){
+    (void)ctx;
+    matrix_async(test_async_nothing, NULL, 1, NULL);
+}
+
+static void test_async_errors(void){
+    TEST_CHECK(test_exits(test_async_bad_mult, NULL, MATRIX_INVALID_DIMENSIONS),
+               TEST_NAME " m_mult_async: invalid dimensions not reported");
+    TEST_CHECK(test_exits(test_async_bad_chain, NULL, MATRIX_INVALID_DIMENSIONS),
+               TEST_NAME " m_addt_async: error of a dependency not reported");
+    TEST_CHECK(test_exits(test_async_null_dep, NULL, MATRIX_NULL_POINTER), TEST_NAME " matrix_async: NULL dependencies");
+}
+
+void MATRIX_NAME(test_async)(void){
+    test_async_ops();
+    test_async_chain();
+    test_async_threads();
+    test_async_errors();
+}
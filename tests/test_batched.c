@@ -0,0 +1,32 @@
+/*
+ * Tests of the strided-batched products: every matrix of the batch against
+ * its product in double, for the fixed kernel sizes and odd shapes.
+ */
+#include "test_typed.h"
+
+static void test_mult_batched(void){
+    static const size_t shapes[][3] = { {2, 2, 2}, {4, 4, 4}, {7, 3, 9}, {32, 32, 32}, {33, 5, 40} };
+    size_t count = 5;
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++){
+        size_t m = shapes[s][0], k = shapes[s][1], n = shapes[s][2];
+        matrix_t *a = test_random(count, m * k), *b = test_random(count, k * n), *c = matrix_init(count, m * n);
+        matrix_batch_t ba = matrix_batch(a->data, count, m, k, m * k), bb = matrix_batch(b->data, count, k, n, k * n);
+        matrix_batch_t bc = matrix_batch(c->data, count, m, n, m * n);
+        m_mult_batched(&ba, &bb, &bc);
+
+        double err = 0, bound = 0;
+        for(size_t t = 0; t < count; t++){
+            matrix_t ta = matrix_batch_at(&ba, t), tb = matrix_batch_at(&bb, t), tc = matrix_batch_at(&bc, t);
+            err = fmax(err, test_mul_error(&ta, &tb, &tc));
+            bound = fmax(bound, test_mul_bound(&ta, &tb, 2));
+        }
+        TEST_CHECK(err <= bound, TEST_NAME " m_mult_batched %zux%zux%zu: error %g", m, k, n, err);
+        matrix_free(a);
+        matrix_free(b);
+        matrix_free(c);
+    }
+}
+
+void MATRIX_NAME(test_batched)(void){
+    test_mult_batched();
+}
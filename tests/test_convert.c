@@ -0,0 +1,120 @@
+/*
+ * Tests of the conversions between families: rounding to nearest with the
+ * halfway cases away from zero, saturation and NaN for i32, rounding of the
+ * narrowing floating point conversions, and views as sources.
+ */
+#include <stdint.h>
+#include <math.h>
+
+#include "matrix.h"
+#include "state.h"
+#include "test.h"
+
+static void test_convert_f64_i32(void){
+    static const struct { double x; int32_t r; } cases[] = {
+        {0.5, 1}, {-0.5, -1}, {1.5, 2}, {2.5, 3}, {-2.5, -3}, {0.49999999999999994, 0}, {-0.49999999999999994, 0},
+        {1.4999999999999998, 1}, {2147483646.5, INT32_MAX}, {2147483647.0, INT32_MAX}, {1e10, INT32_MAX},
+        {-2147483647.5, INT32_MIN}, {-2147483648.0, INT32_MIN}, {-1e10, INT32_MIN}, {INFINITY, INT32_MAX},
+        {-INFINITY, INT32_MIN}, {NAN, 0}, {-0.0, 0},
+    };
+    size_t n = sizeof(cases) / sizeof(cases[0]);
+    matrix_f64_t *a = matrix_init_f64(1, n);
+    for(size_t i = 0; i < n; i++)
+        a->data[i] = cases[i].x;
+    matrix_i32_t *r = matrix_f64_to_i32(a);
+    for(size_t i = 0; i < n; i++)
+        TEST_CHECK(r->data[i] == cases[i].r, "matrix_f64_to_i32 %.17g: %d, expected %d",
+                   cases[i].x, r->data[i], cases[i].r);
+    matrix_free_f64(a);
+    matrix_free_i32(r);
+}
+
+static void test_convert_f32_i32(void){
+    static const struct { float x; int32_t r; } cases[] = {
+        {0.5f, 1}, {-1.5f, -2}, {0.49999997f, 0}, {8388607.5f, 8388608}, {2147483520.0f, 2147483520},
+        {2147483648.0f, INT32_MAX}, {-2147483648.0f, INT32_MIN}, {3e9f, INT32_MAX}, {-3e9f, INT32_MIN},
+        {NAN, 0},
+    };
+    size_t n = sizeof(cases) / sizeof(cases[0]);
+    matrix_f32_t *a = matrix_init(1, n);
+    matrix_i32_t *r = matrix_init_i32(1, n);
+    for(size_t i = 0; i < n; i++)
+        a->data[i] = cases[i].x;
+    matrix_f32_to_i32t(a, r);
+    for(size_t i = 0; i < n; i++)
+        TEST_CHECK(r->data[i] == cases[i].r, "matrix_f32_to_i32t %.9g: %d, expected %d",
+                   (double)cases[i].x, r->data[i], cases[i].r);
+    matrix_free(a);
+    matrix_free_i32(r);
+}
+
+static void test_convert_float(void){
+    // narrowing rounds to nearest, ties to even, and overflows to infinity
+    matrix_f64_t *a = matrix_init_f64(1, 4);
+    a->data[0] = 0.1;
+    a->data[1] = 1 + 0x1p-24;
+    a->data[2] = 1e39;
+    a->data[3] = -1e39;
+    matrix_f32_t *f = matrix_f64_to_f32(a);
+    TEST_CHECK(f->data[0] == 0.1f && f->data[1] == 1 && isinf(f->data[2]) && f->data[2] > 0 && isinf(f->data[3])
+               && f->data[3] < 0, "matrix_f64_to_f32: %.9g %.9g %g %g", (double)f->data[0], (double)f->data[1],
+               (double)f->data[2], (double)f->data[3]);
+
+    matrix_i32_t *i = matrix_init_i32(1, 4);
+    i->data[0] = INT32_MAX;
+    i->data[1] = INT32_MIN;
+    i->data[2] = 16777217;
+    i->data[3] = -16777219;
+    matrix_f32_t *fi = matrix_i32_to_f32(i);
+    matrix_f64_t *di = matrix_i32_to_f64(i);
+    TEST_CHECK(fi->data[0] == 2147483648.0f && fi->data[1] == -2147483648.0f && fi->data[2] == 16777216.0f
+               && fi->data[3] == -16777220.0f, "matrix_i32_to_f32: %.9g %.9g %.9g %.9g", (double)fi->data[0],
+               (double)fi->data[1], (double)fi->data[2], (double)fi->data[3]);
+    int exact = 1;
+    for(size_t k = 0; k < 4; k++)
+        exact &= di->data[k] == i->data[k];
+    TEST_CHECK(exact, "matrix_i32_to_f64: not exact");
+
+    matrix_free_f64(a);
+    matrix_free(f);
+    matrix_free_i32(i);
+    matrix_free(fi);
+    matrix_free_f64(di);
+}
+
+static void test_convert_view(void){
+    // a view as source, a contiguous matrix as result, and the other way round
+    matrix_f32_t *big = matrix_init(5, 7);
+    for(size_t k = 0; k < 35; k++)
+        big->data[k] = (float)k + 0.25f;
+    matrix_f32_t v = matrix_view(big, 1, 2, 3, 4);
+    matrix_f64_t *d = matrix_f32_to_f64(&v);
+    matrix_i32_t *big_i = matrix_init_i32(4, 6), vi = matrix_view_i32(big_i, 1, 1, 3, 4);
+    matrix_f64_to_i32t(d, &vi);
+    int same = d->stride == 4;
+    for(size_t r = 0; r < 3; r++)
+        for(size_t c = 0; c < 4; c++){
+            float x = big->data[(r + 1) * 7 + c + 2];
+            same &= d->data[r * 4 + c] == x && big_i->data[(r + 1) * 6 + c + 1] == (int32_t)x;
+        }
+    TEST_CHECK(same && big_i->data[0] == 0 && big_i->data[5] == 0, "matrix_f32_to_f64 / matrix_f64_to_i32t views");
+    matrix_free(big);
+    matrix_free_f64(d);
+    matrix_free_i32(big_i);
+}
+
+static void test_convert_dims(void *ctx){
+    matrix_i32_t *r = matrix_init_i32(2, 3);
+    matrix_f32_to_i32t(ctx, r);
+}
+
+void test_convert(void){
+    test_convert_f64_i32();
+    test_convert_f32_i32();
+    test_convert_float();
+    test_convert_view();
+
+    matrix_f32_t *a = matrix_init(3, 2);
+    TEST_CHECK(test_exits(test_convert_dims, a, MATRIX_INVALID_DIMENSIONS), "matrix_f32_to_i32t: dimensions not checked");
+    matrix_free(a);
+}
@@ -0,0 +1,94 @@
+/*
+ * Tests of the fixed-size matrices against the same operations on matrix_t.
+ * The elements are small integers, so that every result is exact in each
+ * family and the checks compare for equality.
+ */
+#include <string.h>
+
+#include "test_typed.h"
+#include "matrix_fixed.h"
+
+#define TEST_FIXED(N)                                                                       \
+static MATRIX_TNAME(matrix##N) test_fixed_random##N(void){                                  \
+    MATRIX_TNAME(matrix##N) m1;                                                             \
+    MATRIX_FIXED_FOR(N, i, j)                                                               \
+        m1.data[i][j] = (MATRIX_TYPE)((int)(test_rand() % 17) - 8);                         \
+    return m1;                                                                              \
+}                                                                                           \
+                                                                                            \
+static int test_fixed_equal##N(const MATRIX_TNAME(matrix##N) *m1, const matrix_t *m2){      \
+    int same = m2->row == (N) && m2->col == (N);                                            \
+    MATRIX_FIXED_FOR(N, i, j)                                                               \
+        same &= m1->data[i][j] == m2->data[i * m2->stride + j];                             \
+    return same;                                                                            \
+}                                                                                           \
+                                                                                            \
+static void test_fixed##N(void){                                                            \
+    MATRIX_TNAME(matrix##N) a = test_fixed_random##N(), b = test_fixed_random##N(), c;      \
+    matrix_t va = MATRIX_NAME(matrix##N##_view)(&a);                                        \
+    matrix_t vb = MATRIX_NAME(matrix##N##_view)(&b);                                        \
+                                                                                            \
+    c = MATRIX_NAME(m##N##_add)(a, b);                                                      \
+    matrix_t *r = m_add(&va, &vb);                                                          \
+    TEST_CHECK(test_fixed_equal##N(&c, r), TEST_NAME " m" #N "_add");                       \
+    matrix_free(r);                                                                         \
+                                                                                            \
+    c = a;                                                                                  \
+    MATRIX_NAME(m##N##_subp)(&c, b);                                                        \
+    r = m_sub(&va, &vb);                                                                    \
+    TEST_CHECK(test_fixed_equal##N(&c, r), TEST_NAME " m" #N "_subp");                      \
+    matrix_free(r);                                                                         \
+                                                                                            \
+    c = MATRIX_NAME(m##N##_kmul)(a, 3);                                                     \
+    r = m_kmul(&va, 3);                                                                     \
+    TEST_CHECK(test_fixed_equal##N(&c, r), TEST_NAME " m" #N "_kmul");                      \
+    matrix_free(r);                                                                         \
+                                                                                            \
+    c = MATRIX_NAME(m##N##_mul)(a, b);                                                      \
+    r = m_mul(&va, &vb);                                                                    \
+    TEST_CHECK(test_fixed_equal##N(&c, r), TEST_NAME " m" #N "_mul");                       \
+    matrix_free(r);                                                                         \
+                                                                                            \
+    c = MATRIX_NAME(m##N##_transp)(a);                                                      \
+    r = m_transp(&va);                                                                      \
+    TEST_CHECK(test_fixed_equal##N(&c, r), TEST_NAME " m" #N "_transp");                    \
+    matrix_free(r);                                                                         \
+                                                                                            \
+    /* powers 0 to 3 by squaring, against m_pow */                                          \
+    const MATRIX_TNAME(matrix##N) id = MATRIX##N##_ID;                                      \
+    c = MATRIX_NAME(m##N##_pow)(a, 0);                                                      \
+    TEST_CHECK(!memcmp(&c, &id, sizeof(c)), TEST_NAME " m" #N "_pow 0: not the identity");  \
+    for(size_t n = 1; n <= 3; n++){                                                         \
+        c = a;                                                                              \
+        MATRIX_NAME(m##N##_powp)(&c, n);                                                    \
+        r = m_pow(&va, n);                                                                  \
+        TEST_CHECK(test_fixed_equal##N(&c, r), TEST_NAME " m" #N "_powp %zu", n);           \
+        matrix_free(r);                                                                     \
+    }                                                                                       \
+                                                                                            \
+    /* conversions: to a new matrix and back, into a view, and views sharing the storage */ \
+    r = MATRIX_NAME(matrix##N##_to)(&a);                                                    \
+    c = MATRIX_NAME(matrix##N##_from)(r);                                                   \
+    TEST_CHECK(test_fixed_equal##N(&a, r) && !memcmp(&c, &a, sizeof(a)),                    \
+               TEST_NAME " matrix" #N "_to / matrix" #N "_from");                           \
+    matrix_free(r);                                                                         \
+    matrix_t *big = matrix_init((N) + 2, (N) + 3), vbig = matrix_view(big, 1, 2, (N), (N)); \
+    MATRIX_NAME(matrix##N##_copyto)(&b, &vbig);                                             \
+    c = MATRIX_NAME(matrix##N##_from)(&vbig);                                               \
+    TEST_CHECK(test_fixed_equal##N(&b, &vbig) && !memcmp(&c, &b, sizeof(b)),                \
+               TEST_NAME " matrix" #N "_copyto view");                                      \
+    matrix_free(big);                                                                       \
+    c = MATRIX_NAME(m##N##_kmul)(a, 2);                                                     \
+    m_kmulp(&va, 2);                                                                        \
+    TEST_CHECK(!memcmp(&c, &a, sizeof(a)), TEST_NAME " matrix" #N "_view: not shared");     \
+}
+
+TEST_FIXED(2)
+TEST_FIXED(3)
+TEST_FIXED(4)
+
+void MATRIX_NAME(test_fixed)(void){
+    test_fixed2();
+    test_fixed3();
+    test_fixed4();
+}
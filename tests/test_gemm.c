@@ -0,0 +1,122 @@
+/*
+ * Tests of the blocked GEMM behind m_mul / m_mult: shapes below, at and past
+ * the register tiles, views as operands and result, and a result aliasing an
+ * operand; and of its epilogue (m_gemm / m_gemmt) against the same product
+ * scaled, biased and activated in double.
+ */
+#include "test_typed.h"
+
+static void test_mul(void){
+    static const size_t shapes[][3] = {
+        {1, 1, 1}, {1, 7, 5}, {5, 1, 7}, {3, 5, 7}, {17, 33, 65}, {64, 64, 64}, {100, 37, 129}, {257, 130, 31},
+    };
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++){
+        size_t m = shapes[s][0], k = shapes[s][1], n = shapes[s][2];
+        matrix_t *a = test_random(m, k), *b = test_random(k, n), *c = m_mul(a, b);
+        TEST_CHECK(test_mul_error(a, b, c) <= test_mul_bound(a, b, 2),
+                   TEST_NAME " m_mul %zux%zux%zu: error %g", m, k, n, test_mul_error(a, b, c));
+
+        // the same operands as views inside larger matrices
+        matrix_t *pa = test_random(m + 3, k + 2), *pb = test_random(k + 1, n + 5), *pc = test_random(m + 2, n + 2);
+        matrix_t va = matrix_view(pa, 2, 1, m, k), vb = matrix_view(pb, 1, 3, k, n), vc = matrix_view(pc, 1, 1, m, n);
+        matrix_copyto(a, &va);
+        matrix_copyto(b, &vb);
+        m_mult(&va, &vb, &vc);
+        TEST_CHECK(test_mul_error(a, b, &vc) <= test_mul_bound(a, b, 2),
+                   TEST_NAME " m_mult views %zux%zux%zu: error %g", m, k, n, test_mul_error(a, b, &vc));
+
+        matrix_free(a);
+        matrix_free(b);
+        matrix_free(c);
+        matrix_free(pa);
+        matrix_free(pb);
+        matrix_free(pc);
+    }
+
+    // result aliasing an operand
+    matrix_t *a = test_random(40, 40), *b = test_random(40, 40), *c = matrix_getcpy(a);
+    m_mult(c, b, c);
+    TEST_CHECK(test_mul_error(a, b, c) <= test_mul_bound(a, b, 2), TEST_NAME " m_mult result == m1");
+    matrix_free(a);
+    matrix_free(b);
+    matrix_free(c);
+}
+
+static double test_act(matrix_act_t act, double x){
+    switch(act){
+    case MATRIX_ACT_RELU:
+        return x > 0 ? x : 0;
+    case MATRIX_ACT_SIGMOID:
+        return 1 / (1 + exp(-x));
+    case MATRIX_ACT_TANH:
+        return tanh(x);
+    default:
+        return x;
+    }
+}
+
+static void test_epilogue(void){
+    // k past GEMM_KC: the epilogue is applied once, after the last block of k
+    static const size_t shapes[][3] = { {1, 1, 1}, {5, 7, 3}, {37, 300, 70}, {130, 600, 90} };
+    // beta, bias (0 none, 1 row, 2 column) and activation; sigmoid and tanh on the floating point families
+    static const struct { double beta; int bias; matrix_act_t act; } cases[] = {
+        {0, 0, MATRIX_ACT_NONE}, {1, 0, MATRIX_ACT_NONE}, {0, 1, MATRIX_ACT_RELU}, {1, 2, MATRIX_ACT_RELU},
+        {-2, 1, MATRIX_ACT_SIGMOID}, {1, 2, MATRIX_ACT_TANH},
+    };
+    MATRIX_TYPE alpha = TEST_INTEGER ? 3 : (MATRIX_TYPE)0.75;
+
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++)
+        for(size_t t = 0; t < sizeof(cases) / sizeof(cases[0]); t++){
+            size_t m = shapes[s][0], k = shapes[s][1], n = shapes[s][2];
+            double beta = cases[t].beta;
+            matrix_act_t act = cases[t].act;
+            if(TEST_INTEGER && (act == MATRIX_ACT_SIGMOID || act == MATRIX_ACT_TANH))
+                continue;
+
+            matrix_t *a = test_random(m, k), *b = test_random(k, n), *c0 = test_random(m, n), *c = matrix_getcpy(c0);
+            // the column bias is a column of a larger matrix (stride != 1)
+            matrix_t *pb = test_random(m, 3), *row = test_random(1, n), col = matrix_view(pb, 0, 1, m, 1);
+            const matrix_t *bias = cases[t].bias == 1 ? row : cases[t].bias == 2 ? &col : NULL;
+            // beta = 0 overwrites: the previous content is never read, even NaN
+            if(beta == 0 && !TEST_INTEGER)
+                for(size_t i = 0; i < m * n; i++)
+                    c->data[i] = (MATRIX_TYPE)NAN;
+
+            m_gemmt(alpha, a, b, (MATRIX_TYPE)beta, bias, act, c);
+            matrix_t *g = beta == 0 ? m_gemm(alpha, a, b, bias, act) : NULL;
+
+            double err = 0, errg = 0;
+            for(size_t i = 0; i < m; i++)
+                for(size_t j = 0; j < n; j++){
+                    double x = 0;
+                    for(size_t p = 0; p < k; p++)
+                        x += AT(a, i, p) * AT(b, p, j);
+                    x = alpha * x + (beta != 0 ? beta * AT(c0, i, j) : 0);
+                    x = test_act(act, x + (!bias ? 0 : cases[t].bias == 1 ? AT(row, 0, j) : AT(&col, i, 0)));
+                    // fmax would drop a NaN
+                    err = isnan(AT(c, i, j)) ? INFINITY : fmax(err, fabs(AT(c, i, j) - x));
+                    if(g)
+                        errg = isnan(AT(g, i, j)) ? INFINITY : fmax(errg, fabs(AT(g, i, j) - x));
+                }
+            double bound = fabs((double)alpha) * test_mul_bound(a, b, 2) + 8 * TEST_EPS * (fabs(beta) + 2);
+            TEST_CHECK(err <= bound, TEST_NAME " m_gemmt %zux%zux%zu beta %g bias %d act %d: error %g",
+                       m, k, n, beta, cases[t].bias, (int)act, err);
+            if(g)
+                TEST_CHECK(errg <= bound, TEST_NAME " m_gemm %zux%zux%zu bias %d act %d: error %g",
+                           m, k, n, cases[t].bias, (int)act, errg);
+
+            matrix_free(a);
+            matrix_free(b);
+            matrix_free(c0);
+            matrix_free(c);
+            matrix_free(pb);
+            matrix_free(row);
+            if(g)
+                matrix_free(g);
+        }
+}
+
+void MATRIX_NAME(test_gemm)(void){
+    test_mul();
+    test_epilogue();
+}
@@ -0,0 +1,75 @@
+/*
+ * Tests of the matrix-vector products and of the dot products against sums
+ * in double, on both orientations and with the matrix as a view.
+ */
+#include "test_typed.h"
+
+static void test_gemv_shapes(void){
+    static const size_t shapes[][2] = { {1, 1}, {7, 3}, {33, 65}, {300, 17}, {5, 1000} };
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++){
+        size_t m = shapes[s][0], n = shapes[s][1];
+        matrix_t *a = test_random(m, n), *x = test_random(n, 1), *xt = test_random(1, m);
+        matrix_t *y = m_gemv(2, a, x, MATRIX_GEMV_DEFAULT), *yt = m_gemv(2, a, xt, MATRIX_GEMV_TRANS);
+        double err = 0, errt = 0, bound = 4 * TEST_EPS * (m + n) * test_maxabs(a) * 8 * 8;
+        for(size_t i = 0; i < m; i++){
+            double r = 0;
+            for(size_t j = 0; j < n; j++)
+                r += 2 * AT(a, i, j) * AT(x, j, 0);
+            err = fmax(err, fabs(AT(y, i, 0) - r));
+        }
+        for(size_t j = 0; j < n; j++){
+            double r = 0;
+            for(size_t i = 0; i < m; i++)
+                r += 2 * AT(a, i, j) * AT(xt, 0, i);
+            errt = fmax(errt, fabs(AT(yt, 0, j) - r));
+        }
+        TEST_CHECK(y->row == m && y->col == 1 && err <= bound, TEST_NAME " m_gemv %zux%zu: error %g", m, n, err);
+        TEST_CHECK(yt->row == 1 && yt->col == n && errt <= bound,
+                   TEST_NAME " m_gemv transposed %zux%zu: error %g", m, n, errt);
+        matrix_free(a);
+        matrix_free(x);
+        matrix_free(xt);
+        matrix_free(y);
+        matrix_free(yt);
+    }
+}
+
+static void test_gemvt_view(void){
+    // y = 3 A x - y with A a view, accumulated in double
+    size_t m = 70, n = 45;
+    matrix_t *big = test_random(m + 2, n + 7), a = matrix_view(big, 1, 3, m, n);
+    matrix_t *x = test_random(1, n), *y = test_random(1, m), *y0 = matrix_getcpy(y);
+    m_gemvt(3, &a, x, -1, MATRIX_GEMV_WIDE, y);
+    double err = 0;
+    for(size_t i = 0; i < m; i++){
+        double r = -AT(y0, 0, i);
+        for(size_t j = 0; j < n; j++)
+            r += 3 * AT(&a, i, j) * AT(x, 0, j);
+        err = fmax(err, fabs(AT(y, 0, i) - r));
+    }
+    TEST_CHECK(err <= 4 * TEST_EPS * 3 * n, TEST_NAME " m_gemvt wide view: error %g", err);
+    matrix_free(big);
+    matrix_free(x);
+    matrix_free(y);
+    matrix_free(y0);
+}
+
+static void test_dot(void){
+    matrix_t *u = test_random(1, 4099), *w = test_random(4099, 1);
+    double dot = 0;
+    for(size_t i = 0; i < 4099; i++)
+        dot += AT(u, 0, i) * AT(w, i, 0);
+    TEST_CHECK(fabs((double)m_dot(u, w) - dot) <= 4 * TEST_EPS * 4099, TEST_NAME " m_dot: %g, expected %g",
+               (double)m_dot(u, w), dot);
+    // accumulated in double: within the rounding of the double sums
+    TEST_CHECK(fabs(m_dotd(u, w) - dot) <= 4 * DBL_EPSILON * 4099, TEST_NAME " m_dotd: %.17g, expected %.17g",
+               m_dotd(u, w), dot);
+    matrix_free(u);
+    matrix_free(w);
+}
+
+void MATRIX_NAME(test_gemv)(void){
+    test_gemv_shapes();
+    test_gemvt_view();
+    test_dot();
+}
@@ -0,0 +1,21 @@
+/*
+ * Tests of the i32 family: the typed test files compiled again with MATRIX_FAMILY_I32.
+ */
+#define MATRIX_FAMILY_I32
+
+#include "test_gemm.c"
+#include "test_batched.c"
+#include "test_fixed.c"
+#include "test_kdiv.c"
+#include "test_transp.c"
+#include "test_reduce.c"
+#include "test_math.c"
+#include "test_gemv.c"
+#include "test_sparse.c"
+#include "test_io.c"
+#include "test_ooc.c"
+#include "test_access.c"
+#include "test_lu.c"
+#include "test_qr.c"
+#include "test_strassen.c"
+#include "test_async.c"
@@ -0,0 +1,94 @@
+/*
+ * Tests of the binary matrix files: a view saved and read back by matrix_load
+ * and matrix_mmap, the private and shared mappings, and the files that are
+ * rejected with EINVAL (wrong element type, truncated, misaligned data).
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "test_typed.h"
+
+// overwrite the bytes of the header at offset
+static void test_io_patch(const char *path, long offset, const void *bytes, size_t size){
+    FILE *f = fopen(path, "r+b");
+    fseek(f, offset, SEEK_SET);
+    fwrite(bytes, size, 1, f);
+    fclose(f);
+}
+
+static int test_io_same(const matrix_t *m1, const matrix_t *m2){
+    int same = m1 && m2 && m1->row == m2->row && m1->col == m2->col;
+    for(size_t i = 0; same && i < m1->row; i++)
+        for(size_t j = 0; j < m1->col; j++)
+            same &= AT(m1, i, j) == AT(m2, i, j);
+    return same;
+}
+
+static void test_io_roundtrip(void){
+    const char *path = test_tmpfile();
+    matrix_t *big = test_random(20, 30), v = matrix_view(big, 3, 4, 11, 13);
+    TEST_CHECK(!matrix_save(&v, path), TEST_NAME " matrix_save: %s", strerror(errno));
+
+    matrix_t *l = matrix_load(path), *mm = matrix_mmap(path, MATRIX_MMAP_READ | MATRIX_MMAP_POPULATE);
+    TEST_CHECK(test_io_same(l, &v) && test_io_same(mm, &v), TEST_NAME " matrix_load / matrix_mmap: not the saved matrix");
+    matrix_free(l);
+    matrix_free(mm);
+
+    // a private mapping keeps its changes, a shared one writes them back to the file
+    mm = matrix_mmap(path, MATRIX_MMAP_PRIVATE);
+    mm->data[0] = (MATRIX_TYPE)(AT(&v, 0, 0) + 1);
+    matrix_free(mm);
+    l = matrix_load(path);
+    TEST_CHECK(test_io_same(l, &v), TEST_NAME " matrix_mmap private: change written to the file");
+    matrix_free(l);
+
+    mm = matrix_mmap(path, MATRIX_MMAP_SHARED);
+    mm->data[12] = (MATRIX_TYPE)7;
+    matrix_free(mm);
+    l = matrix_load(path);
+    TEST_CHECK(l && AT(l, 0, 12) == 7, TEST_NAME " matrix_mmap shared: change not in the file");
+    matrix_free(l);
+
+    errno = 0;
+    TEST_CHECK(!matrix_load("/nonexistent/matrix") && errno == ENOENT, TEST_NAME " matrix_load: missing file");
+    matrix_free(big);
+}
+
+static void test_io_invalid(void){
+    const char *path = test_tmpfile();
+    matrix_t *m1 = test_random(8, 9);
+
+    // element type of another family (header: type at 12)
+    matrix_save(m1, path);
+    uint32_t type = 0;
+    test_io_patch(path, 12, &type, sizeof(type));
+    errno = 0;
+    matrix_t *l = matrix_load(path), *mm = matrix_mmap(path, MATRIX_MMAP_READ);
+    TEST_CHECK(!l && !mm && errno == EINVAL, TEST_NAME " matrix_load / matrix_mmap: wrong element type accepted");
+
+    // data shorter than the header says
+    matrix_save(m1, path);
+    TEST_CHECK(!truncate(path, 4096 + 8 * 9 * sizeof(MATRIX_TYPE) - 1), "truncate: %s", strerror(errno));
+    errno = 0;
+    l = matrix_load(path);
+    mm = matrix_mmap(path, MATRIX_MMAP_READ);
+    TEST_CHECK(!l && !mm && errno == EINVAL, TEST_NAME " matrix_load / matrix_mmap: truncated file accepted");
+
+    // a data offset that is not a multiple of the element size (header: offset at 40, alignment at 48)
+    matrix_save(m1, path);
+    uint64_t offset = 4098;
+    uint32_t align = 2;
+    test_io_patch(path, 40, &offset, sizeof(offset));
+    test_io_patch(path, 48, &align, sizeof(align));
+    errno = 0;
+    mm = matrix_mmap(path, MATRIX_MMAP_READ);
+    TEST_CHECK(!mm && errno == EINVAL, TEST_NAME " matrix_mmap: misaligned data offset accepted");
+    matrix_free(m1);
+}
+
+void MATRIX_NAME(test_io)(void){
+    test_io_roundtrip();
+    test_io_invalid();
+}
@@ -0,0 +1,36 @@
+/*
+ * Tests of the scalar division of each family: integers truncate toward 0,
+ * the minimum divided by -1 wraps around, and a division by 0 exits.
+ */
+#include <stdint.h>
+
+#include "test_typed.h"
+#include "state.h"
+
+static void test_kdiv_zero(void *ctx){
+    m_kdivp(ctx, 0);
+}
+
+static void test_kdivt(void){
+    MATRIX_TYPE d[] = { 7, -7, TEST_INTEGER ? (MATRIX_TYPE)INT32_MIN : -8, 9 };
+    matrix_t *a = matrix_init(2, 2), *q = matrix_init(2, 2), *neg = matrix_init(2, 2);
+    matrix_set_data(a, d);
+    m_kdivt(a, 2, q);
+    m_kdivt(a, -1, neg);
+    // integers truncate toward 0, the minimum divided by -1 wraps around to itself
+    double half[] = { TEST_INTEGER ? 3 : 3.5, TEST_INTEGER ? -3 : -3.5, d[2] / 2.0, TEST_INTEGER ? 4 : 4.5 };
+    for(size_t i = 0; i < 4; i++){
+        TEST_CHECK(AT(q, i / 2, i % 2) == half[i], TEST_NAME " m_kdivt %g / 2: %g", (double)d[i], AT(q, i / 2, i % 2));
+        TEST_CHECK(AT(neg, i / 2, i % 2) == (TEST_INTEGER && i == 2 ? d[2] : -(double)d[i]),
+                   TEST_NAME " m_kdivt %g / -1: %g", (double)d[i], AT(neg, i / 2, i % 2));
+    }
+    if(TEST_INTEGER)
+        TEST_CHECK(test_exits(test_kdiv_zero, a, MATRIX_INVALID_ARGUMENT), TEST_NAME " m_kdiv by 0 does not exit");
+    matrix_free(a);
+    matrix_free(q);
+    matrix_free(neg);
+}
+
+void MATRIX_NAME(test_kdiv)(void){
+    test_kdivt();
+}
@@ -0,0 +1,125 @@
+/*
+ * Tests of the LU factorization: P*A = L*U across the 64 column panels,
+ * solves and inverses by their backward error, the determinant, and singular
+ * matrices. The integer family only checks that it is rejected.
+ */
+#include <string.h>
+
+#include "test_typed.h"
+#include "state.h"
+
+static double test_lu_reconstruct(const matrix_t *a, const matrix_lu_t *lu){
+    // largest |(P*A - L*U)(i,j)| relative to n max|A|
+    size_t n = a->row;
+    double err = 0;
+    for(size_t i = 0; i < n; i++)
+        for(size_t j = 0; j < n; j++){
+            double s = 0;
+            for(size_t k = 0; k <= (i < j ? i : j); k++)
+                s += (k == i ? 1 : AT(lu->lu, i, k)) * AT(lu->lu, k, j);
+            err = fmax(err, fabs(AT(a, lu->perm[i], j) - s));
+        }
+    return err / (n * test_maxabs(a));
+}
+
+static void test_lu_solve(void){
+    static const size_t sizes[] = { 1, 2, 7, 33, 64, 65, 100, 200 };
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+        size_t n = sizes[s];
+        matrix_t *a = test_random(n, n), *b = test_random(n, 3);
+        matrix_lu_t *lu = matrix_lu(a);
+        matrix_t *x = m_lu_solve(lu, b), *inv = m_lu_inv(lu), *ax = m_mul(a, x), *ai = m_mul(a, inv);
+
+        double rec = test_lu_reconstruct(a, lu);
+        TEST_CHECK(!lu->singular && rec <= 16 * TEST_EPS * n, TEST_NAME " matrix_lu %zu: P*A - L*U %g", n, rec);
+
+        // backward error: |A*X - B| relative to |A| |X| + |B|
+        double res = 0, ires = 0, scale = n * test_maxabs(a) * test_maxabs(x) + test_maxabs(b);
+        for(size_t i = 0; i < n; i++){
+            for(size_t j = 0; j < 3; j++)
+                res = fmax(res, fabs(AT(ax, i, j) - AT(b, i, j)));
+            for(size_t j = 0; j < n; j++)
+                ires = fmax(ires, fabs(AT(ai, i, j) - (i == j)) / (n * test_maxabs(a) * test_maxabs(inv)));
+        }
+        TEST_CHECK(res <= 64 * TEST_EPS * n * scale, TEST_NAME " m_lu_solve %zu: residual %g", n, res);
+        TEST_CHECK(ires <= 64 * TEST_EPS * n, TEST_NAME " m_lu_inv %zu: residual %g", n, ires);
+
+        // the result may be B itself
+        m_lu_solvet(lu, b, b);
+        TEST_CHECK(!memcmp(b->data, x->data, n * 3 * sizeof(MATRIX_TYPE)), TEST_NAME " m_lu_solvet %zu in place", n);
+
+        matrix_lu_free(lu);
+        matrix_free(a);
+        matrix_free(b);
+        matrix_free(x);
+        matrix_free(inv);
+        matrix_free(ax);
+        matrix_free(ai);
+    }
+
+    // the same from a strided view, factored on each call
+    matrix_t *big = test_random(40, 50), a = matrix_view(big, 3, 5, 30, 30), b = matrix_view(big, 3, 40, 30, 2);
+    matrix_t *x = m_solve(&a, &b), *ax = m_mul(&a, x);
+    double res = 0, scale = 30 * test_maxabs(&a) * test_maxabs(x) + test_maxabs(&b);
+    for(size_t i = 0; i < 30; i++)
+        for(size_t j = 0; j < 2; j++)
+            res = fmax(res, fabs(AT(ax, i, j) - AT(&b, i, j)));
+    TEST_CHECK(res <= 64 * TEST_EPS * 30 * scale, TEST_NAME " m_solve on a view: residual %g", res);
+    matrix_free(big);
+    matrix_free(x);
+    matrix_free(ax);
+}
+
+static void test_lu_singular_inv(void *ctx){
+    m_lu_inv(ctx);
+}
+
+static void test_lu_singular_solve(void *ctx){
+    matrix_t *b = matrix_init(50, 1);
+    m_solve(ctx, b);
+}
+
+static void test_lu_det(void){
+    // determinant with a row exchange
+    MATRIX_TYPE d[] = { 0, 2, 1, 3, 0, 4, 0, 0, 5 };
+    matrix_t *a = matrix_init(3, 3);
+    matrix_set_data(a, d);
+    TEST_CHECK(fabs((double)m_det(a) + 30) <= 64 * TEST_EPS * 30, TEST_NAME " m_det: %g", (double)m_det(a));
+
+    // a row twice another: singular, determinant 0, no solve nor inverse
+    matrix_t *z = test_random(50, 50);
+    memcpy(z->data + 7 * z->stride, z->data + 3 * z->stride, 50 * sizeof(MATRIX_TYPE));
+    for(size_t j = 0; j < 50; j++)
+        z->data[7 * z->stride + j] *= 2;
+    matrix_lu_t *lu = matrix_lu(z);
+    TEST_CHECK(lu->singular, TEST_NAME " matrix_lu: singular matrix not detected");
+    TEST_CHECK(test_exits(test_lu_singular_inv, lu, MATRIX_SINGULAR), TEST_NAME " m_lu_inv: singular matrix accepted");
+    TEST_CHECK(test_exits(test_lu_singular_solve, z, MATRIX_SINGULAR), TEST_NAME " m_solve: singular matrix accepted");
+
+    // an exact zero column stops the elimination: the determinant is exactly 0
+    matrix_t *c = test_random(5, 5);
+    for(size_t i = 0; i < 5; i++)
+        c->data[i * c->stride + 2] = 0;
+    TEST_CHECK(m_det(c) == 0, TEST_NAME " m_det of a zero column: %g", (double)m_det(c));
+
+    matrix_lu_free(lu);
+    matrix_free(a);
+    matrix_free(z);
+    matrix_free(c);
+}
+
+static void test_lu_integer(void *ctx){
+    matrix_lu(ctx);
+}
+
+void MATRIX_NAME(test_lu)(void){
+    // floating point families only
+    if(TEST_INTEGER){
+        matrix_t *a = matrix_Id(3);
+        TEST_CHECK(test_exits(test_lu_integer, a, MATRIX_INVALID_ARGUMENT), TEST_NAME " matrix_lu: accepted");
+        matrix_free(a);
+        return;
+    }
+    test_lu_solve();
+    test_lu_det();
+}
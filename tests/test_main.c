@@ -0,0 +1,103 @@
+/*
+ * Test suite: reference comparisons of the kernels of every element type family.
+ *
+ * usage: matrix_test
+ *
+ * make test runs it once per SIMD level (MATRIX_SIMD=scalar, avx2, avx512), so
+ * that each kernel variant available on the machine is compared with the
+ * reference loops.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+
+#include "test.h"
+
+int test_checks, test_failures;
+
+static uint64_t test_state = 0x9e3779b97f4a7c15;
+
+static char test_path[64];
+
+uint32_t test_rand(void){
+    // xorshift64*
+    test_state ^= test_state >> 12;
+    test_state ^= test_state << 25;
+    test_state ^= test_state >> 27;
+    return (uint32_t)((test_state * 0x2545f4914f6cdd1d) >> 32);
+}
+
+double test_uniform(double lo, double hi){
+    return lo + (hi - lo) * (test_rand() / 4294967296.0);
+}
+
+int test_exits(void (*fn)(void *ctx), void *ctx, int code){
+    fflush(NULL);
+    pid_t pid = fork();
+    if(pid < 0)
+        return 0;
+    if(!pid){
+        // the message of errx is expected: keep the output of the run readable
+        int null = open("/dev/null", O_WRONLY);
+        if(null >= 0)
+            dup2(null, STDERR_FILENO);
+        fn(ctx);
+        _exit(0);
+    }
+
+    int status;
+    if(waitpid(pid, &status, 0) != pid)
+        return 0;
+    return WIFEXITED(status) && WEXITSTATUS(status) == code;
+}
+
+static void test_cleanup(void){
+    if(test_path[0])
+        unlink(test_path);
+}
+
+const char *test_tmpfile(void){
+    if(!test_path[0]){
+        strcpy(test_path, "/tmp/matrix_test_XXXXXX");
+        int fd = mkstemp(test_path);
+        if(fd < 0){
+            perror("matrix_test");
+            exit(1);
+        }
+        close(fd);
+        atexit(test_cleanup);
+    }
+    return test_path;
+}
+
+int main(void){
+    const char *simd = getenv("MATRIX_SIMD");
+
+    TEST_RUN_TYPED(test_gemm);
+    TEST_RUN_TYPED(test_batched);
+    TEST_RUN_TYPED(test_fixed);
+    TEST_RUN_TYPED(test_kdiv);
+    TEST_RUN_TYPED(test_transp);
+    TEST_RUN_TYPED(test_reduce);
+    TEST_RUN_TYPED(test_math);
+    TEST_RUN_TYPED(test_gemv);
+    TEST_RUN_TYPED(test_sparse);
+    TEST_RUN_TYPED(test_io);
+    TEST_RUN_TYPED(test_ooc);
+    TEST_RUN_TYPED(test_access);
+    TEST_RUN_TYPED(test_lu);
+    TEST_RUN_TYPED(test_qr);
+    TEST_RUN_TYPED(test_strassen);
+    TEST_RUN_TYPED(test_async);
+
+    test_alloc();
+    test_convert();
+    test_stats();
+    test_q8();
+
+    printf("matrix_test (%s): %d checks, %d failed\n", simd ? simd : "default", test_checks, test_failures);
+    return test_failures != 0;
+}
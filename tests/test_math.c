@@ -0,0 +1,154 @@
+/*
+ * Tests of the span functions on views (stride != col): the built-in math
+ * functions against libm in double, m_applys row by row and m_clamp with its
+ * bounds checked. The elements around the views must stay untouched.
+ */
+#include <string.h>
+
+#include "test_typed.h"
+#include "state.h"
+
+// libm reference of a built-in function, truncated like the integer family computes it
+static double test_fn(matrix_fn_t fn, double x){
+    double y;
+    switch(fn & ~MATRIX_FN_FAST){
+    case MATRIX_FN_EXP: y = exp(x); break;
+    case MATRIX_FN_LOG: y = log(x); break;
+    case MATRIX_FN_TANH: y = tanh(x); break;
+    case MATRIX_FN_SIGMOID: y = 1 / (1 + exp(-x)); break;
+    case MATRIX_FN_RELU: y = x > 0 ? x : 0; break;
+    default: y = sqrt(x); break;
+    }
+    return TEST_INTEGER ? trunc(y) : y;
+}
+
+// view of rows x cols at (1, 2) of a larger matrix filled with values in [lo, hi)
+static matrix_t *test_math_big(size_t row, size_t col, double lo, double hi){
+    matrix_t *big = matrix_init(row + 3, col + 5);
+    for(size_t i = 0; i < big->row * big->col; i++)
+        big->data[i] = TEST_INTEGER ? (MATRIX_TYPE)floor(test_uniform(lo, hi)) : (MATRIX_TYPE)test_uniform(lo, hi);
+    return big;
+}
+
+// 1 if big and copy agree outside the view at (1, 2)
+static int test_math_border(const matrix_t *big, const matrix_t *copy, size_t row, size_t col){
+    int same = 1;
+    for(size_t i = 0; i < big->row; i++)
+        for(size_t j = 0; j < big->col; j++)
+            if(i < 1 || i >= 1 + row || j < 2 || j >= 2 + col)
+                same &= AT(big, i, j) == AT(copy, i, j);
+    return same;
+}
+
+static void test_map_views(void){
+    static const struct { matrix_fn_t fn; double lo, hi; } fns[] = {
+        {MATRIX_FN_EXP, -20, 20}, {MATRIX_FN_LOG, 1, 1e6}, {MATRIX_FN_TANH, -10, 10}, {MATRIX_FN_SIGMOID, -30, 30},
+        {MATRIX_FN_RELU, -5, 5}, {MATRIX_FN_SQRT, 0, 1e4},
+    };
+    size_t row = 13, col = 37;
+    for(size_t f = 0; f < sizeof(fns) / sizeof(fns[0]); f++)
+        for(int fast = 0; fast < 2; fast++){
+            matrix_fn_t fn = fns[f].fn | (fast ? MATRIX_FN_FAST : 0);
+            // precise within a few ulp, fast below 1e-5 (f32) or 1e-9 (f64) relative
+            double tol = TEST_INTEGER ? 0 : fast ? (TEST_EPS > 1e-10 ? 1e-5 : 1e-9) : 8 * TEST_EPS;
+            matrix_t *big = test_math_big(row, col, fns[f].lo, fns[f].hi), *copy = matrix_getcpy(big);
+            matrix_t *out = matrix_init(row + 2, col + 1);
+            matrix_t v = matrix_view(big, 1, 2, row, col), vo = matrix_view(out, 1, 0, row, col);
+
+            matrix_t *r = m_map(&v, fn);
+            m_mapt(&v, &vo, fn);
+            m_mapp(&v, fn);
+            double err = 0;
+            int exact = 1;
+            for(size_t i = 0; i < row; i++)
+                for(size_t j = 0; j < col; j++){
+                    double y = test_fn(fn, AT(copy, i + 1, j + 2));
+                    err = fmax(err, fabs(AT(r, i, j) - y) / fmax(fabs(y), 1e-300));
+                    exact &= AT(&vo, i, j) == AT(r, i, j) && AT(&v, i, j) == AT(r, i, j);
+                }
+            TEST_CHECK(err <= tol, TEST_NAME " m_map %#x view: relative error %g", (unsigned)fn, err);
+            TEST_CHECK(exact && test_math_border(big, copy, row, col), TEST_NAME " m_mapt / m_mapp %#x views", (unsigned)fn);
+            matrix_free(big);
+            matrix_free(copy);
+            matrix_free(out);
+            matrix_free(r);
+        }
+}
+
+static size_t test_span_calls;
+
+static void test_span(const MATRIX_TYPE *in, MATRIX_TYPE *out, size_t n){
+    test_span_calls++;
+    for(size_t i = 0; i < n; i++)
+        out[i] = 2 * in[i] + 1;
+}
+
+static void test_applys_views(void){
+    size_t row = 9, col = 20;
+    matrix_t *big = test_math_big(row, col, -100, 100), *copy = matrix_getcpy(big), v = matrix_view(big, 1, 2, row, col);
+
+    // one call per row of a view, one for a dense matrix
+    test_span_calls = 0;
+    matrix_t *r = m_applys(&v, test_span);
+    TEST_CHECK(test_span_calls == row, TEST_NAME " m_applys view: %zu calls", test_span_calls);
+    test_span_calls = 0;
+    matrix_t *r2 = m_applys(r, test_span);
+    TEST_CHECK(test_span_calls == 1, TEST_NAME " m_applys dense: %zu calls", test_span_calls);
+    m_applysp(&v, test_span);
+
+    int same = 1;
+    for(size_t i = 0; i < row; i++)
+        for(size_t j = 0; j < col; j++){
+            MATRIX_TYPE x = 2 * copy->data[(i + 1) * copy->stride + j + 2] + 1, x2 = 2 * x + 1;
+            same &= AT(r, i, j) == x && AT(&v, i, j) == x && AT(r2, i, j) == x2;
+        }
+    TEST_CHECK(same && test_math_border(big, copy, row, col), TEST_NAME " m_applys / m_applysp views");
+    matrix_free(big);
+    matrix_free(copy);
+    matrix_free(r);
+    matrix_free(r2);
+}
+
+static void test_clamp_inverted(void *ctx){
+    m_clampp(ctx, 1, -1);
+}
+
+static void test_clamp_nan(void *ctx){
+    m_clamp(ctx, (MATRIX_TYPE)NAN, 1);
+}
+
+static void test_clamp_views(void){
+    size_t row = 11, col = 35;
+    matrix_t *big = test_math_big(row, col, -10, 10), *copy = matrix_getcpy(big), v = matrix_view(big, 1, 2, row, col);
+    matrix_t *out = matrix_init(row + 1, col + 4), vo = matrix_view(out, 1, 3, row, col);
+    MATRIX_TYPE lo = (MATRIX_TYPE)-3, hi = (MATRIX_TYPE)4.5;
+
+    matrix_t *r = m_clamp(&v, lo, hi);
+    m_clampt(&v, lo, hi, &vo);
+    m_clampp(&v, lo, hi);
+    int same = 1;
+    for(size_t i = 0; i < row; i++)
+        for(size_t j = 0; j < col; j++){
+            double x = fmin(fmax(AT(copy, i + 1, j + 2), lo), hi);
+            same &= AT(r, i, j) == x && AT(&vo, i, j) == x && AT(&v, i, j) == x;
+        }
+    TEST_CHECK(same && test_math_border(big, copy, row, col), TEST_NAME " m_clamp / m_clampt / m_clampp views");
+
+    // lo == hi is a valid, constant clamp; lo > hi is rejected
+    m_clampp(&v, 2, 2);
+    TEST_CHECK(AT(&v, 0, 0) == 2 && AT(&v, row - 1, col - 1) == 2, TEST_NAME " m_clampp lo == hi");
+    TEST_CHECK(test_exits(test_clamp_inverted, &v, MATRIX_INVALID_ARGUMENT), TEST_NAME " m_clampp: lo > hi accepted");
+    if(!TEST_INTEGER)
+        TEST_CHECK(test_exits(test_clamp_nan, &v, MATRIX_INVALID_ARGUMENT), TEST_NAME " m_clamp: NaN bound accepted");
+
+    matrix_free(big);
+    matrix_free(copy);
+    matrix_free(out);
+    matrix_free(r);
+}
+
+void MATRIX_NAME(test_math)(void){
+    test_map_views();
+    test_applys_views();
+    test_clamp_views();
+}
@@ -0,0 +1,118 @@
+/*
+ * Tests of the out-of-core operations against the same operations in memory,
+ * with a budget small enough for 16 x 16 GEMM tiles and sizes that are not
+ * multiples of the tiles, so that every step reads and writes partial tiles.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "test_typed.h"
+
+// budget of OOC_GEMM_TILES (5) tiles of 16 x 16 elements
+#define TEST_OOC_BUDGET (5 * 16 * 16 * sizeof(MATRIX_TYPE))
+
+static matrix_t *test_ooc_load(const char *path){
+    matrix_t *m1 = matrix_load(path);
+    TEST_CHECK(m1 != NULL, TEST_NAME " matrix_load %s: %s", path, strerror(errno));
+    return m1;
+}
+
+static int test_ooc_same(const matrix_t *m1, const matrix_t *m2){
+    int same = m1 && m2 && m1->row == m2->row && m1->col == m2->col;
+    for(size_t i = 0; same && i < m1->row; i++)
+        for(size_t j = 0; j < m1->col; j++)
+            same &= AT(m1, i, j) == AT(m2, i, j);
+    return same;
+}
+
+static void test_ooc_mul(const char *pa, const char *pb, const char *pc){
+    static const size_t shapes[][3] = { {37, 45, 29}, {16, 16, 16}, {1, 50, 1}, {70, 3, 33}, {5, 0, 7} };
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++){
+        size_t m = shapes[s][0], k = shapes[s][1], n = shapes[s][2];
+        matrix_t *a = test_random(m, k), *b = test_random(k, n);
+        matrix_save(a, pa);
+        matrix_save(b, pb);
+
+        TEST_CHECK(!m_mul_file(pa, pb, pc), TEST_NAME " m_mul_file %zux%zux%zu: %s", m, k, n, strerror(errno));
+        matrix_t *c = test_ooc_load(pc);
+        double e = c ? test_mul_error(a, b, c) : INFINITY;
+        TEST_CHECK(c && c->row == m && c->col == n && e <= test_mul_bound(a, b, 2),
+                   TEST_NAME " m_mul_file %zux%zux%zu: error %g from m_mul", m, k, n, e);
+        if(c)
+            matrix_free(c);
+
+        // the result replaces an operand
+        TEST_CHECK(!m_mul_file(pa, pb, pa), TEST_NAME " m_mul_file %zux%zux%zu in place: %s", m, k, n, strerror(errno));
+        c = test_ooc_load(pa);
+        e = c ? test_mul_error(a, b, c) : INFINITY;
+        TEST_CHECK(e <= test_mul_bound(a, b, 2), TEST_NAME " m_mul_file %zux%zux%zu in place: error %g", m, k, n, e);
+        if(c)
+            matrix_free(c);
+        matrix_free(a);
+        matrix_free(b);
+    }
+}
+
+static void test_ooc_map(const char *pa, const char *pb, const char *pc){
+    // the element-wise operations are exact: the results are compared for equality
+    static const size_t shapes[][2] = { {37, 45}, {1, 1000}, {300, 1}, {3, 7} };
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++){
+        size_t m = shapes[s][0], n = shapes[s][1];
+        matrix_t *a = test_random(m, n), *b = test_random(m, n), *r;
+        matrix_save(a, pa);
+        matrix_save(b, pb);
+
+        m_add_file(pa, pb, pc);
+        matrix_t *c = test_ooc_load(pc);
+        TEST_CHECK(test_ooc_same(c, r = m_add(a, b)), TEST_NAME " m_add_file %zux%zu: not m_add", m, n);
+        matrix_free(r);
+        if(c)
+            matrix_free(c);
+
+        m_sub_file(pa, pb, pc);
+        c = test_ooc_load(pc);
+        TEST_CHECK(test_ooc_same(c, r = m_sub(a, b)), TEST_NAME " m_sub_file %zux%zu: not m_sub", m, n);
+        matrix_free(r);
+        if(c)
+            matrix_free(c);
+
+        m_kmul_file(pa, 3, pc);
+        c = test_ooc_load(pc);
+        TEST_CHECK(test_ooc_same(c, r = m_kmul(a, 3)), TEST_NAME " m_kmul_file %zux%zu: not m_kmul", m, n);
+        matrix_free(r);
+        if(c)
+            matrix_free(c);
+
+        m_map_file(pb, MATRIX_FN_RELU, pb);
+        c = test_ooc_load(pb);
+        TEST_CHECK(test_ooc_same(c, r = m_map(b, MATRIX_FN_RELU)), TEST_NAME " m_map_file %zux%zu in place: not m_map", m, n);
+        matrix_free(r);
+        if(c)
+            matrix_free(c);
+        matrix_free(a);
+        matrix_free(b);
+    }
+
+    errno = 0;
+    TEST_CHECK(m_add_file("/nonexistent/matrix", pb, pc) && errno == ENOENT, TEST_NAME " m_add_file: missing operand");
+}
+
+void MATRIX_NAME(test_ooc)(void){
+    // three files next to the temporary file of the tests
+    char pa[64], pb[64], pc[64];
+    snprintf(pa, sizeof(pa), "%s.a", test_tmpfile());
+    snprintf(pb, sizeof(pb), "%s.b", test_tmpfile());
+    snprintf(pc, sizeof(pc), "%s.c", test_tmpfile());
+
+    size_t budget = matrix_get_ooc_budget();
+    matrix_set_ooc_budget(TEST_OOC_BUDGET);
+    test_ooc_mul(pa, pb, pc);
+    test_ooc_map(pa, pb, pc);
+    matrix_set_ooc_budget(budget);
+
+    unlink(pa);
+    unlink(pb);
+    unlink(pc);
+}
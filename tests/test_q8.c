@@ -0,0 +1,151 @@
+/*
+ * Tests of the int8 matrices: quantization, and the int8 products against the
+ * exact sums of (a - za)*(b - zb) in int64, for shapes on both sides of the
+ * in place path (short A) and with k tails of every kernel width.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "matrix.h"
+#include "test.h"
+#include "state.h"
+
+// scale and zero point of row i
+#define Q8_ROW(q, i) ((q)->quant & MATRIX_QUANT_ROW ? (i) : 0)
+
+static matrix_t *q8_random(size_t row, size_t col, float lo, float hi){
+    matrix_t *m1 = matrix_init(row, col);
+    for(size_t i = 0; i < row * col; i++)
+        m1->data[i] = (float)test_uniform(lo, hi);
+    return m1;
+}
+
+static int64_t q8_ref(const matrix_q8_t *a, const matrix_q8_t *b, size_t i, size_t j){
+    // exact sum of (a - za)*(b - zb) of row i of A and row j of B
+    int64_t za = a->zero[Q8_ROW(a, i)], zb = b->zero[Q8_ROW(b, j)], s = 0;
+    for(size_t p = 0; p < a->col; p++)
+        s += (a->data[i * a->stride + p] - za) * (b->data[j * b->stride + p] - zb);
+    return s;
+}
+
+static void test_quantize(void){
+    static const matrix_quant_t modes[] = {
+        MATRIX_QUANT_TENSOR, MATRIX_QUANT_ROW, MATRIX_QUANT_SYMMETRIC, MATRIX_QUANT_ROW | MATRIX_QUANT_SYMMETRIC,
+    };
+    for(size_t mo = 0; mo < 4; mo++){
+        matrix_t *x = q8_random(13, 300, -2, 5);
+        matrix_q8_t *q = matrix_quantize(x, modes[mo]);
+        matrix_t *y = matrix_dequantize(q);
+
+        // within half a step, and the range of every row mapped inside [-127, 127]
+        double err = 0;
+        int range = 1;
+        for(size_t i = 0; i < 13; i++)
+            for(size_t j = 0; j < 300; j++){
+                err = fmax(err, fabs(y->data[i * 300 + j] - x->data[i * 300 + j]) / q->scale[Q8_ROW(q, i)]);
+                range &= q->data[i * q->stride + j] >= -127;
+            }
+        TEST_CHECK(err <= 0.5 + 1e-3 && range, "matrix_quantize mode %d: error %g steps", (int)modes[mo], err);
+        if(modes[mo] & MATRIX_QUANT_SYMMETRIC)
+            TEST_CHECK(q->zero[0] == 0, "matrix_quantize symmetric: zero point %d", q->zero[0]);
+        matrix_free(x);
+        matrix_free(y);
+        matrix_q8_free(q);
+    }
+}
+
+static void test_q8_mul(void){
+    // m around Q8_DOT_ROWS (64), k tails of the 4, 16, 32 and 64 byte kernels
+    static const size_t shapes[][3] = {
+        {1, 1, 1}, {3, 5, 7}, {4, 4, 64}, {17, 9, 130}, {33, 70, 200}, {1, 300, 1000},
+        {64, 40, 65}, {65, 67, 513}, {100, 40, 77}, {130, 33, 300}, {5, 3, 0},
+    };
+    // asymmetric A with symmetric B (activations and weights), and the other combinations
+    static const matrix_quant_t modes[][2] = {
+        {MATRIX_QUANT_ROW, MATRIX_QUANT_ROW | MATRIX_QUANT_SYMMETRIC}, {MATRIX_QUANT_TENSOR, MATRIX_QUANT_ROW},
+        {MATRIX_QUANT_ROW, MATRIX_QUANT_TENSOR}, {MATRIX_QUANT_SYMMETRIC, MATRIX_QUANT_SYMMETRIC},
+    };
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++)
+        for(size_t mo = 0; mo < 4; mo++){
+            size_t m = shapes[s][0], n = shapes[s][1], k = shapes[s][2];
+            matrix_t *x = q8_random(m, k, -1, 3), *w = q8_random(n, k, -2, 2);
+            matrix_q8_t *a = matrix_quantize(x, modes[mo][0]), *b = matrix_quantize(w, modes[mo][1]);
+            matrix_i32_t *c = matrix_init_i32(m, n);
+            matrix_t *f = m_q8_mul(a, b);
+            m_q8_mult_i32(a, b, c);
+
+            // requantized to a per-row output
+            matrix_q8_t *r = matrix_q8_init(m, n, MATRIX_QUANT_ROW);
+            for(size_t i = 0; i < m; i++){
+                r->scale[i] = 0.05f * (float)(i % 3 + 1);
+                r->zero[i] = (int32_t)(i % 5) - 2;
+            }
+            m_q8_multq(a, b, r);
+
+            int exact = 1, requant = 1;
+            double err = 0;
+            for(size_t i = 0; i < m; i++)
+                for(size_t j = 0; j < n; j++){
+                    int64_t ref = q8_ref(a, b, i, j);
+                    double sab = (double)a->scale[Q8_ROW(a, i)] * b->scale[Q8_ROW(b, j)];
+                    exact &= c->data[i * c->stride + j] == ref;
+                    err = fmax(err, fabs(f->data[i * f->stride + j] - ref * sab) / (fabs(ref * sab) + sab));
+                    double q = fmin(fmax(nearbyint(ref * sab / r->scale[i]) + r->zero[i], -127), 127);
+                    requant &= fabs(r->data[i * r->stride + j] - q) <= 1;
+                }
+            TEST_CHECK(exact, "m_q8_mult_i32 %zux%zux%zu modes %zu: not the exact sums", m, n, k, mo);
+            TEST_CHECK(err <= 1e-5, "m_q8_mul %zux%zux%zu modes %zu: relative error %g", m, n, k, mo, err);
+            TEST_CHECK(requant, "m_q8_multq %zux%zux%zu modes %zu: off by more than 1", m, n, k, mo);
+
+            matrix_free(x);
+            matrix_free(w);
+            matrix_free(f);
+            matrix_free_i32(c);
+            matrix_q8_free(a);
+            matrix_q8_free(b);
+            matrix_q8_free(r);
+        }
+}
+
+static void test_q8_alias(void){
+    // requantized result in place of either operand, on the in place path (n <= 64) and the packed one
+    static const size_t sizes[] = { 8, 33, 64, 65, 100 };
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+        size_t n = sizes[s];
+        matrix_t *x = q8_random(n, n, -1, 1), *w = q8_random(n, n, -1, 1);
+        matrix_q8_t *a = matrix_quantize(x, MATRIX_QUANT_ROW), *b = matrix_quantize(w, MATRIX_QUANT_ROW);
+        matrix_q8_t *r = matrix_quantize(x, MATRIX_QUANT_ROW), *ra = matrix_quantize(x, MATRIX_QUANT_ROW);
+        matrix_q8_t *rb = matrix_quantize(w, MATRIX_QUANT_ROW), *r2 = matrix_quantize(w, MATRIX_QUANT_ROW);
+
+        // each aliased result against a separate one with the same scales
+        m_q8_multq(ra, b, r);
+        m_q8_multq(ra, b, ra);
+        m_q8_multq(a, rb, rb);
+        m_q8_multq(a, b, r2);
+
+        TEST_CHECK(!memcmp(ra->data, r->data, n * n), "m_q8_multq %zu: result == a differs", n);
+        TEST_CHECK(!memcmp(rb->data, r2->data, n * n), "m_q8_multq %zu: result == b differs", n);
+
+        matrix_free(x);
+        matrix_free(w);
+        matrix_q8_free(a);
+        matrix_q8_free(b);
+        matrix_q8_free(r);
+        matrix_q8_free(ra);
+        matrix_q8_free(rb);
+        matrix_q8_free(r2);
+    }
+}
+
+static void test_q8_huge(void *ctx){
+    (void)ctx;
+    matrix_q8_init(SIZE_MAX / 2, 3, MATRIX_QUANT_TENSOR);
+}
+
+void test_q8(void){
+    test_quantize();
+    test_q8_mul();
+    test_q8_alias();
+    TEST_CHECK(test_exits(test_q8_huge, NULL, MATRIX_INVALID_ARGUMENT), "matrix_q8_init: row * col overflow accepted");
+}
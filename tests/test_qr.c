@@ -0,0 +1,146 @@
+/*
+ * Tests of the QR factorizations: Q orthonormal and Q*R = A for tall, square
+ * and wide matrices, least squares by the orthogonality of the residual, the
+ * tall-skinny QR against the Householder one, and rank deficient matrices.
+ * The integer family only checks that it is rejected.
+ */
+#include <string.h>
+
+#include "test_typed.h"
+#include "state.h"
+
+static void test_qr_householder(void){
+    // the last shapes are wide: no least squares
+    static const size_t shapes[][2] = { {40, 1}, {70, 70}, {129, 65}, {300, 40}, {20, 50}, {1, 9} };
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++){
+        size_t m = shapes[s][0], n = shapes[s][1], p = m < n ? m : n;
+        matrix_t *a = test_random(m, n), *b = test_random(m, 2);
+        matrix_qr_t *qr = matrix_qr(a);
+        matrix_t *q = m_qr_q(qr), *r = m_qr_r(qr), *qt = m_transp(q), *qtq = m_mul(qt, q), *qrm = m_mul(q, r);
+
+        // R upper triangular, Q with orthonormal columns
+        double orth = 0, fact = 0, lower = 0;
+        for(size_t i = 0; i < p; i++)
+            for(size_t j = 0; j < p; j++)
+                orth = fmax(orth, fabs(AT(qtq, i, j) - (i == j)));
+        for(size_t i = 0; i < p; i++)
+            for(size_t j = 0; j < i; j++)
+                lower = fmax(lower, fabs(AT(r, i, j)));
+        for(size_t i = 0; i < m; i++)
+            for(size_t j = 0; j < n; j++)
+                fact = fmax(fact, fabs(AT(qrm, i, j) - AT(a, i, j)));
+        TEST_CHECK(q->row == m && q->col == p && r->row == p && r->col == n && !lower,
+                   TEST_NAME " m_qr_q / m_qr_r %zux%zu: shapes, or R not upper triangular", m, n);
+        TEST_CHECK(orth <= 16 * TEST_EPS * m, TEST_NAME " m_qr_q %zux%zu: |Q^T Q - I| %g", m, n, orth);
+        TEST_CHECK(fact <= 16 * TEST_EPS * m * n, TEST_NAME " m_qr_r %zux%zu: |Q R - A| %g", m, n, fact);
+        matrix_free(q);
+        matrix_free(r);
+        matrix_free(qt);
+        matrix_free(qtq);
+        matrix_free(qrm);
+        if(m < n){
+            matrix_qr_free(qr);
+            matrix_free(a);
+            matrix_free(b);
+            continue;
+        }
+
+        // least squares: the residual is orthogonal to the columns of A
+        matrix_t *x = m_qr_solve(qr, b), *ax = m_mul(a, x), *res = m_sub(b, ax), *at = m_transp(a), *g = m_mul(at, res);
+        double bound = 64 * TEST_EPS * m * n * (1 + test_maxabs(x));
+        TEST_CHECK(test_maxabs(g) <= bound, TEST_NAME " m_qr_solve %zux%zu: |A^T r| %g", m, n, test_maxabs(g));
+
+        matrix_t *y = m_lstsq(a, b);
+        double diff = 0;
+        for(size_t i = 0; i < n; i++)
+            for(size_t j = 0; j < 2; j++)
+                diff = fmax(diff, fabs(AT(y, i, j) - AT(x, i, j)));
+        TEST_CHECK(diff <= bound, TEST_NAME " m_lstsq %zux%zu: %g from m_qr_solve", m, n, diff);
+
+        matrix_qr_free(qr);
+        matrix_free(a);
+        matrix_free(b);
+        matrix_free(x);
+        matrix_free(ax);
+        matrix_free(res);
+        matrix_free(at);
+        matrix_free(g);
+        matrix_free(y);
+    }
+}
+
+static void test_qr_tall(void){
+    // the last shapes have more row blocks than one wave of the reduction tree
+    static const size_t shapes[][2] = { {5, 5}, {3000, 7}, {20000, 40}, {1200000, 2} };
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++){
+        size_t m = shapes[s][0], n = shapes[s][1];
+        matrix_t *a = test_random(m, n), *b = test_random(m, 1);
+        matrix_qr_t *qr = matrix_qr(a);
+        matrix_t *r = m_tsqr(a), *r2 = m_qr_r(qr);
+
+        // R is unique up to the signs of its rows
+        double err = 0, scale = test_maxabs(r2);
+        for(size_t i = 0; i < n; i++)
+            for(size_t j = 0; j < n; j++)
+                err = fmax(err, fabs(fabs(AT(r, i, j)) - fabs(AT(r2, i, j))));
+        TEST_CHECK(err <= 64 * TEST_EPS * n * scale * log2((double)m + 1), TEST_NAME " m_tsqr %zux%zu: error %g", m, n, err);
+
+        matrix_t *x = m_tsqr_solve(a, b), *x2 = m_qr_solve(qr, b);
+        double diff = 0;
+        for(size_t i = 0; i < n; i++)
+            diff = fmax(diff, fabs(AT(x, i, 0) - AT(x2, i, 0)));
+        TEST_CHECK(diff <= 256 * TEST_EPS * n * (1 + test_maxabs(x2)) * log2((double)m + 1),
+                   TEST_NAME " m_tsqr_solve %zux%zu: %g from m_qr_solve", m, n, diff);
+
+        matrix_qr_free(qr);
+        matrix_free(a);
+        matrix_free(b);
+        matrix_free(r);
+        matrix_free(r2);
+        matrix_free(x);
+        matrix_free(x2);
+    }
+}
+
+
+static void test_qr_rank_lstsq(void *ctx){
+    matrix_t *b = matrix_init(((matrix_t *)ctx)->row, 1);
+    m_lstsq(ctx, b);
+}
+
+static void test_qr_rank_tsqr(void *ctx){
+    matrix_t *b = matrix_init(((matrix_t *)ctx)->row, 1);
+    m_tsqr_solve(ctx, b);
+}
+
+static void test_qr_rank(void){
+    // a column twice another: no unique least squares solution
+    static const size_t rows[] = { 30, 5000 };
+    for(size_t s = 0; s < 2; s++){
+        matrix_t *a = test_random(rows[s], 6);
+        for(size_t i = 0; i < rows[s]; i++)
+            a->data[i * a->stride + 4] = 2 * a->data[i * a->stride + 1];
+        TEST_CHECK(test_exits(test_qr_rank_lstsq, a, MATRIX_SINGULAR),
+                   TEST_NAME " m_lstsq %zux6: rank deficient matrix accepted", rows[s]);
+        TEST_CHECK(test_exits(test_qr_rank_tsqr, a, MATRIX_SINGULAR),
+                   TEST_NAME " m_tsqr_solve %zux6: rank deficient matrix accepted", rows[s]);
+        matrix_free(a);
+    }
+}
+
+static void test_qr_integer(void *ctx){
+    matrix_qr(ctx);
+}
+
+void MATRIX_NAME(test_qr)(void){
+    // floating point families only
+    if(TEST_INTEGER){
+        matrix_t *a = matrix_Id(3);
+        TEST_CHECK(test_exits(test_qr_integer, a, MATRIX_INVALID_ARGUMENT), TEST_NAME " matrix_qr: accepted");
+        matrix_free(a);
+        return;
+    }
+    test_qr_householder();
+    test_qr_tall();
+    test_qr_rank();
+}
@@ -0,0 +1,86 @@
+/*
+ * Tests of the reduction engine: every direction on a view against sums in
+ * double, and the accuracy of the summation modes on a vector spread over
+ * many tasks, against a compensated sum in long double.
+ */
+#include <stdlib.h>
+
+#include "test_typed.h"
+
+static void test_reduce_dirs(void){
+    // every direction, on a view, against sums in double
+    matrix_t *big = test_random(40, 1003), v = matrix_view(big, 2, 1, 37, 1000);
+    static const matrix_dir_t dirs[] = { ROW, COLUMN, ALL };
+    for(size_t d = 0; d < 3; d++){
+        matrix_dir_t dir = dirs[d];
+        size_t rr = dir == COLUMN ? v.row : 1, rc = dir == ROW ? v.col : 1, len = dir == ROW ? v.row : dir == COLUMN ? v.col : v.row * v.col;
+        matrix_t *sum = matrix_init(rr, rc), *min = matrix_init(rr, rc), *max = matrix_init(rr, rc);
+        size_t *argmax = malloc(rr * rc * sizeof(size_t));
+        m_reduce(&v, dir, &(matrix_reduce_t){ .sum = sum, .min = min, .max = max, .argmax = argmax });
+
+        double err = 0;
+        int extrema = 1;
+        for(size_t o = 0; o < rr * rc; o++){
+            double s = 0, lo = INFINITY, hi = -INFINITY;
+            size_t at = 0;
+            for(size_t e = 0; e < len; e++){
+                size_t i = dir == ROW ? e : dir == COLUMN ? o : e / v.col, j = dir == ROW ? o : dir == COLUMN ? e : e % v.col;
+                double x = AT(&v, i, j);
+                s += x;
+                lo = fmin(lo, x);
+                if(x > hi){
+                    hi = x;
+                    at = dir == ALL ? i * v.col + j : dir == ROW ? i : j;
+                }
+            }
+            err = fmax(err, fabs(sum->data[o] - s));
+            extrema &= min->data[o] == (MATRIX_TYPE)lo && max->data[o] == (MATRIX_TYPE)hi && argmax[o] == at;
+        }
+        TEST_CHECK(err <= 4 * TEST_EPS * len * 8, TEST_NAME " m_reduce sum dir %d: error %g", (int)dir, err);
+        TEST_CHECK(extrema, TEST_NAME " m_reduce min / max / argmax dir %d", (int)dir);
+        matrix_free(sum);
+        matrix_free(min);
+        matrix_free(max);
+        free(argmax);
+    }
+    matrix_free(big);
+}
+
+static void test_reduce_modes(void){
+    /*
+        * accuracy of the summation modes with ALL over 128 tasks of REDUCE_TASK elements:
+        * pairwise grows as log n, Kahan not at all. Every element is 1 + 31 eps, so that
+        * a task sums to 65536 + 31*65536 eps exactly, and once the running total reaches
+        * 2^22 each partial added to it straight loses 31/64 of an ulp
+    */
+    size_t n = (size_t)1 << 23;
+    matrix_t *x = matrix_init(1, n), *s = matrix_init(1, 1), *norm1 = matrix_init(1, 1);
+    // the reference itself is summed with compensation in long double
+    long double sum = 0, comp = 0;
+    double abs = 0;
+    for(size_t i = 0; i < n; i++){
+        x->data[i] = TEST_INTEGER ? (MATRIX_TYPE)(test_rand() % 7) : (MATRIX_TYPE)(1 + 31 * TEST_EPS);
+        long double y = AT(x, 0, i), t = sum + y;
+        comp += fabsl(sum) >= fabsl(y) ? (sum - t) + y : (y - t) + sum;
+        sum = t;
+        abs += fabs(AT(x, 0, i));
+    }
+    double exact = (double)(sum + comp);
+    static const matrix_sum_t modes[] = { MATRIX_SUM_PAIRWISE, MATRIX_SUM_KAHAN, MATRIX_SUM_NAIVE };
+    // pairwise is exact here, every node of the tree holding a power of two times the sum of a task
+    double bounds[] = { 4 * TEST_EPS * abs, 4 * TEST_EPS * abs, TEST_EPS * n * abs };
+    for(size_t mo = 0; mo < 3; mo++){
+        m_reduce(x, ALL, &(matrix_reduce_t){ .sum = s, .norm1 = norm1, .mode = modes[mo] });
+        double err = fabs(AT(s, 0, 0) - exact), err1 = fabs(AT(norm1, 0, 0) - exact);
+        TEST_CHECK(err <= bounds[mo] && err1 <= bounds[mo], TEST_NAME " summation mode %d: error %g, norm1 %g, bound %g",
+                   (int)modes[mo], err, err1, bounds[mo]);
+    }
+    matrix_free(x);
+    matrix_free(s);
+    matrix_free(norm1);
+}
+
+void MATRIX_NAME(test_reduce)(void){
+    test_reduce_dirs();
+    test_reduce_modes();
+}
@@ -0,0 +1,172 @@
+/*
+ * Tests of the sparse matrices against the dense operations: the CSR and COO
+ * conversions, SpMV, SpMM, the Gustavson SpGEMM and the powers, on matrices
+ * with empty rows, and on matrices without any non-zero.
+ */
+#include <stdint.h>
+
+#include "test_typed.h"
+
+// dense row x col matrix with about one element in sparse non-zero, and every fifth row empty
+static matrix_t *test_sparse_random(size_t row, size_t col, unsigned sparse, int unit){
+    matrix_t *m1 = matrix_init(row, col);
+    for(size_t i = 0; i < row; i++)
+        for(size_t j = 0; i % 5 != 4 && j < col; j++)
+            if(!(test_rand() % sparse))
+                m1->data[i * col + j] = unit ? (MATRIX_TYPE)(test_rand() & 1 ? 1 : -1)
+                                             : (MATRIX_TYPE)((int)(test_rand() % 17) - 8);
+    return m1;
+}
+
+static int test_sparse_equal(const matrix_t *a, const matrix_t *b){
+    int same = a->row == b->row && a->col == b->col;
+    for(size_t i = 0; same && i < a->row; i++)
+        for(size_t j = 0; j < a->col; j++)
+            same &= AT(a, i, j) == AT(b, i, j);
+    return same;
+}
+
+static int test_csr_valid(const matrix_csr_t *s, const matrix_t *dense){
+    // offsets, increasing columns, no stored zeros, and the same elements as dense
+    int ok = s->ptr[0] == 0 && s->ptr[s->row] == s->nnz;
+    for(size_t i = 0; ok && i < s->row; i++){
+        ok &= s->ptr[i] <= s->ptr[i + 1];
+        for(size_t k = s->ptr[i]; ok && k < s->ptr[i + 1]; k++)
+            ok &= (k == s->ptr[i] || s->idx[k - 1] < s->idx[k]) && s->val[k] != 0
+                  && s->val[k] == dense->data[i * dense->stride + s->idx[k]];
+    }
+    size_t nnz = 0;
+    for(size_t i = 0; i < dense->row; i++)
+        for(size_t j = 0; j < dense->col; j++)
+            nnz += AT(dense, i, j) != 0;
+    return ok && nnz == s->nnz;
+}
+
+static void test_sparse_convert(void){
+    static const size_t shapes[][3] = { {1, 1, 2}, {10, 7, 3}, {100, 130, 20}, {33, 1, 2}, {8, 9, 1000000} };
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++){
+        size_t m = shapes[s][0], n = shapes[s][1];
+        matrix_t *a = test_sparse_random(m, n, (unsigned)shapes[s][2], 0);
+        matrix_csr_t *csr = matrix_csr_from(a);
+        matrix_t *back = matrix_csr_to(csr);
+        TEST_CHECK(test_csr_valid(csr, a) && test_sparse_equal(a, back),
+                   TEST_NAME " matrix_csr_from / matrix_csr_to %zux%zu, nnz %zu", m, n, csr->nnz);
+
+        // COO in reverse order, each element split in two duplicates summed by the conversion
+        matrix_coo_t *coo = matrix_coo_init(m, n, 1);
+        for(size_t i = m; i-- > 0;)
+            for(size_t j = n; j-- > 0;)
+                if(AT(a, i, j) != 0){
+                    MATRIX_TYPE x = a->data[i * n + j], h = x / 2;
+                    matrix_coo_push(coo, i, j, h);
+                    matrix_coo_push(coo, i, j, x - h);
+                }
+        matrix_csr_t *from_coo = matrix_csr_from_coo(coo);
+        matrix_coo_t *coo2 = matrix_coo_from_csr(from_coo), *coo3 = matrix_coo_from(a);
+        matrix_t *back2 = matrix_coo_to(coo2), *back3 = matrix_coo_to(coo3);
+        TEST_CHECK(test_csr_valid(from_coo, a) && test_sparse_equal(a, back2) && test_sparse_equal(a, back3),
+                   TEST_NAME " COO conversions %zux%zu", m, n);
+
+        int get = 1;
+        for(size_t i = 0; i < m; i++)
+            for(size_t j = 0; j < n; j++)
+                get &= matrix_csr_get(csr, i, j) == a->data[i * n + j];
+        TEST_CHECK(get, TEST_NAME " matrix_csr_get %zux%zu", m, n);
+
+        matrix_free(a);
+        matrix_free(back);
+        matrix_free(back2);
+        matrix_free(back3);
+        matrix_csr_free(csr);
+        matrix_csr_free(from_coo);
+        matrix_coo_free(coo);
+        matrix_coo_free(coo2);
+        matrix_coo_free(coo3);
+    }
+}
+
+static void test_sparse_products(void){
+    // the last shape has no non-zero at all
+    static const size_t shapes[][4] = { {1, 1, 1, 2}, {10, 7, 5, 3}, {200, 150, 40, 10}, {1000, 800, 3, 50}, {9, 6, 4, 0} };
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++){
+        size_t m = shapes[s][0], k = shapes[s][1], n = shapes[s][2];
+        matrix_t *a = shapes[s][3] ? test_sparse_random(m, k, (unsigned)shapes[s][3], 0) : matrix_init(m, k);
+        matrix_t *b = test_sparse_random(k, n, 4, 0), *x = test_random(k, 1), *y = test_random(1, m), *y0 = matrix_getcpy(y);
+        matrix_csr_t *sa = matrix_csr_from(a), *sb = matrix_csr_from(b);
+
+        // SpMV: column vector, and a row vector with beta
+        matrix_t *ax = m_spmv(2, sa, x), *dx = m_gemv(2, a, x, MATRIX_GEMV_DEFAULT);
+        matrix_t xt = matrix_view_data(x->data, 1, k, k);
+        m_spmvt(3, sa, &xt, -1, y);
+        double err = 0, errt = 0;
+        for(size_t i = 0; i < m; i++){
+            double r = -AT(y0, 0, i);
+            for(size_t j = 0; j < k; j++)
+                r += 3 * AT(a, i, j) * AT(x, j, 0);
+            err = fmax(err, fabs(AT(ax, i, 0) - AT(dx, i, 0)));
+            errt = fmax(errt, fabs(AT(y, 0, i) - r));
+        }
+        double bound = 4 * TEST_EPS * k * 8 * 3;
+        TEST_CHECK(ax->row == m && ax->col == 1 && err <= bound, TEST_NAME " m_spmv %zux%zu: %g from m_gemv", m, k, err);
+        TEST_CHECK(errt <= bound, TEST_NAME " m_spmvt %zux%zu: error %g", m, k, errt);
+
+        // SpMM, and SpGEMM back to dense, against m_mul
+        matrix_t *d = m_mul(a, b), *sd = m_spmul(sa, b);
+        matrix_csr_t *ss = m_spspmul(sa, sb);
+        matrix_t *ssd = matrix_csr_to(ss);
+        double errm = test_mul_error(a, b, sd), errs = test_mul_error(a, b, ssd);
+        TEST_CHECK(errm <= test_mul_bound(a, b, 2), TEST_NAME " m_spmul %zux%zux%zu: error %g", m, k, n, errm);
+        TEST_CHECK(errs <= test_mul_bound(a, b, 2) && ss->ptr[m] == ss->nnz,
+                   TEST_NAME " m_spspmul %zux%zux%zu: error %g", m, k, n, errs);
+
+        matrix_free(a);
+        matrix_free(b);
+        matrix_free(x);
+        matrix_free(y);
+        matrix_free(y0);
+        matrix_free(ax);
+        matrix_free(dx);
+        matrix_free(d);
+        matrix_free(sd);
+        matrix_free(ssd);
+        matrix_csr_free(sa);
+        matrix_csr_free(sb);
+        matrix_csr_free(ss);
+    }
+}
+
+static void test_sparse_pow(void){
+    /*
+        * elements +-1, so that the powers are exact: about 3 non-zeros per row of 64 fill past
+        * 1/16 of the matrix at the square and switch to the dense products, a permutation stays
+        * sparse, and the zero matrix stays empty
+    */
+    size_t dim = 64;
+    matrix_t *fill = test_sparse_random(dim, dim, 21, 1), *perm = matrix_init(dim, dim), *zero = matrix_init(dim, dim);
+    for(size_t i = 0; i < dim; i++)
+        perm->data[i * dim + (i * 5 + 3) % dim] = (MATRIX_TYPE)(i % 2 ? -1 : 1);
+    matrix_t *cases[] = { fill, perm, zero };
+
+    for(size_t c = 0; c < 3; c++){
+        matrix_csr_t *s = matrix_csr_from(cases[c]);
+        for(size_t n = 0; n <= 7; n++){
+            matrix_csr_t *p = m_sppow(s, n);
+            matrix_t *dp = matrix_csr_to(p), *ref = m_pow(cases[c], n);
+            TEST_CHECK(test_sparse_equal(dp, ref) && p->ptr[dim] == p->nnz,
+                       TEST_NAME " m_sppow case %zu, power %zu: not m_pow", c, n);
+            matrix_csr_free(p);
+            matrix_free(dp);
+            matrix_free(ref);
+        }
+        matrix_csr_free(s);
+    }
+    matrix_free(fill);
+    matrix_free(perm);
+    matrix_free(zero);
+}
+
+void MATRIX_NAME(test_sparse)(void){
+    test_sparse_convert();
+    test_sparse_products();
+    test_sparse_pow();
+}
@@ -0,0 +1,149 @@
+/*
+ * Tests of the instrumentation: the counters of a call, nested operations
+ * counted once, the hook with its context, and hooks replaced while other
+ * threads run operations. Without MATRIX_STATS, nothing may be recorded.
+ */
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#include "matrix.h"
+#include "test.h"
+
+typedef struct {
+    matrix_op_t op;
+    uint64_t calls, elements;
+}test_trace_t;
+
+static void test_trace(matrix_op_t op, const matrix_stat_t *call, void *ctx){
+    test_trace_t *t = ctx;
+    t->op = op;
+    t->calls += call->calls;
+    t->elements += call->elements;
+}
+
+static void test_stats_disabled(void){
+    test_trace_t t = { 0 };
+    matrix_stat_t stats[MATRIX_OP_COUNT];
+    matrix_stats_hook(test_trace, &t);
+    matrix_t *a = matrix_of(4, 4, 1), *b = m_mul(a, a);
+    matrix_stats_hook(NULL, NULL);
+    matrix_stats(stats);
+    TEST_CHECK(!t.calls && !stats[MATRIX_OP_MUL].calls, "matrix_stats: calls recorded without MATRIX_STATS");
+    matrix_free(a);
+    matrix_free(b);
+}
+
+static void test_stats_counters(void){
+    matrix_stat_t stats[MATRIX_OP_COUNT];
+    matrix_t *a = matrix_of(10, 20, 1), *b = matrix_of(20, 30, 2);
+    matrix_f64_t *x = matrix_init_f64(5, 6);
+
+    matrix_stats_reset();
+    matrix_t *c = m_mul(a, b);
+    matrix_f64_t *y = m_add_f64(x, x);
+    matrix_stats(stats);
+    matrix_stat_t *mul = &stats[MATRIX_OP_MUL], *add = &stats[MATRIX_OP_ADD];
+    TEST_CHECK(mul->calls == 1 && mul->elements == 10 * 30 && mul->flops == 2 * 10 * 30 * 20 && mul->allocs >= 1,
+               "matrix_stats m_mul: %llu calls, %llu elements, %llu flops, %llu allocations",
+               (unsigned long long)mul->calls, (unsigned long long)mul->elements, (unsigned long long)mul->flops,
+               (unsigned long long)mul->allocs);
+    TEST_CHECK(add->calls == 1 && add->elements == 30 && add->bytes == 3 * 30 * sizeof(double),
+               "matrix_stats m_add_f64: %llu calls, %llu bytes", (unsigned long long)add->calls,
+               (unsigned long long)add->bytes);
+
+    // m_pow multiplies through m_mul: one call of m_pow only
+    matrix_t *sq = matrix_of(8, 8, 1);
+    matrix_stats_reset();
+    matrix_t *p = m_pow(sq, 5);
+    matrix_stats(stats);
+    TEST_CHECK(stats[MATRIX_OP_POW].calls == 1 && !stats[MATRIX_OP_MUL].calls,
+               "matrix_stats m_pow: %llu calls, %llu of m_mul", (unsigned long long)stats[MATRIX_OP_POW].calls,
+               (unsigned long long)stats[MATRIX_OP_MUL].calls);
+
+    matrix_stats_reset();
+    matrix_stats(stats);
+    uint64_t total = 0;
+    for(size_t i = 0; i < MATRIX_OP_COUNT; i++)
+        total += stats[i].calls + stats[i].elements + stats[i].flops + stats[i].ns;
+    TEST_CHECK(!total, "matrix_stats_reset: counters left");
+    TEST_CHECK(!strcmp(matrix_op_name(MATRIX_OP_MUL), "m_mul") && !strcmp(matrix_op_name(MATRIX_OP_COUNT), "?"),
+               "matrix_op_name");
+
+    matrix_free(a);
+    matrix_free(b);
+    matrix_free(c);
+    matrix_free_f64(x);
+    matrix_free_f64(y);
+    matrix_free(sq);
+    matrix_free(p);
+}
+
+static void test_stats_trace(void){
+    test_trace_t t = { 0 };
+    matrix_t *a = matrix_of(3, 4, 1);
+    matrix_stats_hook(test_trace, &t);
+    matrix_t *b = m_kmul(a, 2), *c = m_transp(b);
+    matrix_stats_hook(NULL, &t);
+    matrix_t *d = m_add(a, a);
+    TEST_CHECK(t.calls == 2 && t.elements == 24 && t.op == MATRIX_OP_TRANSP,
+               "matrix_stats_hook: %llu calls, %llu elements, last %s", (unsigned long long)t.calls,
+               (unsigned long long)t.elements, matrix_op_name(t.op));
+    matrix_free(a);
+    matrix_free(b);
+    matrix_free(c);
+    matrix_free(d);
+}
+
+// hooks that check they receive the context they were set with
+static int test_ctx_a, test_ctx_b;
+static atomic_int test_hook_calls, test_hook_mismatch, test_hook_done;
+
+static void test_hook_a(matrix_op_t op, const matrix_stat_t *call, void *ctx){
+    (void)op;
+    (void)call;
+    atomic_fetch_add(&test_hook_calls, 1);
+    if(ctx != &test_ctx_a)
+        atomic_fetch_add(&test_hook_mismatch, 1);
+}
+
+static void test_hook_b(matrix_op_t op, const matrix_stat_t *call, void *ctx){
+    (void)op;
+    (void)call;
+    atomic_fetch_add(&test_hook_calls, 1);
+    if(ctx != &test_ctx_b)
+        atomic_fetch_add(&test_hook_mismatch, 1);
+}
+
+static void *test_stats_worker(void *arg){
+    (void)arg;
+    matrix_t *a = matrix_of(2, 2, 1);
+    while(!atomic_load(&test_hook_done))
+        m_kaddp(a, 1);
+    matrix_free(a);
+    return NULL;
+}
+
+static void test_stats_swap(void){
+    pthread_t threads[4];
+    for(size_t i = 0; i < 4; i++)
+        pthread_create(&threads[i], NULL, test_stats_worker, NULL);
+    for(int i = 0; i < 200000; i++)
+        matrix_stats_hook(i % 2 ? test_hook_a : test_hook_b, i % 2 ? &test_ctx_a : &test_ctx_b);
+    atomic_store(&test_hook_done, 1);
+    for(size_t i = 0; i < 4; i++)
+        pthread_join(threads[i], NULL);
+    matrix_stats_hook(NULL, NULL);
+    TEST_CHECK(!atomic_load(&test_hook_mismatch), "matrix_stats_hook: %d of %d calls with the context of the other hook",
+               atomic_load(&test_hook_mismatch), atomic_load(&test_hook_calls));
+}
+
+void test_stats(void){
+    if(!matrix_stats_enabled()){
+        test_stats_disabled();
+        return;
+    }
+    test_stats_counters();
+    test_stats_trace();
+    test_stats_swap();
+}
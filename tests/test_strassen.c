@@ -0,0 +1,125 @@
+/*
+ * Tests of the Strassen-Winograd multiplication: products with odd dimensions
+ * at several levels of the recursion, strided views as operands and result,
+ * m_pow, products on several threads at once (each has its own workspace),
+ * and the crossover setting.
+ */
+#include <string.h>
+#include <pthread.h>
+
+#include "test_typed.h"
+
+static void test_strassen_shapes(void){
+    // odd dimensions at several levels exercise the peeling of the last row, column and inner index
+    static const size_t shapes[][3] = {
+        {64, 64, 64}, {129, 131, 130}, {200, 67, 151}, {257, 256, 255}, {130, 300, 129},
+    };
+    matrix_set_strassen(64);
+
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++){
+        size_t m = shapes[s][0], k = shapes[s][1], n = shapes[s][2];
+        matrix_t *a = test_random(m, k), *b = test_random(k, n), *c = m_mul(a, b);
+        // normwise bound: every level of the recursion multiplies it by a small constant
+        TEST_CHECK(test_mul_error(a, b, c) <= test_mul_bound(a, b, 64),
+                   TEST_NAME " Strassen %zux%zux%zu: error %g", m, k, n, test_mul_error(a, b, c));
+
+        // the integer family is exact: the same product as the blocked kernel
+        if(TEST_INTEGER){
+            matrix_set_strassen(0);
+            matrix_t *d = m_mul(a, b);
+            TEST_CHECK(!memcmp(c->data, d->data, m * n * sizeof(MATRIX_TYPE)),
+                       TEST_NAME " Strassen %zux%zux%zu: not the blocked product", m, k, n);
+            matrix_free(d);
+            matrix_set_strassen(64);
+        }
+        matrix_free(a);
+        matrix_free(b);
+        matrix_free(c);
+    }
+
+    // m_pow: A^3 against (A*A)*A with the blocked kernel
+    matrix_t *a = test_random(129, 129);
+    if(!TEST_INTEGER)
+        m_kmulp(a, (MATRIX_TYPE)(1.0 / 16));
+    matrix_t *p = m_pow(a, 3);
+    matrix_set_strassen(0);
+    matrix_t *a2 = m_mul(a, a);
+    double err = test_mul_error(a2, a, p);
+    TEST_CHECK(err <= test_mul_bound(a2, a, 256), TEST_NAME " Strassen m_pow: error %g", err);
+    matrix_free(a);
+    matrix_free(a2);
+    matrix_free(p);
+}
+
+
+static void test_strassen_views(void){
+    // operands and result inside larger matrices, the elements around the result untouched
+    matrix_set_strassen(64);
+    matrix_t *big = test_random(300, 320), *out = matrix_init(150, 160);
+    matrix_t a = matrix_view(big, 1, 3, 131, 140), b = matrix_view(big, 150, 170, 140, 133), c = matrix_view(out, 5, 7, 131, 133);
+    m_mult(&a, &b, &c);
+    double err = test_mul_error(&a, &b, &c);
+    TEST_CHECK(err <= test_mul_bound(&a, &b, 64), TEST_NAME " Strassen on views: error %g", err);
+
+    int outside = 1;
+    for(size_t i = 0; i < 150; i++)
+        for(size_t j = 0; j < 160; j++)
+            outside &= (i >= 5 && i < 136 && j >= 7 && j < 140) || out->data[i * 160 + j] == 0;
+    TEST_CHECK(outside, TEST_NAME " Strassen on views: written outside the result");
+    matrix_free(big);
+    matrix_free(out);
+}
+
+typedef struct {
+    matrix_t *a, *b, *c;
+}test_strassen_job_t;
+
+static void *test_strassen_thread(void *arg){
+    test_strassen_job_t *job = arg;
+    job->c = m_mul(job->a, job->b);
+    return NULL;
+}
+
+static void test_strassen_threads(void){
+    matrix_set_strassen(64);
+    test_strassen_job_t jobs[3];
+    pthread_t threads[3];
+    for(size_t t = 0; t < 3; t++){
+        jobs[t] = (test_strassen_job_t){ test_random(130 + t, 140), test_random(140, 150 - t), NULL };
+        pthread_create(&threads[t], NULL, test_strassen_thread, &jobs[t]);
+    }
+    for(size_t t = 0; t < 3; t++){
+        pthread_join(threads[t], NULL);
+        double err = test_mul_error(jobs[t].a, jobs[t].b, jobs[t].c);
+        TEST_CHECK(err <= test_mul_bound(jobs[t].a, jobs[t].b, 64), TEST_NAME " Strassen on thread %zu: error %g", t, err);
+        matrix_free(jobs[t].a);
+        matrix_free(jobs[t].b);
+        matrix_free(jobs[t].c);
+    }
+}
+
+static void test_strassen_setting(void){
+    static const size_t values[] = { 0, 100, MATRIX_STRASSEN_AUTO, 1 };
+    for(size_t v = 0; v < sizeof(values) / sizeof(values[0]); v++){
+        matrix_set_strassen(values[v]);
+        TEST_CHECK(matrix_get_strassen() == values[v], "matrix_get_strassen: %zu set, %zu read", values[v],
+                   matrix_get_strassen());
+    }
+
+    // a crossover of 1 recurses down to the smallest one accepted only
+    matrix_t *a = test_random(70, 70), *b = test_random(70, 70), *c = m_mul(a, b);
+    double err = test_mul_error(a, b, c);
+    TEST_CHECK(err <= test_mul_bound(a, b, 64), TEST_NAME " Strassen with a crossover of 1: error %g", err);
+    matrix_free(a);
+    matrix_free(b);
+    matrix_free(c);
+}
+
+void MATRIX_NAME(test_strassen)(void){
+    size_t saved = matrix_get_strassen();
+    test_strassen_shapes();
+    test_strassen_views();
+    test_strassen_threads();
+    test_strassen_setting();
+    matrix_set_strassen(saved);
+}
@@ -0,0 +1,93 @@
+/*
+ * Tests of the transpositions against the element by element definition: the
+ * tiled out-of-place kernel on sizes around and between its 8x8 tiles, and
+ * the in-place ones on square views and dense rectangular shapes.
+ */
+#include <string.h>
+
+#include "test_typed.h"
+#include "matrix_transp.h"
+#include "state.h"
+
+// 1 if b is the transpose of a
+static int test_is_transp(const matrix_t *a, const matrix_t *b){
+    int same = b->row == a->col && b->col == a->row;
+    for(size_t i = 0; same && i < a->row; i++)
+        for(size_t j = 0; j < a->col; j++)
+            same &= AT(a, i, j) == AT(b, j, i);
+    return same;
+}
+
+static void test_transp_tiled(void){
+    static const size_t shapes[][2] = {
+        {1, 1}, {1, 9}, {7, 9}, {8, 8}, {13, 29}, {64, 63}, {100, 257}, {1000, 3}, {515, 517},
+    };
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++){
+        size_t m = shapes[s][0], n = shapes[s][1];
+        matrix_t *a = test_random(m, n), *t = m_transp(a);
+        TEST_CHECK(test_is_transp(a, t), TEST_NAME " m_transp %zux%zu", m, n);
+
+        // a view into a view
+        matrix_t *pa = test_random(m + 3, n + 1), *pt = test_random(n + 2, m + 5);
+        matrix_t va = matrix_view(pa, 3, 1, m, n), vt = matrix_view(pt, 1, 2, n, m);
+        m_transpt(&va, &vt);
+        TEST_CHECK(test_is_transp(&va, &vt), TEST_NAME " m_transpt views %zux%zu", m, n);
+
+        matrix_free(a);
+        matrix_free(t);
+        matrix_free(pa);
+        matrix_free(pt);
+    }
+}
+
+static void test_transp_rect(void *ctx){
+    matrix_t v = matrix_view(ctx, 0, 0, 2, 3);
+    m_transpp(&v);
+}
+
+static void test_transp_inplace(void){
+    // 1xN, Nx1, prime x composite and the other way round, with and without 8x8 tiles
+    static const size_t shapes[][2] = {
+        {1, 1}, {1, 100}, {100, 1}, {7, 12}, {13, 30}, {30, 13}, {31, 64}, {97, 100}, {127, 128}, {5, 515},
+    };
+    for(size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++){
+        size_t m = shapes[s][0], n = shapes[s][1];
+        matrix_t *a = test_random(m, n), *t = m_transp(a), *p = matrix_getcpy(a);
+        m_transpp(p);
+        int same = p->row == n && p->col == m && p->stride == m;
+        for(size_t i = 0; same && i < n; i++)
+            for(size_t j = 0; j < m; j++)
+                same &= AT(p, i, j) == AT(t, i, j);
+        TEST_CHECK(same, TEST_NAME " m_transpp %zux%zu: not m_transp", m, n);
+
+        // the kernel on the raw storage, back to the original
+        int back = !matrix_transpose_inplace(n, m, p->data) && !memcmp(p->data, a->data, m * n * sizeof(MATRIX_TYPE));
+        TEST_CHECK(back, TEST_NAME " matrix_transpose_inplace %zux%zu: not the inverse permutation", n, m);
+
+        matrix_free(a);
+        matrix_free(t);
+        matrix_free(p);
+    }
+
+    // square: dense and views, swapped across the diagonal
+    static const size_t sizes[] = { 1, 7, 8, 9, 65, 200 };
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+        size_t n = sizes[s];
+        matrix_t *big = test_random(n + 3, n + 2), v = matrix_view(big, 2, 1, n, n), *c = matrix_getcpy(&v);
+        m_transpp(&v);
+        TEST_CHECK(test_is_transp(c, &v), TEST_NAME " m_transpp view %zu", n);
+        matrix_free(big);
+        matrix_free(c);
+    }
+
+    // a rectangular view cannot take the transposed shape
+    matrix_t *a = test_random(4, 4);
+    TEST_CHECK(test_exits(test_transp_rect, a, MATRIX_INVALID_DIMENSIONS),
+               TEST_NAME " m_transpp: rectangular view accepted");
+    matrix_free(a);
+}
+
+void MATRIX_NAME(test_transp)(void){
+    test_transp_tiled();
+    test_transp_inplace();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+ * @file test_typed.h
+ * @brief Helpers of the typed test files
+ *
+ * A typed test file is compiled for f32 on its own, and again for f64 and i32
+ * by test_f64.c and test_i32.c, the same way as the typed sources of the
+ * library; its entry point is named with MATRIX_NAME and declared in test.h
+ * with TEST_TYPED.
+ *
+ * The floating point checks use error bounds of the form c * u * k * max|A| * max|B|
+ * (u the unit roundoff, k the inner dimension); the integer family is exact.
+ */
+
+#include <math.h>
+#include <float.h>
+
+#include "matrix.h"
+#include "test.h"
+
+#define TEST_INTEGER ((MATRIX_TYPE)0.5 == 0)
+
+// unit roundoff of the family, 0 for the integer one
+#define TEST_EPS (TEST_INTEGER ? 0 : sizeof(MATRIX_TYPE) == sizeof(float) ? (double)FLT_EPSILON : DBL_EPSILON)
+
+#if defined(MATRIX_FAMILY_F64)
+#define TEST_NAME "f64"
+#elif defined(MATRIX_FAMILY_I32)
+#define TEST_NAME "i32"
+#else
+#define TEST_NAME "f32"
+#endif
+
+#define AT(m, i, j) ((double)(m)->data[(i) * (m)->stride + (j)])
+
+static inline void test_fill(matrix_t *m1){
+    // small integers for i32, so that no sum of the tests overflows
+    for(size_t i = 0; i < m1->row; i++)
+        for(size_t j = 0; j < m1->col; j++)
+            m1->data[i * m1->stride + j] = TEST_INTEGER ? (MATRIX_TYPE)((int)(test_rand() % 17) - 8)
+                                                        : (MATRIX_TYPE)test_uniform(-1, 1);
+}
+
+static inline matrix_t *test_random(size_t row, size_t col){
+    matrix_t *m1 = matrix_init(row, col);
+    test_fill(m1);
+    return m1;
+}
+
+static inline double test_maxabs(const matrix_t *m1){
+    double max = 0;
+    for(size_t i = 0; i < m1->row; i++)
+        for(size_t j = 0; j < m1->col; j++)
+            max = fmax(max, fabs(AT(m1, i, j)));
+    return max;
+}
+
+static inline double test_mul_error(const matrix_t *a, const matrix_t *b, const matrix_t *c){
+    // largest |C - A*B|, the product in double
+    double err = 0;
+    for(size_t i = 0; i < a->row; i++)
+        for(size_t j = 0; j < b->col; j++){
+            double s = 0;
+            for(size_t p = 0; p < a->col; p++)
+                s += AT(a, i, p) * AT(b, p, j);
+            err = fmax(err, fabs(AT(c, i, j) - s));
+        }
+    return err;
+}
+
+static inline double test_mul_bound(const matrix_t *a, const matrix_t *b, double c){
+    return c * TEST_EPS * (a->col + 1) * test_maxabs(a) * test_maxabs(b);
+}